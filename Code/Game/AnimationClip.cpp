@@ -0,0 +1,238 @@
+#include "Game/AnimationClip.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <algorithm>
+#include <emmintrin.h>
+#include <math.h>
+
+
+constexpr float MAX_QUANTIZED_VALUE = 65535.f;
+
+
+//-----------------------------------------------------------------------------------------------
+void AnimationClip::Compress(RawAnimationClip const& rawClip, float tolerance)
+{
+	GUARANTEE_OR_DIE(rawClip.m_frames.size() >= 2, "Animation clips need at least two frames");
+
+	m_name = rawClip.m_name;
+	m_numBones = rawClip.m_frames[0].GetNumBones();
+	m_numValuesPerKey = NUM_POSE_CHANNELS * rawClip.m_frames[0].GetNumBonesPadded();
+	m_numRawFrames = (int)rawClip.m_frames.size();
+	m_framesPerSecond = rawClip.m_framesPerSecond;
+	m_duration = static_cast<float>(m_numRawFrames - 1) / m_framesPerSecond;
+	m_isLooping = rawClip.m_isLooping;
+
+	// keep each bone's rotations in one hemisphere so lerping between keys never takes the long way
+	RawAnimationClip continuousClip = rawClip;
+	for (int frameIndex = 1; frameIndex < m_numRawFrames; frameIndex++)
+	{
+		SkeletonPose const& previous = continuousClip.m_frames[frameIndex - 1];
+		SkeletonPose& current = continuousClip.m_frames[frameIndex];
+		for (int boneIndex = 0; boneIndex < m_numBones; boneIndex++)
+		{
+			Quaternion rotation = current.GetBoneRotation(boneIndex);
+			if (DotProduct4D(rotation, previous.GetBoneRotation(boneIndex)) < 0.f)
+			{
+				rotation = Quaternion(-rotation.x, -rotation.y, -rotation.z, -rotation.w);
+				current.SetBone(boneIndex, rotation, current.GetBoneTranslation(boneIndex));
+			}
+		}
+	}
+
+	std::vector<int> keyFrames;
+	FitKeyFrames(continuousClip, tolerance, keyFrames);
+	QuantizeKeys(continuousClip, keyFrames);
+	m_maxError = MeasureMaxError(continuousClip);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Douglas-Peucker over the whole pose: split a segment at the frame that straight-line
+// interpolation gets most wrong, until every channel is within tolerance
+//
+void AnimationClip::FitKeyFrames(RawAnimationClip const& rawClip, float tolerance, std::vector<int>& out_keyFrames) const
+{
+	int lastFrame = m_numRawFrames - 1;
+	std::vector<bool> isKeyFrame(m_numRawFrames, false);
+	isKeyFrame[0] = true;
+	isKeyFrame[lastFrame] = true;
+
+	std::vector<std::pair<int, int>> segments;
+	segments.push_back(std::make_pair(0, lastFrame));
+	while (!segments.empty())
+	{
+		int startFrame = segments.back().first;
+		int endFrame = segments.back().second;
+		segments.pop_back();
+		if (endFrame - startFrame < 2)
+		{
+			continue;
+		}
+
+		float const* startValues = rawClip.m_frames[startFrame].GetValues();
+		float const* endValues = rawClip.m_frames[endFrame].GetValues();
+		float worstError = 0.f;
+		int worstFrame = -1;
+		for (int frameIndex = startFrame + 1; frameIndex < endFrame; frameIndex++)
+		{
+			float fraction = static_cast<float>(frameIndex - startFrame) / static_cast<float>(endFrame - startFrame);
+			float const* values = rawClip.m_frames[frameIndex].GetValues();
+			for (int valueIndex = 0; valueIndex < m_numValuesPerKey; valueIndex++)
+			{
+				float fitted = startValues[valueIndex] + (endValues[valueIndex] - startValues[valueIndex]) * fraction;
+				float error = fabsf(fitted - values[valueIndex]);
+				if (error > worstError)
+				{
+					worstError = error;
+					worstFrame = frameIndex;
+				}
+			}
+		}
+
+		if (worstError > tolerance)
+		{
+			isKeyFrame[worstFrame] = true;
+			segments.push_back(std::make_pair(startFrame, worstFrame));
+			segments.push_back(std::make_pair(worstFrame, endFrame));
+		}
+	}
+
+	out_keyFrames.clear();
+	for (int frameIndex = 0; frameIndex < m_numRawFrames; frameIndex++)
+	{
+		if (isKeyFrame[frameIndex])
+		{
+			out_keyFrames.push_back(frameIndex);
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AnimationClip::QuantizeKeys(RawAnimationClip const& rawClip, std::vector<int> const& keyFrames)
+{
+	int numKeys = (int)keyFrames.size();
+	m_keyFrames.resize(numKeys);
+	m_keyValues.resize(numKeys * m_numValuesPerKey);
+	m_valueScales.resize(m_numValuesPerKey);
+	m_valueOffsets.resize(m_numValuesPerKey);
+
+	// each channel gets the full 16 bits over its own range; constant channels cost no precision
+	for (int valueIndex = 0; valueIndex < m_numValuesPerKey; valueIndex++)
+	{
+		float minValue = rawClip.m_frames[keyFrames[0]].GetValues()[valueIndex];
+		float maxValue = minValue;
+		for (int keyIndex = 1; keyIndex < numKeys; keyIndex++)
+		{
+			float value = rawClip.m_frames[keyFrames[keyIndex]].GetValues()[valueIndex];
+			minValue = value < minValue ? value : minValue;
+			maxValue = value > maxValue ? value : maxValue;
+		}
+
+		m_valueOffsets[valueIndex] = minValue;
+		m_valueScales[valueIndex] = (maxValue - minValue) / MAX_QUANTIZED_VALUE;
+	}
+
+	for (int keyIndex = 0; keyIndex < numKeys; keyIndex++)
+	{
+		m_keyFrames[keyIndex] = static_cast<float>(keyFrames[keyIndex]);
+		float const* values = rawClip.m_frames[keyFrames[keyIndex]].GetValues();
+		unsigned short* keyRow = &m_keyValues[keyIndex * m_numValuesPerKey];
+		for (int valueIndex = 0; valueIndex < m_numValuesPerKey; valueIndex++)
+		{
+			float scale = m_valueScales[valueIndex];
+			float quantized = scale > 0.f ? (values[valueIndex] - m_valueOffsets[valueIndex]) / scale : 0.f;
+			keyRow[valueIndex] = static_cast<unsigned short>(floorf(quantized + 0.5f));
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+float AnimationClip::MeasureMaxError(RawAnimationClip const& rawClip) const
+{
+	SkeletonPose sampledPose(m_numBones);
+	float maxError = 0.f;
+	for (int frameIndex = 0; frameIndex < m_numRawFrames; frameIndex++)
+	{
+		// the last frame of a loop wraps to the first, which holds the same pose
+		float seconds = static_cast<float>(frameIndex) / m_framesPerSecond;
+		Sample(seconds, sampledPose);
+
+		SkeletonPose const& rawPose = rawClip.m_frames[frameIndex];
+		for (int boneIndex = 0; boneIndex < m_numBones; boneIndex++)
+		{
+			Quaternion sampledRotation = sampledPose.GetBoneRotation(boneIndex);
+			Quaternion rawRotation = rawPose.GetBoneRotation(boneIndex);
+			float rotationError = 1.f - fabsf(DotProduct4D(sampledRotation, rawRotation));
+			float translationError = (sampledPose.GetBoneTranslation(boneIndex) - rawPose.GetBoneTranslation(boneIndex)).GetLength();
+			maxError = rotationError > maxError ? rotationError : maxError;
+			maxError = translationError > maxError ? translationError : maxError;
+		}
+	}
+
+	return maxError;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AnimationClip::Sample(float seconds, SkeletonPose& out_pose, int numBones) const
+{
+	if (out_pose.GetNumBones() != m_numBones)
+	{
+		out_pose.Resize(m_numBones);
+	}
+
+	if (m_isLooping)
+	{
+		seconds = fmodf(seconds, m_duration);
+		seconds = seconds < 0.f ? seconds + m_duration : seconds;
+	}
+	else
+	{
+		seconds = seconds < 0.f ? 0.f : (seconds > m_duration ? m_duration : seconds);
+	}
+
+	// one search finds the knot pair for every channel
+	float frame = seconds * m_framesPerSecond;
+	int numKeys = (int)m_keyFrames.size();
+	int endKey = (int)(std::upper_bound(m_keyFrames.begin(), m_keyFrames.end(), frame) - m_keyFrames.begin());
+	endKey = endKey < 1 ? 1 : (endKey > numKeys - 1 ? numKeys - 1 : endKey);
+	int startKey = endKey - 1;
+	float fraction = (frame - m_keyFrames[startKey]) / (m_keyFrames[endKey] - m_keyFrames[startKey]);
+	fraction = fraction < 0.f ? 0.f : (fraction > 1.f ? 1.f : fraction);
+
+	unsigned short const* startRow = &m_keyValues[startKey * m_numValuesPerKey];
+	unsigned short const* endRow = &m_keyValues[endKey * m_numValuesPerKey];
+	float* outValues = out_pose.GetValues();
+	__m128i const zero = _mm_setzero_si128();
+	__m128 const blend = _mm_set1_ps(fraction);
+	int const valuesPerChannel = m_numValuesPerKey / NUM_POSE_CHANNELS;
+	int const valuesToDecode = numBones < 0 || numBones >= m_numBones ? valuesPerChannel : GetNumBonesPadded(numBones);
+	for (int channelStart = 0; channelStart < m_numValuesPerKey; channelStart += valuesPerChannel)
+	{
+		for (int valueIndex = channelStart; valueIndex < channelStart + valuesToDecode; valueIndex += 4)
+		{
+			__m128 startValue = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(startRow + valueIndex)), zero));
+			__m128 endValue = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(endRow + valueIndex)), zero));
+			__m128 quantized = _mm_add_ps(startValue, _mm_mul_ps(_mm_sub_ps(endValue, startValue), blend));
+			__m128 value = _mm_add_ps(_mm_loadu_ps(&m_valueOffsets[valueIndex]), _mm_mul_ps(quantized, _mm_loadu_ps(&m_valueScales[valueIndex])));
+			_mm_storeu_ps(outValues + valueIndex, value);
+		}
+	}
+
+	NormalizePoseRotations(out_pose);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+size_t AnimationClip::GetCompressedBytes() const
+{
+	return m_keyFrames.size() * sizeof(float) + m_keyValues.size() * sizeof(unsigned short) +
+		(m_valueScales.size() + m_valueOffsets.size()) * sizeof(float);
+}
+
+size_t AnimationClip::GetRawBytes() const
+{
+	return static_cast<size_t>(m_numRawFrames) * NUM_POSE_CHANNELS * m_numBones * sizeof(float);
+}
@@ -0,0 +1,67 @@
+//-----------------------------------------------------------------------------------------------
+// AnimationClip.hpp
+//
+// Compressed skeletal animation. Keys are curve fitted (piecewise linear, knots only where the
+// motion needs them, shared by every channel) and quantized to 16 bits per channel with a
+// per-channel range. Each key row matches the SkeletonPose layout, so sampling is two row
+// decodes and a lerp done four channels at a time with SSE.
+//
+#pragma once
+
+#include "Game/Skeleton.hpp"
+
+#include <string>
+#include <vector>
+
+
+constexpr float DEFAULT_CLIP_TOLERANCE = 0.002f;		// quaternion units (~0.25 degrees) and meters
+
+
+//-----------------------------------------------------------------------------------------------
+struct RawAnimationClip
+{
+	std::string					m_name;
+	float						m_framesPerSecond = 30.f;
+	bool						m_isLooping = true;		// looping clips repeat the first frame at the end
+	std::vector<SkeletonPose>	m_frames;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class AnimationClip
+{
+public:
+	void Compress(RawAnimationClip const& rawClip, float tolerance = DEFAULT_CLIP_TOLERANCE);
+	// numBones limits decoding to the leading bones (-1 for all); the rest of out_pose is left alone
+	void Sample(float seconds, SkeletonPose& out_pose, int numBones = -1) const;
+
+	std::string const& GetName() const { return m_name; }
+	float GetDuration() const { return m_duration; }
+	bool IsLooping() const { return m_isLooping; }
+	int GetNumBones() const { return m_numBones; }
+	int GetNumKeys() const { return (int)m_keyFrames.size(); }
+	int GetNumRawFrames() const { return m_numRawFrames; }
+	size_t GetCompressedBytes() const;
+	size_t GetRawBytes() const;
+	float GetMaxError() const { return m_maxError; }
+
+private:
+	void FitKeyFrames(RawAnimationClip const& rawClip, float tolerance, std::vector<int>& out_keyFrames) const;
+	void QuantizeKeys(RawAnimationClip const& rawClip, std::vector<int> const& keyFrames);
+	float MeasureMaxError(RawAnimationClip const& rawClip) const;
+
+private:
+	std::string						m_name;
+	int								m_numBones = 0;
+	int								m_numValuesPerKey = 0;		// NUM_POSE_CHANNELS * padded bones
+	int								m_numRawFrames = 0;
+	float							m_framesPerSecond = 30.f;
+	float							m_duration = 0.f;
+	bool							m_isLooping = true;
+	float							m_maxError = 0.f;
+
+	std::vector<float>				m_keyFrames;				// source frame of each key, ascending
+	std::vector<unsigned short>		m_keyValues;				// one row of m_numValuesPerKey per key
+	std::vector<float>				m_valueScales;
+	std::vector<float>				m_valueOffsets;
+};
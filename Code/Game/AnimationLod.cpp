@@ -0,0 +1,151 @@
+#include "Game/AnimationLod.hpp"
+#include "Game/LocomotionAnimations.hpp"
+
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <algorithm>
+#include <math.h>
+
+
+constexpr float NEVER_UPDATED_URGENCY = 1.0e30f;
+constexpr float EVERY_FRAME_URGENCY = 1.0e20f;		// LODs with no interval go before any throttled one
+constexpr float MIN_LOD_DISTANCE = 0.01f;
+constexpr double EXPECTED_EVALUATIONS_MARGIN = 1.5;
+
+
+//-----------------------------------------------------------------------------------------------
+void AnimationLodScheduler::Update(LocomotionAnimations const& animations, Vec3 const& cameraPosition, float verticalFovDegrees, float deltaSeconds,
+	AnimationLodCharacter* characters, int numCharacters)
+{
+	double startSeconds = GetCurrentTimeSeconds();
+	m_stats = AnimationLodStats();
+	m_dueCharacters.clear();
+
+	// world height the viewport spans one meter from the camera
+	float screenHeightAtUnitDistance = 2.f * tanf(ConvertDegreesToRadians(0.5f * verticalFovDegrees));
+
+	// pick LODs, collect what is due, and interpolate everything else
+	for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+	{
+		AnimationLodCharacter& character = characters[characterIndex];
+		character.m_isPoseChanged = false;
+		character.m_secondsSinceUpdate += deltaSeconds;
+		character.m_lod = ChooseLod(character.m_position, cameraPosition, screenHeightAtUnitDistance);
+		m_stats.m_numCharactersPerLod[character.m_lod]++;
+
+		float interval = m_settings.m_updateIntervals[character.m_lod];
+		if (!character.m_hasUpdated || character.m_secondsSinceUpdate >= interval)
+		{
+			DueCharacter due;
+			due.m_characterIndex = characterIndex;
+			if (!character.m_hasUpdated)
+			{
+				due.m_urgency = NEVER_UPDATED_URGENCY;
+			}
+			else
+			{
+				due.m_urgency = interval > 0.f ? character.m_secondsSinceUpdate / interval : EVERY_FRAME_URGENCY + character.m_secondsSinceUpdate;
+			}
+			m_dueCharacters.push_back(due);
+
+			// if the budget defers it, the interpolation finishes at its target and holds there
+			bool isFirstFrameDue = character.m_secondsSinceUpdate - deltaSeconds < interval;
+			if (character.m_hasUpdated && m_settings.m_interpolates[character.m_lod] && isFirstFrameDue)
+			{
+				character.m_pose = character.m_targetPose;
+				character.m_isPoseChanged = true;
+			}
+		}
+		else if (m_settings.m_interpolates[character.m_lod])
+		{
+			BlendPoses(character.m_previousTargetPose, character.m_targetPose, character.m_secondsSinceUpdate / interval, character.m_pose);
+			character.m_isPoseChanged = true;
+			m_stats.m_numInterpolated++;
+		}
+	}
+
+	// most overdue first, for as long as the budget lasts; at least one so nothing starves. Only as
+	// many as the last frames' rate says can fit get sorted, so a big backlog doesn't cost a full sort.
+	auto isMoreUrgent = [](DueCharacter const& a, DueCharacter const& b) { return a.m_urgency > b.m_urgency; };
+	double budgetSeconds = 0.001 * static_cast<double>(m_settings.m_updateBudgetMs);
+	int numDue = (int)m_dueCharacters.size();
+	double expectedEvaluations = EXPECTED_EVALUATIONS_MARGIN * budgetSeconds / m_secondsPerEvaluation + 1.0;
+	int numToSort = numDue;
+	if (expectedEvaluations < static_cast<double>(numDue))
+	{
+		numToSort = static_cast<int>(expectedEvaluations);
+		std::nth_element(m_dueCharacters.begin(), m_dueCharacters.begin() + numToSort, m_dueCharacters.end(), isMoreUrgent);
+	}
+	std::sort(m_dueCharacters.begin(), m_dueCharacters.begin() + numToSort, isMoreUrgent);
+
+	double evaluationStartSeconds = GetCurrentTimeSeconds();
+	double elapsedSeconds = 0.0;
+	int dueIndex = 0;
+	for (; dueIndex < numToSort; dueIndex++)
+	{
+		elapsedSeconds = GetCurrentTimeSeconds() - evaluationStartSeconds;
+		if (dueIndex > 0 && elapsedSeconds > budgetSeconds)
+		{
+			break;
+		}
+
+		EvaluateCharacter(animations, characters[m_dueCharacters[dueIndex].m_characterIndex]);
+		m_stats.m_numUpdated++;
+	}
+	if (m_stats.m_numUpdated > 1)
+	{
+		m_secondsPerEvaluation = elapsedSeconds / static_cast<double>(m_stats.m_numUpdated - 1);
+	}
+	m_stats.m_numDeferred = numDue - m_stats.m_numUpdated;
+
+	m_stats.m_updateMs = 1000.0 * (GetCurrentTimeSeconds() - startSeconds);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int AnimationLodScheduler::ChooseLod(Vec3 const& characterPosition, Vec3 const& cameraPosition, float screenHeightAtUnitDistance) const
+{
+	float distance = (characterPosition - cameraPosition).GetLength();
+	distance = distance > MIN_LOD_DISTANCE ? distance : MIN_LOD_DISTANCE;
+	float screenFraction = m_settings.m_characterHeight / (distance * screenHeightAtUnitDistance);
+
+	int lod = 0;
+	for (int lodIndex = 0; lodIndex < NUM_ANIMATION_LODS - 1; lodIndex++)
+	{
+		if (distance > m_settings.m_maxDistances[lodIndex] || screenFraction < m_settings.m_minScreenFractions[lodIndex])
+		{
+			lod = lodIndex + 1;
+		}
+	}
+	return lod;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AnimationLodScheduler::EvaluateCharacter(LocomotionAnimations const& animations, AnimationLodCharacter& character)
+{
+	int lod = character.m_lod;
+	int numBones = m_settings.m_animatesDetailBones[lod] ? animations.m_skeleton.GetNumBones() : animations.m_numCoreBones;
+
+	// the old target becomes the start of the next interpolation; swapping keeps both buffers allocated
+	std::swap(character.m_previousTargetPose, character.m_targetPose);
+	animations.m_blendSpace.EvaluatePose(character.m_localVelocity, character.m_secondsSinceUpdate, animations.m_clips, character.m_blendState,
+		m_scratchPose, character.m_targetPose, m_settings.m_maxBlendClips[lod], numBones);
+
+	// nothing sensible to come from when this is the first pose or bones were just switched back on
+	bool interpolates = m_settings.m_interpolates[lod] && m_settings.m_updateIntervals[lod] > 0.f;
+	if (!character.m_hasUpdated || numBones > character.m_numBones || !interpolates)
+	{
+		character.m_previousTargetPose = character.m_targetPose;
+		character.m_pose = character.m_targetPose;
+	}
+	else
+	{
+		character.m_pose = character.m_previousTargetPose;
+	}
+
+	character.m_numBones = numBones;
+	character.m_secondsSinceUpdate = 0.f;
+	character.m_hasUpdated = true;
+	character.m_isPoseChanged = true;
+}
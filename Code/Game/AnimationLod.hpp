@@ -0,0 +1,102 @@
+//-----------------------------------------------------------------------------------------------
+// AnimationLod.hpp
+//
+// Level of detail for locomotion animation. Each character's LOD comes from its distance to the
+// camera and the fraction of the screen it covers. Coarser LODs re-evaluate the blend space less
+// often and show a pose interpolated between the last two evaluations. They also blend fewer
+// clips and skip the detail bones. Evaluations that are due are run most overdue first, until
+// the frame's time budget is spent; the rest wait a frame.
+//
+#pragma once
+
+#include "Game/BlendSpace2D.hpp"
+#include "Game/Skeleton.hpp"
+
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <vector>
+
+struct LocomotionAnimations;
+
+
+constexpr int NUM_ANIMATION_LODS = 4;
+
+
+//-----------------------------------------------------------------------------------------------
+struct AnimationLodSettings
+{
+	// a character takes the coarser of its distance LOD and its screen size LOD
+	float	m_maxDistances[NUM_ANIMATION_LODS - 1] = { 12.f, 30.f, 70.f };
+	float	m_minScreenFractions[NUM_ANIMATION_LODS - 1] = { 0.2f, 0.08f, 0.03f };	// of the viewport height
+	float	m_characterHeight = 1.8f;
+
+	float	m_updateIntervals[NUM_ANIMATION_LODS] = { 0.f, 1.f / 30.f, 1.f / 12.f, 1.f / 5.f };
+	bool	m_interpolates[NUM_ANIMATION_LODS] = { false, true, true, false };		// the last LOD just holds its pose
+	int		m_maxBlendClips[NUM_ANIMATION_LODS] = { 3, 3, 2, 1 };
+	bool	m_animatesDetailBones[NUM_ANIMATION_LODS] = { true, true, false, false };
+
+	float	m_updateBudgetMs = 1.f;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct AnimationLodCharacter
+{
+	// set by the owner every frame
+	Vec3				m_position;
+	Vec2				m_localVelocity;			// x forward, y left; the blend space input
+
+	// the pose to draw; m_numBones leading bones are valid, and m_isPoseChanged says whether
+	// model transforms need recomputing this frame
+	SkeletonPose		m_pose;
+	int					m_numBones = 0;
+	int					m_lod = 0;
+	bool				m_isPoseChanged = false;
+
+	// last two evaluations; m_pose moves from the first to the second over one update interval
+	BlendSpaceState		m_blendState;
+	SkeletonPose		m_previousTargetPose;
+	SkeletonPose		m_targetPose;
+	float				m_secondsSinceUpdate = 0.f;
+	bool				m_hasUpdated = false;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct AnimationLodStats
+{
+	int		m_numCharactersPerLod[NUM_ANIMATION_LODS] = {};
+	int		m_numUpdated = 0;				// full blend space evaluations this frame
+	int		m_numDeferred = 0;				// due, but pushed to a later frame by the budget
+	int		m_numInterpolated = 0;
+	double	m_updateMs = 0.0;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class AnimationLodScheduler
+{
+public:
+	void Update(LocomotionAnimations const& animations, Vec3 const& cameraPosition, float verticalFovDegrees, float deltaSeconds,
+		AnimationLodCharacter* characters, int numCharacters);
+
+	AnimationLodStats const& GetStats() const { return m_stats; }
+
+	AnimationLodSettings	m_settings;
+
+private:
+	int ChooseLod(Vec3 const& characterPosition, Vec3 const& cameraPosition, float screenHeightAtUnitDistance) const;
+	void EvaluateCharacter(LocomotionAnimations const& animations, AnimationLodCharacter& character);
+
+private:
+	struct DueCharacter
+	{
+		float	m_urgency;					// seconds overdue as a multiple of the interval
+		int		m_characterIndex;
+	};
+
+	std::vector<DueCharacter>	m_dueCharacters;		// kept between frames so sorting allocates nothing
+	double						m_secondsPerEvaluation = 1.0e-6;
+	SkeletonPose				m_scratchPose;
+	AnimationLodStats			m_stats;
+};
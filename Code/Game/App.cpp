@@ -1,6 +1,11 @@
 #include "Game/Game.hpp"
 #include "Game/AttractMode.hpp"
 #include "Game/App.hpp"
+#include "Game/DebugLineBatch.hpp"
+#include "Game/FrameMemory.hpp"
+#include "Game/GameBenchmarks.hpp"
+#include "Game/InputQueue.hpp"
+#include "Game/VertexStream.hpp"
 
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/DebugRenderSystem.hpp"
@@ -10,9 +15,16 @@
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/Clock.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/Math/AABB2.hpp"
 
 
+constexpr float PLAY_MODE_TARGET_FPS = 120.f;
+constexpr float ATTRACT_MODE_TARGET_FPS = 30.f;
+constexpr float UNFOCUSED_TARGET_FPS = 10.f;
+
+
 App* g_theApp = nullptr;			// Created and owned by Main_Windows.cpp
 Renderer* g_theRenderer = nullptr;	// Created and owned by the App
 InputSystem* g_theInput = nullptr;	// used by game code for input queries. App class should own (create, manage, destroy) a single instance of the InputSystem for your game
@@ -28,6 +40,9 @@ App::~App()
 
 void App::Startup()
 {
+	// per-frame scratch memory
+	FrameMemoryStartup();
+
 	// create the event system
 	EventSystemConfig eventSystemConfig;
 	g_theEventSystem = new EventSystem(eventSystemConfig);
@@ -59,6 +74,16 @@ void App::Startup()
 	g_theWindow->Startup();
 	g_theRenderer->Startup();
 
+	// transient geometry is streamed through one shared vertex buffer
+	g_vertexStream = new VertexStream(g_theRenderer);
+	g_debugLines = new DebugLineBatch();
+	g_inputQueue = new InputQueue();
+
+	m_playModeTargetFps = PLAY_MODE_TARGET_FPS;
+	m_attractModeTargetFps = ATTRACT_MODE_TARGET_FPS;
+	m_unfocusedTargetFps = UNFOCUSED_TARGET_FPS;
+	m_framePacer.Startup();
+
 	// create and startup debug renderer
 	DebugRenderConfig debugRendererConfig;
 	debugRendererConfig.m_renderer = g_theRenderer;
@@ -72,6 +97,10 @@ void App::Startup()
 
 	// subscribe to quit event
 	g_theEventSystem->SubscribeToEvent(QUIT_COMMAND, App::EventHandler_CloseWindow);
+	g_theEventSystem->SubscribeToEvent("Crowd", App::Command_Crowd);
+	g_theEventSystem->SubscribeToEvent("CrowdGoal", App::Command_CrowdGoal);
+	g_theEventSystem->SubscribeToEvent("FrameRate", App::Command_FrameRate);
+	RegisterGameBenchmarkCommands();
 }
 
 void App::Run()
@@ -79,42 +108,75 @@ void App::Run()
 	// Program main loop; keep running frames until it's time to quit
 	while (!IsQuitting())
 	{
+		UpdateFramePacing();
+		m_framePacer.WaitForNextFrame();
 		RunFrame();
 	}
 }
 
+//-----------------------------------------------------------------------------------------------
+// the attract screen and an unfocused window don't need full rate
+//
+void App::UpdateFramePacing()
+{
+	float targetFps = m_gameState == PLAY_MODE ? m_playModeTargetFps : m_attractModeTargetFps;
+	if (!g_theWindow->DoesCurrentWindowHaveFocus())
+	{
+		targetFps = m_unfocusedTargetFps;
+	}
+	m_framePacer.SetTargetFps(targetFps);
+}
+
 void App::Shutdown()
 {
 	// un-subscribe from quit event
 	g_theEventSystem->UnsubscribeFromEvent(QUIT_COMMAND, App::EventHandler_CloseWindow);
+	g_theEventSystem->UnsubscribeFromEvent("Crowd", App::Command_Crowd);
+	g_theEventSystem->UnsubscribeFromEvent("CrowdGoal", App::Command_CrowdGoal);
+	g_theEventSystem->UnsubscribeFromEvent("FrameRate", App::Command_FrameRate);
+	UnregisterGameBenchmarkCommands();
 
 	m_isQuitting = false;
+	m_framePacer.Shutdown();
+
+	// the game owns GPU buffers, so it goes before the renderer does
+	if (m_theGame != nullptr)
+	{
+		m_theGame->Shutdown();
+	}
+	delete m_theGame;			m_theGame = nullptr;
+	delete m_theAttractMode;	m_theAttractMode = nullptr;
 
 	DebugRenderSystemShutdown();
+	delete g_debugLines;		g_debugLines = nullptr;
+	delete g_vertexStream;		g_vertexStream = nullptr;
+	delete g_inputQueue;		g_inputQueue = nullptr;
 	g_theRenderer->Shutdown();
 	g_theWindow->Shutdown();
 	g_theInput->Shutdown();
 	g_theEventSystem->Shutdown();
 	g_theDevConsole->Shutdown();
 
-	if (m_theGame != nullptr)
-	{
-		m_theGame->Shutdown();
-	}
-	delete m_theGame;			m_theGame = nullptr;
-	delete m_theAttractMode;	m_theAttractMode = nullptr;
 	delete g_theRenderer;		g_theRenderer = nullptr;
 	delete g_theWindow;			g_theWindow = nullptr;
 	delete g_theInput;			g_theInput = nullptr;
 	delete g_theEventSystem;	g_theEventSystem = nullptr;
 	delete g_theDevConsole;		g_theDevConsole = nullptr;
+
+	FrameMemoryShutdown();
 }
 
 void App::RunFrame()
 {
 	BeginFrame();
 	Update();
-	Render();
+
+	// an idle attract screen leaves the last presented frame up
+	m_isFrameSkipped = m_gameState == ATTRACT_MODE && m_theAttractMode != nullptr && !m_theAttractMode->NeedsRedraw() && !g_theDevConsole->IsOpen();
+	if (!m_isFrameSkipped)
+	{
+		Render();
+	}
 	EndFrame();
 }
 
@@ -127,11 +189,17 @@ bool App::HandleQuitRequested()
 
 void App::BeginFrame()
 {
+	// everything allocated from frame scratch memory last frame is gone after this
+	FrameMemoryBeginFrame();
+
 	Clock::TickSystemClock();
 
 	g_theInput->BeginFrame();
 	g_theWindow->BeginFrame();
+	g_inputQueue->SampleInput();
 	g_theRenderer->BeginFrame();
+	g_vertexStream->BeginFrame();
+	g_debugLines->Clear();
 	g_theDevConsole->BeginFrame();
 	DebugRenderBeginFrame();
 
@@ -285,7 +353,11 @@ void App::EndFrame()
 {
 	g_theInput->EndFrame();
 	g_theWindow->EndFrame();
-	g_theRenderer->EndFrame();
+	if (!m_isFrameSkipped)
+	{
+		g_theRenderer->EndFrame();
+	}
+	g_inputQueue->EndFrame(GetCurrentTimeSeconds());		// presented
 	g_theDevConsole->EndFrame();
 	DebugRenderEndFrame();
 
@@ -325,15 +397,85 @@ bool App::EventHandler_CloseWindow(EventArgs& eventArgs)
 	return false;
 }
 
+
+//-----------------------------------------------------------------------------------------------
+// Crowd agents=1000; agents=0 removes the crowd
+//
+bool App::Command_Crowd(EventArgs& args)
+{
+	if (g_theApp == nullptr || g_theApp->m_gameState != PLAY_MODE || g_theApp->m_theGame == nullptr)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "Crowd: start the game first");
+		return false;
+	}
+
+	int numAgents = args.GetValue("agents", -1);
+	if (numAgents < 0)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "Crowd: usage Crowd agents=N");
+		return false;
+	}
+
+	g_theApp->m_theGame->SetCrowdSize(numAgents);
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("Crowd: %d agents", numAgents));
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// CrowdGoal x=10 y=-5 sends every agent there; CrowdGoal with no position lets them wander again
+//
+bool App::Command_CrowdGoal(EventArgs& args)
+{
+	if (g_theApp == nullptr || g_theApp->m_gameState != PLAY_MODE || g_theApp->m_theGame == nullptr)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "CrowdGoal: start the game first");
+		return false;
+	}
+
+	bool hasX = !args.GetValue("x", std::string()).empty();
+	bool hasY = !args.GetValue("y", std::string()).empty();
+	if (!hasX && !hasY)
+	{
+		g_theApp->m_theGame->ClearCrowdGoal();
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "CrowdGoal: cleared, agents walk between waypoints");
+		return true;
+	}
+
+	Vec2 goal(args.GetValue("x", 0.f), args.GetValue("y", 0.f));
+	g_theApp->m_theGame->SetCrowdGoal(goal);
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("CrowdGoal: every agent heading to (%.1f, %.1f)", goal.x, goal.y));
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// FrameRate play=120 attract=30 unfocused=10; 0 runs that state unpaced, omitted rates are kept
+//
+bool App::Command_FrameRate(EventArgs& args)
+{
+	if (g_theApp == nullptr)
+	{
+		return false;
+	}
+
+	g_theApp->m_playModeTargetFps = args.GetValue("play", g_theApp->m_playModeTargetFps);
+	g_theApp->m_attractModeTargetFps = args.GetValue("attract", g_theApp->m_attractModeTargetFps);
+	g_theApp->m_unfocusedTargetFps = args.GetValue("unfocused", g_theApp->m_unfocusedTargetFps);
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("FrameRate: play %.0f, attract %.0f, unfocused %.0f fps",
+		g_theApp->m_playModeTargetFps, g_theApp->m_attractModeTargetFps, g_theApp->m_unfocusedTargetFps));
+	return true;
+}
+
 void App::AddGameKeyText()
 {
 	if (g_theDevConsole)
 	{
 		g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, "Major Controls");
 		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "---------------");
-		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- E/S/D/F		: XY Movement");
-		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- Z / C			: Z Movement");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- W/S/A/D		: XY Movement");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- Space			: Jump");
 		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- Shift			: Sprint");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- M				: Toggle blend space / motion matching locomotion");
 		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- 1				: Spawn wire frame sphere");
 		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- 2				: spawn Line");
 		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- 3				: Spawn Basis");
@@ -341,11 +483,33 @@ void App::AddGameKeyText()
 		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- 5				: Spawn Wire frame Cylinder");
 		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- 6				: Spawn point");
 		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- 7				: Add Message");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- 8				: Spawn 1000 points per frame (hold)");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- K				: Throw a physics ball");
 		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- ~				: Open Dev console");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- Crowd agents=1000	: Spawn a crowd of autonomous agents (0 removes it)");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- CrowdGoal x=0 y=0	: Send the crowd to one goal (no position clears it)");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- FrameRate play=120 attract=30 unfocused=10	: Frame rate targets (0 is unpaced)");
 		g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, "Other Controls");
 		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "---------------");
 		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- Space	: Start game from Attract mode. ");
 		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- Esc	: Quit if in Attract Mode. / Go back to Attract mode if in Game mode.");
+		g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, "Benchmarks");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "---------------");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkSpringArm props=100000 frames=10000");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkCharacters characters=500 props=10000 frames=600");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkAnimation characters=1000 frames=100");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkBlendSpace characters=5000 frames=100");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkMotionMatching characters=1000 rates=16 tolerance=0 interval=0.1 frames=60");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkAnimationLod characters=4000 radius=150 budget=1 frames=120");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkSkinning vertices=1000000 frames=20");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkCrowd agents=4000 props=200 frames=120 threads=-1");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkFlowField obstacles=300 goals=8 agents=10000 moves=50 threads=-1");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkSimdMath matrices=100000 frames=20");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkPropOrientation props=10000 frames=600");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkRings rings=1000 sides=64 frames=100");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkDebugLines lines=10000 frames=100");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkPhysics bodies=10000 frames=600 throws=20");
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, "- BenchmarkParticles particles=1000000 frames=120");
 		g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, "Type help for a list of commands");
 	}
 }
@@ -365,5 +529,12 @@ void App::UpdateCursorState()
 		cursorRelative = true;
 	}
 
-	g_theInput->SetCursorMode(cursorHidden, cursorRelative);
+	bool isModeChanged = !m_hasSetCursorMode || cursorHidden != m_isCursorHidden || cursorRelative != m_isCursorRelative;
+	if (isModeChanged)
+	{
+		g_theInput->SetCursorMode(cursorHidden, cursorRelative);
+		m_hasSetCursorMode = true;
+		m_isCursorHidden = cursorHidden;
+		m_isCursorRelative = cursorRelative;
+	}
 }
\ No newline at end of file
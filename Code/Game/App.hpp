@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Game/GameCommon.hpp"
+#include "Game/FramePacer.hpp"
 
 #include "Engine/Renderer/Camera.hpp"
 #include "Engine/Core/Rgba8.hpp"
@@ -24,24 +25,42 @@ public:
 	bool IsQuitting() const { return m_isQuitting; }
 	bool HandleQuitRequested();
 
+	FramePacerStats const& GetFramePacerStats() const { return m_framePacer.GetStats(); }
+
 private:
 	void BeginFrame();
 	void Update();
 	void Render() const;
 	void EndFrame();
+	void UpdateFramePacing();
 
 private:
 	bool m_isQuitting = false;
+	bool m_isFrameSkipped = false;		// nothing rendered or presented this frame
 	Game* m_theGame = nullptr;
 	AttractMode* m_theAttractMode = nullptr;
 
 	void LoadFonts();
 	void LoadTextures();
 	static bool EventHandler_CloseWindow(EventArgs& eventArgs);
+	static bool Command_Crowd(EventArgs& args);
+	static bool Command_CrowdGoal(EventArgs& args);
+	static bool Command_FrameRate(EventArgs& args);
 	void AddGameKeyText();
 	void RenderTestMouse() const;
 	void UpdateCursorState();
 
+	// last mode handed to the InputSystem; it is only told again when this changes
+	bool m_hasSetCursorMode = false;
+	bool m_isCursorHidden = false;
+	bool m_isCursorRelative = false;
+
+	// frames per second per state; 0 runs unpaced
+	FramePacer m_framePacer;
+	float m_playModeTargetFps = 0.f;
+	float m_attractModeTargetFps = 0.f;
+	float m_unfocusedTargetFps = 0.f;
+
 public:
 	GameState m_gameState = ATTRACT_MODE;
 };
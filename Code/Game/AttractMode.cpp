@@ -1,11 +1,17 @@
 #include "Game/App.hpp"
 #include "Game/AttractMode.hpp"
+#include "Game/DebugLineBatch.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/InputQueue.hpp"
+#include "Game/VertexSpanUtils.hpp"
 
 #include "Engine/Math/MathUtils.hpp"
+#include "Engine/Window/Window.hpp"
 #include "Engine/Core/Clock.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
+#include <math.h>
 
 extern App* g_theApp;
 
@@ -13,12 +19,33 @@ constexpr int MAX_VERTEXAS = 3;
 constexpr float MIN_CIRCLE_RADIUS = 2.0f;
 constexpr float MAX_CIRCLE_RADIUS = 20.0f;
 constexpr float CHANGE_SPEED = 15.0f;
+constexpr float RING_THICKNESS = 3.0f;
+constexpr double MAX_SECONDS_BETWEEN_REDRAWS = 1.0;	// in case the window lost its contents
+const Rgba8 RING_COLOR(255, 0, 0);
+
+
+float RangeMapX(float value);
+float RangeMapY(float value);
+
 
 void AttractMode::Startup()
 {
 	m_screenCamera.SetOrthographicView(Vec2(0.f, 0.f), Vec2(200.f, 100.f));
 
 	m_attractModeClock = new Clock();
+
+	// nothing here but the ring ever changes shape
+	m_triangleVertexes[0] = Vertex_PCU(Vec3(RangeMapX(-0.5f), RangeMapY(-0.5f), 0.f), Rgba8::WHITE, Vec2::ZERO);
+	m_triangleVertexes[1] = Vertex_PCU(Vec3(RangeMapX(0.f), RangeMapY(0.5f), 0.f), Rgba8::WHITE, Vec2::ZERO);
+	m_triangleVertexes[2] = Vertex_PCU(Vec3(RangeMapX(0.5f), RangeMapY(-0.5f), 0.f), Rgba8::WHITE, Vec2::ZERO);
+
+	VertexSpanWriter boxVerts(m_boxVertexes, AABB2_NUM_VERTEXES);
+	AddVertsForAABB2(boxVerts, AABB2(Vec2(10.f, 10.f), Vec2(50.f, 50.f)), Rgba8(255, 255, 255));
+	m_boxTexture = g_theRenderer->CreateOrGetTextureFromFile("Data/Images/Test_StbiFlippedAndOpenGL.png");
+
+	BuildRingVertexes();
+	m_lastRedrawSeconds = GetCurrentTimeSeconds();
+	m_needsRedraw = true;
 }
 
 void AttractMode::Update()
@@ -61,8 +88,12 @@ void AttractMode::Update()
 		m_attractModeClock->StepSingleFrame();
 	}
 
-	
+	UpdateCircleRadius(deltaseconds);
+	UpdateRedraw();
+}
 
+void AttractMode::UpdateCircleRadius(float deltaseconds)
+{
 	if (isIncreasing)
 	{
 		m_circleRadius += (deltaseconds * CHANGE_SPEED);
@@ -87,6 +118,44 @@ void AttractMode::Update()
 	}
 }
 
+//----------------------------------------------------------------------------------------------------------
+// Redraw when the ring would move by more than a pixel, when input came in (it may be typed into
+// the dev console or change the clock), and once in a while regardless
+//
+void AttractMode::UpdateRedraw()
+{
+	float screenHeight = m_screenCamera.GetOrthographicTopRight().y - m_screenCamera.GetOrthographicBottomLeft().y;
+	int clientHeight = g_theWindow->GetClientDimensions().y;
+	float unitsPerPixel = clientHeight > 0 ? screenHeight / (float)clientHeight : 0.f;
+	bool hasRingMoved = fabsf(m_circleRadius - m_ringVertexesRadius) > unitsPerPixel;
+
+	bool hasInput = !g_inputQueue->GetEvents().empty();
+	g_inputQueue->ConsumeAllEvents();
+
+	double nowSeconds = GetCurrentTimeSeconds();
+	bool isStale = nowSeconds - m_lastRedrawSeconds > MAX_SECONDS_BETWEEN_REDRAWS;
+
+	m_needsRedraw = hasRingMoved || hasInput || isStale;
+	if (!m_needsRedraw)
+	{
+		return;
+	}
+
+	if (hasRingMoved)
+	{
+		BuildRingVertexes();
+	}
+	m_lastRedrawSeconds = nowSeconds;
+}
+
+void AttractMode::BuildRingVertexes()
+{
+	Vec2 center = (m_screenCamera.GetOrthographicBottomLeft() + m_screenCamera.GetOrthographicTopRight()) / 2.f;
+	VertexSpanWriter ringVerts(m_ringVertexes, GetNumVertexesForRing2D());
+	AddVertsForRing2D(ringVerts, center, m_circleRadius, RING_THICKNESS, RING_COLOR);
+	m_ringVertexesRadius = m_circleRadius;
+}
+
 void AttractMode::Render() const
 {
 	g_theRenderer->ClearScreen(m_backgroundColor);
@@ -94,30 +163,18 @@ void AttractMode::Render() const
 	g_theRenderer->BeginCamera(m_screenCamera);
 	RenderTestTriangle();
 	RenderRingAndTexture();
+	g_debugLines->Render();
 
 	g_theRenderer->EndCamera(m_screenCamera);
 }
 
 void AttractMode::RenderRingAndTexture() const
 {
-	// box
-	std::vector<Vertex_PCU> boxVerts;
-	AABB2 bounds(Vec2(10.f, 10.f), Vec2(50.f, 50.f));
-	AddVertsForAABB2(boxVerts, bounds, Rgba8(255, 255, 255));
+	g_theRenderer->BindTexture(m_boxTexture);
+	g_theRenderer->DrawVertexArray(AABB2_NUM_VERTEXES, m_boxVertexes);
 
-	Texture* texture = g_theRenderer->CreateOrGetTextureFromFile("Data/Images/Test_StbiFlippedAndOpenGL.png");
-	g_theRenderer->BindTexture(texture);
-	g_theRenderer->DrawVertexArray((int)boxVerts.size(), boxVerts.data());
-
-	// ring
-	Vec2 center = (m_screenCamera.GetOrthographicBottomLeft() + m_screenCamera.GetOrthographicTopRight()) / 2.f;
-	float thickness = 3.0f;
-	Rgba8 color(255, 0, 0);
-
-	std::vector<Vertex_PCU> ringVerts;
-	AddVertsForRing2D(ringVerts, center, m_circleRadius, thickness, color);
 	g_theRenderer->BindTexture(nullptr);
-	g_theRenderer->DrawVertexArray((int)ringVerts.size(), ringVerts.data());
+	g_theRenderer->DrawVertexArray(GetNumVertexesForRing2D(), m_ringVertexes);
 }
 
 float RangeMapX(float value)
@@ -132,14 +189,6 @@ float RangeMapY(float value)
 
 void AttractMode::RenderTestTriangle() const
 {
-	const int NUM_VERTICES = 3;
-
-	Vertex_PCU vertices[NUM_VERTICES] = {
-		Vertex_PCU(Vec3(RangeMapX(-0.5f), RangeMapY(-0.5f),  0.f),  Rgba8::WHITE, Vec2::ZERO),
-		Vertex_PCU(Vec3(RangeMapX(0.f),   RangeMapY(0.5f), 0.f),  Rgba8::WHITE, Vec2::ZERO),
-		Vertex_PCU(Vec3(RangeMapX(0.5f),  RangeMapY(-0.5f), 0.f) , Rgba8::WHITE, Vec2::ZERO)
-	};
-
 	g_theRenderer->BindTexture(nullptr);
-	g_theRenderer->DrawVertexArray(NUM_VERTICES, vertices);
+	g_theRenderer->DrawVertexArray(ATTRACT_MODE_TRIANGLE_NUM_VERTEXES, m_triangleVertexes);
 }
\ No newline at end of file
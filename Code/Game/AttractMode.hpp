@@ -1,9 +1,14 @@
 #pragma once
 
+#include "Game/VertexSpanUtils.hpp"
+
 #include "Engine/Renderer/Camera.hpp"
 #include "Engine/Core/Rgba8.hpp"
 
 class Clock;
+class Texture;
+
+constexpr int ATTRACT_MODE_TRIANGLE_NUM_VERTEXES = 3;
 
 class AttractMode
 {
@@ -12,15 +17,32 @@ public:
 	void Update();
 	void Render() const;
 
+	// false when the screen would look the same as the last frame drawn; the App then skips
+	// rendering and presenting, and the window keeps showing that frame
+	bool NeedsRedraw() const { return m_needsRedraw; }
+
 private:
 	float m_circleRadius = 10.0f;
 	bool isIncreasing = true;
 	Clock* m_attractModeClock = nullptr;
 
+	void UpdateCircleRadius(float deltaseconds);
+	void UpdateRedraw();
+
+	// geometry and texture are built once; the ring only when its radius moved by a pixel
+	Texture* m_boxTexture = nullptr;
+	Vertex_PCU m_triangleVertexes[ATTRACT_MODE_TRIANGLE_NUM_VERTEXES];
+	Vertex_PCU m_boxVertexes[AABB2_NUM_VERTEXES];
+	Vertex_PCU m_ringVertexes[GetNumVertexesForRing2D()];
+	float m_ringVertexesRadius = -1.f;
+	double m_lastRedrawSeconds = 0.0;
+	bool m_needsRedraw = true;
+
 protected:
 	void RenderRingAndTexture() const;
 	Rgba8 m_backgroundColor = Rgba8(157, 187, 227);
 	void RenderTestTriangle() const;
+	void BuildRingVertexes();
 
 public:
 	Camera m_screenCamera;
@@ -0,0 +1,408 @@
+#include "Game/BlendSpace2D.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <math.h>
+
+
+constexpr float BLEND_SPACE_INSIDE_TOLERANCE = -1.0e-5f;
+constexpr float BLEND_SPACE_MIN_WEIGHT = 1.0e-4f;
+
+
+//-----------------------------------------------------------------------------------------------
+void BlendSpace2D::AddSample(Vec2 const& position, int clipIndex)
+{
+	Sample sample;
+	sample.m_position = position;
+	sample.m_clipIndex = clipIndex;
+	m_samples.push_back(sample);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void BlendSpace2D::Build()
+{
+	GUARANTEE_OR_DIE(m_samples.size() >= 3, "Blend spaces need at least three samples");
+
+	Triangulate();
+	GUARANTEE_OR_DIE(!m_triangles.empty(), "Blend space samples are all on one line");
+	LinkNeighbors();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Bowyer-Watson, in doubles; there are only a handful of samples and this runs once at load
+//
+void BlendSpace2D::Triangulate()
+{
+	struct Corner
+	{
+		double x;
+		double y;
+	};
+
+	int numSamples = (int)m_samples.size();
+	std::vector<Corner> corners(numSamples + 3);
+	double minX = m_samples[0].m_position.x;
+	double minY = m_samples[0].m_position.y;
+	double maxX = minX;
+	double maxY = minY;
+	for (int sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+	{
+		corners[sampleIndex].x = m_samples[sampleIndex].m_position.x;
+		corners[sampleIndex].y = m_samples[sampleIndex].m_position.y;
+		minX = corners[sampleIndex].x < minX ? corners[sampleIndex].x : minX;
+		minY = corners[sampleIndex].y < minY ? corners[sampleIndex].y : minY;
+		maxX = corners[sampleIndex].x > maxX ? corners[sampleIndex].x : maxX;
+		maxY = corners[sampleIndex].y > maxY ? corners[sampleIndex].y : maxY;
+	}
+
+	// super triangle enclosing every sample, counter-clockwise
+	double size = (maxX - minX > maxY - minY ? maxX - minX : maxY - minY) + 1.0;
+	double centerX = 0.5 * (minX + maxX);
+	double centerY = 0.5 * (minY + maxY);
+	corners[numSamples + 0] = { centerX - 20.0 * size, centerY - 10.0 * size };
+	corners[numSamples + 1] = { centerX + 20.0 * size, centerY - 10.0 * size };
+	corners[numSamples + 2] = { centerX, centerY + 20.0 * size };
+
+	std::vector<Triangle> triangles(1);
+	triangles[0].m_sampleIndexes[0] = numSamples + 0;
+	triangles[0].m_sampleIndexes[1] = numSamples + 1;
+	triangles[0].m_sampleIndexes[2] = numSamples + 2;
+
+	auto isInCircumcircle = [&corners](Triangle const& triangle, Corner const& point)
+	{
+		Corner const& a = corners[triangle.m_sampleIndexes[0]];
+		Corner const& b = corners[triangle.m_sampleIndexes[1]];
+		Corner const& c = corners[triangle.m_sampleIndexes[2]];
+		double ax = a.x - point.x;
+		double ay = a.y - point.y;
+		double bx = b.x - point.x;
+		double by = b.y - point.y;
+		double cx = c.x - point.x;
+		double cy = c.y - point.y;
+		double determinant = (ax * ax + ay * ay) * (bx * cy - cx * by) - (bx * bx + by * by) * (ax * cy - cx * ay) + (cx * cx + cy * cy) * (ax * by - bx * ay);
+		return determinant > 0.0;
+	};
+
+	for (int sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+	{
+		Corner const& point = corners[sampleIndex];
+
+		// every edge of the cavity that isn't shared by two removed triangles gets fanned to the new point
+		std::vector<std::pair<int, int>> cavityEdges;
+		std::vector<Triangle> keptTriangles;
+		for (int triangleIndex = 0; triangleIndex < (int)triangles.size(); triangleIndex++)
+		{
+			Triangle const& triangle = triangles[triangleIndex];
+			if (!isInCircumcircle(triangle, point))
+			{
+				keptTriangles.push_back(triangle);
+				continue;
+			}
+
+			for (int edgeIndex = 0; edgeIndex < 3; edgeIndex++)
+			{
+				int start = triangle.m_sampleIndexes[edgeIndex];
+				int end = triangle.m_sampleIndexes[(edgeIndex + 1) % 3];
+				bool isShared = false;
+				for (int cavityIndex = 0; cavityIndex < (int)cavityEdges.size(); cavityIndex++)
+				{
+					if (cavityEdges[cavityIndex].first == end && cavityEdges[cavityIndex].second == start)
+					{
+						cavityEdges.erase(cavityEdges.begin() + cavityIndex);
+						isShared = true;
+						break;
+					}
+				}
+				if (!isShared)
+				{
+					cavityEdges.push_back(std::make_pair(start, end));
+				}
+			}
+		}
+
+		triangles = keptTriangles;
+		for (int cavityIndex = 0; cavityIndex < (int)cavityEdges.size(); cavityIndex++)
+		{
+			Triangle triangle;
+			triangle.m_sampleIndexes[0] = cavityEdges[cavityIndex].first;
+			triangle.m_sampleIndexes[1] = cavityEdges[cavityIndex].second;
+			triangle.m_sampleIndexes[2] = sampleIndex;
+			triangles.push_back(triangle);
+		}
+	}
+
+	// drop everything still touching the super triangle, and slivers from collinear samples
+	m_triangles.clear();
+	for (int triangleIndex = 0; triangleIndex < (int)triangles.size(); triangleIndex++)
+	{
+		Triangle const& triangle = triangles[triangleIndex];
+		if (triangle.m_sampleIndexes[0] >= numSamples || triangle.m_sampleIndexes[1] >= numSamples || triangle.m_sampleIndexes[2] >= numSamples)
+		{
+			continue;
+		}
+
+		Corner const& a = corners[triangle.m_sampleIndexes[0]];
+		Corner const& b = corners[triangle.m_sampleIndexes[1]];
+		Corner const& c = corners[triangle.m_sampleIndexes[2]];
+		double twiceArea = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+		if (twiceArea > 1.0e-9 * size * size)
+		{
+			m_triangles.push_back(triangle);
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void BlendSpace2D::LinkNeighbors()
+{
+	for (int triangleIndex = 0; triangleIndex < (int)m_triangles.size(); triangleIndex++)
+	{
+		Triangle& triangle = m_triangles[triangleIndex];
+		for (int corner = 0; corner < 3; corner++)
+		{
+			int start = triangle.m_sampleIndexes[(corner + 1) % 3];
+			int end = triangle.m_sampleIndexes[(corner + 2) % 3];
+			triangle.m_neighbors[corner] = -1;
+
+			for (int otherIndex = 0; otherIndex < (int)m_triangles.size() && triangle.m_neighbors[corner] < 0; otherIndex++)
+			{
+				Triangle const& other = m_triangles[otherIndex];
+				for (int otherCorner = 0; otherCorner < 3; otherCorner++)
+				{
+					if (other.m_sampleIndexes[(otherCorner + 1) % 3] == end && other.m_sampleIndexes[(otherCorner + 2) % 3] == start)
+					{
+						triangle.m_neighbors[corner] = otherIndex;
+						break;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void BlendSpace2D::GetBarycentric(int triangleIndex, Vec2 const& point, float* out_weights) const
+{
+	Triangle const& triangle = m_triangles[triangleIndex];
+	Vec2 const& a = m_samples[triangle.m_sampleIndexes[0]].m_position;
+	Vec2 const& b = m_samples[triangle.m_sampleIndexes[1]].m_position;
+	Vec2 const& c = m_samples[triangle.m_sampleIndexes[2]].m_position;
+
+	float twiceArea = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+	out_weights[0] = ((b.x - point.x) * (c.y - point.y) - (c.x - point.x) * (b.y - point.y)) / twiceArea;
+	out_weights[1] = ((c.x - point.x) * (a.y - point.y) - (a.x - point.x) * (c.y - point.y)) / twiceArea;
+	out_weights[2] = 1.f - out_weights[0] - out_weights[1];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec2 BlendSpace2D::GetClosestPointOnHull(Vec2 const& point, int& out_triangleIndex) const
+{
+	Vec2 closestPoint = point;
+	float closestDistanceSquared = -1.f;
+	for (int triangleIndex = 0; triangleIndex < (int)m_triangles.size(); triangleIndex++)
+	{
+		Triangle const& triangle = m_triangles[triangleIndex];
+		for (int corner = 0; corner < 3; corner++)
+		{
+			if (triangle.m_neighbors[corner] >= 0)
+			{
+				continue;
+			}
+
+			Vec2 const& start = m_samples[triangle.m_sampleIndexes[(corner + 1) % 3]].m_position;
+			Vec2 const& end = m_samples[triangle.m_sampleIndexes[(corner + 2) % 3]].m_position;
+			Vec2 edge = end - start;
+			Vec2 toPoint = point - start;
+			float edgeLengthSquared = edge.x * edge.x + edge.y * edge.y;
+			float fraction = edgeLengthSquared > 0.f ? (toPoint.x * edge.x + toPoint.y * edge.y) / edgeLengthSquared : 0.f;
+			fraction = fraction < 0.f ? 0.f : (fraction > 1.f ? 1.f : fraction);
+
+			Vec2 pointOnEdge = start + edge * fraction;
+			Vec2 offset = point - pointOnEdge;
+			float distanceSquared = offset.x * offset.x + offset.y * offset.y;
+			if (closestDistanceSquared < 0.f || distanceSquared < closestDistanceSquared)
+			{
+				closestDistanceSquared = distanceSquared;
+				closestPoint = pointOnEdge;
+				out_triangleIndex = triangleIndex;
+			}
+		}
+	}
+
+	return closestPoint;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Walks from the cached triangle toward the input, crossing whichever edge the point is furthest
+// outside of. Inputs barely move between frames, so this is usually zero or one step.
+//
+BlendSpaceWeights BlendSpace2D::GetWeights(Vec2 const& input, int& inout_cachedTriangle) const
+{
+	int numTriangles = (int)m_triangles.size();
+	int triangleIndex = inout_cachedTriangle >= 0 && inout_cachedTriangle < numTriangles ? inout_cachedTriangle : 0;
+	float barycentric[3];
+	bool isInside = false;
+	bool isOutsideHull = false;
+	for (int step = 0; step <= numTriangles; step++)
+	{
+		GetBarycentric(triangleIndex, input, barycentric);
+		int mostOutside = 0;
+		for (int corner = 1; corner < 3; corner++)
+		{
+			mostOutside = barycentric[corner] < barycentric[mostOutside] ? corner : mostOutside;
+		}
+
+		if (barycentric[mostOutside] >= BLEND_SPACE_INSIDE_TOLERANCE)
+		{
+			isInside = true;
+			break;
+		}
+
+		int nextTriangle = m_triangles[triangleIndex].m_neighbors[mostOutside];
+		if (nextTriangle < 0)
+		{
+			isOutsideHull = true;
+			break;
+		}
+		triangleIndex = nextTriangle;
+	}
+
+	// the walk should always settle; if it ever cycles, fall back to checking every triangle
+	if (!isInside && !isOutsideHull)
+	{
+		for (triangleIndex = 0; triangleIndex < numTriangles && !isInside; triangleIndex++)
+		{
+			GetBarycentric(triangleIndex, input, barycentric);
+			isInside = barycentric[0] >= BLEND_SPACE_INSIDE_TOLERANCE && barycentric[1] >= BLEND_SPACE_INSIDE_TOLERANCE && barycentric[2] >= BLEND_SPACE_INSIDE_TOLERANCE;
+		}
+		triangleIndex = isInside ? triangleIndex - 1 : 0;
+		isOutsideHull = !isInside;
+	}
+
+	// past the outermost samples: use the nearest point on the hull, and play faster to keep up
+	BlendSpaceWeights weights;
+	if (!isInside)
+	{
+		Vec2 clampedInput = GetClosestPointOnHull(input, triangleIndex);
+		GetBarycentric(triangleIndex, clampedInput, barycentric);
+
+		float inputLength = sqrtf(input.x * input.x + input.y * input.y);
+		float clampedLength = sqrtf(clampedInput.x * clampedInput.x + clampedInput.y * clampedInput.y);
+		if (isOutsideHull && clampedLength > 0.f)
+		{
+			float playbackRate = inputLength / clampedLength;
+			weights.m_playbackRate = playbackRate < 1.f ? 1.f : (playbackRate > MAX_BLEND_SPACE_PLAYBACK_RATE ? MAX_BLEND_SPACE_PLAYBACK_RATE : playbackRate);
+		}
+	}
+	inout_cachedTriangle = triangleIndex;
+
+	float totalWeight = 0.f;
+	for (int corner = 0; corner < 3; corner++)
+	{
+		float weight = barycentric[corner];
+		if (weight > BLEND_SPACE_MIN_WEIGHT)
+		{
+			weights.m_sampleIndexes[weights.m_numClips] = m_triangles[triangleIndex].m_sampleIndexes[corner];
+			weights.m_weights[weights.m_numClips] = weight;
+			weights.m_numClips++;
+			totalWeight += weight;
+		}
+	}
+
+	for (int weightIndex = 0; weightIndex < weights.m_numClips; weightIndex++)
+	{
+		weights.m_weights[weightIndex] /= totalWeight;
+	}
+
+	return weights;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void BlendSpace2D::DropLightestClips(BlendSpaceWeights& weights, int maxClips)
+{
+	// at most three entries; a selection sort puts the heaviest first
+	for (int first = 0; first < weights.m_numClips - 1; first++)
+	{
+		int heaviest = first;
+		for (int other = first + 1; other < weights.m_numClips; other++)
+		{
+			heaviest = weights.m_weights[other] > weights.m_weights[heaviest] ? other : heaviest;
+		}
+		float weight = weights.m_weights[first];
+		int sampleIndex = weights.m_sampleIndexes[first];
+		weights.m_weights[first] = weights.m_weights[heaviest];
+		weights.m_sampleIndexes[first] = weights.m_sampleIndexes[heaviest];
+		weights.m_weights[heaviest] = weight;
+		weights.m_sampleIndexes[heaviest] = sampleIndex;
+	}
+
+	weights.m_numClips = maxClips;
+	float totalWeight = 0.f;
+	for (int weightIndex = 0; weightIndex < maxClips; weightIndex++)
+	{
+		totalWeight += weights.m_weights[weightIndex];
+	}
+	for (int weightIndex = 0; weightIndex < maxClips; weightIndex++)
+	{
+		weights.m_weights[weightIndex] /= totalWeight;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void BlendSpace2D::EvaluatePose(Vec2 const& input, float deltaSeconds, AnimationClip const* clips, BlendSpaceState& state, SkeletonPose& scratchPose, SkeletonPose& out_pose,
+	int maxClips, int numBones) const
+{
+	BlendSpaceWeights weights = GetWeights(input, state.m_cachedTriangle);
+	if (weights.m_numClips > maxClips)
+	{
+		DropLightestClips(weights, maxClips < 1 ? 1 : maxClips);
+	}
+
+	// the moving clips set the cycle length; clips sitting at the origin (idle) just follow along
+	float cycleSeconds = 0.f;
+	float movingWeight = 0.f;
+	float allSeconds = 0.f;
+	for (int weightIndex = 0; weightIndex < weights.m_numClips; weightIndex++)
+	{
+		Sample const& sample = m_samples[weights.m_sampleIndexes[weightIndex]];
+		float weightedSeconds = weights.m_weights[weightIndex] * clips[sample.m_clipIndex].GetDuration();
+		allSeconds += weightedSeconds;
+		if (sample.m_position.x != 0.f || sample.m_position.y != 0.f)
+		{
+			cycleSeconds += weightedSeconds;
+			movingWeight += weights.m_weights[weightIndex];
+		}
+	}
+	cycleSeconds = movingWeight > 0.f ? cycleSeconds / movingWeight : allSeconds;
+
+	state.m_phase += deltaSeconds * weights.m_playbackRate / cycleSeconds;
+	state.m_phase -= floorf(state.m_phase);
+	state.m_numClipsSampled = weights.m_numClips;
+
+	if (weights.m_numClips == 1)
+	{
+		AnimationClip const& clip = clips[m_samples[weights.m_sampleIndexes[0]].m_clipIndex];
+		clip.Sample(state.m_phase * clip.GetDuration(), out_pose, numBones);
+		return;
+	}
+
+	if (out_pose.GetNumBones() != clips[0].GetNumBones())
+	{
+		out_pose.Resize(clips[0].GetNumBones());
+	}
+	out_pose.SetToZero();
+	for (int weightIndex = 0; weightIndex < weights.m_numClips; weightIndex++)
+	{
+		AnimationClip const& clip = clips[m_samples[weights.m_sampleIndexes[weightIndex]].m_clipIndex];
+		clip.Sample(state.m_phase * clip.GetDuration(), scratchPose, numBones);
+		AccumulatePose(out_pose, scratchPose, weights.m_weights[weightIndex]);
+	}
+	NormalizePoseRotations(out_pose);
+}
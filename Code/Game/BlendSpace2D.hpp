@@ -0,0 +1,81 @@
+//-----------------------------------------------------------------------------------------------
+// BlendSpace2D.hpp
+//
+// Clips placed at 2D parameter positions (e.g. local velocity) and Delaunay triangulated once at
+// load. Evaluating finds the triangle holding the input by walking from the last frame's triangle,
+// so at most three clips get a weight and only those are sampled. The blend space itself is shared
+// and read-only; each character keeps its own BlendSpaceState.
+//
+#pragma once
+
+#include "Game/AnimationClip.hpp"
+#include "Game/Skeleton.hpp"
+
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+
+constexpr int MAX_BLEND_SPACE_WEIGHTS = 3;
+constexpr float MAX_BLEND_SPACE_PLAYBACK_RATE = 3.f;
+
+
+//-----------------------------------------------------------------------------------------------
+struct BlendSpaceWeights
+{
+	int		m_numClips = 0;
+	int		m_sampleIndexes[MAX_BLEND_SPACE_WEIGHTS] = {};
+	float	m_weights[MAX_BLEND_SPACE_WEIGHTS] = {};
+	float	m_playbackRate = 1.f;		// > 1 when the input lies past the outermost samples
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct BlendSpaceState
+{
+	int		m_cachedTriangle = 0;
+	float	m_phase = 0.f;				// 0 to 1, shared by every clip in the blend so strides line up
+	int		m_numClipsSampled = 0;		// last evaluation, for stats
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class BlendSpace2D
+{
+public:
+	void AddSample(Vec2 const& position, int clipIndex);
+	void Build();
+
+	BlendSpaceWeights GetWeights(Vec2 const& input, int& inout_cachedTriangle) const;
+
+	// advances state's phase and writes the blended pose; scratchPose is only touched for multi-clip blends.
+	// Coarse LODs can keep only the heaviest maxClips and decode only the leading numBones (-1 for all).
+	void EvaluatePose(Vec2 const& input, float deltaSeconds, AnimationClip const* clips, BlendSpaceState& state, SkeletonPose& scratchPose, SkeletonPose& out_pose,
+		int maxClips = MAX_BLEND_SPACE_WEIGHTS, int numBones = -1) const;
+
+	int GetNumSamples() const { return (int)m_samples.size(); }
+	int GetSampleClipIndex(int sampleIndex) const { return m_samples[sampleIndex].m_clipIndex; }
+	int GetNumTriangles() const { return (int)m_triangles.size(); }
+
+private:
+	struct Sample
+	{
+		Vec2	m_position;
+		int		m_clipIndex = -1;
+	};
+
+	struct Triangle
+	{
+		int		m_sampleIndexes[3] = {};
+		int		m_neighbors[3] = { -1, -1, -1 };	// across the edge opposite each corner
+	};
+
+	void Triangulate();
+	void LinkNeighbors();
+	void GetBarycentric(int triangleIndex, Vec2 const& point, float* out_weights) const;
+	Vec2 GetClosestPointOnHull(Vec2 const& point, int& out_triangleIndex) const;
+	static void DropLightestClips(BlendSpaceWeights& weights, int maxClips);
+
+private:
+	std::vector<Sample>		m_samples;
+	std::vector<Triangle>	m_triangles;
+};
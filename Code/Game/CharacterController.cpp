@@ -0,0 +1,354 @@
+#include "Game/CharacterController.hpp"
+
+#include "Engine/Math/MathUtils.hpp"
+#include <emmintrin.h>
+
+
+constexpr float CHARACTER_MIN_MOVE_DISTANCE = 0.0001f;
+constexpr float CHARACTER_STEP_PROGRESS_FRACTION = 0.99f;
+
+
+//-----------------------------------------------------------------------------------------------
+CharacterController::CharacterController() :
+	CharacterController(CharacterControllerConfig())
+{
+}
+
+CharacterController::CharacterController(CharacterControllerConfig const& config) :
+	m_config(config)
+{
+	m_segmentHalfLength = m_config.m_capsuleHalfHeight - m_config.m_capsuleRadius;
+	m_segmentHalfLength = m_segmentHalfLength > 0.f ? m_segmentHalfLength : 0.f;
+	m_minWalkableNormalZ = CosDegrees(m_config.m_maxWalkableSlopeDegrees);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void CharacterController::MoveCharacters(CharacterMotion* characters, int numCharacters, float deltaSeconds, PropBroadphase const& broadphase)
+{
+	for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+	{
+		MoveCharacter(characters[characterIndex], deltaSeconds, broadphase);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void CharacterController::MoveCharacter(CharacterMotion& character, float deltaSeconds, PropBroadphase const& broadphase)
+{
+	Vec3 displacement = character.m_velocity * deltaSeconds;
+	Vec3 horizontal(displacement.x, displacement.y, 0.f);
+
+	// one gather covers everything this move can reach, step and snap included
+	float reach = displacement.GetLength() + m_config.m_stepHeight + m_config.m_groundSnapDistance + m_config.m_capsuleRadius + m_config.m_skinWidth;
+	Vec3 const& start = character.m_position;
+	broadphase.GatherPropsInRegion(start.x - reach, start.y - reach, start.x + reach, start.y + reach, m_candidates);
+
+	Vec3 position = character.m_position;
+	ResolvePenetration(position);
+
+	// side pass
+	bool didTouchWalkable = false;
+	Vec3 velocity = character.m_velocity;
+	Vec3 movedPosition = SlideCapsule(position, horizontal, velocity, true, didTouchWalkable);
+
+	// blocked while walking: try again lifted by the step height, then settle back down
+	float desiredDistance = horizontal.GetLength();
+	float progress = GetDistanceXY3D(position, movedPosition);
+	if (character.m_isGrounded && m_config.m_stepHeight > 0.f && desiredDistance > CHARACTER_MIN_MOVE_DISTANCE &&
+		progress < desiredDistance * CHARACTER_STEP_PROGRESS_FRACTION)
+	{
+		SweepHit upHit = SweepCapsule(position, Vec3(0.f, 0.f, m_config.m_stepHeight));
+		float raiseHeight = GetClamped(upHit.m_fraction * m_config.m_stepHeight - m_config.m_skinWidth, 0.f, m_config.m_stepHeight);
+		Vec3 raisedPosition = position + Vec3(0.f, 0.f, raiseHeight);
+
+		Vec3 steppedVelocity = character.m_velocity;
+		bool didStepTouchWalkable = false;
+		Vec3 steppedPosition = SlideCapsule(raisedPosition, horizontal, steppedVelocity, true, didStepTouchWalkable);
+
+		float dropDistance = raiseHeight + m_config.m_groundSnapDistance;
+		SweepHit downHit = SweepCapsule(steppedPosition, Vec3(0.f, 0.f, -dropDistance));
+		float steppedProgress = GetDistanceXY3D(position, steppedPosition);
+		if (downHit.m_didHit && IsWalkable(downHit.m_normal) && steppedProgress > progress + CHARACTER_MIN_MOVE_DISTANCE)
+		{
+			float dropHeight = GetClamped(downHit.m_fraction * dropDistance - m_config.m_skinWidth, 0.f, dropDistance);
+			movedPosition = steppedPosition - Vec3(0.f, 0.f, dropHeight);
+			velocity = steppedVelocity;
+		}
+	}
+
+	// vertical pass: gravity and jumping
+	bool didLand = false;
+	movedPosition = SlideCapsule(movedPosition, Vec3(0.f, 0.f, displacement.z), velocity, false, didLand);
+	bool isGrounded = didLand && velocity.z <= 0.f;
+
+	// stay glued to the ground when walking down slopes and off small ledges
+	if (!isGrounded && character.m_isGrounded && velocity.z <= 0.f)
+	{
+		SweepHit snapHit = SweepCapsule(movedPosition, Vec3(0.f, 0.f, -m_config.m_groundSnapDistance));
+		if (snapHit.m_didHit && IsWalkable(snapHit.m_normal))
+		{
+			float snapHeight = GetClamped(snapHit.m_fraction * m_config.m_groundSnapDistance - m_config.m_skinWidth, 0.f, m_config.m_groundSnapDistance);
+			movedPosition.z -= snapHeight;
+			isGrounded = true;
+		}
+	}
+
+	if (isGrounded && velocity.z < 0.f)
+	{
+		velocity.z = 0.f;
+	}
+
+	character.m_position = movedPosition;
+	character.m_velocity = velocity;
+	character.m_isGrounded = isGrounded;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Moves along displacement until something is hit, then slides the remainder along the surface.
+// Steep surfaces hit during the horizontal pass are treated as vertical walls so they can't be climbed.
+//
+Vec3 CharacterController::SlideCapsule(Vec3 center, Vec3 displacement, Vec3& velocity, bool isHorizontalPass, bool& out_didTouchWalkable) const
+{
+	for (int iteration = 0; iteration < MAX_CHARACTER_SLIDE_ITERATIONS; iteration++)
+	{
+		float distance = displacement.GetLength();
+		if (distance < CHARACTER_MIN_MOVE_DISTANCE)
+		{
+			break;
+		}
+
+		SweepHit hit = SweepCapsule(center, displacement);
+		if (!hit.m_didHit)
+		{
+			center += displacement;
+			break;
+		}
+
+		// stop a skin width short of the contact
+		float travel = GetClamped(hit.m_fraction * distance - m_config.m_skinWidth, 0.f, distance);
+		center += displacement * (travel / distance);
+		displacement *= 1.f - (travel / distance);
+
+		Vec3 normal = hit.m_normal;
+		bool isWalkable = IsWalkable(normal);
+		if (isWalkable)
+		{
+			out_didTouchWalkable = true;
+		}
+		else if (isHorizontalPass)
+		{
+			normal.z = 0.f;
+			if (normal.GetLengthSquared() < CHARACTER_MIN_MOVE_DISTANCE)
+			{
+				break;
+			}
+			normal.Normalize();
+		}
+
+		float intoSurface = DotProduct3D(displacement, normal);
+		if (intoSurface < 0.f)
+		{
+			displacement -= normal * intoSurface;
+		}
+
+		// walking over walkable ground keeps the input velocity; walls and ceilings eat into it
+		if (!isHorizontalPass || !isWalkable)
+		{
+			float velocityIntoSurface = DotProduct3D(velocity, normal);
+			if (velocityIntoSurface < 0.f)
+			{
+				velocity -= normal * velocityIntoSurface;
+			}
+		}
+	}
+
+	return center;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Earliest contact of the capsule moving by displacement against the gathered props and the ground.
+// Each prop sphere is tested against the capsule's side and both caps; four props per SSE pass.
+//
+CharacterController::SweepHit CharacterController::SweepCapsule(Vec3 const& center, Vec3 const& displacement) const
+{
+	SweepHit hit;
+	float radius = m_config.m_capsuleRadius;
+	float segmentHalfLength = m_segmentHalfLength;
+
+	// ground plane
+	float bottomSphereZ = center.z - segmentHalfLength;
+	if (displacement.z < 0.f && bottomSphereZ - radius >= m_config.m_groundHeight - m_config.m_skinWidth)
+	{
+		float fraction = (m_config.m_groundHeight + radius - bottomSphereZ) / displacement.z;
+		fraction = fraction > 0.f ? fraction : 0.f;
+		if (fraction <= 1.f)
+		{
+			hit.m_didHit = true;
+			hit.m_fraction = fraction;
+			hit.m_normal = Vec3(0.f, 0.f, 1.f);
+		}
+	}
+
+	__m128 const zero = _mm_setzero_ps();
+	__m128 const one = _mm_set1_ps(1.f);
+	__m128 const noHit = _mm_set1_ps(2.f);
+	__m128 const capsuleRadius = _mm_set1_ps(radius);
+	__m128 const halfLength = _mm_set1_ps(segmentHalfLength);
+	__m128 const dx = _mm_set1_ps(displacement.x);
+	__m128 const dy = _mm_set1_ps(displacement.y);
+	__m128 const dz = _mm_set1_ps(displacement.z);
+	__m128 const cx = _mm_set1_ps(center.x);
+	__m128 const cy = _mm_set1_ps(center.y);
+	__m128 const cz = _mm_set1_ps(center.z);
+	__m128 const lengthXYSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+	__m128 const lengthSquared = _mm_add_ps(lengthXYSquared, _mm_mul_ps(dz, dz));
+	__m128 const hasXYMotion = _mm_cmpgt_ps(lengthXYSquared, _mm_set1_ps(1.0e-12f));
+	__m128 const hasMotion = _mm_cmpgt_ps(lengthSquared, _mm_set1_ps(1.0e-12f));
+
+	__m128 bestFractions = noHit;
+	__m128 bestIndexes = _mm_set1_ps(-1.f);
+	__m128 laneIndexes = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+	__m128 const four = _mm_set1_ps(4.f);
+
+	int numPadded = (int)m_candidates.m_radii.size();
+	for (int candidateIndex = 0; candidateIndex < numPadded; candidateIndex += 4)
+	{
+		// sphere center relative to the capsule center, and the combined radius
+		__m128 qx = _mm_sub_ps(_mm_loadu_ps(&m_candidates.m_centersX[candidateIndex]), cx);
+		__m128 qy = _mm_sub_ps(_mm_loadu_ps(&m_candidates.m_centersY[candidateIndex]), cy);
+		__m128 qz = _mm_sub_ps(_mm_loadu_ps(&m_candidates.m_centersZ[candidateIndex]), cz);
+		__m128 combinedRadius = _mm_add_ps(_mm_loadu_ps(&m_candidates.m_radii[candidateIndex]), capsuleRadius);
+		__m128 combinedRadiusSquared = _mm_mul_ps(combinedRadius, combinedRadius);
+
+		// side: |q.xy - t * d.xy| = combinedRadius, valid while the sphere is level with the segment
+		__m128 b = _mm_add_ps(_mm_mul_ps(qx, dx), _mm_mul_ps(qy, dy));
+		__m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)), combinedRadiusSquared);
+		__m128 discriminant = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(lengthXYSquared, c));
+		__m128 isOutside = _mm_cmpgt_ps(c, zero);
+		__m128 fraction = _mm_div_ps(_mm_sub_ps(b, _mm_sqrt_ps(_mm_max_ps(discriminant, zero))), lengthXYSquared);
+		fraction = _mm_and_ps(isOutside, fraction);
+		__m128 isValid = _mm_or_ps(_mm_and_ps(isOutside, _mm_cmpge_ps(discriminant, zero)), _mm_andnot_ps(isOutside, _mm_cmpgt_ps(b, zero)));
+		__m128 relativeZ = _mm_sub_ps(qz, _mm_mul_ps(fraction, dz));
+		__m128 absRelativeZ = _mm_max_ps(relativeZ, _mm_sub_ps(zero, relativeZ));
+		isValid = _mm_and_ps(isValid, hasXYMotion);
+		isValid = _mm_and_ps(isValid, _mm_cmple_ps(absRelativeZ, halfLength));
+		isValid = _mm_and_ps(isValid, _mm_cmpge_ps(fraction, zero));
+		isValid = _mm_and_ps(isValid, _mm_cmple_ps(fraction, one));
+		__m128 sideFraction = _mm_or_ps(_mm_and_ps(isValid, fraction), _mm_andnot_ps(isValid, noHit));
+
+		// caps: plain moving-sphere test against each end of the segment
+		__m128 capFractions[2];
+		for (int capIndex = 0; capIndex < 2; capIndex++)
+		{
+			__m128 capZ = capIndex == 0 ? _mm_sub_ps(qz, halfLength) : _mm_add_ps(qz, halfLength);
+			__m128 capB = _mm_add_ps(b, _mm_mul_ps(capZ, dz));
+			__m128 capC = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)), _mm_mul_ps(capZ, capZ)), combinedRadiusSquared);
+			__m128 capDiscriminant = _mm_sub_ps(_mm_mul_ps(capB, capB), _mm_mul_ps(lengthSquared, capC));
+			__m128 isCapOutside = _mm_cmpgt_ps(capC, zero);
+			__m128 capFraction = _mm_div_ps(_mm_sub_ps(capB, _mm_sqrt_ps(_mm_max_ps(capDiscriminant, zero))), lengthSquared);
+			capFraction = _mm_and_ps(isCapOutside, capFraction);
+			__m128 isCapValid = _mm_or_ps(_mm_and_ps(isCapOutside, _mm_cmpge_ps(capDiscriminant, zero)), _mm_andnot_ps(isCapOutside, _mm_cmpgt_ps(capB, zero)));
+			isCapValid = _mm_and_ps(isCapValid, hasMotion);
+			isCapValid = _mm_and_ps(isCapValid, _mm_cmpge_ps(capFraction, zero));
+			isCapValid = _mm_and_ps(isCapValid, _mm_cmple_ps(capFraction, one));
+			capFractions[capIndex] = _mm_or_ps(_mm_and_ps(isCapValid, capFraction), _mm_andnot_ps(isCapValid, noHit));
+		}
+
+		__m128 candidateFractions = _mm_min_ps(sideFraction, _mm_min_ps(capFractions[0], capFractions[1]));
+		__m128 isBetter = _mm_cmplt_ps(candidateFractions, bestFractions);
+		bestFractions = _mm_or_ps(_mm_and_ps(isBetter, candidateFractions), _mm_andnot_ps(isBetter, bestFractions));
+		bestIndexes = _mm_or_ps(_mm_and_ps(isBetter, laneIndexes), _mm_andnot_ps(isBetter, bestIndexes));
+		laneIndexes = _mm_add_ps(laneIndexes, four);
+	}
+
+	float laneFractions[4];
+	float laneCandidates[4];
+	_mm_storeu_ps(laneFractions, bestFractions);
+	_mm_storeu_ps(laneCandidates, bestIndexes);
+	int bestCandidate = -1;
+	float bestFraction = hit.m_fraction;
+	for (int lane = 0; lane < 4; lane++)
+	{
+		if (laneCandidates[lane] >= 0.f && laneFractions[lane] < bestFraction)
+		{
+			bestFraction = laneFractions[lane];
+			bestCandidate = static_cast<int>(laneCandidates[lane]);
+		}
+	}
+
+	if (bestCandidate < 0)
+	{
+		return hit;
+	}
+
+	// normal from the sphere center to the closest point on the capsule's segment at contact
+	Vec3 sphereCenter(m_candidates.m_centersX[bestCandidate], m_candidates.m_centersY[bestCandidate], m_candidates.m_centersZ[bestCandidate]);
+	Vec3 contactCenter = center + displacement * bestFraction;
+	Vec3 closestOnSegment(contactCenter.x, contactCenter.y, GetClamped(sphereCenter.z, contactCenter.z - segmentHalfLength, contactCenter.z + segmentHalfLength));
+	Vec3 normal = closestOnSegment - sphereCenter;
+	hit.m_didHit = true;
+	hit.m_fraction = bestFraction;
+	hit.m_normal = normal.GetLengthSquared() > 0.f ? normal.GetNormalized() : Vec3(0.f, 0.f, 1.f);
+	return hit;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Pushes the capsule out of anything it already overlaps, e.g. after being spawned inside a prop
+//
+void CharacterController::ResolvePenetration(Vec3& center) const
+{
+	float minCenterZ = m_config.m_groundHeight + m_config.m_capsuleHalfHeight;
+	if (center.z < minCenterZ)
+	{
+		center.z = minCenterZ;
+	}
+
+	__m128 const zero = _mm_setzero_ps();
+	__m128 const capsuleRadius = _mm_set1_ps(m_config.m_capsuleRadius);
+	__m128 const halfLength = _mm_set1_ps(m_segmentHalfLength);
+	__m128 const cx = _mm_set1_ps(center.x);
+	__m128 const cy = _mm_set1_ps(center.y);
+	__m128 const cz = _mm_set1_ps(center.z);
+
+	int numPadded = (int)m_candidates.m_radii.size();
+	for (int candidateIndex = 0; candidateIndex < numPadded; candidateIndex += 4)
+	{
+		__m128 qx = _mm_sub_ps(_mm_loadu_ps(&m_candidates.m_centersX[candidateIndex]), cx);
+		__m128 qy = _mm_sub_ps(_mm_loadu_ps(&m_candidates.m_centersY[candidateIndex]), cy);
+		__m128 qz = _mm_sub_ps(_mm_loadu_ps(&m_candidates.m_centersZ[candidateIndex]), cz);
+		__m128 combinedRadius = _mm_add_ps(_mm_loadu_ps(&m_candidates.m_radii[candidateIndex]), capsuleRadius);
+
+		// distance along z past the segment's ends
+		__m128 overhangZ = _mm_max_ps(_mm_sub_ps(_mm_max_ps(qz, _mm_sub_ps(zero, qz)), halfLength), zero);
+		__m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)), _mm_mul_ps(overhangZ, overhangZ));
+		int overlapMask = _mm_movemask_ps(_mm_cmplt_ps(distanceSquared, _mm_mul_ps(combinedRadius, combinedRadius)));
+		if (overlapMask == 0)
+		{
+			continue;
+		}
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			if ((overlapMask & (1 << lane)) == 0)
+			{
+				continue;
+			}
+
+			int index = candidateIndex + lane;
+			Vec3 sphereCenter(m_candidates.m_centersX[index], m_candidates.m_centersY[index], m_candidates.m_centersZ[index]);
+			Vec3 closestOnSegment(center.x, center.y, GetClamped(sphereCenter.z, center.z - m_segmentHalfLength, center.z + m_segmentHalfLength));
+			Vec3 pushDirection = closestOnSegment - sphereCenter;
+			float distance = pushDirection.GetLength();
+			pushDirection = distance > 0.f ? pushDirection / distance : Vec3(0.f, 0.f, 1.f);
+			float depth = m_candidates.m_radii[index] + m_config.m_capsuleRadius + m_config.m_skinWidth - distance;
+			if (depth > 0.f)
+			{
+				center += pushDirection * depth;
+			}
+		}
+	}
+}
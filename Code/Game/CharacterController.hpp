@@ -0,0 +1,73 @@
+//-----------------------------------------------------------------------------------------------
+// CharacterController.hpp
+//
+// Upright capsule controller: swept collide-and-slide against prop bounding spheres and the
+// ground plane, stepping up small obstacles and snapping to the ground while walking.
+// Characters are moved as a batch, and the sphere tests run four props at a time with SSE.
+//
+#pragma once
+
+#include "Game/PropBroadphase.hpp"
+
+#include "Engine/Math/Vec3.hpp"
+
+
+constexpr int MAX_CHARACTER_SLIDE_ITERATIONS = 4;
+
+
+//-----------------------------------------------------------------------------------------------
+struct CharacterControllerConfig
+{
+	float	m_capsuleRadius = 0.3f;
+	float	m_capsuleHalfHeight = 0.9f;			// center to the very top or bottom, caps included
+	float	m_stepHeight = 0.35f;
+	float	m_skinWidth = 0.01f;
+	float	m_maxWalkableSlopeDegrees = 50.f;
+	float	m_groundSnapDistance = 0.1f;
+	float	m_groundHeight = 0.f;				// infinite ground plane under everything
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct CharacterMotion
+{
+	Vec3	m_position;			// capsule center
+	Vec3	m_velocity;
+	bool	m_isGrounded = false;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class CharacterController
+{
+public:
+	CharacterController();
+	explicit CharacterController(CharacterControllerConfig const& config);
+
+	// advances every character by its velocity; velocity pushing into geometry is removed
+	void MoveCharacters(CharacterMotion* characters, int numCharacters, float deltaSeconds, PropBroadphase const& broadphase);
+
+	CharacterControllerConfig const& GetConfig() const { return m_config; }
+
+private:
+	struct SweepHit
+	{
+		bool	m_didHit = false;
+		float	m_fraction = 1.f;
+		Vec3	m_normal;
+	};
+
+	void MoveCharacter(CharacterMotion& character, float deltaSeconds, PropBroadphase const& broadphase);
+	SweepHit SweepCapsule(Vec3 const& center, Vec3 const& displacement) const;
+	Vec3 SlideCapsule(Vec3 center, Vec3 displacement, Vec3& velocity, bool isHorizontalPass, bool& out_didTouchWalkable) const;
+	void ResolvePenetration(Vec3& center) const;
+	bool IsWalkable(Vec3 const& normal) const { return normal.z >= m_minWalkableNormalZ; }
+
+private:
+	CharacterControllerConfig	m_config;
+	float						m_segmentHalfLength = 0.f;
+	float						m_minWalkableNormalZ = 0.f;
+
+	// props around the character currently being moved; reused so moving allocates nothing
+	PropSphereList				m_candidates;
+};
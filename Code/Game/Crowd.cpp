@@ -0,0 +1,538 @@
+#include "Game/Crowd.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/LocomotionAnimations.hpp"
+#include "Game/NavigationGrid.hpp"
+#include "Game/VertexStream.hpp"
+#include "Game/WorkerThreadPool.hpp"
+
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+
+constexpr float CROWD_HALF_SIZE = 45.f;						// inside the +-50 ground grid
+constexpr float CROWD_WAYPOINT_HALF_SIZE = 40.f;
+constexpr unsigned int CROWD_WAYPOINT_SEED = 0x5eed1234u;
+constexpr float CROWD_AVOIDANCE_RADIUS = 1.2f;
+constexpr float CROWD_AVOIDANCE_WEIGHT = 2.f;
+constexpr float CROWD_GOAL_REACHED_DISTANCE = 1.f;
+constexpr float CROWD_ARRIVAL_DISTANCE = 3.f;				// agents slow down inside this
+constexpr float CROWD_TURN_RATE_DEGREES = 270.f;
+constexpr float CROWD_MIN_SPEED_FRACTION = 0.4f;
+constexpr float CROWD_JUMPS_PER_SECOND = 0.02f;
+constexpr int CROWD_BATCH_SIZE = 128;
+constexpr int MAX_SKINNED_CROWD_AGENTS = 64;
+constexpr int MAX_SKINNED_CROWD_LOD = 1;
+constexpr int CROWD_BOXES_PER_STREAM_ALLOCATION = 1024;
+constexpr float CROWD_BOX_HALF_WIDTH = 0.2f;
+constexpr float CROWD_BOX_HEIGHT = 1.75f;
+const Rgba8 CROWD_AGENT_COLOR(80, 120, 200);
+
+
+//-----------------------------------------------------------------------------------------------
+static float GetRandomZeroToOne(unsigned int& state)
+{
+	state = state * 1664525u + 1013904223u;
+	return static_cast<float>(state >> 8) / 16777216.f;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+char const* GetCrowdPhaseName(CrowdPhase phase)
+{
+	switch (phase)
+	{
+	case CROWD_PHASE_AVOIDANCE:	return "avoidance";
+	case CROWD_PHASE_STEERING:	return "steering";
+	case CROWD_PHASE_MOVEMENT:	return "movement";
+	case CROWD_PHASE_ANIMATION:	return "animation";
+	case CROWD_PHASE_SKINNING:	return "skinning";
+	case CROWD_PHASE_RENDER:	return "render";
+	default:					return "unknown";
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+double CrowdStats::GetUpdateMs() const
+{
+	double updateMs = 0.0;
+	for (int phaseIndex = 0; phaseIndex < CROWD_PHASE_RENDER; phaseIndex++)
+	{
+		updateMs += m_phaseMs[phaseIndex];
+	}
+	return updateMs;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void CrowdSpatialHash::Build(CharacterMotion const* motions, int numAgents, float cellSize)
+{
+	m_inverseCellSize = 1.f / cellSize;
+	int numBuckets = 1;
+	while (numBuckets < 2 * numAgents)
+	{
+		numBuckets <<= 1;
+	}
+	m_bucketMask = numBuckets - 1;
+
+	// count per bucket, prefix sum into starts, then scatter
+	m_bucketStarts.assign(numBuckets + 1, 0);
+	m_agentBuckets.resize(numAgents);
+	for (int agentIndex = 0; agentIndex < numAgents; agentIndex++)
+	{
+		Vec3 const& position = motions[agentIndex].m_position;
+		int bucket = GetBucket(GetCellCoordinate(position.x), GetCellCoordinate(position.y));
+		m_agentBuckets[agentIndex] = bucket;
+		m_bucketStarts[bucket + 1]++;
+	}
+	for (int bucket = 0; bucket < numBuckets; bucket++)
+	{
+		m_bucketStarts[bucket + 1] += m_bucketStarts[bucket];
+	}
+
+	m_bucketCursors.assign(m_bucketStarts.begin(), m_bucketStarts.end() - 1);
+	m_sortedAgentIndexes.resize(numAgents);
+	m_sortedPositions.resize(numAgents);
+	for (int agentIndex = 0; agentIndex < numAgents; agentIndex++)
+	{
+		int sortedIndex = m_bucketCursors[m_agentBuckets[agentIndex]]++;
+		m_sortedAgentIndexes[sortedIndex] = agentIndex;
+		m_sortedPositions[sortedIndex] = Vec2(motions[agentIndex].m_position.x, motions[agentIndex].m_position.y);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::Startup(LocomotionAnimations const& animations, CharacterControllerConfig const& controllerConfig)
+{
+	m_animations = &animations;
+	m_controllerConfig = controllerConfig;
+
+	// fixed waypoints, so every crowd shares the same few flow fields
+	unsigned int randomState = CROWD_WAYPOINT_SEED;
+	for (int waypointIndex = 0; waypointIndex < NUM_CROWD_WAYPOINTS; waypointIndex++)
+	{
+		float x = RangeMap(GetRandomZeroToOne(randomState), 0.f, 1.f, -CROWD_WAYPOINT_HALF_SIZE, CROWD_WAYPOINT_HALF_SIZE);
+		float y = RangeMap(GetRandomZeroToOne(randomState), 0.f, 1.f, -CROWD_WAYPOINT_HALF_SIZE, CROWD_WAYPOINT_HALF_SIZE);
+		m_waypoints[waypointIndex] = Vec2(x, y);
+	}
+	for (int& fieldIndex : m_waypointFlowFields)
+	{
+		fieldIndex = -1;
+	}
+
+	m_skinSlotVertexes.resize(MAX_SKINNED_CROWD_AGENTS);
+	m_freeSkinSlots.clear();
+	for (int slotIndex = MAX_SKINNED_CROWD_AGENTS - 1; slotIndex >= 0; slotIndex--)
+	{
+		m_freeSkinSlots.push_back(slotIndex);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::SetNumAgents(int numAgents)
+{
+	numAgents = numAgents > 0 ? numAgents : 0;
+	int oldNumAgents = GetNumAgents();
+	for (int agentIndex = numAgents; agentIndex < oldNumAgents; agentIndex++)
+	{
+		ReleaseSkinSlot(agentIndex);
+	}
+
+	m_motions.resize(numAgents);
+	m_yawDegrees.resize(numAgents);
+	m_goalWaypoints.resize(numAgents, -1);
+	m_goalSpeedFractions.resize(numAgents);
+	m_avoidanceDirections.resize(numAgents);
+	m_inputs.resize(numAgents);
+	m_randomStates.resize(numAgents);
+	m_animationCharacters.resize(numAgents);
+	m_skinSlots.resize(numAgents, -1);
+
+	for (int agentIndex = oldNumAgents; agentIndex < numAgents; agentIndex++)
+	{
+		SpawnAgent(agentIndex);
+	}
+	m_stats.m_numAgents = numAgents;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::SpawnAgent(int agentIndex)
+{
+	// seeded by index so a given crowd size always starts the same way
+	unsigned int& randomState = m_randomStates[agentIndex];
+	randomState = 2654435761u * (unsigned int)(agentIndex + 1);
+
+	CharacterMotion& motion = m_motions[agentIndex];
+	motion = CharacterMotion();
+	float x = RangeMap(GetRandomZeroToOne(randomState), 0.f, 1.f, -CROWD_HALF_SIZE, CROWD_HALF_SIZE);
+	float y = RangeMap(GetRandomZeroToOne(randomState), 0.f, 1.f, -CROWD_HALF_SIZE, CROWD_HALF_SIZE);
+	motion.m_position = Vec3(x, y, m_controllerConfig.m_groundHeight + m_controllerConfig.m_capsuleHalfHeight);
+	motion.m_isGrounded = true;
+
+	m_yawDegrees[agentIndex] = 360.f * GetRandomZeroToOne(randomState);
+	m_avoidanceDirections[agentIndex] = Vec2();
+	m_inputs[agentIndex] = LocomotionInput();
+	m_animationCharacters[agentIndex] = AnimationLodCharacter();
+	m_skinSlots[agentIndex] = -1;
+	m_goalWaypoints[agentIndex] = -1;
+	ChooseNewGoal(agentIndex);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::ChooseNewGoal(int agentIndex)
+{
+	// any waypoint but the one just reached
+	unsigned int& randomState = m_randomStates[agentIndex];
+	int& goalWaypoint = m_goalWaypoints[agentIndex];
+	if (m_hasSharedGoal)
+	{
+		goalWaypoint = CROWD_SHARED_GOAL;
+	}
+	else
+	{
+		int waypointIndex = (int)(GetRandomZeroToOne(randomState) * (float)(NUM_CROWD_WAYPOINTS - 1));
+		if (goalWaypoint >= 0 && goalWaypoint < NUM_CROWD_WAYPOINTS && waypointIndex >= goalWaypoint)
+		{
+			waypointIndex++;
+		}
+		goalWaypoint = waypointIndex < NUM_CROWD_WAYPOINTS ? waypointIndex : NUM_CROWD_WAYPOINTS - 1;
+	}
+	m_goalSpeedFractions[agentIndex] = RangeMap(GetRandomZeroToOne(randomState), 0.f, 1.f, CROWD_MIN_SPEED_FRACTION, 1.f);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::SetSharedGoal(Vec2 const& goal)
+{
+	m_waypoints[CROWD_SHARED_GOAL] = goal;
+	m_waypointFlowFields[CROWD_SHARED_GOAL] = -1;
+	m_hasSharedGoal = true;
+	for (int agentIndex = 0; agentIndex < GetNumAgents(); agentIndex++)
+	{
+		ChooseNewGoal(agentIndex);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::ClearSharedGoal()
+{
+	m_hasSharedGoal = false;
+	m_waypointFlowFields[CROWD_SHARED_GOAL] = -1;
+	for (int agentIndex = 0; agentIndex < GetNumAgents(); agentIndex++)
+	{
+		ChooseNewGoal(agentIndex);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Asked for every frame so the grid keeps these fields cached; a new field is ready after the
+// grid's next Update, and agents seek in a straight line until then
+//
+void Crowd::RequestFlowFields(NavigationGrid& navigationGrid)
+{
+	int numGoals = m_hasSharedGoal ? NUM_CROWD_WAYPOINTS + 1 : NUM_CROWD_WAYPOINTS;
+	for (int waypointIndex = 0; waypointIndex < numGoals; waypointIndex++)
+	{
+		m_waypointFlowFields[waypointIndex] = navigationGrid.RequestFlowField(m_waypoints[waypointIndex]);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::Update(float deltaSeconds, PropBroadphase const& propBroadphase, NavigationGrid* navigationGrid, WorkerThreadPool& workerPool, Vec3 const& cameraPosition, float verticalFovDegrees)
+{
+	m_stats.m_numAgents = GetNumAgents();
+	m_stats.m_numThreads = workerPool.GetNumThreads();
+	m_stats.m_phaseMs[CROWD_PHASE_RENDER] = m_renderMs;
+	if (GetNumAgents() == 0)
+	{
+		return;
+	}
+
+	int numThreads = workerPool.GetNumThreads();
+	if ((int)m_threadControllers.size() != numThreads)
+	{
+		m_threadControllers.assign(numThreads, CharacterController(m_controllerConfig));
+		m_threadModelTransforms.resize(numThreads);
+		m_threadSkinningMatrices.resize(numThreads);
+	}
+
+	double phaseStartSeconds = GetCurrentTimeSeconds();
+	auto endPhase = [this, &phaseStartSeconds](CrowdPhase phase)
+	{
+		double nowSeconds = GetCurrentTimeSeconds();
+		m_stats.m_phaseMs[phase] = 1000.0 * (nowSeconds - phaseStartSeconds);
+		phaseStartSeconds = nowSeconds;
+	};
+
+	UpdateAvoidance(workerPool);
+	endPhase(CROWD_PHASE_AVOIDANCE);
+	if (navigationGrid)
+	{
+		RequestFlowFields(*navigationGrid);
+	}
+	UpdateSteering(deltaSeconds, navigationGrid, workerPool);
+	endPhase(CROWD_PHASE_STEERING);
+	UpdateMovement(deltaSeconds, propBroadphase, workerPool);
+	endPhase(CROWD_PHASE_MOVEMENT);
+	UpdateAnimation(deltaSeconds, cameraPosition, verticalFovDegrees);
+	endPhase(CROWD_PHASE_ANIMATION);
+	UpdateSkinning(workerPool);
+	endPhase(CROWD_PHASE_SKINNING);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::UpdateAvoidance(WorkerThreadPool& workerPool)
+{
+	m_spatialHash.Build(m_motions.data(), GetNumAgents(), CROWD_AVOIDANCE_RADIUS);
+
+	// push away from every neighbor inside the radius, harder the closer it is
+	workerPool.ParallelFor(GetNumAgents(), CROWD_BATCH_SIZE, [this](int beginIndex, int endIndex, int)
+	{
+		float radiusSquared = CROWD_AVOIDANCE_RADIUS * CROWD_AVOIDANCE_RADIUS;
+		for (int agentIndex = beginIndex; agentIndex < endIndex; agentIndex++)
+		{
+			Vec2 position(m_motions[agentIndex].m_position.x, m_motions[agentIndex].m_position.y);
+			Vec2 push;
+			m_spatialHash.ForEachAgentNear(position, [&](int otherIndex, Vec2 const& otherPosition)
+			{
+				Vec2 away = position - otherPosition;
+				float distanceSquared = away.x * away.x + away.y * away.y;
+				if (otherIndex == agentIndex || distanceSquared >= radiusSquared)
+				{
+					return;
+				}
+
+				// exactly overlapping agents split by index
+				float distance = sqrtf(distanceSquared);
+				Vec2 direction = distance > 0.f ? away / distance : Vec2(otherIndex < agentIndex ? 1.f : -1.f, 0.f);
+				push += direction * (1.f - distance / CROWD_AVOIDANCE_RADIUS);
+			});
+			m_avoidanceDirections[agentIndex] = push;
+		}
+	});
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::UpdateSteering(float deltaSeconds, NavigationGrid const* navigationGrid, WorkerThreadPool& workerPool)
+{
+	workerPool.ParallelFor(GetNumAgents(), CROWD_BATCH_SIZE, [this, deltaSeconds, navigationGrid](int beginIndex, int endIndex, int)
+	{
+		for (int agentIndex = beginIndex; agentIndex < endIndex; agentIndex++)
+		{
+			Vec2 position(m_motions[agentIndex].m_position.x, m_motions[agentIndex].m_position.y);
+			Vec2 toGoal = m_waypoints[m_goalWaypoints[agentIndex]] - position;
+			float goalDistance = toGoal.GetLength();
+			if (goalDistance < CROWD_GOAL_REACHED_DISTANCE && !m_hasSharedGoal)
+			{
+				ChooseNewGoal(agentIndex);
+				toGoal = m_waypoints[m_goalWaypoints[agentIndex]] - position;
+				goalDistance = toGoal.GetLength();
+			}
+
+			// follow the goal's flow field around props, deflected by neighbors, easing off on arrival;
+			// without a field yet, or off the field's reachable cells, head straight for the goal
+			Vec2 desired;
+			int flowField = m_waypointFlowFields[m_goalWaypoints[agentIndex]];
+			if (navigationGrid)
+			{
+				desired = navigationGrid->GetFlowDirection(flowField, position);
+			}
+			if (desired.x == 0.f && desired.y == 0.f && goalDistance > 0.f)
+			{
+				desired = toGoal / goalDistance;
+			}
+			desired += m_avoidanceDirections[agentIndex] * CROWD_AVOIDANCE_WEIGHT;
+			float desiredLength = desired.GetLength();
+			float speedFraction = m_goalSpeedFractions[agentIndex] * GetClamped(goalDistance / CROWD_ARRIVAL_DISTANCE, 0.f, 1.f);
+			desired = desiredLength > 0.f ? desired * (speedFraction / desiredLength) : Vec2();
+
+			// the body turns toward where it wants to go at a limited rate
+			float& yawDegrees = m_yawDegrees[agentIndex];
+			if (desiredLength > 0.f)
+			{
+				float targetYawDegrees = Atan2Degrees(desired.y, desired.x);
+				float maxTurnDegrees = CROWD_TURN_RATE_DEGREES * deltaSeconds;
+				yawDegrees = GetTurnedTowardDegrees(yawDegrees, targetYawDegrees, maxTurnDegrees);
+			}
+
+			// the same intentions a player's keys would give, relative to the body
+			Vec2 iForward(CosDegrees(yawDegrees), SinDegrees(yawDegrees));
+			Vec2 jLeft(-iForward.y, iForward.x);
+			LocomotionInput& input = m_inputs[agentIndex];
+			input.m_moveIntentions = Vec2(DotProduct2D(desired, iForward), DotProduct2D(desired, jLeft));
+			input.m_isSprinting = false;
+			input.m_isJumping = GetRandomZeroToOne(m_randomStates[agentIndex]) < CROWD_JUMPS_PER_SECOND * deltaSeconds;
+		}
+	});
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::UpdateMovement(float deltaSeconds, PropBroadphase const& propBroadphase, WorkerThreadPool& workerPool)
+{
+	workerPool.ParallelFor(GetNumAgents(), CROWD_BATCH_SIZE, [this, deltaSeconds, &propBroadphase](int beginIndex, int endIndex, int threadIndex)
+	{
+		for (int agentIndex = beginIndex; agentIndex < endIndex; agentIndex++)
+		{
+			CharacterMotion& motion = m_motions[agentIndex];
+			ApplyLocomotionInput(m_inputs[agentIndex], m_yawDegrees[agentIndex], deltaSeconds, motion.m_velocity, motion.m_isGrounded);
+		}
+
+		// each thread has its own controller; they keep per-move scratch
+		m_threadControllers[threadIndex].MoveCharacters(&m_motions[beginIndex], endIndex - beginIndex, deltaSeconds, propBroadphase);
+	});
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::UpdateAnimation(float deltaSeconds, Vec3 const& cameraPosition, float verticalFovDegrees)
+{
+	// blend space input is ground velocity relative to the body, as for the player
+	for (int agentIndex = 0; agentIndex < GetNumAgents(); agentIndex++)
+	{
+		CharacterMotion const& motion = m_motions[agentIndex];
+		AnimationLodCharacter& character = m_animationCharacters[agentIndex];
+		float yawDegrees = m_yawDegrees[agentIndex];
+		Vec2 iForward(CosDegrees(yawDegrees), SinDegrees(yawDegrees));
+		Vec2 jLeft(-iForward.y, iForward.x);
+		Vec2 groundVelocity(motion.m_velocity.x, motion.m_velocity.y);
+		character.m_position = motion.m_position;
+		character.m_localVelocity = Vec2(DotProduct2D(groundVelocity, iForward), DotProduct2D(groundVelocity, jLeft));
+	}
+
+	// budgeted, so it stays on this thread
+	m_animationLod.Update(*m_animations, cameraPosition, verticalFovDegrees, deltaSeconds, m_animationCharacters.data(), GetNumAgents());
+	m_stats.m_animationStats = m_animationLod.GetStats();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::UpdateSkinning(WorkerThreadPool& workerPool)
+{
+	// near agents with every bone animated hold the skinned buffers; a newly taken slot is skinned
+	// at once, otherwise only when the pose changed
+	int numBones = m_animations->m_skeleton.GetNumBones();
+	m_agentsToSkin.clear();
+	m_stats.m_numSkinned = 0;
+	for (int agentIndex = 0; agentIndex < GetNumAgents(); agentIndex++)
+	{
+		AnimationLodCharacter const& character = m_animationCharacters[agentIndex];
+		bool wantsSkin = character.m_lod <= MAX_SKINNED_CROWD_LOD && character.m_numBones == numBones;
+		int& skinSlot = m_skinSlots[agentIndex];
+		if (!wantsSkin)
+		{
+			ReleaseSkinSlot(agentIndex);
+			continue;
+		}
+
+		bool isNewSlot = false;
+		if (skinSlot < 0 && !m_freeSkinSlots.empty())
+		{
+			skinSlot = m_freeSkinSlots.back();
+			m_freeSkinSlots.pop_back();
+			isNewSlot = true;
+		}
+		if (skinSlot >= 0)
+		{
+			m_stats.m_numSkinned++;
+			if (isNewSlot || character.m_isPoseChanged)
+			{
+				m_agentsToSkin.push_back(agentIndex);
+			}
+		}
+	}
+
+	SkinnedMesh const& mesh = m_animations->m_skinnedMesh;
+	Skeleton const& skeleton = m_animations->m_skeleton;
+	SkinningPath skinningPath = GetBestSkinningPath();
+	workerPool.ParallelFor((int)m_agentsToSkin.size(), 1, [&](int beginIndex, int endIndex, int threadIndex)
+	{
+		std::vector<BoneMatrix>& modelTransforms = m_threadModelTransforms[threadIndex];
+		std::vector<SkinningMatrix>& skinningMatrices = m_threadSkinningMatrices[threadIndex];
+		modelTransforms.resize(numBones);
+		skinningMatrices.resize(numBones);
+		for (int skinIndex = beginIndex; skinIndex < endIndex; skinIndex++)
+		{
+			int agentIndex = m_agentsToSkin[skinIndex];
+			ComputeModelTransforms(skeleton, m_animationCharacters[agentIndex].m_pose, modelTransforms.data());
+			mesh.ComputeSkinningMatrices(modelTransforms.data(), skinningMatrices.data());
+			mesh.Skin(skinningMatrices.data(), skinningPath, m_skinSlotVertexes[m_skinSlots[agentIndex]]);
+		}
+	});
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::ReleaseSkinSlot(int agentIndex)
+{
+	int& skinSlot = m_skinSlots[agentIndex];
+	if (skinSlot >= 0)
+	{
+		m_freeSkinSlots.push_back(skinSlot);
+		skinSlot = -1;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Crowd::Render() const
+{
+	double startSeconds = GetCurrentTimeSeconds();
+	float capsuleHalfHeight = m_controllerConfig.m_capsuleHalfHeight;
+
+	// skinned agents draw like the player: feet at the capsule bottom, body turned by yaw only
+	g_theRenderer->BindTexture(nullptr);
+	for (int agentIndex = 0; agentIndex < GetNumAgents(); agentIndex++)
+	{
+		int skinSlot = m_skinSlots[agentIndex];
+		if (skinSlot < 0)
+		{
+			continue;
+		}
+
+		Mat44 modelMatrix = EulerAngles(m_yawDegrees[agentIndex], 0.f, 0.f).GetAsMatrix_XFwd_YLeft_ZUp();
+		modelMatrix.SetTranslation3D(m_motions[agentIndex].m_position - Vec3(0.f, 0.f, capsuleHalfHeight));
+		g_theRenderer->SetModelConstants(modelMatrix);
+		g_theRenderer->DrawVertexArray(m_skinSlotVertexes[skinSlot]);
+	}
+
+	// everyone else is a box, streamed in world space a chunk at a time
+	VertexSpanWriter verts;
+	for (int agentIndex = 0; agentIndex < GetNumAgents(); agentIndex++)
+	{
+		if (m_skinSlots[agentIndex] >= 0)
+		{
+			continue;
+		}
+
+		if (verts.GetNumRemaining() < AABB3_NUM_VERTEXES)
+		{
+			g_vertexStream->Draw(verts);
+			int chunkNumVertexes = CROWD_BOXES_PER_STREAM_ALLOCATION * AABB3_NUM_VERTEXES;
+			if (g_vertexStream->GetNumFreeVertexes() < chunkNumVertexes)
+			{
+				g_vertexStream->Flush();
+			}
+			verts = g_vertexStream->Allocate(chunkNumVertexes);
+		}
+
+		Vec3 feet = m_motions[agentIndex].m_position - Vec3(0.f, 0.f, capsuleHalfHeight);
+		AABB3 bounds(feet - Vec3(CROWD_BOX_HALF_WIDTH, CROWD_BOX_HALF_WIDTH, 0.f), feet + Vec3(CROWD_BOX_HALF_WIDTH, CROWD_BOX_HALF_WIDTH, CROWD_BOX_HEIGHT));
+		AddVertsForAABB3D(verts, bounds, CROWD_AGENT_COLOR);
+	}
+	g_vertexStream->Draw(verts);
+
+	m_renderMs = 1000.0 * (GetCurrentTimeSeconds() - startSeconds);
+}
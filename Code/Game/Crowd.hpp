@@ -0,0 +1,196 @@
+//-----------------------------------------------------------------------------------------------
+// Crowd.hpp
+//
+// Stress mode: N autonomous agents walking between a few shared waypoints, or all toward one goal
+// set from the console. Paths come from the navigation grid's flow fields, one per waypoint. They use the
+// Player's locomotion stack: a LocomotionInput, ApplyLocomotionInput and the CharacterController.
+// Animation goes through the LOD scheduler, and near agents get skinned meshes. Agent state is
+// kept one array per field. Each frame runs in phases (avoidance, steering, movement, animation,
+// skinning), and every phase except the budgeted animation pass is split across the worker pool.
+// Avoidance finds neighbors through a spatial hash rebuilt every frame.
+//
+#pragma once
+
+#include "Game/AnimationLod.hpp"
+#include "Game/CharacterController.hpp"
+#include "Game/LocomotionInput.hpp"
+#include "Game/SkinnedMesh.hpp"
+
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <math.h>
+#include <vector>
+
+struct LocomotionAnimations;
+class NavigationGrid;
+class PropBroadphase;
+class WorkerThreadPool;
+
+
+constexpr int NUM_CROWD_WAYPOINTS = 8;
+constexpr int CROWD_SHARED_GOAL = NUM_CROWD_WAYPOINTS;		// waypoint index of the console goal
+
+
+//-----------------------------------------------------------------------------------------------
+enum CrowdPhase
+{
+	CROWD_PHASE_AVOIDANCE,
+	CROWD_PHASE_STEERING,
+	CROWD_PHASE_MOVEMENT,
+	CROWD_PHASE_ANIMATION,
+	CROWD_PHASE_SKINNING,
+	CROWD_PHASE_RENDER,
+	NUM_CROWD_PHASES
+};
+
+char const* GetCrowdPhaseName(CrowdPhase phase);
+
+
+//-----------------------------------------------------------------------------------------------
+struct CrowdStats
+{
+	int					m_numAgents = 0;
+	int					m_numThreads = 0;
+	int					m_numSkinned = 0;			// agents drawn with skinned meshes; the rest are boxes
+	double				m_phaseMs[NUM_CROWD_PHASES] = {};
+	AnimationLodStats	m_animationStats;
+
+	double GetUpdateMs() const;						// every phase but render
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Agents bucketed by ground cell; the buckets are filled with a counting sort so a rebuild is
+// two passes over the crowd and no allocation once warmed up
+//
+class CrowdSpatialHash
+{
+public:
+	void Build(CharacterMotion const* motions, int numAgents, float cellSize);
+
+	// function(int agentIndex, Vec2 const& position) for every agent in the 3x3 cells around position
+	template<typename Function>
+	void ForEachAgentNear(Vec2 const& position, Function const& function) const;
+
+private:
+	int GetCellCoordinate(float value) const { return (int)floorf(value * m_inverseCellSize); }
+	int GetBucket(int cellX, int cellY) const { return (int)(((unsigned int)cellX * 73856093u ^ (unsigned int)cellY * 19349663u) & (unsigned int)m_bucketMask); }
+
+private:
+	float				m_inverseCellSize = 1.f;
+	int					m_bucketMask = 0;
+	std::vector<int>	m_bucketStarts;				// one past the end is the next bucket's start
+	std::vector<int>	m_bucketCursors;
+	std::vector<int>	m_agentBuckets;
+	std::vector<int>	m_sortedAgentIndexes;
+	std::vector<Vec2>	m_sortedPositions;			// copied next to the indexes so queries stay in cache
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class Crowd
+{
+public:
+	void Startup(LocomotionAnimations const& animations, CharacterControllerConfig const& controllerConfig);
+
+	// keeps existing agents, spawning or removing from the end
+	void SetNumAgents(int numAgents);
+	int GetNumAgents() const { return (int)m_motions.size(); }
+
+	// every agent heads for goal until it is cleared, then they go back to the waypoints
+	void SetSharedGoal(Vec2 const& goal);
+	void ClearSharedGoal();
+	bool HasSharedGoal() const { return m_hasSharedGoal; }
+
+	// navigationGrid may be null; agents then seek their goals in a straight line
+	void Update(float deltaSeconds, PropBroadphase const& propBroadphase, NavigationGrid* navigationGrid, WorkerThreadPool& workerPool, Vec3 const& cameraPosition, float verticalFovDegrees);
+	void Render() const;
+
+	CrowdStats const& GetStats() const { return m_stats; }
+
+private:
+	void SpawnAgent(int agentIndex);
+	void ChooseNewGoal(int agentIndex);
+	void RequestFlowFields(NavigationGrid& navigationGrid);
+	void UpdateAvoidance(WorkerThreadPool& workerPool);
+	void UpdateSteering(float deltaSeconds, NavigationGrid const* navigationGrid, WorkerThreadPool& workerPool);
+	void UpdateMovement(float deltaSeconds, PropBroadphase const& propBroadphase, WorkerThreadPool& workerPool);
+	void UpdateAnimation(float deltaSeconds, Vec3 const& cameraPosition, float verticalFovDegrees);
+	void UpdateSkinning(WorkerThreadPool& workerPool);
+	void ReleaseSkinSlot(int agentIndex);
+
+private:
+	LocomotionAnimations const*			m_animations = nullptr;
+	CharacterControllerConfig			m_controllerConfig;
+
+	// agent data, one array per field
+	std::vector<CharacterMotion>		m_motions;					// moved in batches by the controller
+	std::vector<float>					m_yawDegrees;
+	std::vector<int>					m_goalWaypoints;
+	std::vector<float>					m_goalSpeedFractions;		// of walking speed
+	std::vector<Vec2>					m_avoidanceDirections;
+	std::vector<LocomotionInput>		m_inputs;
+	std::vector<unsigned int>			m_randomStates;
+	std::vector<AnimationLodCharacter>	m_animationCharacters;
+	std::vector<int>					m_skinSlots;				// -1 when drawn as a box
+
+	// waypoints and the shared goal, with the flow field toward each; -1 until one is cached
+	Vec2								m_waypoints[NUM_CROWD_WAYPOINTS + 1];
+	int									m_waypointFlowFields[NUM_CROWD_WAYPOINTS + 1];
+	bool								m_hasSharedGoal = false;
+
+	CrowdSpatialHash					m_spatialHash;
+	AnimationLodScheduler				m_animationLod;
+
+	// a few skinned vertex buffers shared by whichever near agents hold them
+	std::vector<std::vector<Vertex_PCU>>	m_skinSlotVertexes;
+	std::vector<int>						m_freeSkinSlots;
+	std::vector<int>						m_agentsToSkin;
+
+	// per-thread scratch, indexed by the pool's thread index
+	std::vector<CharacterController>			m_threadControllers;
+	std::vector<std::vector<BoneMatrix>>		m_threadModelTransforms;
+	std::vector<std::vector<SkinningMatrix>>	m_threadSkinningMatrices;
+
+	CrowdStats							m_stats;
+	mutable double						m_renderMs = 0.0;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+template<typename Function>
+void CrowdSpatialHash::ForEachAgentNear(Vec2 const& position, Function const& function) const
+{
+	if (m_sortedAgentIndexes.empty())
+	{
+		return;
+	}
+
+	// neighboring cells can hash to the same bucket; visit each bucket once
+	int visitedBuckets[9];
+	int numVisitedBuckets = 0;
+	int centerCellX = GetCellCoordinate(position.x);
+	int centerCellY = GetCellCoordinate(position.y);
+	for (int cellY = centerCellY - 1; cellY <= centerCellY + 1; cellY++)
+	{
+		for (int cellX = centerCellX - 1; cellX <= centerCellX + 1; cellX++)
+		{
+			int bucket = GetBucket(cellX, cellY);
+			bool isVisited = false;
+			for (int visitedIndex = 0; visitedIndex < numVisitedBuckets; visitedIndex++)
+			{
+				isVisited = isVisited || visitedBuckets[visitedIndex] == bucket;
+			}
+			if (isVisited)
+			{
+				continue;
+			}
+			visitedBuckets[numVisitedBuckets++] = bucket;
+
+			for (int sortedIndex = m_bucketStarts[bucket]; sortedIndex < m_bucketStarts[bucket + 1]; sortedIndex++)
+			{
+				function(m_sortedAgentIndexes[sortedIndex], m_sortedPositions[sortedIndex]);
+			}
+		}
+	}
+}
@@ -0,0 +1,173 @@
+#include "Game/DebugLineBatch.hpp"
+#include "Game/VertexStream.hpp"
+
+#include <immintrin.h>
+#include <math.h>
+
+
+DebugLineBatch* g_debugLines = nullptr;	// Created and owned by the App
+
+constexpr int LINE_CORNERS = 4;		// back right, front right, front left, back left
+
+
+//-----------------------------------------------------------------------------------------------
+// two counter-clockwise triangles from the corners in order
+//
+static void WriteLineVertexes(Vertex_PCU* verts, float const* cornerX, float const* cornerY, Rgba8 const& color)
+{
+	Vertex_PCU backRight(Vec3(cornerX[0], cornerY[0], 0.f), color, Vec2::ZERO);
+	Vertex_PCU frontRight(Vec3(cornerX[1], cornerY[1], 0.f), color, Vec2::ZERO);
+	Vertex_PCU frontLeft(Vec3(cornerX[2], cornerY[2], 0.f), color, Vec2::ZERO);
+	Vertex_PCU backLeft(Vec3(cornerX[3], cornerY[3], 0.f), color, Vec2::ZERO);
+
+	verts[0] = backRight;
+	verts[1] = frontRight;
+	verts[2] = frontLeft;
+
+	verts[3] = backRight;
+	verts[4] = frontLeft;
+	verts[5] = backLeft;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugLineBatch::AddLine(Vec2 const& start, Vec2 const& end, float thickness, Rgba8 const& color)
+{
+	m_startX.push_back(start.x);
+	m_startY.push_back(start.y);
+	m_endX.push_back(end.x);
+	m_endY.push_back(end.y);
+	m_halfThicknesses.push_back(0.5f * thickness);
+	m_colors.push_back(color);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugLineBatch::Clear()
+{
+	m_startX.clear();
+	m_startY.clear();
+	m_endX.clear();
+	m_endY.clear();
+	m_halfThicknesses.clear();
+	m_colors.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugLineBatch::Reserve(int numLines)
+{
+	m_startX.reserve(numLines);
+	m_startY.reserve(numLines);
+	m_endX.reserve(numLines);
+	m_endY.reserve(numLines);
+	m_halfThicknesses.reserve(numLines);
+	m_colors.reserve(numLines);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// forward is the direction scaled to half the thickness and left is forward turned 90 degrees;
+// the corners are start - forward -+ left and end + forward -+ left
+//
+void DebugLineBatch::AddVertsForLines(VertexSpanWriter& verts, int firstLine, int numLines) const
+{
+	Vertex_PCU* lineVerts = verts.Append(numLines * LINE_SEGMENT2D_NUM_VERTEXES);
+	int endLine = firstLine + numLines;
+
+	int lineIndex = firstLine;
+	for (; lineIndex + 4 <= endLine; lineIndex += 4)
+	{
+		__m128 startX = _mm_loadu_ps(&m_startX[lineIndex]);
+		__m128 startY = _mm_loadu_ps(&m_startY[lineIndex]);
+		__m128 endX = _mm_loadu_ps(&m_endX[lineIndex]);
+		__m128 endY = _mm_loadu_ps(&m_endY[lineIndex]);
+		__m128 halfThickness = _mm_loadu_ps(&m_halfThicknesses[lineIndex]);
+
+		__m128 deltaX = _mm_sub_ps(endX, startX);
+		__m128 deltaY = _mm_sub_ps(endY, startY);
+		__m128 lengthSquared = _mm_add_ps(_mm_mul_ps(deltaX, deltaX), _mm_mul_ps(deltaY, deltaY));
+		__m128 isZeroLength = _mm_cmpeq_ps(lengthSquared, _mm_setzero_ps());
+		__m128 scale = _mm_andnot_ps(isZeroLength, _mm_div_ps(halfThickness, _mm_sqrt_ps(lengthSquared)));
+		__m128 forwardX = _mm_or_ps(_mm_andnot_ps(isZeroLength, _mm_mul_ps(deltaX, scale)), _mm_and_ps(isZeroLength, halfThickness));
+		__m128 forwardY = _mm_mul_ps(deltaY, scale);
+
+		// left is (-forwardY, forwardX)
+		alignas(16) float cornerX[LINE_CORNERS][4];
+		alignas(16) float cornerY[LINE_CORNERS][4];
+		__m128 backX = _mm_sub_ps(startX, forwardX);
+		__m128 backY = _mm_sub_ps(startY, forwardY);
+		__m128 frontX = _mm_add_ps(endX, forwardX);
+		__m128 frontY = _mm_add_ps(endY, forwardY);
+		_mm_store_ps(cornerX[0], _mm_add_ps(backX, forwardY));
+		_mm_store_ps(cornerY[0], _mm_sub_ps(backY, forwardX));
+		_mm_store_ps(cornerX[1], _mm_add_ps(frontX, forwardY));
+		_mm_store_ps(cornerY[1], _mm_sub_ps(frontY, forwardX));
+		_mm_store_ps(cornerX[2], _mm_sub_ps(frontX, forwardY));
+		_mm_store_ps(cornerY[2], _mm_add_ps(frontY, forwardX));
+		_mm_store_ps(cornerX[3], _mm_sub_ps(backX, forwardY));
+		_mm_store_ps(cornerY[3], _mm_add_ps(backY, forwardX));
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			float laneCornerX[LINE_CORNERS] = { cornerX[0][lane], cornerX[1][lane], cornerX[2][lane], cornerX[3][lane] };
+			float laneCornerY[LINE_CORNERS] = { cornerY[0][lane], cornerY[1][lane], cornerY[2][lane], cornerY[3][lane] };
+			Vertex_PCU* quad = lineVerts + ((lineIndex + lane - firstLine) * LINE_SEGMENT2D_NUM_VERTEXES);
+			WriteLineVertexes(quad, laneCornerX, laneCornerY, m_colors[lineIndex + lane]);
+		}
+	}
+
+	for (; lineIndex < endLine; lineIndex++)
+	{
+		float deltaX = m_endX[lineIndex] - m_startX[lineIndex];
+		float deltaY = m_endY[lineIndex] - m_startY[lineIndex];
+		float lengthSquared = deltaX * deltaX + deltaY * deltaY;
+		float halfThickness = m_halfThicknesses[lineIndex];
+		float forwardX = halfThickness;
+		float forwardY = 0.f;
+		if (lengthSquared != 0.f)
+		{
+			float scale = halfThickness / sqrtf(lengthSquared);
+			forwardX = deltaX * scale;
+			forwardY = deltaY * scale;
+		}
+
+		float backX = m_startX[lineIndex] - forwardX;
+		float backY = m_startY[lineIndex] - forwardY;
+		float frontX = m_endX[lineIndex] + forwardX;
+		float frontY = m_endY[lineIndex] + forwardY;
+		float cornerX[LINE_CORNERS] = { backX + forwardY, frontX + forwardY, frontX - forwardY, backX - forwardY };
+		float cornerY[LINE_CORNERS] = { backY - forwardX, frontY - forwardX, frontY + forwardX, backY + forwardX };
+		Vertex_PCU* quad = lineVerts + ((lineIndex - firstLine) * LINE_SEGMENT2D_NUM_VERTEXES);
+		WriteLineVertexes(quad, cornerX, cornerY, m_colors[lineIndex]);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// as many lines per stream range as fit, normally all of them
+//
+void DebugLineBatch::Render() const
+{
+	m_numDrawsLastFrame = 0;
+
+	int numLines = GetNumLines();
+	for (int firstLine = 0; firstLine < numLines; )
+	{
+		int numFitting = g_vertexStream->GetNumFreeVertexes() / LINE_SEGMENT2D_NUM_VERTEXES;
+		if (numFitting == 0)
+		{
+			g_vertexStream->Flush();
+			continue;
+		}
+
+		int numInBatch = numFitting < numLines - firstLine ? numFitting : numLines - firstLine;
+		VertexSpanWriter verts = g_vertexStream->Allocate(numInBatch * LINE_SEGMENT2D_NUM_VERTEXES);
+		AddVertsForLines(verts, firstLine, numInBatch);
+		g_vertexStream->Draw(verts);
+		m_numDrawsLastFrame++;
+		firstLine += numInBatch;
+	}
+
+	g_vertexStream->Flush();
+}
@@ -0,0 +1,51 @@
+//-----------------------------------------------------------------------------------------------
+// DebugLineBatch.hpp
+//
+// Thick 2D line segments collected over a frame and drawn together. Segments are stored as
+// separate x, y, thickness and color arrays, so their quads are built four at a time with SSE:
+// each corner is an endpoint pushed out by half the thickness along the segment and across it,
+// with no trig. Everything goes through the vertex stream as one range and one draw unless it
+// outgrows the stream.
+//
+#pragma once
+
+#include "Game/VertexSpanUtils.hpp"
+
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+
+constexpr int LINE_SEGMENT2D_NUM_VERTEXES = 6;
+
+
+//-----------------------------------------------------------------------------------------------
+class DebugLineBatch
+{
+public:
+	void AddLine(Vec2 const& start, Vec2 const& end, float thickness, Rgba8 const& color);
+	void Clear();
+	void Reserve(int numLines);
+
+	int GetNumLines() const { return (int)m_startX.size(); }
+	int GetNumDrawsLastFrame() const { return m_numDrawsLastFrame; }
+
+	// quads for lines [firstLine, firstLine + numLines); caps stick out by half the thickness, so
+	// joined segments leave no gaps. A zero-length line is a square
+	void AddVertsForLines(VertexSpanWriter& verts, int firstLine, int numLines) const;
+
+	// with the current camera; flushes the vertex stream
+	void Render() const;
+
+private:
+	std::vector<float>	m_startX;
+	std::vector<float>	m_startY;
+	std::vector<float>	m_endX;
+	std::vector<float>	m_endY;
+	std::vector<float>	m_halfThicknesses;
+	std::vector<Rgba8>	m_colors;
+
+	mutable int			m_numDrawsLastFrame = 0;
+};
+
+extern DebugLineBatch* g_debugLines;
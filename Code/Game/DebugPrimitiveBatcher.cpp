@@ -0,0 +1,538 @@
+#include "Game/DebugPrimitiveBatcher.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/VertexStream.hpp"
+
+#include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+#include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <cstring>
+
+
+constexpr int MAX_DEBUG_PRIMITIVE_VERTEXES_PER_KIND = VERTEX_STREAM_DEFAULT_CAPACITY;		// live, not permanent
+constexpr int DEBUG_WIRE_SPHERE_LATITUDE_SLICES = 8;
+constexpr int DEBUG_CYLINDER_SLICES = 8;
+constexpr float DEBUG_ARROW_SHAFT_FRACTION = 0.8f;
+constexpr float DEBUG_ARROW_HEAD_RADIUS_SCALE = 2.f;
+
+
+//-----------------------------------------------------------------------------------------------
+// cone along +x, base of radius 1 at the origin and tip at (1,0,0)
+//
+static void AddVertsForUnitCone(std::vector<Vertex_PCU>& verts, int numSlices)
+{
+	Vec3 tip(1.f, 0.f, 0.f);
+	Vec3 baseCenter(0.f, 0.f, 0.f);
+	float deltaDegrees = 360.f / static_cast<float>(numSlices);
+	for (int sliceIndex = 0; sliceIndex < numSlices; sliceIndex++)
+	{
+		float startDegrees = deltaDegrees * static_cast<float>(sliceIndex);
+		float endDegrees = startDegrees + deltaDegrees;
+		Vec3 baseStart(0.f, CosDegrees(startDegrees), SinDegrees(startDegrees));
+		Vec3 baseEnd(0.f, CosDegrees(endDegrees), SinDegrees(endDegrees));
+
+		verts.push_back(Vertex_PCU(baseStart, Rgba8::WHITE, Vec2::ZERO));
+		verts.push_back(Vertex_PCU(baseEnd, Rgba8::WHITE, Vec2::ZERO));
+		verts.push_back(Vertex_PCU(tip, Rgba8::WHITE, Vec2::ZERO));
+
+		verts.push_back(Vertex_PCU(baseCenter, Rgba8::WHITE, Vec2::ZERO));
+		verts.push_back(Vertex_PCU(baseEnd, Rgba8::WHITE, Vec2::ZERO));
+		verts.push_back(Vertex_PCU(baseStart, Rgba8::WHITE, Vec2::ZERO));
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// octahedron with its corners on the unit axes; 24 vertexes, against 192 for the coarsest sphere
+//
+static void AddVertsForUnitOctahedron(std::vector<Vertex_PCU>& verts)
+{
+	for (int faceIndex = 0; faceIndex < 8; faceIndex++)
+	{
+		float signX = (faceIndex & 1) ? -1.f : 1.f;
+		float signY = (faceIndex & 2) ? -1.f : 1.f;
+		float signZ = (faceIndex & 4) ? -1.f : 1.f;
+		Vec3 cornerX(signX, 0.f, 0.f);
+		Vec3 cornerY(0.f, signY, 0.f);
+		Vec3 cornerZ(0.f, 0.f, signZ);
+
+		// counter-clockwise seen from outside
+		bool isMirrored = signX * signY * signZ < 0.f;
+		verts.push_back(Vertex_PCU(cornerX, Rgba8::WHITE, Vec2::ZERO));
+		verts.push_back(Vertex_PCU(isMirrored ? cornerZ : cornerY, Rgba8::WHITE, Vec2::ZERO));
+		verts.push_back(Vertex_PCU(isMirrored ? cornerY : cornerZ, Rgba8::WHITE, Vec2::ZERO));
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// maps the unit +x mesh onto start->end, scaled by radius across
+//
+static Mat44 GetTransformAlongSegment(Vec3 const& start, Vec3 const& end, float radius)
+{
+	Vec3 displacement = end - start;
+	float length = displacement.GetLength();
+	Vec3 forward = length > 0.f ? displacement / length : Vec3(1.f, 0.f, 0.f);
+
+	Vec3 worldUp(0.f, 0.f, 1.f);
+	if (fabsf(DotProduct3D(forward, worldUp)) > 0.99f)
+	{
+		worldUp = Vec3(0.f, 1.f, 0.f);
+	}
+
+	Vec3 left = CrossProduct3D(worldUp, forward).GetNormalized();
+	Vec3 up = CrossProduct3D(forward, left);
+
+	return Mat44(forward * length, left * radius, up * radius, start);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static Rgba8 LerpColor(Rgba8 const& startColor, Rgba8 const& endColor, float fraction)
+{
+	unsigned char r = (unsigned char)Interpolate((float)startColor.r, (float)endColor.r, fraction);
+	unsigned char g = (unsigned char)Interpolate((float)startColor.g, (float)endColor.g, fraction);
+	unsigned char b = (unsigned char)Interpolate((float)startColor.b, (float)endColor.b, fraction);
+	unsigned char a = (unsigned char)Interpolate((float)startColor.a, (float)endColor.a, fraction);
+	return Rgba8(r, g, b, a);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void WriteInstanceVertexes(Vertex_PCU* verts, std::vector<Vertex_PCU> const& mesh, Mat44 const& transform, Rgba8 const& color)
+{
+	for (int vertIndex = 0; vertIndex < (int)mesh.size(); vertIndex++)
+	{
+		verts[vertIndex].m_position = transform.TransformPosition3D(mesh[vertIndex].m_position);
+		verts[vertIndex].m_color = color;
+		verts[vertIndex].m_uvTexCoords = mesh[vertIndex].m_uvTexCoords;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+DebugPrimitiveBatcher::DebugPrimitiveBatcher()
+{
+	m_timeBuckets.resize(NUM_DEBUG_TIME_BUCKETS);
+	BuildUnitMeshes();
+}
+
+DebugPrimitiveBatcher::~DebugPrimitiveBatcher()
+{
+	ReleasePermanentBuffers();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugPrimitiveBatcher::BuildUnitMeshes()
+{
+	AddVertsForUnitOctahedron(m_unitMeshes[DEBUG_PRIMITIVE_POINT]);
+	AddVertsForCylinder3D(m_unitMeshes[DEBUG_PRIMITIVE_CYLINDER], Vec3(0.f, 0.f, 0.f), Vec3(1.f, 0.f, 0.f), 1.f, Rgba8::WHITE, AABB2::ZERO_TO_ONE, DEBUG_CYLINDER_SLICES);
+	AddVertsForUnitCone(m_unitMeshes[DEBUG_PRIMITIVE_CONE], DEBUG_CYLINDER_SLICES);
+	AddVertsForSphere3D(m_unitMeshes[DEBUG_PRIMITIVE_WIRE_SPHERE], Vec3(), 1.f, Rgba8::WHITE, AABB2::ZERO_TO_ONE, DEBUG_WIRE_SPHERE_LATITUDE_SLICES);
+	AddVertsForCylinder3D(m_unitMeshes[DEBUG_PRIMITIVE_WIRE_CYLINDER], Vec3(0.f, 0.f, 0.f), Vec3(1.f, 0.f, 0.f), 1.f, Rgba8::WHITE, AABB2::ZERO_TO_ONE, DEBUG_CYLINDER_SLICES);
+
+	for (int kindIndex = 0; kindIndex < NUM_DEBUG_PRIMITIVE_KINDS; kindIndex++)
+	{
+		m_maxLiveInstances[kindIndex] = MAX_DEBUG_PRIMITIVE_VERTEXES_PER_KIND / (int)m_unitMeshes[kindIndex].size();
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugPrimitiveBatcher::Update(float currentSeconds)
+{
+	m_currentSeconds = currentSeconds;
+	long long nowTick = static_cast<long long>(floorf(currentSeconds / DEBUG_TIME_BUCKET_SECONDS));
+
+	// visit every bucket the clock passed since last frame, plus the head bucket; one lap at most
+	long long lastTick = nowTick;
+	if (lastTick - m_currentTick >= NUM_DEBUG_TIME_BUCKETS)
+	{
+		lastTick = m_currentTick + NUM_DEBUG_TIME_BUCKETS - 1;
+	}
+
+	for (long long tick = m_currentTick; tick <= lastTick; tick++)
+	{
+		ExpireBucket(m_timeBuckets[tick % NUM_DEBUG_TIME_BUCKETS]);
+	}
+
+	if (nowTick > m_currentTick)
+	{
+		m_currentTick = nowTick;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// a bucket may also hold primitives from a later lap of the wheel; those survive
+//
+void DebugPrimitiveBatcher::ExpireBucket(TimeBucket& bucket)
+{
+	for (int kindIndex = 0; kindIndex < NUM_DEBUG_PRIMITIVE_KINDS; kindIndex++)
+	{
+		std::vector<DebugPrimitiveInstance>& instances = bucket.m_instances[kindIndex];
+		std::vector<Vertex_PCU>& vertexes = bucket.m_vertexes[kindIndex];
+		size_t numMeshVertexes = m_unitMeshes[kindIndex].size();
+		for (int index = 0; index < (int)instances.size(); )
+		{
+			if (instances[index].m_expirySeconds <= m_currentSeconds)
+			{
+				// the last one's vertexes move into the gap along with it
+				size_t lastIndex = instances.size() - 1;
+				if ((size_t)index != lastIndex)
+				{
+					memcpy(&vertexes[index * numMeshVertexes], &vertexes[lastIndex * numMeshVertexes], sizeof(Vertex_PCU) * numMeshVertexes);
+				}
+				vertexes.resize(lastIndex * numMeshVertexes);
+
+				instances[index] = instances.back();
+				instances.pop_back();
+				m_numLiveInstances[kindIndex]--;
+			}
+			else
+			{
+				index++;
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugPrimitiveBatcher::Clear()
+{
+	for (int bucketIndex = 0; bucketIndex < (int)m_timeBuckets.size(); bucketIndex++)
+	{
+		for (int kindIndex = 0; kindIndex < NUM_DEBUG_PRIMITIVE_KINDS; kindIndex++)
+		{
+			m_timeBuckets[bucketIndex].m_instances[kindIndex].clear();
+			m_timeBuckets[bucketIndex].m_vertexes[kindIndex].clear();
+		}
+	}
+
+	for (int kindIndex = 0; kindIndex < NUM_DEBUG_PRIMITIVE_KINDS; kindIndex++)
+	{
+		m_permanentInstances[kindIndex].clear();
+		m_numLiveInstances[kindIndex] = 0;
+	}
+
+	m_numDroppedInstances = 0;
+	m_permanentTextVertexes.clear();
+	ReleasePermanentBuffers();
+	m_isPermanentGeometryDirty = false;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugPrimitiveBatcher::AddInstance(DebugPrimitiveKind kind, Mat44 const& transform, float duration, Rgba8 const& startColor, Rgba8 const& endColor)
+{
+	DebugPrimitiveInstance instance;
+	instance.m_transform = transform;
+	instance.m_startSeconds = m_currentSeconds;
+	instance.m_expirySeconds = m_currentSeconds + duration;
+	instance.m_startColor = startColor;
+	instance.m_endColor = endColor;
+
+	if (duration < 0.f)
+	{
+		m_permanentInstances[kind].push_back(instance);
+		m_isPermanentGeometryDirty = true;
+		return;
+	}
+
+	if (m_numLiveInstances[kind] >= m_maxLiveInstances[kind])
+	{
+		m_numDroppedInstances++;
+		return;
+	}
+
+	long long expiryTick = static_cast<long long>(floorf(instance.m_expirySeconds / DEBUG_TIME_BUCKET_SECONDS));
+	if (expiryTick < m_currentTick)
+	{
+		expiryTick = m_currentTick;
+	}
+
+	// transformed once here; drawing only copies these
+	TimeBucket& bucket = m_timeBuckets[expiryTick % NUM_DEBUG_TIME_BUCKETS];
+	std::vector<Vertex_PCU> const& mesh = m_unitMeshes[kind];
+	size_t firstVertex = bucket.m_vertexes[kind].size();
+	bucket.m_vertexes[kind].resize(firstVertex + mesh.size());
+	WriteInstanceVertexes(&bucket.m_vertexes[kind][firstVertex], mesh, transform, startColor);
+
+	bucket.m_instances[kind].push_back(instance);
+	m_numLiveInstances[kind]++;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugPrimitiveBatcher::AddWorldPoint(Vec3 const& position, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor)
+{
+	Mat44 transform(Vec3(radius, 0.f, 0.f), Vec3(0.f, radius, 0.f), Vec3(0.f, 0.f, radius), position);
+	AddInstance(DEBUG_PRIMITIVE_POINT, transform, duration, startColor, endColor);
+}
+
+void DebugPrimitiveBatcher::AddWorldLine(Vec3 const& start, Vec3 const& end, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor)
+{
+	AddInstance(DEBUG_PRIMITIVE_CYLINDER, GetTransformAlongSegment(start, end, radius), duration, startColor, endColor);
+}
+
+void DebugPrimitiveBatcher::AddWorldArrow(Vec3 const& start, Vec3 const& end, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor)
+{
+	Vec3 headStart = start + (end - start) * DEBUG_ARROW_SHAFT_FRACTION;
+	AddInstance(DEBUG_PRIMITIVE_CYLINDER, GetTransformAlongSegment(start, headStart, radius), duration, startColor, endColor);
+	AddInstance(DEBUG_PRIMITIVE_CONE, GetTransformAlongSegment(headStart, end, radius * DEBUG_ARROW_HEAD_RADIUS_SCALE), duration, startColor, endColor);
+}
+
+void DebugPrimitiveBatcher::AddWorldWireSphere(Vec3 const& center, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor)
+{
+	Mat44 transform(Vec3(radius, 0.f, 0.f), Vec3(0.f, radius, 0.f), Vec3(0.f, 0.f, radius), center);
+	AddInstance(DEBUG_PRIMITIVE_WIRE_SPHERE, transform, duration, startColor, endColor);
+}
+
+void DebugPrimitiveBatcher::AddWorldWireCylinder(Vec3 const& start, Vec3 const& end, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor)
+{
+	AddInstance(DEBUG_PRIMITIVE_WIRE_CYLINDER, GetTransformAlongSegment(start, end, radius), duration, startColor, endColor);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// glyphs are tessellated here, once; the text never changes afterwards
+//
+void DebugPrimitiveBatcher::AddPermanentWorldText(std::string const& text, Mat44 const& transform, float textHeight, Vec2 const& alignment, Rgba8 const& color)
+{
+	float textWidth = g_simpleBitmapFont->GetTextWidth(textHeight, text);
+	Vec2 textMins(-alignment.x * textWidth, -alignment.y * textHeight);
+
+	std::vector<Vertex_PCU> textVerts;
+	g_simpleBitmapFont->AddVertsForText2D(textVerts, textMins, textHeight, text, color);
+	for (int vertIndex = 0; vertIndex < (int)textVerts.size(); vertIndex++)
+	{
+		Vertex_PCU vert = textVerts[vertIndex];
+		vert.m_position = transform.TransformPosition3D(vert.m_position);
+		m_permanentTextVertexes.push_back(vert);
+	}
+
+	m_isPermanentGeometryDirty = true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int DebugPrimitiveBatcher::GetNumLivePrimitives() const
+{
+	int numLive = 0;
+	for (int kindIndex = 0; kindIndex < NUM_DEBUG_PRIMITIVE_KINDS; kindIndex++)
+	{
+		numLive += m_numLiveInstances[kindIndex] + (int)m_permanentInstances[kindIndex].size();
+	}
+
+	return numLive;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugPrimitiveBatcher::Render() const
+{
+	m_numDrawsLastFrame = 0;
+
+	if (m_isPermanentGeometryDirty)
+	{
+		BakePermanentGeometry();
+	}
+
+	RenderKind(DEBUG_PRIMITIVE_POINT);
+	RenderKind(DEBUG_PRIMITIVE_CYLINDER);
+	RenderKind(DEBUG_PRIMITIVE_CONE);
+	g_vertexStream->Flush();
+
+	g_theRenderer->SetRasterizerMode(RasterizerMode::WIREFRAME_CULL_NONE);
+	RenderKind(DEBUG_PRIMITIVE_WIRE_SPHERE);
+	RenderKind(DEBUG_PRIMITIVE_WIRE_CYLINDER);
+	g_vertexStream->Flush();
+	g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
+
+	RenderPermanentGeometry();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// one draw per render state, no per-frame CPU work
+//
+void DebugPrimitiveBatcher::RenderPermanentGeometry() const
+{
+	g_theRenderer->SetModelConstants();
+
+	if (m_numPermanentSolidVertexes > 0)
+	{
+		g_theRenderer->BindTexture(nullptr);
+		g_theRenderer->DrawVertexBuffer(m_permanentSolidBuffer, m_numPermanentSolidVertexes);
+		m_numDrawsLastFrame++;
+	}
+
+	if (m_numPermanentWireVertexes > 0)
+	{
+		g_theRenderer->SetRasterizerMode(RasterizerMode::WIREFRAME_CULL_NONE);
+		g_theRenderer->BindTexture(nullptr);
+		g_theRenderer->DrawVertexBuffer(m_permanentWireBuffer, m_numPermanentWireVertexes);
+		g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
+		m_numDrawsLastFrame++;
+	}
+
+	if (m_numPermanentTextVertexes > 0)
+	{
+		g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_NONE);
+		g_theRenderer->BindTexture(&g_simpleBitmapFont->GetTexture());
+		g_theRenderer->DrawVertexBuffer(m_permanentTextBuffer, m_numPermanentTextVertexes);
+		g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
+		m_numDrawsLastFrame++;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugPrimitiveBatcher::BakePermanentGeometry() const
+{
+	std::vector<Vertex_PCU> solidVerts;
+	std::vector<Vertex_PCU> wireVerts;
+	for (int kindIndex = 0; kindIndex < NUM_DEBUG_PRIMITIVE_KINDS; kindIndex++)
+	{
+		bool isWire = (kindIndex == DEBUG_PRIMITIVE_WIRE_SPHERE || kindIndex == DEBUG_PRIMITIVE_WIRE_CYLINDER);
+		std::vector<Vertex_PCU>& verts = isWire ? wireVerts : solidVerts;
+		std::vector<Vertex_PCU> const& mesh = m_unitMeshes[kindIndex];
+		std::vector<DebugPrimitiveInstance> const& instances = m_permanentInstances[kindIndex];
+
+		for (int instanceIndex = 0; instanceIndex < (int)instances.size(); instanceIndex++)
+		{
+			size_t firstVertex = verts.size();
+			verts.resize(firstVertex + mesh.size());
+			WriteInstanceVertexes(&verts[firstVertex], mesh, instances[instanceIndex].m_transform, instances[instanceIndex].m_startColor);
+		}
+	}
+
+	BakePermanentBuffer(m_permanentSolidBuffer, m_numPermanentSolidVertexes, solidVerts);
+	BakePermanentBuffer(m_permanentWireBuffer, m_numPermanentWireVertexes, wireVerts);
+	BakePermanentBuffer(m_permanentTextBuffer, m_numPermanentTextVertexes, m_permanentTextVertexes);
+
+	m_isPermanentGeometryDirty = false;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugPrimitiveBatcher::BakePermanentBuffer(VertexBuffer*& buffer, int& numVertexes, std::vector<Vertex_PCU> const& verts) const
+{
+	delete buffer;
+	buffer = nullptr;
+	numVertexes = (int)verts.size();
+	if (numVertexes == 0)
+	{
+		return;
+	}
+
+	size_t numBytes = sizeof(Vertex_PCU) * verts.size();
+	buffer = g_theRenderer->CreateVertexBuffer(numBytes);
+	g_theRenderer->CopyCPUToGPU(verts.data(), numBytes, buffer);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugPrimitiveBatcher::ReleasePermanentBuffers() const
+{
+	delete m_permanentSolidBuffer;
+	m_permanentSolidBuffer = nullptr;
+	delete m_permanentWireBuffer;
+	m_permanentWireBuffer = nullptr;
+	delete m_permanentTextBuffer;
+	m_permanentTextBuffer = nullptr;
+
+	m_numPermanentSolidVertexes = 0;
+	m_numPermanentWireVertexes = 0;
+	m_numPermanentTextVertexes = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// all instances of one kind go into as few stream ranges as fit, normally exactly one
+//
+void DebugPrimitiveBatcher::RenderKind(DebugPrimitiveKind kind) const
+{
+	m_batchWriter = VertexSpanWriter();
+	m_numInstancesLeftInBatch = m_numLiveInstances[kind];
+
+	for (int bucketIndex = 0; bucketIndex < (int)m_timeBuckets.size(); bucketIndex++)
+	{
+		RenderInstances(kind, m_timeBuckets[bucketIndex]);
+	}
+
+	if (m_batchWriter.m_count > 0)
+	{
+		g_vertexStream->Draw(m_batchWriter);
+		m_numDrawsLastFrame++;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// copies the bucket's world space vertexes as they are, then recolors the ones that fade
+//
+void DebugPrimitiveBatcher::RenderInstances(DebugPrimitiveKind kind, TimeBucket const& bucket) const
+{
+	std::vector<DebugPrimitiveInstance> const& instances = bucket.m_instances[kind];
+	Vertex_PCU const* cachedVertexes = bucket.m_vertexes[kind].data();
+	int numMeshVertexes = (int)m_unitMeshes[kind].size();
+	int numInstances = (int)instances.size();
+
+	for (int firstInstance = 0; firstInstance < numInstances; )
+	{
+		// start a new range when the current one is full
+		if (m_batchWriter.GetNumRemaining() < numMeshVertexes)
+		{
+			if (m_batchWriter.m_count > 0)
+			{
+				g_vertexStream->Draw(m_batchWriter);
+				m_numDrawsLastFrame++;
+			}
+
+			int numFitting = g_vertexStream->GetNumFreeVertexes() / numMeshVertexes;
+			if (numFitting == 0)
+			{
+				g_vertexStream->Flush();
+				numFitting = g_vertexStream->GetNumFreeVertexes() / numMeshVertexes;
+			}
+
+			int numInBatch = numFitting < m_numInstancesLeftInBatch ? numFitting : m_numInstancesLeftInBatch;
+			m_batchWriter = g_vertexStream->Allocate(numInBatch * numMeshVertexes);
+		}
+
+		int numToCopy = m_batchWriter.GetNumRemaining() / numMeshVertexes;
+		if (numToCopy > numInstances - firstInstance)
+		{
+			numToCopy = numInstances - firstInstance;
+		}
+
+		Vertex_PCU* verts = m_batchWriter.Append(numToCopy * numMeshVertexes);
+		memcpy(verts, cachedVertexes + firstInstance * numMeshVertexes, sizeof(Vertex_PCU) * numToCopy * numMeshVertexes);
+
+		for (int copyIndex = 0; copyIndex < numToCopy; copyIndex++)
+		{
+			DebugPrimitiveInstance const& instance = instances[firstInstance + copyIndex];
+			Rgba8 const& startColor = instance.m_startColor;
+			Rgba8 const& endColor = instance.m_endColor;
+			bool isFading = startColor.r != endColor.r || startColor.g != endColor.g || startColor.b != endColor.b || startColor.a != endColor.a;
+			if (!isFading || instance.m_expirySeconds <= instance.m_startSeconds)
+			{
+				continue;
+			}
+
+			float fraction = (m_currentSeconds - instance.m_startSeconds) / (instance.m_expirySeconds - instance.m_startSeconds);
+			Rgba8 color = LerpColor(startColor, endColor, GetClampedZeroToOne(fraction));
+			Vertex_PCU* instanceVerts = verts + copyIndex * numMeshVertexes;
+			for (int vertIndex = 0; vertIndex < numMeshVertexes; vertIndex++)
+			{
+				instanceVerts[vertIndex].m_color = color;
+			}
+		}
+
+		firstInstance += numToCopy;
+		m_numInstancesLeftInBatch -= numToCopy;
+	}
+}
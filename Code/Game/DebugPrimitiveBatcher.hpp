@@ -0,0 +1,117 @@
+//-----------------------------------------------------------------------------------------------
+// DebugPrimitiveBatcher.hpp
+//
+// Game-side debug shapes kept together by kind and drawn as one batch per kind.
+// Lifetimes are tracked with a timer wheel, so only the buckets the clock has reached are
+// checked for expiry each frame instead of every live primitive. Each bucket also keeps its
+// primitives already transformed to world space, updated only when one is added or expires, so
+// drawing is a copy plus a color fill for the ones that fade. Points are octahedra. Each kind
+// keeps at most one vertex stream's worth of live geometry; primitives past that are dropped.
+// Permanent primitives and permanent world text are baked into static vertex buffers once and
+// only drawn afterwards.
+//
+#pragma once
+
+#include "Game/VertexSpanUtils.hpp"
+
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include <string>
+#include <vector>
+
+
+class VertexBuffer;
+
+
+constexpr int NUM_DEBUG_TIME_BUCKETS = 512;
+constexpr float DEBUG_TIME_BUCKET_SECONDS = 0.25f;
+
+
+//-----------------------------------------------------------------------------------------------
+enum DebugPrimitiveKind
+{
+	DEBUG_PRIMITIVE_POINT,
+	DEBUG_PRIMITIVE_CYLINDER,
+	DEBUG_PRIMITIVE_CONE,
+	DEBUG_PRIMITIVE_WIRE_SPHERE,
+	DEBUG_PRIMITIVE_WIRE_CYLINDER,
+	NUM_DEBUG_PRIMITIVE_KINDS
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct DebugPrimitiveInstance
+{
+	Mat44	m_transform;		// unit mesh -> world
+	float	m_startSeconds = 0.f;
+	float	m_expirySeconds = 0.f;
+	Rgba8	m_startColor;
+	Rgba8	m_endColor;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class DebugPrimitiveBatcher
+{
+public:
+	DebugPrimitiveBatcher();
+	~DebugPrimitiveBatcher();
+
+	void Update(float currentSeconds);
+	void Render() const;
+	void Clear();
+
+	// duration < 0 lives forever, duration 0 lives for one frame
+	void AddWorldPoint(Vec3 const& position, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor);
+	void AddWorldLine(Vec3 const& start, Vec3 const& end, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor);
+	void AddWorldArrow(Vec3 const& start, Vec3 const& end, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor);
+	void AddWorldWireSphere(Vec3 const& center, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor);
+	void AddWorldWireCylinder(Vec3 const& start, Vec3 const& end, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor);
+	void AddPermanentWorldText(std::string const& text, Mat44 const& transform, float textHeight, Vec2 const& alignment, Rgba8 const& color);
+
+	int GetNumLivePrimitives() const;
+	int GetNumDroppedPrimitives() const { return m_numDroppedInstances; }		// since the last Clear()
+	int GetNumDrawsLastFrame() const { return m_numDrawsLastFrame; }
+
+private:
+	struct TimeBucket
+	{
+		std::vector<DebugPrimitiveInstance> m_instances[NUM_DEBUG_PRIMITIVE_KINDS];
+		std::vector<Vertex_PCU>				m_vertexes[NUM_DEBUG_PRIMITIVE_KINDS];		// m_instances in world space, one mesh each, same order
+	};
+
+	void BuildUnitMeshes();
+	void AddInstance(DebugPrimitiveKind kind, Mat44 const& transform, float duration, Rgba8 const& startColor, Rgba8 const& endColor);
+	void ExpireBucket(TimeBucket& bucket);
+	void RenderKind(DebugPrimitiveKind kind) const;
+	void RenderInstances(DebugPrimitiveKind kind, TimeBucket const& bucket) const;
+	void BakePermanentGeometry() const;
+	void BakePermanentBuffer(VertexBuffer*& buffer, int& numVertexes, std::vector<Vertex_PCU> const& verts) const;
+	void ReleasePermanentBuffers() const;
+	void RenderPermanentGeometry() const;
+
+private:
+	std::vector<TimeBucket>				m_timeBuckets;
+	std::vector<DebugPrimitiveInstance>	m_permanentInstances[NUM_DEBUG_PRIMITIVE_KINDS];
+	std::vector<Vertex_PCU>				m_unitMeshes[NUM_DEBUG_PRIMITIVE_KINDS];
+
+	long long					m_currentTick = 0;
+	float						m_currentSeconds = 0.f;
+	int							m_numLiveInstances[NUM_DEBUG_PRIMITIVE_KINDS] = {};
+	int							m_maxLiveInstances[NUM_DEBUG_PRIMITIVE_KINDS] = {};
+	int							m_numDroppedInstances = 0;
+
+	mutable int					m_numDrawsLastFrame = 0;
+	mutable VertexSpanWriter	m_batchWriter;
+	mutable int					m_numInstancesLeftInBatch = 0;
+
+	// static geometry for everything that never expires; rebuilt only when something permanent is added
+	std::vector<Vertex_PCU>		m_permanentTextVertexes;
+	mutable bool				m_isPermanentGeometryDirty = false;
+	mutable VertexBuffer*		m_permanentSolidBuffer = nullptr;
+	mutable VertexBuffer*		m_permanentWireBuffer = nullptr;
+	mutable VertexBuffer*		m_permanentTextBuffer = nullptr;
+	mutable int					m_numPermanentSolidVertexes = 0;
+	mutable int					m_numPermanentWireVertexes = 0;
+	mutable int					m_numPermanentTextVertexes = 0;
+};
@@ -1,4 +1,3 @@
-
 #include "Game/Entity.hpp"
 
 
@@ -11,10 +10,119 @@ Entity::~Entity()
 {
 }
 
-Mat44 Entity::GetModelMatrix() const
+void Entity::SetPosition(Vec3 const& position)
+{
+	if (position != m_position)
+	{
+		m_position = position;
+		m_isPositionDirty = true;
+	}
+}
+
+void Entity::SetOrientation(EulerAngles const& orientation)
+{
+	bool isChanged = orientation.m_yawDegrees != m_orientation.m_yawDegrees ||
+		orientation.m_pitchDegrees != m_orientation.m_pitchDegrees ||
+		orientation.m_rollDegrees != m_orientation.m_rollDegrees;
+	if (isChanged)
+	{
+		m_orientation = orientation;
+		m_isOrientationDirty = true;
+		if (m_usesQuaternionOrientation)
+		{
+			m_orientationQuaternion = Quaternion::MakeFromEulerAnglesDegrees(orientation);
+		}
+	}
+}
+
+void Entity::SetUsesQuaternionOrientation(bool usesQuaternionOrientation)
+{
+	if (usesQuaternionOrientation == m_usesQuaternionOrientation)
+	{
+		return;
+	}
+
+	if (usesQuaternionOrientation)
+	{
+		m_orientationQuaternion = Quaternion::MakeFromEulerAnglesDegrees(m_orientation);
+	}
+	else
+	{
+		m_orientation = m_orientationQuaternion.GetAsEulerAnglesDegrees();
+	}
+	m_usesQuaternionOrientation = usesQuaternionOrientation;
+	m_isOrientationDirty = true;
+}
+
+void Entity::SetOrientationQuaternion(Quaternion const& orientation)
+{
+	bool isChanged = orientation.x != m_orientationQuaternion.x || orientation.y != m_orientationQuaternion.y ||
+		orientation.z != m_orientationQuaternion.z || orientation.w != m_orientationQuaternion.w;
+	if (isChanged)
+	{
+		m_orientationQuaternion = orientation;
+		m_isOrientationDirty = true;
+	}
+}
+
+bool Entity::UpdateTransform() const
+{
+	if (m_isOrientationDirty)
+	{
+		if (m_usesQuaternionOrientation)
+		{
+			m_orientationQuaternion.GetAsVectors_XFwd_YLeft_ZUp(m_iForward, m_jLeft, m_kUp);
+		}
+		else
+		{
+			m_orientation.GetAsVectors_XFwd_YLeft_ZUp(m_iForward, m_jLeft, m_kUp);
+		}
+		m_modelMatrix = Mat44(m_iForward, m_jLeft, m_kUp, m_position);
+	}
+	else if (m_isPositionDirty)
+	{
+		m_modelMatrix.SetTranslation3D(m_position);
+	}
+	else
+	{
+		return false;
+	}
+
+	m_isOrientationDirty = false;
+	m_isPositionDirty = false;
+	return true;
+}
+
+void Entity::SetUpdatedTransform(Mat44 const& modelMatrix) const
+{
+	m_modelMatrix = modelMatrix;
+	m_iForward = modelMatrix.GetIBasis3D();
+	m_jLeft = modelMatrix.GetJBasis3D();
+	m_kUp = modelMatrix.GetKBasis3D();
+	m_isOrientationDirty = false;
+	m_isPositionDirty = false;
+}
+
+Mat44 const& Entity::GetModelMatrix() const
 {
-	Mat44 modelMatrix = m_orientation.GetAsMatrix_XFwd_YLeft_ZUp();
-	modelMatrix.SetTranslation3D(m_position);
+	UpdateTransform();
+	return m_modelMatrix;
+}
 
-	return modelMatrix;
-}
\ No newline at end of file
+Vec3 const& Entity::GetForward() const
+{
+	UpdateTransform();
+	return m_iForward;
+}
+
+Vec3 const& Entity::GetLeft() const
+{
+	UpdateTransform();
+	return m_jLeft;
+}
+
+Vec3 const& Entity::GetUp() const
+{
+	UpdateTransform();
+	return m_kUp;
+}
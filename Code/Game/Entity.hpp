@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Game/Quaternion.hpp"
 #include "Engine/Math/EulerAngles.hpp"
 #include "Engine/Math/Vec3.hpp"
 #include "Engine/Core/Rgba8.hpp"
@@ -15,6 +16,35 @@ public:
 	virtual void Update(float deltaseconds) = 0;
 	virtual void Render() const = 0;
 
+	// writing m_position or m_orientation directly must be followed by a Mark...Dirty call
+	void SetPosition(Vec3 const& position);
+	void SetOrientation(EulerAngles const& orientation);
+	void MarkPositionDirty() { m_isPositionDirty = true; }
+	void MarkOrientationDirty() { m_isOrientationDirty = true; }
+
+	// In quaternion mode the orientation lives in a quaternion, so spin integrates without Euler
+	// angles drifting and the transform is rebuilt without trig. SetOrientation still works;
+	// m_orientation is only brought back up to date when the mode is turned off
+	void SetUsesQuaternionOrientation(bool usesQuaternionOrientation);
+	bool UsesQuaternionOrientation() const { return m_usesQuaternionOrientation; }
+	void SetOrientationQuaternion(Quaternion const& orientation);
+	Quaternion const& GetOrientationQuaternion() const { return m_orientationQuaternion; }
+
+	// refreshes the cached transform; only an Euler orientation change costs any trig. Returns
+	// whether anything was dirty
+	bool UpdateTransform() const;
+
+	// for batched updates: whether UpdateTransform would need trig, and a way to hand it a model
+	// matrix already built from m_orientation and m_position
+	bool NeedsEulerTransform() const { return m_isOrientationDirty && !m_usesQuaternionOrientation; }
+	void SetUpdatedTransform(Mat44 const& modelMatrix) const;
+
+	// cached; brought up to date first if the transform update pass hasn't run since a change
+	Mat44 const& GetModelMatrix() const;
+	Vec3 const& GetForward() const;
+	Vec3 const& GetLeft() const;
+	Vec3 const& GetUp() const;
+
 public:
 	Game* m_game = nullptr;
 
@@ -24,8 +54,16 @@ public:
 	EulerAngles m_orientation;
 	EulerAngles m_angularVelocity;
 
-	Mat44 GetModelMatrix() const;
-
 	Rgba8 m_color = Rgba8::WHITE;
-};
 
+private:
+	bool m_usesQuaternionOrientation = false;
+	Quaternion m_orientationQuaternion;
+
+	mutable Mat44 m_modelMatrix;
+	mutable Vec3 m_iForward = Vec3(1.f, 0.f, 0.f);
+	mutable Vec3 m_jLeft = Vec3(0.f, 1.f, 0.f);
+	mutable Vec3 m_kUp = Vec3(0.f, 0.f, 1.f);
+	mutable bool m_isPositionDirty = true;
+	mutable bool m_isOrientationDirty = true;
+};
@@ -0,0 +1,44 @@
+#include "Game/FrameMemory.hpp"
+#include "Game/HeapAllocationCounter.hpp"
+
+
+MemoryArena* g_frameArena = nullptr;	// Created and rewound by App through FrameMemoryStartup() / FrameMemoryBeginFrame()
+
+static FrameMemoryStats s_lastFrameStats;
+static int s_heapAllocationsAtFrameStart = 0;
+
+
+//-----------------------------------------------------------------------------------------------
+void FrameMemoryStartup()
+{
+	g_frameArena = new MemoryArena(FRAME_ARENA_BLOCK_SIZE);
+	s_heapAllocationsAtFrameStart = GetTotalHeapAllocations();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FrameMemoryShutdown()
+{
+	delete g_frameArena;
+	g_frameArena = nullptr;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FrameMemoryBeginFrame()
+{
+	// latch last frame's numbers before rewinding
+	int totalHeapAllocations = GetTotalHeapAllocations();
+	s_lastFrameStats.m_arenaStats = g_frameArena->GetStats();
+	s_lastFrameStats.m_numHeapAllocations = totalHeapAllocations - s_heapAllocationsAtFrameStart;
+	s_heapAllocationsAtFrameStart = totalHeapAllocations;
+
+	g_frameArena->Reset();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+FrameMemoryStats const& GetFrameMemoryStatsLastFrame()
+{
+	return s_lastFrameStats;
+}
@@ -0,0 +1,70 @@
+//-----------------------------------------------------------------------------------------------
+// FrameMemory.hpp
+//
+// Linear scratch memory that lives for one frame. App rewinds it in BeginFrame, so anything
+// allocated from it (FrameVector, AllocateFrameArray, etc.) must not be kept past the current frame.
+//
+#pragma once
+
+#include "Game/MemoryArena.hpp"
+
+#include <cstddef>
+#include <vector>
+
+
+constexpr size_t FRAME_ARENA_BLOCK_SIZE = 1024 * 1024;
+
+extern MemoryArena* g_frameArena;
+
+
+//-----------------------------------------------------------------------------------------------
+struct FrameMemoryStats
+{
+	MemoryArenaStats	m_arenaStats;
+	int					m_numHeapAllocations = 0;	// every operator new made during the frame
+};
+
+void FrameMemoryStartup();
+void FrameMemoryShutdown();
+void FrameMemoryBeginFrame();
+FrameMemoryStats const& GetFrameMemoryStatsLastFrame();
+
+
+//-----------------------------------------------------------------------------------------------
+template<typename T>
+T* AllocateFrameArray(int count)
+{
+	return g_frameArena->AllocateArray<T>(count);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// STL allocator over the frame arena; deallocate is a no-op since the arena is rewound every frame
+//
+template<typename T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+
+	FrameAllocator() = default;
+
+	template<typename U>
+	FrameAllocator(FrameAllocator<U> const&) {}
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(g_frameArena->Allocate(sizeof(T) * count, alignof(T)));
+	}
+
+	void deallocate(T*, size_t) {}
+
+	template<typename U>
+	bool operator==(FrameAllocator<U> const&) const { return true; }
+
+	template<typename U>
+	bool operator!=(FrameAllocator<U> const&) const { return false; }
+};
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
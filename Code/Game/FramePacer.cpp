@@ -0,0 +1,157 @@
+#include "Game/FramePacer.hpp"
+
+#include "Engine/Core/Time.hpp"
+#include <chrono>
+#include <math.h>
+#include <thread>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+
+constexpr double MIN_SPIN_MARGIN_SECONDS = 0.0005;
+constexpr double MAX_SPIN_MARGIN_SECONDS = 0.004;
+constexpr double OVERSLEEP_SAFETY_SECONDS = 0.00025;
+constexpr double SPIN_MARGIN_SHRINK_FRACTION = 0.02;		// per frame; the margin grows at once
+constexpr double MISSED_DEADLINE_TOLERANCE_SECONDS = 0.0005;
+
+
+//-----------------------------------------------------------------------------------------------
+void FramePacer::Startup()
+{
+#if defined(_WIN32)
+	// the default scheduler tick is ~15.6 ms, far coarser than a frame
+	timeBeginPeriod(1);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FramePacer::Shutdown()
+{
+#if defined(_WIN32)
+	timeEndPeriod(1);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FramePacer::SetTargetFps(float targetFps)
+{
+	targetFps = targetFps > 0.f ? targetFps : 0.f;
+	if (targetFps != m_targetFps)
+	{
+		m_targetFps = targetFps;
+		m_nextDeadlineSeconds = -1.0;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FramePacer::WaitForNextFrame()
+{
+	double nowSeconds = GetCurrentTimeSeconds();
+	if (m_targetFps <= 0.f)
+	{
+		m_nextDeadlineSeconds = -1.0;
+		RecordFrame(nowSeconds, 0.0, 0.0, false);
+		return;
+	}
+
+	double periodSeconds = 1.0 / (double)m_targetFps;
+	if (m_nextDeadlineSeconds < 0.0)
+	{
+		m_nextDeadlineSeconds = nowSeconds;
+	}
+	double deadlineSeconds = m_nextDeadlineSeconds;
+
+	// coarse sleep up to the spin margin, then learn from how far past the request it woke
+	double sleepSeconds = 0.0;
+	double requestedSleepSeconds = deadlineSeconds - nowSeconds - m_spinMarginSeconds;
+	if (requestedSleepSeconds > 0.0)
+	{
+		std::this_thread::sleep_for(std::chrono::duration<double>(requestedSleepSeconds));
+		double wakeSeconds = GetCurrentTimeSeconds();
+		sleepSeconds = wakeSeconds - nowSeconds;
+		nowSeconds = wakeSeconds;
+
+		double wantedMarginSeconds = (sleepSeconds - requestedSleepSeconds) + OVERSLEEP_SAFETY_SECONDS;
+		if (wantedMarginSeconds > m_spinMarginSeconds)
+		{
+			m_spinMarginSeconds = wantedMarginSeconds;
+		}
+		else
+		{
+			m_spinMarginSeconds += (wantedMarginSeconds - m_spinMarginSeconds) * SPIN_MARGIN_SHRINK_FRACTION;
+		}
+		m_spinMarginSeconds = m_spinMarginSeconds < MIN_SPIN_MARGIN_SECONDS ? MIN_SPIN_MARGIN_SECONDS : m_spinMarginSeconds;
+		m_spinMarginSeconds = m_spinMarginSeconds > MAX_SPIN_MARGIN_SECONDS ? MAX_SPIN_MARGIN_SECONDS : m_spinMarginSeconds;
+	}
+
+	// precise finish
+	double spinStartSeconds = nowSeconds;
+	while (nowSeconds < deadlineSeconds)
+	{
+		std::this_thread::yield();
+		nowSeconds = GetCurrentTimeSeconds();
+	}
+	double spinSeconds = nowSeconds - spinStartSeconds;
+
+	// stay on schedule after a late frame, unless it is too far behind to catch up smoothly
+	double lateSeconds = nowSeconds - deadlineSeconds;
+	bool didMissDeadline = lateSeconds > MISSED_DEADLINE_TOLERANCE_SECONDS;
+	m_nextDeadlineSeconds = lateSeconds > periodSeconds ? nowSeconds + periodSeconds : deadlineSeconds + periodSeconds;
+	RecordFrame(nowSeconds, sleepSeconds, spinSeconds, didMissDeadline);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FramePacer::RecordFrame(double frameStartSeconds, double sleepSeconds, double spinSeconds, bool didMissDeadline)
+{
+	double lastFrameStartSeconds = m_lastFrameStartSeconds;
+	m_lastFrameStartSeconds = frameStartSeconds;
+	if (lastFrameStartSeconds < 0.0)
+	{
+		return;
+	}
+
+	m_frameMsHistory[m_nextHistoryFrame] = 1000.0 * (frameStartSeconds - lastFrameStartSeconds);
+	m_sleepMsHistory[m_nextHistoryFrame] = 1000.0 * sleepSeconds;
+	m_spinMsHistory[m_nextHistoryFrame] = 1000.0 * spinSeconds;
+	m_missedHistory[m_nextHistoryFrame] = didMissDeadline;
+	m_nextHistoryFrame = (m_nextHistoryFrame + 1) % FRAME_PACER_HISTORY_FRAMES;
+	m_numHistoryFrames = m_numHistoryFrames < FRAME_PACER_HISTORY_FRAMES ? m_numHistoryFrames + 1 : FRAME_PACER_HISTORY_FRAMES;
+
+	double frameMsSum = 0.0;
+	double sleepMsSum = 0.0;
+	double spinMsSum = 0.0;
+	int numMissed = 0;
+	for (int frameIndex = 0; frameIndex < m_numHistoryFrames; frameIndex++)
+	{
+		frameMsSum += m_frameMsHistory[frameIndex];
+		sleepMsSum += m_sleepMsHistory[frameIndex];
+		spinMsSum += m_spinMsHistory[frameIndex];
+		numMissed += m_missedHistory[frameIndex] ? 1 : 0;
+	}
+
+	double inverseNumFrames = 1.0 / (double)m_numHistoryFrames;
+	double averageFrameMs = frameMsSum * inverseNumFrames;
+	double varianceSum = 0.0;
+	for (int frameIndex = 0; frameIndex < m_numHistoryFrames; frameIndex++)
+	{
+		double deviationMs = m_frameMsHistory[frameIndex] - averageFrameMs;
+		varianceSum += deviationMs * deviationMs;
+	}
+
+	m_stats.m_targetFps = m_targetFps;
+	m_stats.m_averageFrameMs = averageFrameMs;
+	m_stats.m_jitterMs = sqrt(varianceSum * inverseNumFrames);
+	m_stats.m_averageSleepMs = sleepMsSum * inverseNumFrames;
+	m_stats.m_averageSpinMs = spinMsSum * inverseNumFrames;
+	m_stats.m_spinMarginMs = 1000.0 * m_spinMarginSeconds;
+	m_stats.m_numMissedDeadlines = numMissed;
+}
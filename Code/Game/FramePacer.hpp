@@ -0,0 +1,63 @@
+//-----------------------------------------------------------------------------------------------
+// FramePacer.hpp
+//
+// Holds the main loop to a target frame rate. Frames start on a fixed schedule of deadlines one
+// period apart, so a frame that ran late leaves a shorter wait before the next one. Most of the
+// wait is slept so the core goes idle, and the last stretch is spun for precision. The spin
+// margin follows how much the OS has been oversleeping. A frame that misses its deadline by more
+// than a whole period restarts the schedule instead of rushing to catch up.
+//
+#pragma once
+
+
+constexpr int FRAME_PACER_HISTORY_FRAMES = 120;
+
+
+//-----------------------------------------------------------------------------------------------
+// over the last FRAME_PACER_HISTORY_FRAMES frames
+//
+struct FramePacerStats
+{
+	float	m_targetFps = 0.f;				// 0 when unpaced
+	double	m_averageFrameMs = 0.0;			// start to start
+	double	m_jitterMs = 0.0;				// standard deviation of the frame time
+	double	m_averageSleepMs = 0.0;
+	double	m_averageSpinMs = 0.0;
+	double	m_spinMarginMs = 0.0;
+	int		m_numMissedDeadlines = 0;		// frames that started late
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class FramePacer
+{
+public:
+	void Startup();
+	void Shutdown();
+
+	// 0 or less runs frames back to back; a new rate starts a new schedule
+	void SetTargetFps(float targetFps);
+	float GetTargetFps() const { return m_targetFps; }
+
+	// call at the top of every frame
+	void WaitForNextFrame();
+
+	FramePacerStats const& GetStats() const { return m_stats; }
+
+private:
+	void RecordFrame(double frameStartSeconds, double sleepSeconds, double spinSeconds, bool didMissDeadline);
+
+private:
+	float		m_targetFps = 0.f;
+	double		m_nextDeadlineSeconds = -1.0;		// -1 until the first paced frame
+	double		m_lastFrameStartSeconds = -1.0;
+	double		m_spinMarginSeconds = 0.002;
+
+	double		m_frameMsHistory[FRAME_PACER_HISTORY_FRAMES] = {};
+	double		m_sleepMsHistory[FRAME_PACER_HISTORY_FRAMES] = {};
+	double		m_spinMsHistory[FRAME_PACER_HISTORY_FRAMES] = {};
+	bool		m_missedHistory[FRAME_PACER_HISTORY_FRAMES] = {};
+	int			m_numHistoryFrames = 0;
+	int			m_nextHistoryFrame = 0;
+	FramePacerStats	m_stats;
+};
@@ -2,7 +2,13 @@
 #include "Game/Prop.hpp"
 #include "Game/Game.hpp"
 #include "Game/App.hpp"
+#include "Game/DebugLineBatch.hpp"
 #include "Game/Entity.hpp"
+#include "Game/FrameMemory.hpp"
+#include "Game/HeapAllocationCounter.hpp"
+#include "Game/InputQueue.hpp"
+#include "Game/VertexSpanUtils.hpp"
+#include "Game/VertexStream.hpp"
 
 #include "Engine/Renderer/DebugRenderSystem.hpp"
 #include "Engine/Window/Window.hpp"
@@ -16,13 +22,35 @@
 constexpr int MAX_VERTEXAS = 3;
 constexpr unsigned char MIN_TEST_COLOR_VALUE = 5;
 constexpr unsigned char MAX_TEST_COLOR_VALUE = 255;
+constexpr int PLAYERS_PER_POOL_CHUNK = 4;
+constexpr int PROPS_PER_POOL_CHUNK = 64;
+
+constexpr int NUM_THIN_X_GRID_LINES = 100;
+constexpr int NUM_THIN_Y_GRID_LINES = 101;
+constexpr int NUM_THICK_GRID_LINES = 2 * 21;
+constexpr int NUM_ORIGIN_GRID_LINES = 2;
+constexpr int NUM_GRID_LINES = NUM_THIN_X_GRID_LINES + NUM_THIN_Y_GRID_LINES + NUM_THICK_GRID_LINES + NUM_ORIGIN_GRID_LINES;
+
+constexpr int NUM_POINTS_PER_DEBUG_BURST = 1000;
+constexpr int SPHERE_PROP_LATITUDE_SLICES = 8;
+constexpr int PHYSICS_PYRAMID_BASE = 3;
+constexpr float PHYSICS_SPHERE_MASS = 1.f;
+constexpr float PHYSICS_BALL_THROW_SPEED = 12.f;
+constexpr int GAME_PARTICLE_CAPACITY = 16384;
 
 extern App* g_theApp;
 
 
 Game::Game(App* g_app, bool showDebugView) :
 	m_app(g_app),
-	m_showDebugView(showDebugView)
+	m_showDebugView(showDebugView),
+	m_players(m_entityArena, PLAYERS_PER_POOL_CHUNK),
+	m_props(m_entityArena, PROPS_PER_POOL_CHUNK),
+	m_particles(GAME_PARTICLE_CAPACITY)
+{
+}
+
+Game::~Game()
 {
 }
 
@@ -34,54 +62,166 @@ void Game::Startup()
 	// create clock
 	m_GameClock = new Clock();
 
+	CreateLocomotionAnimations(m_locomotionAnimations, MOVEMENT_SPEED, MOVEMENT_SPEED * FAST_MOVEMENT_MULTIPLIER);
 	CreateScene();
+	RebuildPropBroadphase();
+	m_workerPool.Startup();
+	m_navigationGrid.Startup(m_characterController.GetConfig().m_capsuleRadius);
+	SyncNavigationObstacles();
+	m_crowd.Startup(m_locomotionAnimations, m_characterController.GetConfig());
 	AddBasisAtOrigin();
 	InitMovingPoint();
 }
 
 void Game::Shutdown()
 {
-	for (int index = 0; index < m_entities.size(); index++)
-	{
-		Entity* entity = m_entities[index];
-		if (entity != nullptr)
-		{
-			delete entity;
-			entity = nullptr;
-		}
-	}
+	m_crowd.SetNumAgents(0);
+	m_workerPool.Shutdown();
+
+	m_propPhysics.Clear();
+	m_physicsProps.clear();
+	m_particles.Clear();
+	m_debugPrimitives.Clear();
+
+	m_players.DestroyAll();
+	m_props.DestroyAll();
+	m_player = nullptr;
+	m_cubeProp = nullptr;
+	m_cubeProp2 = nullptr;
+	m_sphereProp = nullptr;
+
+	// entities and meshes go back to the heap in one go
+	m_entityArena.ReleaseAll();
+	m_cubeVertexes = nullptr;
+	m_sphereVertexes = nullptr;
 }
 
 void Game::CreateScene()
 {
 	// 1. add a player to the scene
-	m_player = new Player(this);
-	m_player->Startup();
-	m_player->m_position = Vec3(-3.f, 0.f, 1.f);
+	m_player = m_players.Create(this);
+	m_player->SetPosition(Vec3(-3.f, 0.f, 1.f));
 
 	// 2. add 1x1x1 cube prop
-	m_cubeProp = new Prop(this);
-	m_cubeProp->m_position = Vec3(2.f, 2.f, 0.f);
+	m_cubeProp = m_props.Create(this);
+	m_cubeProp->SetPosition(Vec3(2.f, 2.f, 0.f));
 	// rotate cube 1 about x-axis
 	m_cubeProp->m_angularVelocity.m_rollDegrees = 30.f;
 	// rotate cube 1 about y-axis
 	m_cubeProp->m_angularVelocity.m_pitchDegrees = 30.f;
+	m_cubeProp->SetUsesQuaternionOrientation(true);
 	AddVertsForCubeProp(*m_cubeProp);
 
-	m_cubeProp2 = new Prop(this);
-	m_cubeProp2->m_position = Vec3(-2.f, -2.f, 0.f);
+	m_cubeProp2 = m_props.Create(this);
+	m_cubeProp2->SetPosition(Vec3(-2.f, -2.f, 0.f));
 	AddVertsForCubeProp(*m_cubeProp2);
 
-	m_sphereProp = new Prop(this);
+	m_sphereProp = m_props.Create(this);
 	m_sphereProp->m_texture = g_theRenderer->CreateOrGetTextureFromFile("Data/Images/TestUV.png");
 	m_sphereProp->m_angularVelocity.m_yawDegrees = 45.f;
-	m_sphereProp->m_position = Vec3(10.f, -5.f, 1.0f);
+	m_sphereProp->SetUsesQuaternionOrientation(true);
+	m_sphereProp->SetPosition(Vec3(10.f, -5.f, 1.0f));
 	AddVertsForSphereProp(*m_sphereProp);
 
-	m_entities.push_back(m_player);
-	m_entities.push_back(m_cubeProp);
-	m_entities.push_back(m_cubeProp2);
-	m_entities.push_back(m_sphereProp);
+	// 3. the props so far are static physics bodies, and a pyramid of spheres rests among them
+	m_props.ForEach([this](Prop& prop) { AddPhysicsBody(prop, 0.f); });
+	AddPhysicsSpherePyramid(Vec3(-10.f, 4.f, 0.f), PHYSICS_PYRAMID_BASE);
+}
+
+void Game::AddPhysicsBody(Prop& prop, float mass)
+{
+	prop.m_physicsBody = m_propPhysics.AddBody(prop.m_position, prop.m_boundingRadius, mass);
+	m_physicsProps.push_back(&prop);
+}
+
+//----------------------------------------------------------------------------------------------------------
+// Each layer sits in the pockets of the one below. Loose spheres on flat ground would roll apart,
+// so the bottom layer is static
+//
+void Game::AddPhysicsSpherePyramid(Vec3 const& baseCorner, int numPerSide)
+{
+	for (int layer = 0; layer < numPerSide; layer++)
+	{
+		int numInRow = numPerSide - layer;
+		for (int sphereY = 0; sphereY < numInRow; sphereY++)
+		{
+			for (int sphereX = 0; sphereX < numInRow; sphereX++)
+			{
+				Prop* sphereProp = m_props.Create(this);
+				sphereProp->m_texture = g_theRenderer->CreateOrGetTextureFromFile("Data/Images/TestUV.png");
+				sphereProp->SetUsesQuaternionOrientation(true);
+				AddVertsForSphereProp(*sphereProp);
+
+				float radius = sphereProp->m_boundingRadius;
+				sphereProp->SetPosition(baseCorner + Vec3(radius * (float)(1 + layer + 2 * sphereX), radius * (float)(1 + layer + 2 * sphereY),
+					radius + (float)layer * radius * sqrtf(2.f)));
+				AddPhysicsBody(*sphereProp, layer == 0 ? 0.f : PHYSICS_SPHERE_MASS);
+			}
+		}
+	}
+}
+
+void Game::ThrowPhysicsBall()
+{
+	Prop* ballProp = m_props.Create(this);
+	ballProp->m_texture = g_theRenderer->CreateOrGetTextureFromFile("Data/Images/TestUV.png");
+	ballProp->SetUsesQuaternionOrientation(true);
+	AddVertsForSphereProp(*ballProp);
+
+	// from in front of the player, lobbed slightly upward
+	Vec3 const& player_iForward = m_player->GetForward();
+	ballProp->SetPosition(m_player->m_position + player_iForward * (2.f * ballProp->m_boundingRadius) + Vec3(0.f, 0.f, 1.f));
+	AddPhysicsBody(*ballProp, PHYSICS_SPHERE_MASS);
+	m_propPhysics.SetVelocity(ballProp->m_physicsBody, player_iForward * PHYSICS_BALL_THROW_SPEED + Vec3(0.f, 0.f, 3.f));
+
+	// a new prop is the one change the broadphase can't take in place
+	RebuildPropBroadphase();
+}
+
+void Game::RebuildPropBroadphase()
+{
+	m_broadphaseUpdateCenters.clear();
+	m_broadphaseUpdateRadii.clear();
+	m_props.ForEach([this](Prop& prop)
+	{
+		prop.m_broadphaseIndex = (int)m_broadphaseUpdateCenters.size();
+		m_broadphaseUpdateCenters.push_back(prop.m_position);
+		m_broadphaseUpdateRadii.push_back(prop.m_boundingRadius);
+	});
+
+	m_propBroadphase.Build(m_broadphaseUpdateCenters.data(), m_broadphaseUpdateRadii.data(), (int)m_broadphaseUpdateCenters.size());
+}
+
+//----------------------------------------------------------------------------------------------------------
+// Props whose bounds reach between step height and head height block walking; the navigation
+// grid skips obstacles that did not move, so a frame where nothing moved costs a visit per prop
+//
+void Game::SyncNavigationObstacles()
+{
+	CharacterControllerConfig const& config = m_characterController.GetConfig();
+	float bandMinZ = config.m_groundHeight + config.m_stepHeight;
+	float bandMaxZ = config.m_groundHeight + 2.f * config.m_capsuleHalfHeight;
+	m_props.ForEach([this, bandMinZ, bandMaxZ](Prop& prop)
+	{
+		bool isInWalkingBand = prop.m_position.z - prop.m_boundingRadius < bandMaxZ && prop.m_position.z + prop.m_boundingRadius > bandMinZ;
+		Vec2 center(prop.m_position.x, prop.m_position.y);
+		if (!isInWalkingBand)
+		{
+			if (prop.m_navigationObstacle >= 0)
+			{
+				m_navigationGrid.RemoveObstacle(prop.m_navigationObstacle);
+				prop.m_navigationObstacle = -1;
+			}
+		}
+		else if (prop.m_navigationObstacle < 0)
+		{
+			prop.m_navigationObstacle = m_navigationGrid.AddObstacle(center, prop.m_boundingRadius);
+		}
+		else
+		{
+			m_navigationGrid.MoveObstacle(prop.m_navigationObstacle, center, prop.m_boundingRadius);
+		}
+	});
 }
 
 void Game::AddBasisAtOrigin()
@@ -92,65 +232,69 @@ void Game::AddBasisAtOrigin()
 	Vec3 yLeft = Vec3(0.f, 1.f, 0.f);
 	Vec3 zUp = Vec3(0.f, 0.f, 1.f);
 
+	// permanent, so these get baked into static buffers by the batcher
 	float radius = 0.1f;
 	float duration = -1.f;
-	DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-	DebugAddWorldArrow(origin, xForward, radius, duration, Rgba8::RED, Rgba8::RED, mode);
-	DebugAddWorldArrow(origin, yLeft, radius, duration, Rgba8::GREEN, Rgba8::GREEN, mode);
-	DebugAddWorldArrow(origin, zUp, radius, duration, Rgba8::BLUE, Rgba8::BLUE, mode);
+	m_debugPrimitives.AddWorldArrow(origin, xForward, radius, duration, Rgba8::RED, Rgba8::RED);
+	m_debugPrimitives.AddWorldArrow(origin, yLeft, radius, duration, Rgba8::GREEN, Rgba8::GREEN);
+	m_debugPrimitives.AddWorldArrow(origin, zUp, radius, duration, Rgba8::BLUE, Rgba8::BLUE);
 
 	// text
 	Mat44 alongXAxisTransform(Vec3(0.f, -1.f, 0.f), Vec3(1.f, 0.f, 0.f), Vec3(0.f, 0.f, 1.f), Vec3(0.2f, 0.f, 0.2f));
 	float textHeight = 0.2f;
 	Vec2 alignment = Vec2(0.f, 0.f);
-	float textDuration = -1.f;
-	DebugAddWorldText("x - forward", alongXAxisTransform, textHeight, alignment, textDuration, Rgba8::RED, Rgba8::RED, DebugRenderMode::USE_DEPTH);
+	m_debugPrimitives.AddPermanentWorldText("x - forward", alongXAxisTransform, textHeight, alignment, Rgba8::RED);
 
 	Mat44 alongYAxisTransform(Vec3(-1.f, 0.f, 0.f), Vec3(0.f, -1.f, 0.f), Vec3(0.f, 0.f, 1.f), Vec3(0.f, 0.2f, 0.2f));
 	alignment = Vec2(1.f, 0.f);
-	DebugAddWorldText("y - left", alongYAxisTransform, textHeight, alignment, textDuration, Rgba8::GREEN, Rgba8::GREEN, DebugRenderMode::USE_DEPTH);
+	m_debugPrimitives.AddPermanentWorldText("y - left", alongYAxisTransform, textHeight, alignment, Rgba8::GREEN);
 
 	Mat44 alongZAxisTransform(Vec3(-1.f, 0.f, 0.f), Vec3(0.f, 0.f, 1.f), Vec3(0.f, 1.f, 0.f), Vec3(0.f, -0.2f, 0.2f));
 	alignment = Vec2(0.f, 1.f);
-	DebugAddWorldText("z - up", alongZAxisTransform, textHeight, alignment, textDuration, Rgba8::BLUE, Rgba8::BLUE, DebugRenderMode::USE_DEPTH);
+	m_debugPrimitives.AddPermanentWorldText("z - up", alongZAxisTransform, textHeight, alignment, Rgba8::BLUE);
 }
 
 void Game::AddVertsForCubeProp(Prop& prop)
 {
-	float x = 0.5f;
-	float y = 0.5f;
-	float z = 0.5f;
-
-	std::vector<Vertex_PCU>& verts = prop.m_vertexes;
-	verts.clear();
-
-	// face 3 : +x plane : back
-	AddVertsForQuad3D(verts, Vec3(x, -y, -z), Vec3(x, y, -z), Vec3(x, y, z), Vec3(x, -y, z), Rgba8::RED, AABB2::ZERO_TO_ONE);
-
-	// face 1 : -x plane : front
-	AddVertsForQuad3D(verts, Vec3(-x, y, -z), Vec3(-x, -y, -z), Vec3(-x, -y, z), Vec3(-x, y, z), Rgba8::CYAN, AABB2::ZERO_TO_ONE);
-
-	// face 4 : +y plane : west
-	AddVertsForQuad3D(verts, Vec3(x, y, -z), Vec3(-x, y, -z), Vec3(-x, y, z), Vec3(x, y, z), Rgba8::GREEN, AABB2::ZERO_TO_ONE);
-
-	// face 2 : -y plane : east
-	AddVertsForQuad3D(verts, Vec3(-x, -y, -z), Vec3(x, -y, -z), Vec3(x, -y, z), Vec3(-x, -y, z), Rgba8::MAGENTA, AABB2::ZERO_TO_ONE);
+	// all cube props share one mesh
+	prop.m_boundingRadius = 0.87f;	// half the cube's diagonal
+	if (m_cubeVertexes != nullptr)
+	{
+		prop.m_vertexes = m_cubeVertexes;
+		prop.m_numVertexes = m_numCubeVertexes;
+		return;
+	}
 
-	// face 6 : +z plane : top
-	AddVertsForQuad3D(verts, Vec3(x, -y, z), Vec3(x, y, z), Vec3(-x, y, z), Vec3(-x, -y, z), Rgba8::BLUE, AABB2::ZERO_TO_ONE);
+	// +x back, -x front, +y west, -y east, +z top, -z bottom
+	Rgba8 faceColors[AABB3_NUM_FACES] = { Rgba8::RED, Rgba8::CYAN, Rgba8::GREEN, Rgba8::MAGENTA, Rgba8::BLUE, Rgba8::YELLOW };
+	Vertex_PCU* cubeVertexes = m_entityArena.AllocateArray<Vertex_PCU>(AABB3_NUM_VERTEXES);
+	VertexSpanWriter verts(cubeVertexes, AABB3_NUM_VERTEXES);
+	AddVertsForAABB3DWithFaceColors(verts, AABB3(Vec3(-0.5f, -0.5f, -0.5f), Vec3(0.5f, 0.5f, 0.5f)), faceColors);
 
-	// face 5 : -z plane : bottom
-	AddVertsForQuad3D(verts, Vec3(x, y, -z), Vec3(x, -y, -z), Vec3(-x, -y, -z), Vec3(-x, y, -z), Rgba8::YELLOW, AABB2::ZERO_TO_ONE);
+	m_cubeVertexes = cubeVertexes;
+	m_numCubeVertexes = verts.m_count;
+	prop.m_vertexes = m_cubeVertexes;
+	prop.m_numVertexes = m_numCubeVertexes;
 }
 
 void Game::AddVertsForSphereProp(Prop& prop)
 {
-	std::vector<Vertex_PCU>& verts = prop.m_vertexes;
-	verts.clear();
+	// all sphere props share one mesh
+	prop.m_boundingRadius = 1.f;
+	if (m_sphereVertexes == nullptr)
+	{
+		int numVertexes = GetNumVertexesForSphere3D(SPHERE_PROP_LATITUDE_SLICES);
+		Vertex_PCU* sphereVertexes = m_entityArena.AllocateArray<Vertex_PCU>(numVertexes);
+		VertexSpanWriter verts(sphereVertexes, numVertexes);
+		float radius = 1.f;
+		AddVertsForSphere3D(verts, Vec3(), radius, Rgba8::WHITE, AABB2::ZERO_TO_ONE, SPHERE_PROP_LATITUDE_SLICES);
+
+		m_sphereVertexes = sphereVertexes;
+		m_numSphereVertexes = verts.m_count;
+	}
 
-	Vec3 center = prop.m_position;
-	float radius = 1.f;
-	AddVertsForSphere3D(verts, Vec3(), radius, Rgba8::WHITE, AABB2::ZERO_TO_ONE, 8);
+	prop.m_vertexes = m_sphereVertexes;
+	prop.m_numVertexes = m_numSphereVertexes;
 }
 
 
@@ -164,6 +308,7 @@ AddVertsForCylinder3D(verts, start, end, radius, Rgba8::WHITE, AABB2::ZERO_TO_ON
 
 void Game::BeginFrame()
 {
+	m_numDebugHudLines = 0;
 }
 
 void Game::Update()
@@ -171,6 +316,8 @@ void Game::Update()
 	UpdateGameState();
 	UpdateCubePropColor();
 	UpdateAllEnteties();
+	UpdateEntityTransforms();
+	m_debugPrimitives.Update(m_GameClock->GetTotalSeconds());
 	AddDebugRenderObjects();
 	UpdateParametricT();
 }
@@ -231,15 +378,86 @@ void Game::UpdateAllEnteties()
 {
 	float deltaSeconds = m_GameClock->GetDeltaSeconds();
 	
-	// update all entities
-	for (int index = 0; index < m_entities.size(); index++)
+	// update all entities, one contiguous pool at a time
+	m_players.ForEach([deltaSeconds](Player& player) { player.Update(deltaSeconds); });
+	m_props.ForEach([deltaSeconds](Prop& prop) { prop.Update(deltaSeconds); });
+	UpdatePropPhysics(deltaSeconds);
+	m_particles.Update(deltaSeconds);
+
+	// fields are repaired around props that moved before anyone steers by them
+	SyncNavigationObstacles();
+	m_navigationGrid.Update(m_workerPool);
+
+	// after the player, so animation LODs use this frame's camera
+	m_crowd.Update(deltaSeconds, m_propBroadphase, &m_navigationGrid, m_workerPool, m_player->m_springArm.GetCameraPosition(), WORLD_CAMERA_FOV_DEGREES);
+}
+
+//----------------------------------------------------------------------------------------------------------
+// Only bodies the step moved are written back, so a scene at rest costs no transform updates and
+// no broadphase update. Moved props are updated in the broadphase in place, without allocating
+//
+void Game::UpdatePropPhysics(float deltaSeconds)
+{
+	if (g_theInput->WasKeyJustPressed('K'))
 	{
-		Entity* entity = m_entities[index];
-		if (entity != nullptr)
+		ThrowPhysicsBall();
+	}
+
+	m_propPhysics.Step(deltaSeconds);
+	std::vector<int> const& movedBodies = m_propPhysics.GetBodiesMovedLastStep();
+	m_broadphaseUpdateIndexes.clear();
+	m_broadphaseUpdateCenters.clear();
+	m_broadphaseUpdateRadii.clear();
+	for (int bodyIndex : movedBodies)
+	{
+		Prop* prop = m_physicsProps[bodyIndex];
+		prop->SetPosition(m_propPhysics.GetPosition(bodyIndex));
+		prop->SetOrientationQuaternion(m_propPhysics.GetOrientation(bodyIndex));
+		prop->m_velocity = m_propPhysics.GetVelocity(bodyIndex);
+
+		m_broadphaseUpdateIndexes.push_back(prop->m_broadphaseIndex);
+		m_broadphaseUpdateCenters.push_back(prop->m_position);
+		m_broadphaseUpdateRadii.push_back(prop->m_boundingRadius);
+	}
+
+	m_propBroadphase.UpdateProps(m_broadphaseUpdateIndexes.data(), m_broadphaseUpdateCenters.data(), m_broadphaseUpdateRadii.data(), (int)m_broadphaseUpdateIndexes.size());
+}
+
+//----------------------------------------------------------------------------------------------------------
+// One pass after every entity has moved, so renders and queries read cached transforms
+//
+// Rotated Euler entities go through one batched conversion; quaternion and moved-only ones update
+// in place without trig
+void Game::UpdateEntityTransforms()
+{
+	m_transformBatchEntities.clear();
+	m_transformBatchOrientations.clear();
+	m_transformBatchPositions.clear();
+	int numUpdated = 0;
+	auto updateOrGather = [this, &numUpdated](Entity const& entity)
+	{
+		if (entity.NeedsEulerTransform())
+		{
+			m_transformBatchEntities.push_back(&entity);
+			m_transformBatchOrientations.push_back(entity.m_orientation);
+			m_transformBatchPositions.push_back(entity.m_position);
+		}
+		else
 		{
-			entity->Update(deltaSeconds);
+			numUpdated += entity.UpdateTransform() ? 1 : 0;
 		}
+	};
+	m_players.ForEach(updateOrGather);
+	m_props.ForEach(updateOrGather);
+
+	int numBatched = (int)m_transformBatchEntities.size();
+	m_transformBatchMatrices.resize(numBatched);
+	GetMatricesFromEulerAngles(GetBestSimdMathPath(), m_transformBatchOrientations.data(), m_transformBatchPositions.data(), m_transformBatchMatrices.data(), numBatched);
+	for (int entityIndex = 0; entityIndex < numBatched; entityIndex++)
+	{
+		m_transformBatchEntities[entityIndex]->SetUpdatedTransform(m_transformBatchMatrices[entityIndex].GetAsMat44());
 	}
+	m_numTransformsUpdated = numUpdated + numBatched;
 }
 
 void Game::AddDebugRenderObjects()
@@ -247,11 +465,7 @@ void Game::AddDebugRenderObjects()
 	// wireframe sphere
 	if (g_theInput->WasKeyJustPressed('1'))
 	{
-		EulerAngles playerOrientation = m_player->m_orientation;
-		Vec3 player_iForward;
-		Vec3 player_jLeft;
-		Vec3 player_kUp;
-		playerOrientation.GetAsVectors_XFwd_YLeft_ZUp(player_iForward, player_jLeft, player_kUp);
+		Vec3 const& player_iForward = m_player->GetForward();
 		Vec3 playerPosition = m_player->m_position;
 		Vec3 twoUnitsInFrontOfPlayer = (playerPosition + (player_iForward * 2.f));
 		
@@ -260,18 +474,13 @@ void Game::AddDebugRenderObjects()
 		float duration = 5.f;
 		Rgba8 startColor = Rgba8::GREEN;
 		Rgba8 endColor = Rgba8::RED;
-		DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-		DebugAddWorldWireSphere(center, radius, duration, startColor, endColor, mode);
+		m_debugPrimitives.AddWorldWireSphere(center, radius, duration, startColor, endColor);
 	}
 
 	// x-ray line 
 	if (g_theInput->WasKeyJustPressed('2'))
 	{
-		EulerAngles playerOrientation = m_player->m_orientation;
-		Vec3 player_iForward;
-		Vec3 player_jLeft;
-		Vec3 player_kUp;
-		playerOrientation.GetAsVectors_XFwd_YLeft_ZUp(player_iForward, player_jLeft, player_kUp);
+		Vec3 const& player_iForward = m_player->GetForward();
 
 		Vec3 start = m_player->m_position;
 		Vec3 end = start + (player_iForward * 20.f);
@@ -286,26 +495,24 @@ void Game::AddDebugRenderObjects()
 	// player basis (i, j, k)
 	if (g_theInput->WasKeyJustPressed('3'))
 	{
-		Mat44 playerModelMatrix = m_player->GetModelMatrix();
-		Vec3 player_iForward = playerModelMatrix.GetIBasis3D();
-		Vec3 player_jLeft = playerModelMatrix.GetJBasis3D();
-		Vec3 player_kUp = playerModelMatrix.GetKBasis3D();
+		Vec3 const& player_iForward = m_player->GetForward();
+		Vec3 const& player_jLeft = m_player->GetLeft();
+		Vec3 const& player_kUp = m_player->GetUp();
 		
 		float radius = 0.1f;
 		float duration = 20.f;
-		DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
 		// i
 		Vec3 iStart = m_player->m_position;
 		Vec3 iEnd = iStart + (player_iForward * 1.f);
-		DebugAddWorldArrow(iStart, iEnd, radius, duration, Rgba8::RED, Rgba8::RED, mode);
+		m_debugPrimitives.AddWorldArrow(iStart, iEnd, radius, duration, Rgba8::RED, Rgba8::RED);
 		// j
 		Vec3 jStart = m_player->m_position;
 		Vec3 jEnd = jStart + (player_jLeft * 1.f);
-		DebugAddWorldArrow(jStart, jEnd, radius, duration, Rgba8::GREEN, Rgba8::GREEN, mode);
+		m_debugPrimitives.AddWorldArrow(jStart, jEnd, radius, duration, Rgba8::GREEN, Rgba8::GREEN);
 		// k
 		Vec3 kStart = m_player->m_position;
 		Vec3 kEnd = kStart + (player_kUp * 1.f);
-		DebugAddWorldArrow(kStart, kEnd, radius, duration, Rgba8::BLUE, Rgba8::BLUE, mode); 
+		m_debugPrimitives.AddWorldArrow(kStart, kEnd, radius, duration, Rgba8::BLUE, Rgba8::BLUE);
 	}
 
 	// billboard camera opposing text
@@ -329,8 +536,7 @@ void Game::AddDebugRenderObjects()
 		float duration = 10.f;
 		Rgba8 startColor = Rgba8::WHITE;
 		Rgba8 endColor = Rgba8::RED;
-		DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-		DebugAddWorldWireCylinder(start, end, radius, duration, startColor, endColor, mode);
+		m_debugPrimitives.AddWorldWireCylinder(start, end, radius, duration, startColor, endColor);
 	}
 
 	// point on x-y plane
@@ -342,8 +548,13 @@ void Game::AddDebugRenderObjects()
 		float duration = 60.f;
 		Rgba8 startColor = Rgba8(150, 45, 0);
 		Rgba8 endColor = Rgba8(150, 45, 0);
-		DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-		DebugAddWorldPoint(position, radius, duration, startColor, endColor, mode);
+		m_debugPrimitives.AddWorldPoint(position, radius, duration, startColor, endColor);
+	}
+
+	// stress test: burst of points around the player
+	if (g_theInput->IsKeyDown('8'))
+	{
+		AddDebugPointBurst();
 	}
 
 	// camera orientation screen text
@@ -380,6 +591,157 @@ void Game::AddDebugRenderObjects()
 	float scale = m_GameClock->GetTimeScale();
 	std::string timeValuesStr = Stringf("Time: %.2f, FPS: %.1f, Scale: %.2f", totalSeconds, fps, scale);
 	DebugAddScreenText(timeValuesStr, topRightLinePosition, fontSize, topRightAlignment, duration);
+
+	// sampled after the message pump to submitted, for frames that used input
+	InputLatencyStats const& latencyStats = g_inputQueue->GetLatencyStats();
+	std::string latencyStr = Stringf("Input Latency: p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms over %d frames",
+		latencyStats.m_p50Ms, latencyStats.m_p95Ms, latencyStats.m_p99Ms, latencyStats.m_maxMs, latencyStats.m_numSamples);
+	AddDebugHudLine(latencyStr);
+
+	FramePacerStats const& pacerStats = g_theApp->GetFramePacerStats();
+	std::string pacingStr = Stringf("Frame Pacing: target %.0f fps, %.2f ms average, %.2f ms jitter, %d missed, sleep %.2f ms, spin %.2f ms (margin %.2f)",
+		pacerStats.m_targetFps, pacerStats.m_averageFrameMs, pacerStats.m_jitterMs, pacerStats.m_numMissedDeadlines,
+		pacerStats.m_averageSleepMs, pacerStats.m_averageSpinMs, pacerStats.m_spinMarginMs);
+	AddDebugHudLine(pacingStr);
+
+	if (m_crowd.GetNumAgents() > 0)
+	{
+		AddCrowdStatsHudText();
+	}
+
+	// debug view (f1) stats
+	if (m_showDebugView)
+	{
+		AddMemoryStatsHudText();
+		AddRenderStatsHudText();
+		AddPhysicsStatsHudText();
+	}
+}
+
+
+//----------------------------------------------------------------------------------------------------------
+void Game::AddDebugPointBurst()
+{
+	Vec3 center = m_player->m_position;
+	center.z = 0.f;
+	float spread = 20.f;
+	float radius = 0.05f;
+	float duration = 10.f;
+
+	// cheap deterministic scatter; quality does not matter here
+	static unsigned int s_seed = 1u;
+	for (int pointIndex = 0; pointIndex < NUM_POINTS_PER_DEBUG_BURST; pointIndex++)
+	{
+		s_seed = s_seed * 1664525u + 1013904223u;
+		float x = RangeMap((float)(s_seed >> 16 & 0xffff), 0.f, 65535.f, -spread, spread);
+		s_seed = s_seed * 1664525u + 1013904223u;
+		float y = RangeMap((float)(s_seed >> 16 & 0xffff), 0.f, 65535.f, -spread, spread);
+		m_debugPrimitives.AddWorldPoint(center + Vec3(x, y, 0.f), radius, duration, Rgba8::YELLOW, Rgba8::RED);
+	}
+}
+
+
+//----------------------------------------------------------------------------------------------------------
+// stacks one-frame text lines under the player position text
+void Game::AddDebugHudLine(std::string const& text)
+{
+	float fontSize = 15.f;
+	AABB2 cameraBounds(m_screenCamera.GetOrthographicBottomLeft(), m_screenCamera.GetOrthographicTopRight());
+	m_numDebugHudLines++;
+
+	Vec2 linePosition(cameraBounds.m_mins.x, cameraBounds.m_maxs.y - fontSize * (float)(m_numDebugHudLines + 1));
+	Vec2 topLeftAlignment = Vec2(0.f, 1.f);
+	float duration = 0.f;	// one frame
+	DebugAddScreenText(text, linePosition, fontSize, topLeftAlignment, duration);
+}
+
+
+//----------------------------------------------------------------------------------------------------------
+void Game::AddMemoryStatsHudText()
+{
+	MemoryArenaStats arenaStats = m_entityArena.GetStats();
+	std::string arenaStr = Stringf("Entity Arena: %d allocs, %d heap blocks, %.1f / %.1f KB used, fragmentation %.1f%%",
+		arenaStats.m_numAllocations, arenaStats.m_numHeapAllocations,
+		(float)arenaStats.m_bytesUsed / 1024.f, (float)arenaStats.m_bytesReserved / 1024.f,
+		arenaStats.GetFragmentation() * 100.f);
+	AddDebugHudLine(arenaStr);
+
+	std::string entityStr = Stringf("Entities: %d players, %d props, %d transforms updated", m_players.GetCount(), m_props.GetCount(), m_numTransformsUpdated);
+	AddDebugHudLine(entityStr);
+
+	FrameMemoryStats const& frameStats = GetFrameMemoryStatsLastFrame();
+	std::string frameStr = Stringf("Last Frame: %d heap allocs (%d in grid lines), scratch %d allocs / %.1f KB in %d blocks",
+		frameStats.m_numHeapAllocations, m_numGridLineHeapAllocations,
+		frameStats.m_arenaStats.m_numAllocations, (float)frameStats.m_arenaStats.m_bytesUsed / 1024.f, frameStats.m_arenaStats.m_numBlocks);
+	AddDebugHudLine(frameStr);
+}
+
+
+//----------------------------------------------------------------------------------------------------------
+void Game::AddRenderStatsHudText()
+{
+	VertexStreamStats const& streamStats = g_vertexStream->GetStatsLastFrame();
+	std::string streamStr = Stringf("Vertex Stream: %.1f KB streamed, %d uploads, %d draws, %d verts",
+		(float)streamStats.m_numBytesStreamed / 1024.f, streamStats.m_numUploads, streamStats.m_numDraws, streamStats.m_numVertexes);
+	AddDebugHudLine(streamStr);
+
+	std::string debugPrimitivesStr = Stringf("Debug Primitives: %d live, %d dropped, %d draws",
+		m_debugPrimitives.GetNumLivePrimitives(), m_debugPrimitives.GetNumDroppedPrimitives(), m_debugPrimitives.GetNumDrawsLastFrame());
+	AddDebugHudLine(debugPrimitivesStr);
+
+	std::string debugLinesStr = Stringf("Debug Lines: %d lines, %d draws", g_debugLines->GetNumLines(), g_debugLines->GetNumDrawsLastFrame());
+	AddDebugHudLine(debugLinesStr);
+
+	ParticleSystemStats const& particleStats = m_particles.GetStats();
+	std::string particlesStr = Stringf("Particles: %d / %d live, %d emitted, %d expired, %d dropped, update %.2f ms, %d draws",
+		particleStats.m_numLive, particleStats.m_capacity, particleStats.m_numEmitted, particleStats.m_numExpired, particleStats.m_numDropped,
+		particleStats.m_updateMs, m_particles.GetNumDrawsLastFrame());
+	AddDebugHudLine(particlesStr);
+}
+
+
+//----------------------------------------------------------------------------------------------------------
+void Game::AddCrowdStatsHudText()
+{
+	CrowdStats const& crowdStats = m_crowd.GetStats();
+	std::string crowdStr = Stringf("Crowd: %d agents on %d threads, %d skinned, update %.2f ms", crowdStats.m_numAgents, crowdStats.m_numThreads, crowdStats.m_numSkinned, crowdStats.GetUpdateMs());
+	AddDebugHudLine(crowdStr);
+
+	std::string phasesStr = "Crowd Phases:";
+	for (int phaseIndex = 0; phaseIndex < NUM_CROWD_PHASES; phaseIndex++)
+	{
+		phasesStr += Stringf(" %s %.2f ms", GetCrowdPhaseName((CrowdPhase)phaseIndex), crowdStats.m_phaseMs[phaseIndex]);
+	}
+	AddDebugHudLine(phasesStr);
+
+	AnimationLodStats const& lodStats = crowdStats.m_animationStats;
+	std::string lodStr = Stringf("Crowd Animation: LODs %d/%d/%d/%d, %d evaluated, %d interpolated, %d deferred",
+		lodStats.m_numCharactersPerLod[0], lodStats.m_numCharactersPerLod[1], lodStats.m_numCharactersPerLod[2], lodStats.m_numCharactersPerLod[3],
+		lodStats.m_numUpdated, lodStats.m_numInterpolated, lodStats.m_numDeferred);
+	AddDebugHudLine(lodStr);
+
+	NavigationStats const& navigationStats = m_navigationGrid.GetStats();
+	std::string navigationStr = Stringf("Navigation: %d obstacles, %d blocked cells, %d flow fields, %d built, %d repaired (%d cells), %.2f ms",
+		navigationStats.m_numObstacles, navigationStats.m_numBlockedCells, navigationStats.m_numFlowFields, navigationStats.m_numFieldsBuilt,
+		navigationStats.m_numFieldsRepaired, navigationStats.m_numCellsRepaired, navigationStats.m_updateMs);
+	AddDebugHudLine(navigationStr);
+}
+
+
+//----------------------------------------------------------------------------------------------------------
+void Game::AddPhysicsStatsHudText()
+{
+	PropPhysicsStats const& physicsStats = m_propPhysics.GetStats();
+	std::string physicsStr = Stringf("Prop Physics: %d bodies, %d awake, %d sleeping islands, %d pairs, %d contacts, step %.2f ms",
+		physicsStats.m_numBodies, physicsStats.m_numAwake, physicsStats.m_numSleepingIslands, physicsStats.m_numPairs, physicsStats.m_numContacts, physicsStats.GetStepMs());
+	AddDebugHudLine(physicsStr);
+
+	std::string phasesStr = "Prop Physics Phases:";
+	for (int phaseIndex = 0; phaseIndex < NUM_PROP_PHYSICS_PHASES; phaseIndex++)
+	{
+		phasesStr += Stringf(" %s %.2f ms", GetPropPhysicsPhaseName((PropPhysicsPhase)phaseIndex), physicsStats.m_phaseMs[phaseIndex]);
+	}
+	AddDebugHudLine(phasesStr);
 }
 
 
@@ -390,26 +752,34 @@ void Game::Render() const
 	// world camera (for entities)
 	g_theRenderer->BeginCamera(*m_player->m_worldCamera);
 	
+	ScopedHeapAllocationCounter gridLineAllocations;
 	RenderGridLines();
+	m_numGridLineHeapAllocations = gridLineAllocations.GetCount();
 
 	// Render all entities
-	for (int index = 0; index < m_entities.size(); index++)
-	{
-		Entity* entity = m_entities[index];
-		if (entity != nullptr)
-		{
-			entity->Render();
-		}
-	}
-
-	DebugRenderWorld(*m_player->m_worldCamera);
+	m_players.ForEach([](Player const& player) { player.Render(); });
+	m_props.ForEach([](Prop const& prop) { prop.Render(); });
+	m_crowd.Render();
 
 	RenderMovingPoint();
 
+	// camera-facing, so built after the camera has moved
+	Vec3 cameraForward;
+	Vec3 cameraLeft;
+	Vec3 cameraUp;
+	m_player->m_springArm.GetCameraOrientation().GetAsVectors_XFwd_YLeft_ZUp(cameraForward, cameraLeft, cameraUp);
+	m_particles.Render(cameraLeft, cameraUp);
+
+	// transient world geometry goes up in one upload
+	g_vertexStream->Flush();
+	m_debugPrimitives.Render();
+
+	DebugRenderWorld(*m_player->m_worldCamera);
+
 	// screen camera (for HUD / UI)
 	g_theRenderer->BeginCamera(m_screenCamera);
 	// add text / UI code here
-
+	g_debugLines->Render();
 	
 	DebugRenderScreen(m_screenCamera);
 
@@ -420,7 +790,7 @@ void Game::Render() const
 void Game::RenderColorChangingTriangle() const
 {
 	// create verts
-	Vertex_PCU* verts = new Vertex_PCU[MAX_VERTEXAS];
+	Vertex_PCU verts[MAX_VERTEXAS];
 	verts[0].m_position = Vec3(1.f, 0.f, 0.f);
 	verts[1].m_position = Vec3(-1.f, 1.f, 0.f);
 	verts[2].m_position = Vec3(-1.f, -1.f, 0.f);
@@ -439,7 +809,6 @@ void Game::RenderColorChangingTriangle() const
 	// render
 	g_theRenderer->BindTexture(nullptr);
 	g_theRenderer->DrawVertexArray(MAX_VERTEXAS, verts);
-	delete[] verts;
 }
 
 float Game::RangeMapX(float value) const
@@ -469,7 +838,7 @@ void Game::RenderTestTriangle() const
 
 void Game::RenderGridLines() const
 {
-	std::vector<Vertex_PCU> verts;
+	VertexSpanWriter verts = g_vertexStream->Allocate(NUM_GRID_LINES * AABB3_NUM_VERTEXES);
 
 	// axis lines
 	/*AABB3 xOriginPipe(Vec3(0.f, 0.f, 0.f), Vec3(1.f, 0.1f, 0.1f));
@@ -536,8 +905,7 @@ void Game::RenderGridLines() const
 	/*AABB3 zOriginPipeLong(Vec3(0.f, 0.f, 0.f), Vec3(0.42f, 0.42f, halfLength));
 	AddVertsForAABB3D(verts, zOriginPipeLong, Rgba8(0, 0, 200, 175));*/
 
-	g_theRenderer->BindTexture(nullptr);
-	g_theRenderer->DrawVertexArray((int)verts.size(), verts.data());
+	g_vertexStream->Draw(verts);
 }
 
 void Game::EndFrame()
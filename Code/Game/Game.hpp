@@ -1,6 +1,17 @@
 #pragma once
 
 #include "Game/GameCommon.hpp"
+#include "Game/MemoryArena.hpp"
+#include "Game/CharacterController.hpp"
+#include "Game/Crowd.hpp"
+#include "Game/DebugPrimitiveBatcher.hpp"
+#include "Game/LocomotionAnimations.hpp"
+#include "Game/NavigationGrid.hpp"
+#include "Game/ParticleSystem.hpp"
+#include "Game/PropBroadphase.hpp"
+#include "Game/PropPhysics.hpp"
+#include "Game/SimdMath.hpp"
+#include "Game/WorkerThreadPool.hpp"
 #include "Engine/Math/Vec2.hpp"
 
 
@@ -21,6 +32,7 @@ private:
 
 public:
 	Game(App* g_app, bool showDebugView = false);
+	~Game();
 	void Startup();
 	void Shutdown();
 	
@@ -31,6 +43,15 @@ public:
 
 	bool IsDubugViewOn();
 
+	PropBroadphase const& GetPropBroadphase() const { return m_propBroadphase; }
+	CharacterController& GetCharacterController() { return m_characterController; }
+	LocomotionAnimations const& GetLocomotionAnimations() const { return m_locomotionAnimations; }
+	ParticleSystem& GetParticles() { return m_particles; }
+
+	void SetCrowdSize(int numAgents) { m_crowd.SetNumAgents(numAgents); }
+	void SetCrowdGoal(Vec2 const& goal) { m_crowd.SetSharedGoal(goal); }
+	void ClearCrowdGoal() { m_crowd.ClearSharedGoal(); }
+
 	Camera m_screenCamera;
 
 	//Rgba8 m_backGroundColor = Rgba8(139, 191, 124);
@@ -45,6 +66,11 @@ protected:
 
 	Clock* m_GameClock = nullptr;
 
+	// entities and their meshes live in the arena; pools keep each type contiguous
+	MemoryArena m_entityArena;
+	EntityPool<Player> m_players;
+	EntityPool<Prop> m_props;
+
 	void CreateScene();
 	Player* m_player = nullptr;
 	Prop* m_cubeProp = nullptr;
@@ -54,17 +80,57 @@ protected:
 	Prop* m_sphereProp = nullptr;
 	void AddVertsForSphereProp(Prop& prop);
 
+	Vertex_PCU const* m_cubeVertexes = nullptr;
+	int m_numCubeVertexes = 0;
+	Vertex_PCU const* m_sphereVertexes = nullptr;
+	int m_numSphereVertexes = 0;
+
 	/*Prop* m_cylinderProp = nullptr;
 	void AddVertsForCylinderProp(Prop& prop);*/
 
 	void RenderGridLines() const;
 
-	std::vector<Entity*> m_entities;
+	PropBroadphase m_propBroadphase;
+	CharacterController m_characterController;
+	LocomotionAnimations m_locomotionAnimations;
+	void RebuildPropBroadphase();
+	std::vector<int> m_broadphaseUpdateIndexes;		// scratch, kept for its capacity
+	std::vector<Vec3> m_broadphaseUpdateCenters;
+	std::vector<float> m_broadphaseUpdateRadii;
+
+	WorkerThreadPool m_workerPool;
+	NavigationGrid m_navigationGrid;
+	Crowd m_crowd;
+	void SyncNavigationObstacles();
+	void AddCrowdStatsHudText();
+
+	PropPhysics m_propPhysics;
+	std::vector<Prop*> m_physicsProps;		// by body index
+	void AddPhysicsBody(Prop& prop, float mass);
+	void AddPhysicsSpherePyramid(Vec3 const& baseCorner, int numPerSide);
+	void ThrowPhysicsBall();
+	void UpdatePropPhysics(float deltaSeconds);
+	void AddPhysicsStatsHudText();
+
+	ParticleSystem m_particles;
 
 	void UpdateGameState();
 	void UpdateCubePropColor();
 	void UpdateAllEnteties();
+	void UpdateEntityTransforms();
+	int m_numTransformsUpdated = 0;
+	std::vector<Entity const*> m_transformBatchEntities;
+	std::vector<EulerAngles> m_transformBatchOrientations;
+	std::vector<Vec3> m_transformBatchPositions;
+	std::vector<SimdMat44> m_transformBatchMatrices;
 	void AddDebugRenderObjects();
+	void AddDebugPointBurst();
+	DebugPrimitiveBatcher m_debugPrimitives;
+	void AddDebugHudLine(std::string const& text);
+	void AddMemoryStatsHudText();
+	void AddRenderStatsHudText();
+	mutable int m_numGridLineHeapAllocations = 0;
+	int m_numDebugHudLines = 0;
 
 	void AddBasisAtOrigin();
 
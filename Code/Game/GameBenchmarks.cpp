@@ -0,0 +1,1550 @@
+#include "Game/GameBenchmarks.hpp"
+#include "Game/AnimationLod.hpp"
+#include "Game/CharacterController.hpp"
+#include "Game/Crowd.hpp"
+#include "Game/DebugLineBatch.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/HeapAllocationCounter.hpp"
+#include "Game/LocomotionAnimations.hpp"
+#include "Game/MotionDatabase.hpp"
+#include "Game/NavigationGrid.hpp"
+#include "Game/ParticleSystem.hpp"
+#include "Game/Prop.hpp"
+#include "Game/PropBroadphase.hpp"
+#include "Game/PropPhysics.hpp"
+#include "Game/SimdMath.hpp"
+#include "Game/SkinnedMesh.hpp"
+#include "Game/SpringArmCamera.hpp"
+#include "Game/VertexSpanUtils.hpp"
+#include "Game/VertexStream.hpp"
+#include "Game/WorkerThreadPool.hpp"
+
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <math.h>
+#include <vector>
+
+
+constexpr float SPRING_ARM_BUDGET_MS = 0.05f;
+constexpr int NUM_SKINNING_BENCHMARK_POSES = 64;
+constexpr int PHYSICS_BENCHMARK_PYRAMID_BASE = 3;			// 3x3 static, 2x2 and 1 spheres
+constexpr int PHYSICS_BENCHMARK_BODIES_PER_PYRAMID = 14;
+constexpr float PHYSICS_BENCHMARK_RADIUS = 0.5f;
+constexpr float PHYSICS_BENCHMARK_DROP_HEIGHT = 0.25f;
+constexpr float PHYSICS_BENCHMARK_PYRAMID_GAP = 1.f;
+constexpr int PHYSICS_BENCHMARK_SETTLED_FRAMES = 60;		// averaged just before the throws
+constexpr int PARTICLE_BENCHMARK_BURST_SIZE = 32;			// about a footstep's dust
+constexpr float PARTICLE_BENCHMARK_MIN_LIFETIME = 1.5f;
+constexpr float PARTICLE_BENCHMARK_MAX_LIFETIME = 2.5f;
+
+
+//-----------------------------------------------------------------------------------------------
+// small deterministic generator so runs are comparable between builds
+//
+struct BenchmarkRandom
+{
+	unsigned int m_state = 12345u;
+
+	float GetZeroToOne()
+	{
+		m_state = m_state * 1664525u + 1013904223u;
+		return static_cast<float>(m_state >> 8) / 16777216.f;
+	}
+
+	float GetInRange(float minValue, float maxValue)
+	{
+		return minValue + (maxValue - minValue) * GetZeroToOne();
+	}
+};
+
+
+//-----------------------------------------------------------------------------------------------
+void RegisterGameBenchmarkCommands()
+{
+	g_theEventSystem->SubscribeToEvent("BenchmarkSpringArm", Command_BenchmarkSpringArm);
+	g_theEventSystem->SubscribeToEvent("BenchmarkCharacters", Command_BenchmarkCharacters);
+	g_theEventSystem->SubscribeToEvent("BenchmarkAnimation", Command_BenchmarkAnimation);
+	g_theEventSystem->SubscribeToEvent("BenchmarkBlendSpace", Command_BenchmarkBlendSpace);
+	g_theEventSystem->SubscribeToEvent("BenchmarkMotionMatching", Command_BenchmarkMotionMatching);
+	g_theEventSystem->SubscribeToEvent("BenchmarkAnimationLod", Command_BenchmarkAnimationLod);
+	g_theEventSystem->SubscribeToEvent("BenchmarkSkinning", Command_BenchmarkSkinning);
+	g_theEventSystem->SubscribeToEvent("BenchmarkCrowd", Command_BenchmarkCrowd);
+	g_theEventSystem->SubscribeToEvent("BenchmarkFlowField", Command_BenchmarkFlowField);
+	g_theEventSystem->SubscribeToEvent("BenchmarkSimdMath", Command_BenchmarkSimdMath);
+	g_theEventSystem->SubscribeToEvent("BenchmarkPropOrientation", Command_BenchmarkPropOrientation);
+	g_theEventSystem->SubscribeToEvent("BenchmarkRings", Command_BenchmarkRings);
+	g_theEventSystem->SubscribeToEvent("BenchmarkDebugLines", Command_BenchmarkDebugLines);
+	g_theEventSystem->SubscribeToEvent("BenchmarkPhysics", Command_BenchmarkPhysics);
+	g_theEventSystem->SubscribeToEvent("BenchmarkParticles", Command_BenchmarkParticles);
+}
+
+void UnregisterGameBenchmarkCommands()
+{
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkSpringArm", Command_BenchmarkSpringArm);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkCharacters", Command_BenchmarkCharacters);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkAnimation", Command_BenchmarkAnimation);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkBlendSpace", Command_BenchmarkBlendSpace);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkMotionMatching", Command_BenchmarkMotionMatching);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkAnimationLod", Command_BenchmarkAnimationLod);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkSkinning", Command_BenchmarkSkinning);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkCrowd", Command_BenchmarkCrowd);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkFlowField", Command_BenchmarkFlowField);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkSimdMath", Command_BenchmarkSimdMath);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkPropOrientation", Command_BenchmarkPropOrientation);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkRings", Command_BenchmarkRings);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkDebugLines", Command_BenchmarkDebugLines);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkPhysics", Command_BenchmarkPhysics);
+	g_theEventSystem->UnsubscribeFromEvent("BenchmarkParticles", Command_BenchmarkParticles);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkSpringArm props=100000 frames=10000
+// Scatters props around a target walking a circle, then times one camera update per frame.
+//
+bool Command_BenchmarkSpringArm(EventArgs& args)
+{
+	int numProps = args.GetValue("props", 100000);
+	int numFrames = args.GetValue("frames", 10000);
+	if (numProps < 1 || numFrames < 1)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkSpringArm: props and frames must be positive");
+		return false;
+	}
+
+	// keep density roughly constant (one prop per 4 square meters) no matter the count
+	float halfExtent = 0.5f * sqrtf(4.f * static_cast<float>(numProps));
+	BenchmarkRandom random;
+	std::vector<Vec3> centers(numProps);
+	std::vector<float> radii(numProps);
+	for (int propIndex = 0; propIndex < numProps; propIndex++)
+	{
+		centers[propIndex] = Vec3(random.GetInRange(-halfExtent, halfExtent), random.GetInRange(-halfExtent, halfExtent), random.GetInRange(0.f, 3.f));
+		radii[propIndex] = random.GetInRange(0.3f, 1.f);
+	}
+
+	PropBroadphase broadphase;
+	double buildStartSeconds = GetCurrentTimeSeconds();
+	broadphase.Build(centers.data(), radii.data(), numProps);
+	double buildSeconds = GetCurrentTimeSeconds() - buildStartSeconds;
+
+	SpringArmConfig config;
+	SpringArmCamera springArm(config);
+	float const deltaSeconds = 1.f / 60.f;
+	float const walkRadius = 0.5f * halfExtent;
+	double totalSeconds = 0.0;
+	double worstSeconds = 0.0;
+	int numBlockedFrames = 0;
+	for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+	{
+		float walkDegrees = 360.f * static_cast<float>(frameIndex) / static_cast<float>(numFrames);
+		Vec3 target(walkRadius * CosDegrees(walkDegrees), walkRadius * SinDegrees(walkDegrees), 1.f);
+		EulerAngles view(walkDegrees + 90.f, 15.f * SinDegrees(4.f * walkDegrees), 0.f);
+
+		double frameStartSeconds = GetCurrentTimeSeconds();
+		springArm.Update(target, view, deltaSeconds, broadphase);
+		double frameSeconds = GetCurrentTimeSeconds() - frameStartSeconds;
+
+		totalSeconds += frameSeconds;
+		worstSeconds = frameSeconds > worstSeconds ? frameSeconds : worstSeconds;
+		if (springArm.GetCurrentArmLength() < config.m_armLength - 0.01f)
+		{
+			numBlockedFrames++;
+		}
+	}
+
+	float averageMs = static_cast<float>(1000.0 * totalSeconds / static_cast<double>(numFrames));
+	Rgba8 resultColor = averageMs <= SPRING_ARM_BUDGET_MS ? DevConsole::INFO_MAJOR_COLOR : DevConsole::WARNING_COLOR;
+	g_theDevConsole->AddLine(resultColor, Stringf("Spring arm: %d props, %d frames, avg %.4f ms, worst %.4f ms (budget %.2f ms)",
+		numProps, numFrames, averageMs, 1000.0 * worstSeconds, SPRING_ARM_BUDGET_MS));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  broadphase build %.2f ms, arm blocked on %d frames",
+		1000.0 * buildSeconds, numBlockedFrames));
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkCharacters characters=500 props=10000 frames=600
+// Characters wander through a prop field under gravity; every frame is one batched controller call.
+//
+bool Command_BenchmarkCharacters(EventArgs& args)
+{
+	int numCharacters = args.GetValue("characters", 500);
+	int numProps = args.GetValue("props", 10000);
+	int numFrames = args.GetValue("frames", 600);
+	if (numCharacters < 1 || numProps < 1 || numFrames < 1)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkCharacters: characters, props and frames must be positive");
+		return false;
+	}
+
+	float halfExtent = 0.5f * sqrtf(4.f * static_cast<float>(numProps));
+	BenchmarkRandom random;
+	std::vector<Vec3> centers(numProps);
+	std::vector<float> radii(numProps);
+	for (int propIndex = 0; propIndex < numProps; propIndex++)
+	{
+		radii[propIndex] = random.GetInRange(0.2f, 1.f);
+		centers[propIndex] = Vec3(random.GetInRange(-halfExtent, halfExtent), random.GetInRange(-halfExtent, halfExtent), random.GetInRange(-0.5f, 1.f) * radii[propIndex]);
+	}
+
+	PropBroadphase broadphase;
+	broadphase.Build(centers.data(), radii.data(), numProps);
+
+	CharacterController controller;
+	std::vector<CharacterMotion> characters(numCharacters);
+	for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+	{
+		CharacterMotion& character = characters[characterIndex];
+		character.m_position = Vec3(random.GetInRange(-halfExtent, halfExtent), random.GetInRange(-halfExtent, halfExtent), 2.f);
+		float headingDegrees = random.GetInRange(0.f, 360.f);
+		character.m_velocity = Vec3(4.f * CosDegrees(headingDegrees), 4.f * SinDegrees(headingDegrees), 0.f);
+	}
+
+	float const deltaSeconds = 1.f / 60.f;
+	double totalSeconds = 0.0;
+	double worstSeconds = 0.0;
+	for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+	{
+		for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+		{
+			characters[characterIndex].m_velocity.z -= 9.8f * deltaSeconds;
+		}
+
+		double frameStartSeconds = GetCurrentTimeSeconds();
+		controller.MoveCharacters(characters.data(), numCharacters, deltaSeconds, broadphase);
+		double frameSeconds = GetCurrentTimeSeconds() - frameStartSeconds;
+
+		totalSeconds += frameSeconds;
+		worstSeconds = frameSeconds > worstSeconds ? frameSeconds : worstSeconds;
+	}
+
+	int numGrounded = 0;
+	for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+	{
+		numGrounded += characters[characterIndex].m_isGrounded ? 1 : 0;
+	}
+
+	double averageMs = 1000.0 * totalSeconds / static_cast<double>(numFrames);
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Characters: %d characters, %d props, %d frames, avg %.3f ms per batch (%.4f ms each), worst %.3f ms",
+		numCharacters, numProps, numFrames, averageMs, averageMs / static_cast<double>(numCharacters), 1000.0 * worstSeconds));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %d of %d grounded at the end", numGrounded, numCharacters));
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkAnimation characters=1000 frames=100
+// Per character: sample two compressed clips, blend them, then one batched local-to-model pass.
+//
+bool Command_BenchmarkAnimation(EventArgs& args)
+{
+	int numCharacters = args.GetValue("characters", 1000);
+	int numFrames = args.GetValue("frames", 100);
+	if (numCharacters < 1 || numFrames < 1)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkAnimation: characters and frames must be positive");
+		return false;
+	}
+
+	LocomotionAnimations animations;
+	CreateLocomotionAnimations(animations, MOVEMENT_SPEED, MOVEMENT_SPEED * FAST_MOVEMENT_MULTIPLIER);
+	AnimationClip const& walk = animations.m_clips[LOCOMOTION_CLIP_WALK_FORWARD];
+	AnimationClip const& run = animations.m_clips[LOCOMOTION_CLIP_RUN_FORWARD];
+	int numBones = animations.m_skeleton.GetNumBones();
+
+	std::vector<SkeletonPose> walkPoses(numCharacters, SkeletonPose(numBones));
+	std::vector<SkeletonPose> runPoses(numCharacters, SkeletonPose(numBones));
+	std::vector<SkeletonPose> blendedPoses(numCharacters, SkeletonPose(numBones));
+	std::vector<SkeletonPose const*> posePointers(numCharacters);
+	std::vector<BoneMatrix> modelTransforms(numCharacters * numBones);
+	BenchmarkRandom random;
+	std::vector<float> phases(numCharacters);
+	std::vector<float> weights(numCharacters);
+	for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+	{
+		posePointers[characterIndex] = &blendedPoses[characterIndex];
+		phases[characterIndex] = random.GetZeroToOne();
+		weights[characterIndex] = random.GetZeroToOne();
+	}
+
+	float const deltaSeconds = 1.f / 60.f;
+	double totalSeconds = 0.0;
+	for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+	{
+		double frameStartSeconds = GetCurrentTimeSeconds();
+		for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+		{
+			float& phase = phases[characterIndex];
+			phase += deltaSeconds;
+			phase -= floorf(phase);
+			walk.Sample(phase * walk.GetDuration(), walkPoses[characterIndex]);
+			run.Sample(phase * run.GetDuration(), runPoses[characterIndex]);
+			BlendPoses(walkPoses[characterIndex], runPoses[characterIndex], weights[characterIndex], blendedPoses[characterIndex]);
+		}
+		ComputeModelTransformsBatch(animations.m_skeleton, posePointers.data(), numCharacters, modelTransforms.data());
+		totalSeconds += GetCurrentTimeSeconds() - frameStartSeconds;
+	}
+
+	double averageMs = 1000.0 * totalSeconds / static_cast<double>(numFrames);
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Animation: %d characters x %d bones, avg %.3f ms per frame, %.0f characters per ms",
+		numCharacters, numBones, averageMs, static_cast<double>(numCharacters) / averageMs));
+
+	size_t compressedBytes = 0;
+	size_t rawBytes = 0;
+	float maxError = 0.f;
+	for (int clipIndex = 0; clipIndex < NUM_LOCOMOTION_CLIPS; clipIndex++)
+	{
+		AnimationClip const& clip = animations.m_clips[clipIndex];
+		compressedBytes += clip.GetCompressedBytes();
+		rawBytes += clip.GetRawBytes();
+		maxError = clip.GetMaxError() > maxError ? clip.GetMaxError() : maxError;
+	}
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  clips %zu bytes compressed from %zu raw (%.1fx), max error %.4f",
+		compressedBytes, rawBytes, static_cast<double>(rawBytes) / static_cast<double>(compressedBytes), maxError));
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkBlendSpace characters=5000 frames=100
+// Every character steers its velocity around the locomotion blend space and evaluates a pose.
+//
+bool Command_BenchmarkBlendSpace(EventArgs& args)
+{
+	int numCharacters = args.GetValue("characters", 5000);
+	int numFrames = args.GetValue("frames", 100);
+	if (numCharacters < 1 || numFrames < 1)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkBlendSpace: characters and frames must be positive");
+		return false;
+	}
+
+	float sprintSpeed = MOVEMENT_SPEED * FAST_MOVEMENT_MULTIPLIER;
+	LocomotionAnimations animations;
+	CreateLocomotionAnimations(animations, MOVEMENT_SPEED, sprintSpeed);
+	int numBones = animations.m_skeleton.GetNumBones();
+
+	std::vector<BlendSpaceState> states(numCharacters);
+	std::vector<SkeletonPose> scratchPoses(numCharacters, SkeletonPose(numBones));
+	std::vector<SkeletonPose> poses(numCharacters, SkeletonPose(numBones));
+	std::vector<float> headings(numCharacters);
+	std::vector<float> speeds(numCharacters);
+	BenchmarkRandom random;
+	for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+	{
+		headings[characterIndex] = random.GetInRange(0.f, 360.f);
+		speeds[characterIndex] = random.GetInRange(0.f, 1.f) < 0.2f ? random.GetInRange(MOVEMENT_SPEED, sprintSpeed) : random.GetInRange(0.f, MOVEMENT_SPEED);
+	}
+
+	float const deltaSeconds = 1.f / 60.f;
+	double totalSeconds = 0.0;
+	long long numClipsSampled = 0;
+	for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+	{
+		double frameStartSeconds = GetCurrentTimeSeconds();
+		for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+		{
+			float& heading = headings[characterIndex];
+			heading += 30.f * deltaSeconds;
+			Vec2 localVelocity(speeds[characterIndex] * CosDegrees(heading), speeds[characterIndex] * SinDegrees(heading));
+			animations.m_blendSpace.EvaluatePose(localVelocity, deltaSeconds, animations.m_clips, states[characterIndex], scratchPoses[characterIndex], poses[characterIndex]);
+			numClipsSampled += states[characterIndex].m_numClipsSampled;
+		}
+		totalSeconds += GetCurrentTimeSeconds() - frameStartSeconds;
+	}
+
+	double averageMs = 1000.0 * totalSeconds / static_cast<double>(numFrames);
+	double clipsPerCharacter = static_cast<double>(numClipsSampled) / (static_cast<double>(numCharacters) * static_cast<double>(numFrames));
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Blend space: %d characters, avg %.3f ms per frame (%.2f us each)",
+		numCharacters, averageMs, 1000.0 * averageMs / static_cast<double>(numCharacters)));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %d samples in %d triangles, %.2f of %d clips sampled per character",
+		animations.m_blendSpace.GetNumSamples(), animations.m_blendSpace.GetNumTriangles(), clipsPerCharacter, NUM_LOCOMOTION_CLIPS));
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkMotionMatching characters=1000 rates=16 tolerance=0 interval=0.1 frames=60
+// rates sets the database size (playback rate variants per clip), tolerance and interval are the
+// quality vs speed knobs. Searches are checked against brute force, then characters are animated.
+//
+bool Command_BenchmarkMotionMatching(EventArgs& args)
+{
+	int numCharacters = args.GetValue("characters", 1000);
+	int numRates = args.GetValue("rates", 16);
+	int numFrames = args.GetValue("frames", 60);
+	MotionMatchingSettings settings;
+	settings.m_searchTolerance = args.GetValue("tolerance", 0.f);
+	settings.m_searchInterval = args.GetValue("interval", settings.m_searchInterval);
+	if (numCharacters < 1 || numRates < 1 || numFrames < 1 || settings.m_searchTolerance < 0.f)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkMotionMatching: characters, rates and frames must be positive, tolerance not negative");
+		return false;
+	}
+
+	float sprintSpeed = MOVEMENT_SPEED * FAST_MOVEMENT_MULTIPLIER;
+	LocomotionAnimations animations;
+	CreateLocomotionAnimations(animations, MOVEMENT_SPEED, sprintSpeed);
+
+	std::vector<float> playbackRates(numRates);
+	for (int rateIndex = 0; rateIndex < numRates; rateIndex++)
+	{
+		playbackRates[rateIndex] = numRates == 1 ? 1.f : RangeMap(static_cast<float>(rateIndex), 0.f, static_cast<float>(numRates - 1), 0.5f, 2.f);
+	}
+	MotionDatabase database;
+	BuildLocomotionMotionDatabase(animations, playbackRates.data(), numRates, database);
+
+	// one query per character: some heading, some speed, mid-stride in some clip
+	BenchmarkRandom random;
+	std::vector<float> queries(numCharacters * MOTION_FEATURE_STRIDE);
+	std::vector<Vec2> desiredVelocities(numCharacters);
+	for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+	{
+		float headingDegrees = random.GetInRange(0.f, 360.f);
+		float speed = random.GetInRange(0.f, sprintSpeed);
+		desiredVelocities[characterIndex] = Vec2(speed * CosDegrees(headingDegrees), speed * SinDegrees(headingDegrees));
+		Vec2 currentVelocity = desiredVelocities[characterIndex] * random.GetInRange(0.5f, 1.f);
+		int currentRow = static_cast<int>(random.GetInRange(0.f, static_cast<float>(database.GetNumRows() - 1)));
+		database.BuildQuery(currentVelocity, desiredVelocities[characterIndex], currentRow, &queries[characterIndex * MOTION_FEATURE_STRIDE]);
+	}
+
+	std::vector<float> exactDistances(numCharacters);
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+	{
+		database.SearchBruteForce(&queries[characterIndex * MOTION_FEATURE_STRIDE], exactDistances[characterIndex]);
+	}
+	double bruteForceSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	std::vector<float> distances(numCharacters);
+	long long rowsTested = 0;
+	long long blocksTested = 0;
+	startSeconds = GetCurrentTimeSeconds();
+	for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+	{
+		MotionSearchStats stats;
+		database.Search(&queries[characterIndex * MOTION_FEATURE_STRIDE], settings.m_searchTolerance, distances[characterIndex], &stats);
+		rowsTested += stats.m_rowsTested;
+		blocksTested += stats.m_blocksTested;
+	}
+	double searchSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	// quality: how much further the accepted match is than the true best
+	int numExact = 0;
+	double excessDistance = 0.0;
+	for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+	{
+		float exact = sqrtf(exactDistances[characterIndex]);
+		float found = sqrtf(distances[characterIndex]);
+		numExact += found <= exact ? 1 : 0;
+		excessDistance += exact > 0.f ? static_cast<double>(found / exact) - 1.0 : 0.0;
+	}
+
+	// full per-frame update: playback, periodic searches, crossfades
+	std::vector<MotionMatchingState> states(numCharacters);
+	int numBones = animations.m_skeleton.GetNumBones();
+	SkeletonPose scratchPose(numBones);
+	SkeletonPose pose(numBones);
+	float const deltaSeconds = 1.f / 60.f;
+	startSeconds = GetCurrentTimeSeconds();
+	for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+	{
+		for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+		{
+			Vec2 const& desiredVelocity = desiredVelocities[characterIndex];
+			database.EvaluatePose(desiredVelocity, desiredVelocity, deltaSeconds, animations.m_clips, settings, states[characterIndex], scratchPose, pose);
+		}
+	}
+	double updateSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	double bruteForceUs = 1000000.0 * bruteForceSeconds / static_cast<double>(numCharacters);
+	double searchUs = 1000000.0 * searchSeconds / static_cast<double>(numCharacters);
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Motion matching: %d rows in %d blocks, %d searches, tolerance %.2f",
+		database.GetNumRows(), database.GetNumBlocks(), numCharacters, settings.m_searchTolerance));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  brute force %.2f us per search, accelerated %.2f us (%.1fx), %.0f rows and %.0f blocks tested on average",
+		bruteForceUs, searchUs, searchUs > 0.0 ? bruteForceUs / searchUs : 0.0,
+		static_cast<double>(rowsTested) / numCharacters, static_cast<double>(blocksTested) / numCharacters));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %.1f%% exact matches, matches %.2f%% further than the best on average",
+		100.0 * numExact / numCharacters, 100.0 * excessDistance / numCharacters));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %d frames at %.2fs search interval: %.3f ms per frame, %.2f us per character",
+		numFrames, settings.m_searchInterval, 1000.0 * updateSeconds / numFrames, 1000000.0 * updateSeconds / (static_cast<double>(numFrames) * numCharacters)));
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Animates a crowd spread around the camera for a number of frames, with the given LOD settings;
+// returns the average ms per frame including model transforms for every changed pose
+//
+static double RunAnimationLodCrowd(LocomotionAnimations const& animations, AnimationLodSettings const& settings, int numCharacters, float radius, int numFrames,
+	AnimationLodStats& out_averageStats)
+{
+	BenchmarkRandom random;
+	std::vector<AnimationLodCharacter> characters(numCharacters);
+	for (AnimationLodCharacter& character : characters)
+	{
+		// uniform over the disc, so most of the crowd is far away like in a real scene
+		float distance = radius * sqrtf(random.GetZeroToOne());
+		float angleDegrees = random.GetInRange(0.f, 360.f);
+		character.m_position = Vec3(distance * CosDegrees(angleDegrees), distance * SinDegrees(angleDegrees), 0.f);
+		float speed = random.GetInRange(0.f, MOVEMENT_SPEED * FAST_MOVEMENT_MULTIPLIER);
+		float headingDegrees = random.GetInRange(0.f, 360.f);
+		character.m_localVelocity = Vec2(speed * CosDegrees(headingDegrees), speed * SinDegrees(headingDegrees));
+	}
+
+	AnimationLodScheduler scheduler;
+	scheduler.m_settings = settings;
+	int numBones = animations.m_skeleton.GetNumBones();
+	std::vector<BoneMatrix> modelTransforms(numCharacters * numBones);
+	float const deltaSeconds = 1.f / 60.f;
+	double totalSeconds = 0.0;
+	out_averageStats = AnimationLodStats();
+	for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+	{
+		double frameStartSeconds = GetCurrentTimeSeconds();
+		scheduler.Update(animations, Vec3(0.f, 0.f, 1.7f), 60.f, deltaSeconds, characters.data(), numCharacters);
+		for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+		{
+			AnimationLodCharacter const& character = characters[characterIndex];
+			if (character.m_isPoseChanged)
+			{
+				ComputeModelTransforms(animations.m_skeleton, character.m_pose, &modelTransforms[characterIndex * numBones], character.m_numBones);
+			}
+		}
+		totalSeconds += GetCurrentTimeSeconds() - frameStartSeconds;
+
+		AnimationLodStats const& stats = scheduler.GetStats();
+		for (int lod = 0; lod < NUM_ANIMATION_LODS; lod++)
+		{
+			out_averageStats.m_numCharactersPerLod[lod] += stats.m_numCharactersPerLod[lod];
+		}
+		out_averageStats.m_numUpdated += stats.m_numUpdated;
+		out_averageStats.m_numDeferred += stats.m_numDeferred;
+		out_averageStats.m_numInterpolated += stats.m_numInterpolated;
+	}
+
+	for (int lod = 0; lod < NUM_ANIMATION_LODS; lod++)
+	{
+		out_averageStats.m_numCharactersPerLod[lod] /= numFrames;
+	}
+	out_averageStats.m_numUpdated /= numFrames;
+	out_averageStats.m_numDeferred /= numFrames;
+	out_averageStats.m_numInterpolated /= numFrames;
+	return 1000.0 * totalSeconds / static_cast<double>(numFrames);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkAnimationLod characters=4000 radius=150 budget=1 frames=120
+// Runs a quarter, half and all of the crowd, at full rate and with LODs, to show how cost scales
+//
+bool Command_BenchmarkAnimationLod(EventArgs& args)
+{
+	int numCharacters = args.GetValue("characters", 4000);
+	float radius = args.GetValue("radius", 150.f);
+	int numFrames = args.GetValue("frames", 120);
+	AnimationLodSettings lodSettings;
+	lodSettings.m_updateBudgetMs = args.GetValue("budget", lodSettings.m_updateBudgetMs);
+	if (numCharacters < 4 || numFrames < 1 || radius <= 0.f || lodSettings.m_updateBudgetMs <= 0.f)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkAnimationLod: characters must be at least 4, frames, radius and budget positive");
+		return false;
+	}
+
+	LocomotionAnimations animations;
+	CreateLocomotionAnimations(animations, MOVEMENT_SPEED, MOVEMENT_SPEED * FAST_MOVEMENT_MULTIPLIER);
+
+	// everything at LOD 0 with no budget is the reference
+	AnimationLodSettings fullRateSettings;
+	for (int lodIndex = 0; lodIndex < NUM_ANIMATION_LODS - 1; lodIndex++)
+	{
+		fullRateSettings.m_maxDistances[lodIndex] = 1.0e9f;
+		fullRateSettings.m_minScreenFractions[lodIndex] = 0.f;
+	}
+	fullRateSettings.m_updateBudgetMs = 1.0e9f;
+
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Animation LOD: crowd within %.0fm of the camera, %.2f ms update budget", radius, lodSettings.m_updateBudgetMs));
+	for (int crowdSize = numCharacters / 4; crowdSize <= numCharacters; crowdSize *= 2)
+	{
+		AnimationLodStats fullRateStats;
+		AnimationLodStats lodStats;
+		double fullRateMs = RunAnimationLodCrowd(animations, fullRateSettings, crowdSize, radius, numFrames, fullRateStats);
+		double lodMs = RunAnimationLodCrowd(animations, lodSettings, crowdSize, radius, numFrames, lodStats);
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %5d characters: full rate %.3f ms, LOD %.3f ms per frame; LODs %d/%d/%d/%d, %d evaluated, %d interpolated, %d deferred",
+			crowdSize, fullRateMs, lodMs,
+			lodStats.m_numCharactersPerLod[0], lodStats.m_numCharactersPerLod[1], lodStats.m_numCharactersPerLod[2], lodStats.m_numCharactersPerLod[3],
+			lodStats.m_numUpdated, lodStats.m_numInterpolated, lodStats.m_numDeferred));
+	}
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkSkinning vertices=1000000 frames=20
+// Skins a crowd of character meshes in varied poses on one thread with every path this CPU
+// supports, after checking each path against the double precision reference
+//
+bool Command_BenchmarkSkinning(EventArgs& args)
+{
+	int numVertexesWanted = args.GetValue("vertices", 1000000);
+	int numFrames = args.GetValue("frames", 20);
+	if (numVertexesWanted < 1 || numFrames < 1)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkSkinning: vertices and frames must be positive");
+		return false;
+	}
+
+	LocomotionAnimations animations;
+	CreateLocomotionAnimations(animations, MOVEMENT_SPEED, MOVEMENT_SPEED * FAST_MOVEMENT_MULTIPLIER);
+	SkinnedMesh const& mesh = animations.m_skinnedMesh;
+	int numBones = mesh.GetNumBones();
+	int numMeshVertexes = mesh.GetNumVertexes();
+	int numCharacters = (numVertexesWanted + numMeshVertexes - 1) / numMeshVertexes;
+	int numVertexes = numCharacters * numMeshVertexes;
+
+	// a spread of poses from every clip; characters cycle through them
+	std::vector<BoneMatrix> modelTransforms(numBones);
+	std::vector<BoneMatrix> referenceTransforms(NUM_SKINNING_BENCHMARK_POSES * numBones);
+	std::vector<SkinningMatrix> skinningMatrices(NUM_SKINNING_BENCHMARK_POSES * numBones);
+	SkeletonPose pose(numBones);
+	BenchmarkRandom random;
+	for (int poseIndex = 0; poseIndex < NUM_SKINNING_BENCHMARK_POSES; poseIndex++)
+	{
+		AnimationClip const& clip = animations.m_clips[poseIndex % NUM_LOCOMOTION_CLIPS];
+		clip.Sample(random.GetInRange(0.f, clip.GetDuration()), pose);
+		ComputeModelTransforms(animations.m_skeleton, pose, modelTransforms.data());
+		for (int boneIndex = 0; boneIndex < numBones; boneIndex++)
+		{
+			referenceTransforms[poseIndex * numBones + boneIndex] = GetConcatenatedTransform(modelTransforms[boneIndex], mesh.GetInverseBindTransforms()[boneIndex]);
+		}
+		mesh.ComputeSkinningMatrices(modelTransforms.data(), &skinningMatrices[poseIndex * numBones]);
+	}
+
+	std::vector<Vec3> referencePositions(NUM_SKINNING_BENCHMARK_POSES * numMeshVertexes);
+	for (int poseIndex = 0; poseIndex < NUM_SKINNING_BENCHMARK_POSES; poseIndex++)
+	{
+		SkinVertexesReference(&referenceTransforms[poseIndex * numBones], mesh.GetSkinVertexes(), numMeshVertexes, &referencePositions[poseIndex * numMeshVertexes]);
+	}
+
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Skinning: %d characters x %d vertexes, %d bones, best path %s",
+		numCharacters, numMeshVertexes, numBones, GetSkinningPathName(GetBestSkinningPath())));
+
+	std::vector<Vertex_PCU> skinnedVertexes(numVertexes);
+	for (int pathIndex = 0; pathIndex <= GetBestSkinningPath(); pathIndex++)
+	{
+		SkinningPath path = static_cast<SkinningPath>(pathIndex);
+
+		// every pose against the reference
+		float maxError = 0.f;
+		for (int poseIndex = 0; poseIndex < NUM_SKINNING_BENCHMARK_POSES; poseIndex++)
+		{
+			SkinVertexes(path, &skinningMatrices[poseIndex * numBones], mesh.GetSkinVertexes(), numMeshVertexes, skinnedVertexes.data());
+			for (int vertexIndex = 0; vertexIndex < numMeshVertexes; vertexIndex++)
+			{
+				float error = (skinnedVertexes[vertexIndex].m_position - referencePositions[poseIndex * numMeshVertexes + vertexIndex]).GetLength();
+				maxError = error > maxError ? error : maxError;
+			}
+		}
+
+		double totalSeconds = 0.0;
+		for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+		{
+			double frameStartSeconds = GetCurrentTimeSeconds();
+			for (int characterIndex = 0; characterIndex < numCharacters; characterIndex++)
+			{
+				int poseIndex = (characterIndex + frameIndex) % NUM_SKINNING_BENCHMARK_POSES;
+				SkinVertexes(path, &skinningMatrices[poseIndex * numBones], mesh.GetSkinVertexes(), numMeshVertexes, &skinnedVertexes[characterIndex * numMeshVertexes]);
+			}
+			totalSeconds += GetCurrentTimeSeconds() - frameStartSeconds;
+		}
+
+		double averageMs = 1000.0 * totalSeconds / static_cast<double>(numFrames);
+		double vertexesPerSecond = static_cast<double>(numVertexes) * static_cast<double>(numFrames) / totalSeconds;
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %-6s %.3f ms per frame, %.1f M vertexes per second per core, max error %.2e",
+			GetSkinningPathName(path), averageMs, vertexesPerSecond / 1.0e6, maxError));
+	}
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkCrowd agents=4000 props=200 frames=120 threads=-1
+// Runs a quarter, half and all of the crowd on one thread and then on the worker pool, with
+// the camera above the middle of the grid; threads=-1 uses every hardware thread
+//
+bool Command_BenchmarkCrowd(EventArgs& args)
+{
+	int numAgents = args.GetValue("agents", 4000);
+	int numProps = args.GetValue("props", 200);
+	int numFrames = args.GetValue("frames", 120);
+	int numWorkerThreads = args.GetValue("threads", -1);
+	numWorkerThreads = numWorkerThreads > 0 ? numWorkerThreads - 1 : -1;
+	if (numAgents < 4 || numProps < 0 || numFrames < 1)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkCrowd: agents must be at least 4, frames positive");
+		return false;
+	}
+
+	LocomotionAnimations animations;
+	CreateLocomotionAnimations(animations, MOVEMENT_SPEED, MOVEMENT_SPEED * FAST_MOVEMENT_MULTIPLIER);
+
+	std::vector<Vec3> centers(numProps);
+	std::vector<float> radii(numProps);
+	BenchmarkRandom random;
+	for (int propIndex = 0; propIndex < numProps; propIndex++)
+	{
+		centers[propIndex] = Vec3(random.GetInRange(-45.f, 45.f), random.GetInRange(-45.f, 45.f), 0.f);
+		radii[propIndex] = random.GetInRange(0.5f, 1.f);
+	}
+	PropBroadphase broadphase;
+	broadphase.Build(centers.data(), radii.data(), numProps);
+
+	CharacterControllerConfig controllerConfig;
+	NavigationGrid navigationGrid;
+	navigationGrid.Startup(controllerConfig.m_capsuleRadius);
+	for (int propIndex = 0; propIndex < numProps; propIndex++)
+	{
+		navigationGrid.AddObstacle(Vec2(centers[propIndex].x, centers[propIndex].y), radii[propIndex]);
+	}
+
+	WorkerThreadPool singleThread;
+	WorkerThreadPool workerPool;
+	singleThread.Startup(0);
+	workerPool.Startup(numWorkerThreads);
+	WorkerThreadPool* pools[] = { &singleThread, &workerPool };
+
+	Vec3 cameraPosition(-50.f, 0.f, 10.f);
+	float const deltaSeconds = 1.f / 60.f;
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Crowd: %d props, average ms per frame over %d frames", numProps, numFrames));
+	for (int crowdSize = numAgents / 4; crowdSize <= numAgents; crowdSize *= 2)
+	{
+		for (WorkerThreadPool* pool : pools)
+		{
+			Crowd crowd;
+			crowd.Startup(animations, controllerConfig);
+			crowd.SetNumAgents(crowdSize);
+
+			// flow fields are built on the first frames and then only looked up
+			double phaseMs[NUM_CROWD_PHASES] = {};
+			for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+			{
+				navigationGrid.Update(*pool);
+				crowd.Update(deltaSeconds, broadphase, &navigationGrid, *pool, cameraPosition, WORLD_CAMERA_FOV_DEGREES);
+				for (int phaseIndex = 0; phaseIndex < CROWD_PHASE_RENDER; phaseIndex++)
+				{
+					phaseMs[phaseIndex] += crowd.GetStats().m_phaseMs[phaseIndex] / static_cast<double>(numFrames);
+				}
+			}
+
+			std::string phasesStr;
+			double totalMs = 0.0;
+			for (int phaseIndex = 0; phaseIndex < CROWD_PHASE_RENDER; phaseIndex++)
+			{
+				phasesStr += Stringf(" %s %.2f", GetCrowdPhaseName((CrowdPhase)phaseIndex), phaseMs[phaseIndex]);
+				totalMs += phaseMs[phaseIndex];
+			}
+			g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %5d agents, %2d threads: %.2f ms |%s",
+				crowdSize, pool->GetNumThreads(), totalMs, phasesStr.c_str()));
+		}
+	}
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkFlowField obstacles=300 goals=8 agents=10000 moves=50 threads=-1
+// Builds one field per goal around random obstacles, times agent lookups, then moves one obstacle
+// at a time and times the incremental repair. The repaired fields are checked against a fresh build.
+//
+bool Command_BenchmarkFlowField(EventArgs& args)
+{
+	int numObstacles = args.GetValue("obstacles", 300);
+	int numGoals = args.GetValue("goals", 8);
+	int numAgents = args.GetValue("agents", 10000);
+	int numMoves = args.GetValue("moves", 50);
+	int numWorkerThreads = args.GetValue("threads", -1);
+	numWorkerThreads = numWorkerThreads > 0 ? numWorkerThreads - 1 : -1;
+	if (numObstacles < 1 || numGoals < 1 || numGoals > MAX_CACHED_FLOW_FIELDS || numAgents < 1 || numMoves < 1)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, Stringf("BenchmarkFlowField: counts must be positive, at most %d goals", MAX_CACHED_FLOW_FIELDS));
+		return false;
+	}
+
+	BenchmarkRandom random;
+	std::vector<Vec2> obstacleCenters(numObstacles);
+	std::vector<float> obstacleRadii(numObstacles);
+	for (int obstacleIndex = 0; obstacleIndex < numObstacles; obstacleIndex++)
+	{
+		obstacleCenters[obstacleIndex] = Vec2(random.GetInRange(-45.f, 45.f), random.GetInRange(-45.f, 45.f));
+		obstacleRadii[obstacleIndex] = random.GetInRange(0.5f, 1.5f);
+	}
+	std::vector<Vec2> goals(numGoals);
+	for (Vec2& goal : goals)
+	{
+		goal = Vec2(random.GetInRange(-40.f, 40.f), random.GetInRange(-40.f, 40.f));
+	}
+
+	// goals in the same cell share a field, so keep the slot each goal got
+	float agentRadius = CharacterControllerConfig().m_capsuleRadius;
+	std::vector<int> goalFields(numGoals);
+	auto startGrid = [&](NavigationGrid& grid)
+	{
+		grid.Startup(agentRadius);
+		for (int obstacleIndex = 0; obstacleIndex < numObstacles; obstacleIndex++)
+		{
+			grid.AddObstacle(obstacleCenters[obstacleIndex], obstacleRadii[obstacleIndex]);
+		}
+		for (int goalIndex = 0; goalIndex < numGoals; goalIndex++)
+		{
+			goalFields[goalIndex] = grid.RequestFlowField(goals[goalIndex]);
+		}
+	};
+
+	WorkerThreadPool singleThread;
+	WorkerThreadPool workerPool;
+	singleThread.Startup(0);
+	workerPool.Startup(numWorkerThreads);
+
+	// full builds, every goal at once
+	NavigationGrid grid;
+	startGrid(grid);
+	grid.Update(singleThread);
+	double singleBuildMs = grid.GetStats().m_updateMs;
+	startGrid(grid);
+	grid.Update(workerPool);
+	double poolBuildMs = grid.GetStats().m_updateMs;
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Flow Field: %d x %d cells, %d obstacles covering %d cells, %d goals",
+		NAVIGATION_GRID_WIDTH, NAVIGATION_GRID_WIDTH, numObstacles, grid.GetStats().m_numBlockedCells, numGoals));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  build: %.3f ms per field, all fields %.3f ms on 1 thread, %.3f ms on %d threads",
+		singleBuildMs / (double)numGoals, singleBuildMs, poolBuildMs, workerPool.GetNumThreads()));
+
+	// every agent asks its goal's field for a direction
+	std::vector<Vec2> agentPositions(numAgents);
+	for (Vec2& position : agentPositions)
+	{
+		position = Vec2(random.GetInRange(-45.f, 45.f), random.GetInRange(-45.f, 45.f));
+	}
+	Vec2 directionSum;
+	double lookupStartSeconds = GetCurrentTimeSeconds();
+	for (int agentIndex = 0; agentIndex < numAgents; agentIndex++)
+	{
+		directionSum += grid.GetFlowDirection(goalFields[agentIndex % numGoals], agentPositions[agentIndex]);
+	}
+	double lookupNs = 1.0e9 * (GetCurrentTimeSeconds() - lookupStartSeconds) / (double)numAgents;
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  lookup: %.1f ns per agent (checksum %.1f)", lookupNs, directionSum.x + directionSum.y));
+
+	// one obstacle moves a few meters per update, the way a pushed prop would
+	double repairMs = 0.0;
+	int numCellsRepaired = 0;
+	for (int moveIndex = 0; moveIndex < numMoves; moveIndex++)
+	{
+		int obstacleIndex = (int)(random.GetZeroToOne() * (float)numObstacles) % numObstacles;
+		Vec2& center = obstacleCenters[obstacleIndex];
+		center += Vec2(random.GetInRange(-3.f, 3.f), random.GetInRange(-3.f, 3.f));
+		center = Vec2(GetClamped(center.x, -45.f, 45.f), GetClamped(center.y, -45.f, 45.f));
+		grid.MoveObstacle(obstacleIndex, center, obstacleRadii[obstacleIndex]);
+		grid.Update(singleThread);
+		repairMs += grid.GetStats().m_updateMs;
+		numCellsRepaired += grid.GetStats().m_numCellsRepaired;
+	}
+	double repairMsPerMove = repairMs / (double)numMoves;
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  repair: %.3f ms per move for all fields (%.1fx faster than rebuilding), %.0f cells per field",
+		repairMsPerMove, singleBuildMs / repairMsPerMove, (double)numCellsRepaired / (double)(numMoves * numGoals)));
+
+	// a repaired field must match one built from scratch around the moved obstacles
+	NavigationGrid freshGrid;
+	startGrid(freshGrid);
+	freshGrid.Update(singleThread);
+	float maxCostError = 0.f;
+	for (int fieldIndex : goalFields)
+	{
+		float const* repairedCosts = grid.GetFlowFieldCosts(fieldIndex);
+		float const* freshCosts = freshGrid.GetFlowFieldCosts(fieldIndex);
+		for (int cellIndex = 0; cellIndex < NUM_NAVIGATION_CELLS; cellIndex++)
+		{
+			bool isRepairedReachable = repairedCosts[cellIndex] < FLOW_FIELD_UNREACHABLE;
+			bool isFreshReachable = freshCosts[cellIndex] < FLOW_FIELD_UNREACHABLE;
+			float error = isRepairedReachable != isFreshReachable ? FLOW_FIELD_UNREACHABLE : fabsf(repairedCosts[cellIndex] - freshCosts[cellIndex]);
+			error = isRepairedReachable || isFreshReachable ? error : 0.f;
+			maxCostError = error > maxCostError ? error : maxCostError;
+		}
+	}
+	Rgba8 checkColor = maxCostError < 1.0e-3f ? DevConsole::INFO_MINOR_COLOR : DevConsole::ERROR_COLOR;
+	g_theDevConsole->AddLine(checkColor, Stringf("  repaired vs rebuilt: max cost difference %.2e cells", maxCostError));
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static float GetMaxMatrixError(std::vector<SimdMat44> const& matrices, std::vector<SimdMat44> const& referenceMatrices)
+{
+	float maxError = 0.f;
+	for (int matrixIndex = 0; matrixIndex < static_cast<int>(matrices.size()); matrixIndex++)
+	{
+		Mat44 matrix = matrices[matrixIndex].GetAsMat44();
+		Mat44 referenceMatrix = referenceMatrices[matrixIndex].GetAsMat44();
+		for (int valueIndex = 0; valueIndex < 16; valueIndex++)
+		{
+			float error = fabsf(matrix.m_values[valueIndex] - referenceMatrix.m_values[valueIndex]);
+			maxError = error > maxError ? error : maxError;
+		}
+	}
+	return maxError;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkSimdMath matrices=100000 frames=20
+// Times each SimdMath batch on one thread with every path this CPU supports, after checking it
+// against the scalar path. Orientations cover several turns, as long-running yaw does in game
+//
+bool Command_BenchmarkSimdMath(EventArgs& args)
+{
+	int numMatrices = args.GetValue("matrices", 100000);
+	int numFrames = args.GetValue("frames", 20);
+	if (numMatrices < 1 || numFrames < 1)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkSimdMath: matrices and frames must be positive");
+		return false;
+	}
+
+	BenchmarkRandom random;
+	std::vector<EulerAngles> orientations(numMatrices);
+	std::vector<Vec3> translations(numMatrices);
+	std::vector<Vec3> vectors(numMatrices);
+	for (int matrixIndex = 0; matrixIndex < numMatrices; matrixIndex++)
+	{
+		orientations[matrixIndex] = EulerAngles(random.GetInRange(-1800.f, 1800.f), random.GetInRange(-90.f, 90.f), random.GetInRange(-180.f, 180.f));
+		translations[matrixIndex] = Vec3(random.GetInRange(-50.f, 50.f), random.GetInRange(-50.f, 50.f), random.GetInRange(0.f, 10.f));
+		vectors[matrixIndex] = Vec3(random.GetInRange(-10.f, 10.f), random.GetInRange(-10.f, 10.f), random.GetInRange(-10.f, 10.f));
+	}
+
+	std::vector<SimdMat44> matrices(numMatrices);
+	std::vector<SimdMat44> appendThese(numMatrices);
+	GetMatricesFromEulerAngles(SIMD_MATH_PATH_SCALAR, orientations.data(), translations.data(), matrices.data(), numMatrices);
+	for (int matrixIndex = 0; matrixIndex < numMatrices; matrixIndex++)
+	{
+		appendThese[matrixIndex] = matrices[(matrixIndex * 7 + 1) % numMatrices];
+	}
+
+	std::vector<SimdMat44> referenceEulerMatrices(numMatrices);
+	std::vector<SimdMat44> referenceProducts(numMatrices);
+	std::vector<SimdMat44> referenceInverses(numMatrices);
+	std::vector<Vec3> referenceNormalized = vectors;
+	GetMatricesFromEulerAngles(SIMD_MATH_PATH_SCALAR, orientations.data(), translations.data(), referenceEulerMatrices.data(), numMatrices);
+	AppendMatrices(SIMD_MATH_PATH_SCALAR, matrices.data(), appendThese.data(), referenceProducts.data(), numMatrices);
+	InvertMatrices(SIMD_MATH_PATH_SCALAR, matrices.data(), referenceInverses.data(), numMatrices);
+	NormalizeVectors(SIMD_MATH_PATH_SCALAR, referenceNormalized.data(), numMatrices);
+
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("SIMD math: %d matrices, %d frames, best path %s",
+		numMatrices, numFrames, GetSimdMathPathName(GetBestSimdMathPath())));
+
+	std::vector<SimdMat44> eulerMatrices(numMatrices);
+	std::vector<SimdMat44> products(numMatrices);
+	std::vector<SimdMat44> inverses(numMatrices);
+	std::vector<Vec3> normalized(numMatrices);
+	double const nanosecondsPerCall = 1.0e9 / (static_cast<double>(numMatrices) * static_cast<double>(numFrames));
+	for (int pathIndex = 0; pathIndex <= GetBestSimdMathPath(); pathIndex++)
+	{
+		SimdMathPath path = static_cast<SimdMathPath>(pathIndex);
+		double eulerSeconds = 0.0;
+		double appendSeconds = 0.0;
+		double invertSeconds = 0.0;
+		double normalizeSeconds = 0.0;
+		for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+		{
+			double startSeconds = GetCurrentTimeSeconds();
+			GetMatricesFromEulerAngles(path, orientations.data(), translations.data(), eulerMatrices.data(), numMatrices);
+			double eulerEndSeconds = GetCurrentTimeSeconds();
+			AppendMatrices(path, matrices.data(), appendThese.data(), products.data(), numMatrices);
+			double appendEndSeconds = GetCurrentTimeSeconds();
+			InvertMatrices(path, matrices.data(), inverses.data(), numMatrices);
+			double invertEndSeconds = GetCurrentTimeSeconds();
+			normalized = vectors;
+			double normalizeStartSeconds = GetCurrentTimeSeconds();
+			NormalizeVectors(path, normalized.data(), numMatrices);
+			double normalizeEndSeconds = GetCurrentTimeSeconds();
+
+			eulerSeconds += eulerEndSeconds - startSeconds;
+			appendSeconds += appendEndSeconds - eulerEndSeconds;
+			invertSeconds += invertEndSeconds - appendEndSeconds;
+			normalizeSeconds += normalizeEndSeconds - normalizeStartSeconds;
+		}
+
+		float maxNormalizeError = 0.f;
+		for (int vectorIndex = 0; vectorIndex < numMatrices; vectorIndex++)
+		{
+			float error = (normalized[vectorIndex] - referenceNormalized[vectorIndex]).GetLength();
+			maxNormalizeError = error > maxNormalizeError ? error : maxNormalizeError;
+		}
+
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %-6s ns per call: euler %.2f, append %.2f, invert %.2f, normalize %.2f",
+			GetSimdMathPathName(path), eulerSeconds * nanosecondsPerCall, appendSeconds * nanosecondsPerCall, invertSeconds * nanosecondsPerCall, normalizeSeconds * nanosecondsPerCall));
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("         max error vs scalar: euler %.2e, append %.2e, invert %.2e, normalize %.2e",
+			GetMaxMatrixError(eulerMatrices, referenceEulerMatrices), GetMaxMatrixError(products, referenceProducts), GetMaxMatrixError(inverses, referenceInverses), maxNormalizeError));
+	}
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+enum PropOrientationBenchmarkMode
+{
+	PROP_ORIENTATION_EULER,
+	PROP_ORIENTATION_EULER_BATCHED,
+	PROP_ORIENTATION_QUATERNION,
+	NUM_PROP_ORIENTATION_MODES
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkPropOrientation props=10000 frames=600
+// Spins props about fixed axes of their own and times update plus transform per prop: Euler with
+// one trig-built matrix each, Euler through the batched SIMD conversion the game uses, and
+// quaternion. Afterwards every basis is compared with the exact constant-rate spin.
+//
+bool Command_BenchmarkPropOrientation(EventArgs& args)
+{
+	int numProps = args.GetValue("props", 10000);
+	int numFrames = args.GetValue("frames", 600);
+	if (numProps < 1 || numFrames < 1)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkPropOrientation: props and frames must be positive");
+		return false;
+	}
+
+	BenchmarkRandom random;
+	std::vector<EulerAngles> angularVelocities(numProps);
+	std::vector<Vec3> positions(numProps);
+	for (int propIndex = 0; propIndex < numProps; propIndex++)
+	{
+		angularVelocities[propIndex] = EulerAngles(random.GetInRange(-90.f, 90.f), random.GetInRange(-90.f, 90.f), random.GetInRange(-90.f, 90.f));
+		positions[propIndex] = Vec3(random.GetInRange(-50.f, 50.f), random.GetInRange(-50.f, 50.f), 0.f);
+	}
+
+	char const* modeNames[NUM_PROP_ORIENTATION_MODES] = { "euler", "euler batched", "quaternion" };
+	float const deltaSeconds = 1.f / 60.f;
+	float const elapsedSeconds = deltaSeconds * static_cast<float>(numFrames);
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Prop orientation: %d props, %d frames, %.1f s of spin", numProps, numFrames, elapsedSeconds));
+
+	std::vector<EulerAngles> batchOrientations(numProps);
+	std::vector<Vec3> batchPositions(numProps);
+	std::vector<SimdMat44> batchMatrices(numProps);
+	for (int modeIndex = 0; modeIndex < NUM_PROP_ORIENTATION_MODES; modeIndex++)
+	{
+		std::vector<Prop> props;
+		props.reserve(numProps);
+		for (int propIndex = 0; propIndex < numProps; propIndex++)
+		{
+			props.emplace_back(nullptr);
+			Prop& prop = props.back();
+			prop.SetPosition(positions[propIndex]);
+			prop.m_angularVelocity = angularVelocities[propIndex];
+			prop.SetUsesQuaternionOrientation(modeIndex == PROP_ORIENTATION_QUATERNION);
+			prop.UpdateTransform();
+		}
+
+		double startSeconds = GetCurrentTimeSeconds();
+		for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+		{
+			if (modeIndex == PROP_ORIENTATION_EULER_BATCHED)
+			{
+				for (int propIndex = 0; propIndex < numProps; propIndex++)
+				{
+					props[propIndex].Update(deltaSeconds);
+					batchOrientations[propIndex] = props[propIndex].m_orientation;
+					batchPositions[propIndex] = props[propIndex].m_position;
+				}
+				GetMatricesFromEulerAngles(GetBestSimdMathPath(), batchOrientations.data(), batchPositions.data(), batchMatrices.data(), numProps);
+				for (int propIndex = 0; propIndex < numProps; propIndex++)
+				{
+					props[propIndex].SetUpdatedTransform(batchMatrices[propIndex].GetAsMat44());
+				}
+				continue;
+			}
+
+			for (Prop& prop : props)
+			{
+				prop.Update(deltaSeconds);
+				prop.UpdateTransform();
+			}
+		}
+		double totalSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+		// the exact spin about a fixed body axis is one axis-angle rotation
+		float maxBasisError = 0.f;
+		float maxSkew = 0.f;
+		for (int propIndex = 0; propIndex < numProps; propIndex++)
+		{
+			EulerAngles const& rates = angularVelocities[propIndex];
+			Vec3 rateVector(rates.m_rollDegrees, rates.m_pitchDegrees, rates.m_yawDegrees);
+			Quaternion exact = Quaternion::MakeFromAxisAngleDegrees(rateVector, rateVector.GetLength() * elapsedSeconds);
+			Vec3 exactBasis[3];
+			exact.GetAsVectors_XFwd_YLeft_ZUp(exactBasis[0], exactBasis[1], exactBasis[2]);
+
+			Prop const& prop = props[propIndex];
+			Vec3 basis[3] = { prop.GetForward(), prop.GetLeft(), prop.GetUp() };
+			for (int axisIndex = 0; axisIndex < 3; axisIndex++)
+			{
+				float error = (basis[axisIndex] - exactBasis[axisIndex]).GetLength();
+				float skew = fabsf(basis[axisIndex].GetLength() - 1.f);
+				maxBasisError = error > maxBasisError ? error : maxBasisError;
+				maxSkew = skew > maxSkew ? skew : maxSkew;
+			}
+		}
+
+		double nanosecondsPerProp = 1.0e9 * totalSeconds / (static_cast<double>(numProps) * static_cast<double>(numFrames));
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %-13s %.2f ns per prop update + transform, max basis error %.2e, max length error %.2e",
+			modeNames[modeIndex], nanosecondsPerProp, maxBasisError, maxSkew));
+	}
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static float GetMaxVertexError(std::vector<Vertex_PCU> const& vertexes, std::vector<Vertex_PCU> const& reference)
+{
+	float maxError = 0.f;
+	for (int vertexIndex = 0; vertexIndex < (int)vertexes.size(); vertexIndex++)
+	{
+		float error = (vertexes[vertexIndex].m_position - reference[vertexIndex].m_position).GetLength();
+		maxError = error > maxError ? error : maxError;
+	}
+	return maxError;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkRings rings=1000 sides=64 frames=100
+// Tessellates screen-sized rings with the per-side trig reference, one AddVertsForRing2D call
+// each, and one AddVertsForRings2D call for all of them, then compares the vertexes
+//
+bool Command_BenchmarkRings(EventArgs& args)
+{
+	int numRings = args.GetValue("rings", 1000);
+	int numSides = args.GetValue("sides", RING2D_DEFAULT_NUM_SIDES);
+	int numFrames = args.GetValue("frames", 100);
+	if (numRings < 1 || numSides < 3 || numFrames < 1)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkRings: rings and frames must be positive and sides at least 3");
+		return false;
+	}
+
+	BenchmarkRandom random;
+	std::vector<Ring2D> rings(numRings);
+	for (Ring2D& ring : rings)
+	{
+		ring.m_center = Vec2(random.GetInRange(0.f, 1600.f), random.GetInRange(0.f, 800.f));
+		ring.m_radius = random.GetInRange(10.f, 400.f);
+		ring.m_thickness = random.GetInRange(1.f, 20.f);
+		ring.m_color = Rgba8(255, 255, 255);
+	}
+
+	int numVertexes = numRings * GetNumVertexesForRing2D(numSides);
+	std::vector<Vertex_PCU> referenceVertexes(numVertexes);
+	std::vector<Vertex_PCU> ringVertexes(numVertexes);
+	std::vector<Vertex_PCU> batchedVertexes(numVertexes);
+	double referenceSeconds = 0.0;
+	double ringSeconds = 0.0;
+	double batchedSeconds = 0.0;
+	for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+	{
+		VertexSpanWriter referenceVerts(referenceVertexes.data(), numVertexes);
+		VertexSpanWriter ringVerts(ringVertexes.data(), numVertexes);
+		VertexSpanWriter batchedVerts(batchedVertexes.data(), numVertexes);
+
+		double startSeconds = GetCurrentTimeSeconds();
+		for (Ring2D const& ring : rings)
+		{
+			AddVertsForRing2DReference(referenceVerts, ring.m_center, ring.m_radius, ring.m_thickness, ring.m_color, numSides);
+		}
+		double referenceEndSeconds = GetCurrentTimeSeconds();
+		for (Ring2D const& ring : rings)
+		{
+			AddVertsForRing2D(ringVerts, ring.m_center, ring.m_radius, ring.m_thickness, ring.m_color, numSides);
+		}
+		double ringEndSeconds = GetCurrentTimeSeconds();
+		AddVertsForRings2D(batchedVerts, rings.data(), numRings, numSides);
+		double batchedEndSeconds = GetCurrentTimeSeconds();
+
+		referenceSeconds += referenceEndSeconds - startSeconds;
+		ringSeconds += ringEndSeconds - referenceEndSeconds;
+		batchedSeconds += batchedEndSeconds - ringEndSeconds;
+	}
+
+	double const nanosecondsPerRing = 1.0e9 / (static_cast<double>(numRings) * static_cast<double>(numFrames));
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Rings: %d rings of %d sides, %d frames, sincos path %s",
+		numRings, numSides, numFrames, GetSimdMathPathName(GetBestSimdMathPath())));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  ns per ring: trig reference %.1f, AddVertsForRing2D %.1f, AddVertsForRings2D %.1f",
+		referenceSeconds * nanosecondsPerRing, ringSeconds * nanosecondsPerRing, batchedSeconds * nanosecondsPerRing));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  max vertex error vs reference: ring %.2e, batched %.2e",
+		GetMaxVertexError(ringVertexes, referenceVertexes), GetMaxVertexError(batchedVertexes, referenceVertexes)));
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// corners at 45 degrees off each endpoint, as DebugDrawLine used to place them
+//
+static void AddVertsForLineWithTrig(Vertex_PCU* verts, Vec2 const& start, Vec2 const& end, float thickness, Rgba8 const& color)
+{
+	float halfThickness = 0.5f * thickness;
+	float orientationDegrees = (end - start).GetOrientationDegrees();
+	Vec2 backLeft = start + Vec2(CosDegrees(orientationDegrees + 135.f), SinDegrees(orientationDegrees + 135.f)) * halfThickness;
+	Vec2 frontLeft = end + Vec2(CosDegrees(orientationDegrees + 45.f), SinDegrees(orientationDegrees + 45.f)) * halfThickness;
+	Vec2 frontRight = end + Vec2(CosDegrees(orientationDegrees - 45.f), SinDegrees(orientationDegrees - 45.f)) * halfThickness;
+	Vec2 backRight = start + Vec2(CosDegrees(orientationDegrees - 135.f), SinDegrees(orientationDegrees - 135.f)) * halfThickness;
+
+	verts[0] = Vertex_PCU(Vec3(backRight.x, backRight.y, 0.f), color, Vec2::ZERO);
+	verts[1] = Vertex_PCU(Vec3(frontRight.x, frontRight.y, 0.f), color, Vec2::ZERO);
+	verts[2] = Vertex_PCU(Vec3(frontLeft.x, frontLeft.y, 0.f), color, Vec2::ZERO);
+	verts[3] = Vertex_PCU(Vec3(backRight.x, backRight.y, 0.f), color, Vec2::ZERO);
+	verts[4] = Vertex_PCU(Vec3(frontLeft.x, frontLeft.y, 0.f), color, Vec2::ZERO);
+	verts[5] = Vertex_PCU(Vec3(backLeft.x, backLeft.y, 0.f), color, Vec2::ZERO);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkDebugLines lines=10000 frames=100
+// Times the CPU side of a frame of debug lines: adding them to a DebugLineBatch and building every
+// quad, which is all Render does before its one stream range is drawn. The trig corner placement
+// DebugDrawLine used before is timed alongside for comparison
+//
+bool Command_BenchmarkDebugLines(EventArgs& args)
+{
+	int numLines = args.GetValue("lines", 10000);
+	int numFrames = args.GetValue("frames", 100);
+	if (numLines < 1 || numFrames < 1)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkDebugLines: lines and frames must be positive");
+		return false;
+	}
+
+	BenchmarkRandom random;
+	std::vector<Vec2> starts(numLines);
+	std::vector<Vec2> ends(numLines);
+	for (int lineIndex = 0; lineIndex < numLines; lineIndex++)
+	{
+		starts[lineIndex] = Vec2(random.GetInRange(0.f, 1600.f), random.GetInRange(0.f, 800.f));
+		ends[lineIndex] = starts[lineIndex] + Vec2(random.GetInRange(-50.f, 50.f), random.GetInRange(-50.f, 50.f));
+	}
+
+	DebugLineBatch lines;
+	lines.Reserve(numLines);
+	std::vector<Vertex_PCU> vertexes(numLines * LINE_SEGMENT2D_NUM_VERTEXES);
+	std::vector<Vertex_PCU> trigVertexes(numLines * LINE_SEGMENT2D_NUM_VERTEXES);
+	double totalSeconds = 0.0;
+	double worstSeconds = 0.0;
+	double trigSeconds = 0.0;
+	for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+	{
+		double startSeconds = GetCurrentTimeSeconds();
+		lines.Clear();
+		for (int lineIndex = 0; lineIndex < numLines; lineIndex++)
+		{
+			lines.AddLine(starts[lineIndex], ends[lineIndex], DEBUG_LINE_THICKNESS, Rgba8::WHITE);
+		}
+		VertexSpanWriter verts(vertexes.data(), (int)vertexes.size());
+		lines.AddVertsForLines(verts, 0, numLines);
+		double frameSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+		double trigStartSeconds = GetCurrentTimeSeconds();
+		for (int lineIndex = 0; lineIndex < numLines; lineIndex++)
+		{
+			AddVertsForLineWithTrig(&trigVertexes[lineIndex * LINE_SEGMENT2D_NUM_VERTEXES], starts[lineIndex], ends[lineIndex], DEBUG_LINE_THICKNESS, Rgba8::WHITE);
+		}
+		trigSeconds += GetCurrentTimeSeconds() - trigStartSeconds;
+
+		totalSeconds += frameSeconds;
+		worstSeconds = frameSeconds > worstSeconds ? frameSeconds : worstSeconds;
+	}
+
+	int numVertexes = numLines * LINE_SEGMENT2D_NUM_VERTEXES;
+	int numDraws = (numVertexes + VERTEX_STREAM_DEFAULT_CAPACITY - 1) / VERTEX_STREAM_DEFAULT_CAPACITY;
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Debug lines: %d lines, %d frames, avg %.3f ms, worst %.3f ms, %d draw(s) of %d vertexes",
+		numLines, numFrames, 1000.0 * totalSeconds / (double)numFrames, 1000.0 * worstSeconds, numDraws, numVertexes));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  trig corner placement alone: avg %.3f ms", 1000.0 * trigSeconds / (double)numFrames));
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkPhysics bodies=10000 frames=600 throws=20
+// Square pyramids of spheres are dropped onto racks, a static bottom layer, to settle and fall
+// asleep. Halfway through, balls are dropped onto the tops of random pyramids, waking their
+// islands. Reports time per physics phase, the cost of a step once everything sleeps, and how
+// many pyramids still stand. As in the game, a prop broadphase over every body takes the moved
+// ones in place after each step; its cost and heap allocations on frames with moving bodies are
+// reported next to what a full build costs.
+//
+bool Command_BenchmarkPhysics(EventArgs& args)
+{
+	int numBodies = args.GetValue("bodies", 10000);
+	int numFrames = args.GetValue("frames", 600);
+	int numThrows = args.GetValue("throws", 20);
+	int throwFrame = numFrames / 2;
+	if (numBodies < PHYSICS_BENCHMARK_BODIES_PER_PYRAMID || throwFrame < PHYSICS_BENCHMARK_SETTLED_FRAMES || numThrows < 0)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, Stringf("BenchmarkPhysics: at least %d bodies and %d frames, throws not negative",
+			PHYSICS_BENCHMARK_BODIES_PER_PYRAMID, 2 * PHYSICS_BENCHMARK_SETTLED_FRAMES));
+		return false;
+	}
+
+	// each layer sits in the pockets of the one below, r * sqrt(2) higher. Loose spheres on flat
+	// ground would roll apart, so the bottom layer is static
+	float const radius = PHYSICS_BENCHMARK_RADIUS;
+	float const layerHeight = radius * sqrtf(2.f);
+	float const restingTopZ = radius + (float)(PHYSICS_BENCHMARK_PYRAMID_BASE - 1) * layerHeight;
+	int numPyramids = numBodies / PHYSICS_BENCHMARK_BODIES_PER_PYRAMID;
+	int pyramidsPerRow = (int)ceilf(sqrtf((float)numPyramids));
+	float pyramidSpacing = 2.f * radius * (float)PHYSICS_BENCHMARK_PYRAMID_BASE + PHYSICS_BENCHMARK_PYRAMID_GAP;
+	PropPhysics physics;
+	std::vector<Vec3> topPositions;
+	std::vector<int> topBodies;
+	for (int pyramidIndex = 0; pyramidIndex < numPyramids; pyramidIndex++)
+	{
+		float originX = pyramidSpacing * (float)(pyramidIndex % pyramidsPerRow);
+		float originY = pyramidSpacing * (float)(pyramidIndex / pyramidsPerRow);
+		for (int layer = 0; layer < PHYSICS_BENCHMARK_PYRAMID_BASE; layer++)
+		{
+			int numPerSide = PHYSICS_BENCHMARK_PYRAMID_BASE - layer;
+			for (int sphereY = 0; sphereY < numPerSide; sphereY++)
+			{
+				for (int sphereX = 0; sphereX < numPerSide; sphereX++)
+				{
+					Vec3 position(originX + radius * (float)(layer + 2 * sphereX), originY + radius * (float)(layer + 2 * sphereY),
+						radius + (float)layer * layerHeight);
+					if (layer == 0)
+					{
+						physics.AddBody(position, radius, 0.f);
+						continue;
+					}
+
+					position.z += PHYSICS_BENCHMARK_DROP_HEIGHT;
+					int bodyIndex = physics.AddBody(position, radius, 1.f);
+					if (numPerSide == 1)
+					{
+						topBodies.push_back(bodyIndex);
+						topPositions.push_back(Vec3(position.x, position.y, restingTopZ));
+					}
+				}
+			}
+		}
+	}
+
+	// broadphase prop index = body index
+	std::vector<Vec3> bodyCenters;
+	std::vector<float> bodyRadii;
+	for (int bodyIndex = 0; bodyIndex < physics.GetNumBodies(); bodyIndex++)
+	{
+		bodyCenters.push_back(physics.GetPosition(bodyIndex));
+		bodyRadii.push_back(radius);
+	}
+	PropBroadphase broadphase;
+	double buildStartSeconds = GetCurrentTimeSeconds();
+	broadphase.Build(bodyCenters.data(), bodyRadii.data(), (int)bodyCenters.size());
+	double buildSeconds = GetCurrentTimeSeconds() - buildStartSeconds;
+
+	std::vector<Vec3> movedCenters;
+	std::vector<float> movedRadii;
+	movedCenters.reserve(numBodies + numThrows);
+	movedRadii.reserve(numBodies + numThrows);
+	bodyCenters.reserve(numBodies + numThrows);
+	bodyRadii.reserve(numBodies + numThrows);
+
+	BenchmarkRandom random;
+	float const deltaSeconds = 1.f / 60.f;
+	double phaseMs[NUM_PROP_PHYSICS_PHASES] = {};
+	double awakeStepSeconds = 0.0;
+	double awakeUpdateSeconds = 0.0;
+	int numAwakeFrames = 0;
+	int numMovedProps = 0;
+	int numResorts = 0;
+	int numUpdateHeapAllocations = 0;
+	double totalSeconds = 0.0;
+	double worstSeconds = 0.0;
+	double settledSeconds = 0.0;
+	int numAwakeBeforeThrows = 0;
+	int maxAwakeAfterThrows = 0;
+	int numIslandsWoken = 0;
+	for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+	{
+		if (frameIndex == throwFrame)
+		{
+			numAwakeBeforeThrows = physics.GetStats().m_numAwake;
+			for (int throwIndex = 0; throwIndex < numThrows; throwIndex++)
+			{
+				int pyramidIndex = (int)(random.GetZeroToOne() * (float)numPyramids) % numPyramids;
+				int ballIndex = physics.AddBody(topPositions[pyramidIndex] + Vec3(random.GetInRange(-0.2f, 0.2f), random.GetInRange(-0.2f, 0.2f), 3.f), radius, 2.f);
+				physics.SetVelocity(ballIndex, Vec3(0.f, 0.f, -8.f));
+				bodyCenters.push_back(physics.GetPosition(ballIndex));
+				bodyRadii.push_back(radius);
+			}
+
+			// new props, so a full build, as the game does on a throw
+			broadphase.Build(bodyCenters.data(), bodyRadii.data(), (int)bodyCenters.size());
+		}
+
+		double stepStartSeconds = GetCurrentTimeSeconds();
+		physics.Step(deltaSeconds);
+		double stepSeconds = GetCurrentTimeSeconds() - stepStartSeconds;
+
+		std::vector<int> const& movedBodies = physics.GetBodiesMovedLastStep();
+		if (!movedBodies.empty())
+		{
+			ScopedHeapAllocationCounter updateAllocations;
+			double updateStartSeconds = GetCurrentTimeSeconds();
+			movedCenters.clear();
+			movedRadii.clear();
+			for (int bodyIndex : movedBodies)
+			{
+				movedCenters.push_back(physics.GetPosition(bodyIndex));
+				movedRadii.push_back(radius);
+			}
+			numResorts += broadphase.UpdateProps(movedBodies.data(), movedCenters.data(), movedRadii.data(), (int)movedBodies.size()) ? 1 : 0;
+			awakeUpdateSeconds += GetCurrentTimeSeconds() - updateStartSeconds;
+			numUpdateHeapAllocations += updateAllocations.GetCount();
+
+			awakeStepSeconds += stepSeconds;
+			numMovedProps += (int)movedBodies.size();
+			numAwakeFrames++;
+		}
+
+		PropPhysicsStats const& stats = physics.GetStats();
+		for (int phaseIndex = 0; phaseIndex < NUM_PROP_PHYSICS_PHASES; phaseIndex++)
+		{
+			phaseMs[phaseIndex] += stats.m_phaseMs[phaseIndex] / (double)numFrames;
+		}
+		totalSeconds += stepSeconds;
+		worstSeconds = stepSeconds > worstSeconds ? stepSeconds : worstSeconds;
+		if (frameIndex >= throwFrame - PHYSICS_BENCHMARK_SETTLED_FRAMES && frameIndex < throwFrame)
+		{
+			settledSeconds += stepSeconds;
+		}
+		if (frameIndex >= throwFrame)
+		{
+			maxAwakeAfterThrows = stats.m_numAwake > maxAwakeAfterThrows ? stats.m_numAwake : maxAwakeAfterThrows;
+			numIslandsWoken += stats.m_numIslandsWoken;
+		}
+	}
+
+	// a pyramid stands while its top sphere is still on top
+	int numStanding = 0;
+	for (int pyramidIndex = 0; pyramidIndex < numPyramids; pyramidIndex++)
+	{
+		numStanding += GetDistance3D(physics.GetPosition(topBodies[pyramidIndex]), topPositions[pyramidIndex]) < radius ? 1 : 0;
+	}
+
+	std::string phasesStr;
+	for (int phaseIndex = 0; phaseIndex < NUM_PROP_PHYSICS_PHASES; phaseIndex++)
+	{
+		phasesStr += Stringf(" %s %.2f", GetPropPhysicsPhaseName((PropPhysicsPhase)phaseIndex), phaseMs[phaseIndex]);
+	}
+	PropPhysicsStats const& endStats = physics.GetStats();
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Physics: %d bodies in %d pyramids, %d frames, avg %.2f ms, worst %.2f ms, settled %.3f ms",
+		numPyramids * PHYSICS_BENCHMARK_BODIES_PER_PYRAMID, numPyramids, numFrames, 1000.0 * totalSeconds / (double)numFrames, 1000.0 * worstSeconds,
+		1000.0 * settledSeconds / (double)PHYSICS_BENCHMARK_SETTLED_FRAMES));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  avg ms |%s", phasesStr.c_str()));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %d awake before %d throws, which woke %d islands and at most %d bodies; %d awake and %d sleeping islands at the end",
+		numAwakeBeforeThrows, numThrows, numIslandsWoken, maxAwakeAfterThrows, endStats.m_numAwake, endStats.m_numSleepingIslands));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %d of %d pyramids standing", numStanding, numPyramids));
+	double awakeFrameDivisor = numAwakeFrames > 0 ? (double)numAwakeFrames : 1.0;
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %d frames with moving bodies: avg %.3f ms step + %.3f ms broadphase update for %d props, %d re-sorts, %d heap allocations; a full build is %.3f ms",
+		numAwakeFrames, 1000.0 * awakeStepSeconds / awakeFrameDivisor, 1000.0 * awakeUpdateSeconds / awakeFrameDivisor, numMovedProps / (numAwakeFrames > 0 ? numAwakeFrames : 1),
+		numResorts, numUpdateHeapAllocations, 1000.0 * buildSeconds));
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// BenchmarkParticles particles=1000000 frames=120
+// Footstep-sized bursts at random spots keep a pool of the given size about full, emitting each
+// frame as many as expire on average. Once the pool has filled, times emission, the update, and
+// building the billboards one vertex stream range at a time, and counts heap allocations.
+//
+bool Command_BenchmarkParticles(EventArgs& args)
+{
+	int numParticles = args.GetValue("particles", 1000000);
+	int numFrames = args.GetValue("frames", 120);
+	if (numParticles < 1 || numFrames < 1)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR_COLOR, "BenchmarkParticles: particles and frames must be positive");
+		return false;
+	}
+
+	float const deltaSeconds = 1.f / 60.f;
+	float averageLifetime = 0.5f * (PARTICLE_BENCHMARK_MIN_LIFETIME + PARTICLE_BENCHMARK_MAX_LIFETIME);
+	int numPerFrame = (int)ceilf((float)numParticles * deltaSeconds / averageLifetime);
+	int numFillFrames = (int)ceilf(PARTICLE_BENCHMARK_MAX_LIFETIME / deltaSeconds);
+
+	ParticleSystem particles(numParticles);
+	ParticleBurst burst;
+	burst.m_positionSpread = Vec3(0.2f, 0.2f, 0.05f);
+	burst.m_velocity = Vec3(0.f, 0.f, 0.6f);
+	burst.m_velocitySpread = Vec3(0.8f, 0.8f, 0.4f);
+	burst.m_minLifetimeSeconds = PARTICLE_BENCHMARK_MIN_LIFETIME;
+	burst.m_maxLifetimeSeconds = PARTICLE_BENCHMARK_MAX_LIFETIME;
+	burst.m_color = Rgba8(150, 130, 100, 160);
+
+	BenchmarkRandom random;
+	std::vector<Vertex_PCU> streamRange(VERTEX_STREAM_DEFAULT_CAPACITY);
+	Vec3 cameraLeft(0.f, 1.f, 0.f);
+	Vec3 cameraUp(0.f, 0.f, 1.f);
+	double emitSeconds = 0.0;
+	double updateSeconds = 0.0;
+	double billboardSeconds = 0.0;
+	double worstSeconds = 0.0;
+	long long totalLive = 0;
+	int numRanges = 0;
+	int numDropped = 0;
+	int numHeapAllocations = 0;
+	for (int frameIndex = 0; frameIndex < numFillFrames + numFrames; frameIndex++)
+	{
+		bool isMeasured = frameIndex >= numFillFrames;
+		ScopedHeapAllocationCounter frameAllocations;
+		double emitStartSeconds = GetCurrentTimeSeconds();
+		for (int numEmitted = 0; numEmitted < numPerFrame; numEmitted += PARTICLE_BENCHMARK_BURST_SIZE)
+		{
+			burst.m_position = Vec3(random.GetInRange(-50.f, 50.f), random.GetInRange(-50.f, 50.f), 0.05f);
+			particles.Emit(burst, PARTICLE_BENCHMARK_BURST_SIZE);
+		}
+		double updateStartSeconds = GetCurrentTimeSeconds();
+		particles.Update(deltaSeconds);
+		double billboardStartSeconds = GetCurrentTimeSeconds();
+		int numLive = particles.GetNumLive();
+		int maxPerRange = VERTEX_STREAM_DEFAULT_CAPACITY / PARTICLE_NUM_VERTEXES;
+		for (int firstParticle = 0; firstParticle < numLive; firstParticle += maxPerRange)
+		{
+			int numInRange = numLive - firstParticle < maxPerRange ? numLive - firstParticle : maxPerRange;
+			VertexSpanWriter verts(streamRange.data(), VERTEX_STREAM_DEFAULT_CAPACITY);
+			particles.AddVertsForParticles(verts, firstParticle, numInRange, cameraLeft, cameraUp);
+			numRanges += isMeasured ? 1 : 0;
+		}
+		double endSeconds = GetCurrentTimeSeconds();
+		if (!isMeasured)
+		{
+			continue;
+		}
+
+		emitSeconds += updateStartSeconds - emitStartSeconds;
+		updateSeconds += billboardStartSeconds - updateStartSeconds;
+		billboardSeconds += endSeconds - billboardStartSeconds;
+		worstSeconds = endSeconds - emitStartSeconds > worstSeconds ? endSeconds - emitStartSeconds : worstSeconds;
+		totalLive += numLive;
+		numDropped += particles.GetStats().m_numDropped;
+		numHeapAllocations += frameAllocations.GetCount();
+	}
+
+	double averageLive = (double)totalLive / (double)numFrames;
+	double simulationMs = 1000.0 * (emitSeconds + updateSeconds) / (double)numFrames;
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Particles: %.0f live of %d, %d frames, emit + update avg %.2f ms (%.2f ns per particle), worst frame %.2f ms",
+		averageLive, numParticles, numFrames, simulationMs, 1000000.0 * simulationMs / averageLive, 1000.0 * worstSeconds));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  emit %.2f ms (%d per frame), update %.2f ms, billboards %.2f ms in %d stream range(s) per frame",
+		1000.0 * emitSeconds / (double)numFrames, numPerFrame, 1000.0 * updateSeconds / (double)numFrames, 1000.0 * billboardSeconds / (double)numFrames, numRanges / numFrames));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("  %d heap allocations and %d particles dropped once the pool had filled", numHeapAllocations, numDropped));
+	return true;
+}
@@ -0,0 +1,29 @@
+//-----------------------------------------------------------------------------------------------
+// GameBenchmarks.hpp
+//
+// Headless timing runs for game systems, exposed as dev console commands.
+// None of them touch the renderer, so results only measure the CPU work being benchmarked.
+//
+#pragma once
+
+#include "Engine/Core/EngineCommon.hpp"
+
+
+void RegisterGameBenchmarkCommands();
+void UnregisterGameBenchmarkCommands();
+
+bool Command_BenchmarkSpringArm(EventArgs& args);
+bool Command_BenchmarkCharacters(EventArgs& args);
+bool Command_BenchmarkAnimation(EventArgs& args);
+bool Command_BenchmarkBlendSpace(EventArgs& args);
+bool Command_BenchmarkMotionMatching(EventArgs& args);
+bool Command_BenchmarkAnimationLod(EventArgs& args);
+bool Command_BenchmarkSkinning(EventArgs& args);
+bool Command_BenchmarkCrowd(EventArgs& args);
+bool Command_BenchmarkFlowField(EventArgs& args);
+bool Command_BenchmarkSimdMath(EventArgs& args);
+bool Command_BenchmarkPropOrientation(EventArgs& args);
+bool Command_BenchmarkRings(EventArgs& args);
+bool Command_BenchmarkDebugLines(EventArgs& args);
+bool Command_BenchmarkPhysics(EventArgs& args);
+bool Command_BenchmarkParticles(EventArgs& args);
@@ -13,6 +13,12 @@ constexpr int TOTAL_NUM_KEYS = 255;
 constexpr float DEBUG_LINE_THICKNESS = 0.3f;
 constexpr float DEBUG_RING_THICKNESS = 0.3f;
 
+// player ground speeds; the locomotion blend space is laid out on these
+constexpr float MOVEMENT_SPEED = 4.f;
+constexpr float FAST_MOVEMENT_MULTIPLIER = 10.f;
+
+constexpr float WORLD_CAMERA_FOV_DEGREES = 60.f;
+
 
 const Vec2 SCREEN_BOTTOM_LEFT_ORTHO(0.f, 0.f);
 const Vec2 SCREEN_TOP_RIGHT_ORTHO(1600.f, 800.f);
@@ -20,7 +26,7 @@ const Vec2 SCREEN_TOP_RIGHT_ORTHO(1600.f, 800.f);
 const Vec2 WORLD_BOTTON_LEFT_ORTHO(-1.f, -1.f);
 const Vec2 WORLD_TOP_RIGHT_ORTHO(1.f, 1.f);
 
-// temporary game-code functions
+// screen-space debug lines for this frame, drawn together by g_debugLines
 void DebugDrawRing(const Vec2& center, float radius, float thickness, const Rgba8& color);
 void DebugDrawLine(const Vec2& startPoint, const Vec2& endPoint, float thickness, const Rgba8& color);
 
@@ -0,0 +1,69 @@
+#include "Game/HeapAllocationCounter.hpp"
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+
+static std::atomic<int> s_totalHeapAllocations(0);
+
+
+//-----------------------------------------------------------------------------------------------
+int GetTotalHeapAllocations()
+{
+	return s_totalHeapAllocations.load(std::memory_order_relaxed);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ScopedHeapAllocationCounter::ScopedHeapAllocationCounter() :
+	m_startCount(GetTotalHeapAllocations())
+{
+}
+
+int ScopedHeapAllocationCounter::GetCount() const
+{
+	return GetTotalHeapAllocations() - m_startCount;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Global allocation operator replacements; everything else (nothrow, sized delete) routes through these
+//
+void* operator new(size_t numBytes)
+{
+	s_totalHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	void* memory = malloc(numBytes > 0 ? numBytes : 1);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+void* operator new[](size_t numBytes)
+{
+	return operator new(numBytes);
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	free(memory);
+}
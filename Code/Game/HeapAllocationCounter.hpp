@@ -0,0 +1,24 @@
+//-----------------------------------------------------------------------------------------------
+// HeapAllocationCounter.hpp
+//
+// Counts every global operator new made by the game process so per-frame allocation work can be measured.
+//
+#pragma once
+
+
+int GetTotalHeapAllocations();
+
+
+//-----------------------------------------------------------------------------------------------
+// Counts heap allocations made between construction and GetCount()
+//
+class ScopedHeapAllocationCounter
+{
+public:
+	ScopedHeapAllocationCounter();
+
+	int GetCount() const;
+
+private:
+	int m_startCount = 0;
+};
@@ -0,0 +1,121 @@
+#include "Game/InputQueue.hpp"
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Input/InputSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+
+
+InputQueue* g_inputQueue = nullptr;
+
+
+//-----------------------------------------------------------------------------------------------
+void InputQueue::SampleInput()
+{
+	double nowSeconds = GetCurrentTimeSeconds();
+	for (int keyCode = 0; keyCode < NUM_INPUT_KEY_CODES; keyCode++)
+	{
+		bool isKeyDown = g_theInput->IsKeyDown((unsigned char)keyCode);
+		if (isKeyDown == m_wereKeysDown[keyCode])
+		{
+			continue;
+		}
+
+		InputEvent keyEvent;
+		keyEvent.m_type = isKeyDown ? INPUT_EVENT_KEY_PRESSED : INPUT_EVENT_KEY_RELEASED;
+		keyEvent.m_keyCode = (unsigned char)keyCode;
+		keyEvent.m_timeSeconds = nowSeconds;
+		m_events.push_back(keyEvent);
+		m_wereKeysDown[keyCode] = isKeyDown;
+	}
+
+	IntVec2 cursorDelta = g_theInput->GetCursorClientDelta();
+	if (cursorDelta.x != 0 || cursorDelta.y != 0)
+	{
+		InputEvent cursorEvent;
+		cursorEvent.m_type = INPUT_EVENT_CURSOR_MOVED;
+		cursorEvent.m_cursorDelta = cursorDelta;
+		cursorEvent.m_timeSeconds = nowSeconds;
+		m_events.push_back(cursorEvent);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+IntVec2 InputQueue::ConsumeCursorDelta()
+{
+	IntVec2 cursorDelta;
+	for (InputEvent& inputEvent : m_events)
+	{
+		if (inputEvent.m_type == INPUT_EVENT_CURSOR_MOVED && !inputEvent.m_isConsumed)
+		{
+			cursorDelta.x += inputEvent.m_cursorDelta.x;
+			cursorDelta.y += inputEvent.m_cursorDelta.y;
+			MarkConsumed(inputEvent);
+		}
+	}
+	return cursorDelta;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void InputQueue::ConsumeAllEvents()
+{
+	for (InputEvent& inputEvent : m_events)
+	{
+		if (!inputEvent.m_isConsumed)
+		{
+			MarkConsumed(inputEvent);
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void InputQueue::MarkConsumed(InputEvent& inputEvent)
+{
+	inputEvent.m_isConsumed = true;
+	if (m_oldestConsumedSeconds < 0.0 || inputEvent.m_timeSeconds < m_oldestConsumedSeconds)
+	{
+		m_oldestConsumedSeconds = inputEvent.m_timeSeconds;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void InputQueue::EndFrame(double submitSeconds)
+{
+	if (m_oldestConsumedSeconds >= 0.0)
+	{
+		m_latencyHistoryMs[m_nextLatencySample] = (float)(1000.0 * (submitSeconds - m_oldestConsumedSeconds));
+		m_nextLatencySample = (m_nextLatencySample + 1) % INPUT_LATENCY_HISTORY_FRAMES;
+		m_numLatencySamples = std::min(m_numLatencySamples + 1, INPUT_LATENCY_HISTORY_FRAMES);
+		UpdateLatencyStats();
+	}
+
+	m_events.clear();
+	m_oldestConsumedSeconds = -1.0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// nearest rank percentiles; the history is small enough to sort every frame that adds to it
+//
+void InputQueue::UpdateLatencyStats()
+{
+	m_sortedLatenciesMs.assign(m_latencyHistoryMs, m_latencyHistoryMs + m_numLatencySamples);
+	std::sort(m_sortedLatenciesMs.begin(), m_sortedLatenciesMs.end());
+
+	int lastIndex = m_numLatencySamples - 1;
+	auto getPercentile = [this, lastIndex](float fraction)
+	{
+		int sampleIndex = (int)(fraction * (float)lastIndex + 0.5f);
+		return m_sortedLatenciesMs[sampleIndex];
+	};
+
+	m_latencyStats.m_numSamples = m_numLatencySamples;
+	m_latencyStats.m_p50Ms = getPercentile(0.5f);
+	m_latencyStats.m_p95Ms = getPercentile(0.95f);
+	m_latencyStats.m_p99Ms = getPercentile(0.99f);
+	m_latencyStats.m_maxMs = m_sortedLatenciesMs[lastIndex];
+}
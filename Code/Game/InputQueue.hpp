@@ -0,0 +1,87 @@
+//-----------------------------------------------------------------------------------------------
+// InputQueue.hpp
+//
+// Timestamped input events for game code. The engine's InputSystem only reports current state,
+// refreshed when the window pumps its messages. Right after that pump the queue turns key changes
+// and cursor motion into events, each stamped with the time it was seen. Game code consumes them
+// where the input is used. The oldest event a frame consumed starts its input latency, and the
+// App ends it when the frame is submitted. Events nobody consumed are dropped at the end of the
+// frame, so look input does not pile up while the dev console is open.
+//
+#pragma once
+
+#include "Engine/Math/IntVec2.hpp"
+#include <vector>
+
+
+constexpr int NUM_INPUT_KEY_CODES = 256;
+constexpr int INPUT_LATENCY_HISTORY_FRAMES = 240;
+
+
+//-----------------------------------------------------------------------------------------------
+enum InputEventType
+{
+	INPUT_EVENT_KEY_PRESSED,
+	INPUT_EVENT_KEY_RELEASED,
+	INPUT_EVENT_CURSOR_MOVED,
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct InputEvent
+{
+	InputEventType	m_type = INPUT_EVENT_KEY_PRESSED;
+	unsigned char	m_keyCode = 0;
+	IntVec2			m_cursorDelta;
+	double			m_timeSeconds = 0.0;
+	bool			m_isConsumed = false;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// over the frames that consumed input in the last INPUT_LATENCY_HISTORY_FRAMES
+//
+struct InputLatencyStats
+{
+	int		m_numSamples = 0;
+	float	m_p50Ms = 0.f;
+	float	m_p95Ms = 0.f;
+	float	m_p99Ms = 0.f;
+	float	m_maxMs = 0.f;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class InputQueue
+{
+public:
+	void SampleInput();						// right after the window's message pump
+	void EndFrame(double submitSeconds);	// once the frame is submitted
+
+	// sum of unconsumed cursor motion
+	IntVec2 ConsumeCursorDelta();
+
+	// marks every unconsumed event as used by this frame without acting on it
+	void ConsumeAllEvents();
+
+	std::vector<InputEvent> const& GetEvents() const { return m_events; }
+	InputLatencyStats const& GetLatencyStats() const { return m_latencyStats; }
+
+private:
+	void MarkConsumed(InputEvent& inputEvent);
+	void UpdateLatencyStats();
+
+private:
+	std::vector<InputEvent>	m_events;
+	bool					m_wereKeysDown[NUM_INPUT_KEY_CODES] = {};
+	double					m_oldestConsumedSeconds = -1.0;		// -1 while this frame consumed nothing
+
+	float					m_latencyHistoryMs[INPUT_LATENCY_HISTORY_FRAMES] = {};
+	int						m_numLatencySamples = 0;
+	int						m_nextLatencySample = 0;
+	std::vector<float>		m_sortedLatenciesMs;
+	InputLatencyStats		m_latencyStats;
+};
+
+
+extern InputQueue* g_inputQueue;
@@ -0,0 +1,320 @@
+#include "Game/LocomotionAnimations.hpp"
+
+#include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+
+constexpr float LOCOMOTION_FRAMES_PER_SECOND = 60.f;
+constexpr float MOTION_DATABASE_PLAYBACK_RATES[] = { 0.8f, 1.f, 1.25f };
+constexpr float SKELETON_BONE_RADIUS = 0.035f;
+constexpr float SKIN_JOINT_BLEND_FRACTION = 0.25f;
+
+
+//-----------------------------------------------------------------------------------------------
+// Detail bones come after the core ones so animation LODs can drop them as a block
+//
+enum HumanoidBone
+{
+	BONE_PELVIS,
+	BONE_SPINE,
+	BONE_CHEST,
+	BONE_NECK,
+	BONE_HEAD,
+	BONE_LEFT_SHOULDER,
+	BONE_LEFT_ELBOW,
+	BONE_RIGHT_SHOULDER,
+	BONE_RIGHT_ELBOW,
+	BONE_LEFT_HIP,
+	BONE_LEFT_KNEE,
+	BONE_LEFT_ANKLE,
+	BONE_RIGHT_HIP,
+	BONE_RIGHT_KNEE,
+	BONE_RIGHT_ANKLE,
+	NUM_CORE_HUMANOID_BONES,
+
+	BONE_LEFT_HAND = NUM_CORE_HUMANOID_BONES,
+	BONE_RIGHT_HAND,
+	BONE_LEFT_TOE,
+	BONE_RIGHT_TOE,
+	NUM_HUMANOID_BONES
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Shape of one gait cycle; angles in degrees
+//
+struct GaitParameters
+{
+	char const*	m_name = "";
+	float		m_cycleSeconds = 1.f;
+	bool		m_isSideways = false;		// legs swing about X (strafe) instead of Y
+	bool		m_isReversed = false;		// play the cycle backwards: backpedal, strafe right
+	float		m_legSwing = 0.f;
+	float		m_kneeBend = 0.f;
+	float		m_armSwing = 0.f;
+	float		m_elbowBend = 0.f;
+	float		m_bobHeight = 0.f;
+	float		m_lean = 0.f;
+	float		m_twist = 0.f;
+	float		m_breathing = 0.f;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+static void CreateHumanoidSkeleton(Skeleton& skeleton)
+{
+	skeleton.AddBone("Pelvis",			-1,						Vec3(0.f, 0.f, 0.95f));
+	skeleton.AddBone("Spine",			BONE_PELVIS,			Vec3(0.f, 0.f, 0.15f));
+	skeleton.AddBone("Chest",			BONE_SPINE,				Vec3(0.f, 0.f, 0.25f));
+	skeleton.AddBone("Neck",			BONE_CHEST,				Vec3(0.f, 0.f, 0.2f));
+	skeleton.AddBone("Head",			BONE_NECK,				Vec3(0.f, 0.f, 0.12f));
+	skeleton.AddBone("LeftShoulder",	BONE_CHEST,				Vec3(0.f, 0.18f, 0.15f));
+	skeleton.AddBone("LeftElbow",		BONE_LEFT_SHOULDER,		Vec3(0.f, 0.f, -0.28f));
+	skeleton.AddBone("RightShoulder",	BONE_CHEST,				Vec3(0.f, -0.18f, 0.15f));
+	skeleton.AddBone("RightElbow",		BONE_RIGHT_SHOULDER,	Vec3(0.f, 0.f, -0.28f));
+	skeleton.AddBone("LeftHip",			BONE_PELVIS,			Vec3(0.f, 0.1f, -0.05f));
+	skeleton.AddBone("LeftKnee",		BONE_LEFT_HIP,			Vec3(0.f, 0.f, -0.42f));
+	skeleton.AddBone("LeftAnkle",		BONE_LEFT_KNEE,			Vec3(0.f, 0.f, -0.42f));
+	skeleton.AddBone("RightHip",		BONE_PELVIS,			Vec3(0.f, -0.1f, -0.05f));
+	skeleton.AddBone("RightKnee",		BONE_RIGHT_HIP,			Vec3(0.f, 0.f, -0.42f));
+	skeleton.AddBone("RightAnkle",		BONE_RIGHT_KNEE,		Vec3(0.f, 0.f, -0.42f));
+	skeleton.AddBone("LeftHand",		BONE_LEFT_ELBOW,		Vec3(0.f, 0.f, -0.26f));
+	skeleton.AddBone("RightHand",		BONE_RIGHT_ELBOW,		Vec3(0.f, 0.f, -0.26f));
+	skeleton.AddBone("LeftToe",			BONE_LEFT_ANKLE,		Vec3(0.14f, 0.f, -0.06f));
+	skeleton.AddBone("RightToe",		BONE_RIGHT_ANKLE,		Vec3(0.14f, 0.f, -0.06f));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static Quaternion MakeRotation(float pitchDegrees, float rollDegrees, float yawDegrees = 0.f)
+{
+	Quaternion yaw = Quaternion::MakeFromAxisAngleDegrees(Vec3(0.f, 0.f, 1.f), yawDegrees);
+	Quaternion pitch = Quaternion::MakeFromAxisAngleDegrees(Vec3(0.f, 1.f, 0.f), pitchDegrees);
+	Quaternion roll = Quaternion::MakeFromAxisAngleDegrees(Vec3(1.f, 0.f, 0.f), rollDegrees);
+	return yaw * pitch * roll;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// One frame of the cycle. Positive pitch swings a limb backwards, positive roll swings it to the left.
+//
+static void PoseGaitFrame(Skeleton const& skeleton, GaitParameters const& gait, float phase, SkeletonPose& out_pose)
+{
+	out_pose.SetToBindPose(skeleton);
+	float cycleDegrees = 360.f * (gait.m_isReversed ? 1.f - phase : phase);
+	float leftSwing = SinDegrees(cycleDegrees);
+	float rightSwing = -leftSwing;
+
+	// knees fold while their leg travels forward
+	float leftKnee = gait.m_kneeBend * GetClamped(CosDegrees(cycleDegrees), 0.f, 1.f) + 0.1f * gait.m_kneeBend;
+	float rightKnee = gait.m_kneeBend * GetClamped(-CosDegrees(cycleDegrees), 0.f, 1.f) + 0.1f * gait.m_kneeBend;
+
+	Vec3 pelvisTranslation = skeleton.GetBindTranslation(BONE_PELVIS);
+	pelvisTranslation.z += gait.m_bobHeight * (CosDegrees(2.f * cycleDegrees) - 1.f) * 0.5f;
+	out_pose.SetBone(BONE_PELVIS, MakeRotation(0.f, 0.f, gait.m_twist * leftSwing), pelvisTranslation);
+
+	float breath = gait.m_breathing * SinDegrees(cycleDegrees);
+	out_pose.SetBone(BONE_SPINE, MakeRotation(gait.m_lean * 0.5f, 0.f, -0.5f * gait.m_twist * leftSwing), skeleton.GetBindTranslation(BONE_SPINE));
+	out_pose.SetBone(BONE_CHEST, MakeRotation(gait.m_lean * 0.5f + breath, 0.f), skeleton.GetBindTranslation(BONE_CHEST));
+	out_pose.SetBone(BONE_NECK, MakeRotation(-gait.m_lean * 0.5f, 0.f), skeleton.GetBindTranslation(BONE_NECK));
+
+	// arms counter the opposite leg, hanging slightly away from the body
+	float elbowSwing = 0.25f * gait.m_elbowBend;
+	out_pose.SetBone(BONE_LEFT_SHOULDER, MakeRotation(gait.m_armSwing * leftSwing, 6.f), skeleton.GetBindTranslation(BONE_LEFT_SHOULDER));
+	out_pose.SetBone(BONE_LEFT_ELBOW, MakeRotation(-gait.m_elbowBend + elbowSwing * leftSwing, 0.f), skeleton.GetBindTranslation(BONE_LEFT_ELBOW));
+	out_pose.SetBone(BONE_RIGHT_SHOULDER, MakeRotation(gait.m_armSwing * rightSwing, -6.f), skeleton.GetBindTranslation(BONE_RIGHT_SHOULDER));
+	out_pose.SetBone(BONE_RIGHT_ELBOW, MakeRotation(-gait.m_elbowBend + elbowSwing * rightSwing, 0.f), skeleton.GetBindTranslation(BONE_RIGHT_ELBOW));
+
+	float leftHipPitch = gait.m_isSideways ? 0.f : -gait.m_legSwing * leftSwing;
+	float rightHipPitch = gait.m_isSideways ? 0.f : -gait.m_legSwing * rightSwing;
+	float leftHipRoll = gait.m_isSideways ? gait.m_legSwing * leftSwing : 0.f;
+	float rightHipRoll = gait.m_isSideways ? gait.m_legSwing * rightSwing : 0.f;
+	out_pose.SetBone(BONE_LEFT_HIP, MakeRotation(leftHipPitch - 0.5f * leftKnee, leftHipRoll), skeleton.GetBindTranslation(BONE_LEFT_HIP));
+	out_pose.SetBone(BONE_LEFT_KNEE, MakeRotation(leftKnee, 0.f), skeleton.GetBindTranslation(BONE_LEFT_KNEE));
+	out_pose.SetBone(BONE_LEFT_ANKLE, MakeRotation(-0.5f * (leftHipPitch + 0.5f * leftKnee), -leftHipRoll), skeleton.GetBindTranslation(BONE_LEFT_ANKLE));
+	out_pose.SetBone(BONE_RIGHT_HIP, MakeRotation(rightHipPitch - 0.5f * rightKnee, rightHipRoll), skeleton.GetBindTranslation(BONE_RIGHT_HIP));
+	out_pose.SetBone(BONE_RIGHT_KNEE, MakeRotation(rightKnee, 0.f), skeleton.GetBindTranslation(BONE_RIGHT_KNEE));
+	out_pose.SetBone(BONE_RIGHT_ANKLE, MakeRotation(-0.5f * (rightHipPitch + 0.5f * rightKnee), -rightHipRoll), skeleton.GetBindTranslation(BONE_RIGHT_ANKLE));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Ground speed the stride implies: a planted foot slides back by one stride over half a cycle
+//
+static float MeasureStrideSpeed(Skeleton const& skeleton, RawAnimationClip const& rawClip, float cycleSeconds, bool isSideways)
+{
+	std::vector<BoneMatrix> modelTransforms(skeleton.GetNumBones());
+	float minOffset = 0.f;
+	float maxOffset = 0.f;
+	for (int frameIndex = 0; frameIndex < (int)rawClip.m_frames.size(); frameIndex++)
+	{
+		ComputeModelTransforms(skeleton, rawClip.m_frames[frameIndex], modelTransforms.data());
+		Vec3 ankle = modelTransforms[BONE_LEFT_ANKLE].GetTranslation();
+		float offset = isSideways ? ankle.y : ankle.x;
+		minOffset = frameIndex == 0 || offset < minOffset ? offset : minOffset;
+		maxOffset = frameIndex == 0 || offset > maxOffset ? offset : maxOffset;
+	}
+
+	return (maxOffset - minOffset) / (0.5f * cycleSeconds);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void CreateGaitClip(Skeleton const& skeleton, GaitParameters const& gait, AnimationClip& out_clip, float& out_speed)
+{
+	RawAnimationClip rawClip;
+	rawClip.m_name = gait.m_name;
+	rawClip.m_framesPerSecond = LOCOMOTION_FRAMES_PER_SECOND;
+	rawClip.m_isLooping = true;
+
+	int numFrames = static_cast<int>(gait.m_cycleSeconds * LOCOMOTION_FRAMES_PER_SECOND + 0.5f);
+	rawClip.m_frames.resize(numFrames + 1);
+	for (int frameIndex = 0; frameIndex <= numFrames; frameIndex++)
+	{
+		float phase = static_cast<float>(frameIndex % numFrames) / static_cast<float>(numFrames);
+		PoseGaitFrame(skeleton, gait, phase, rawClip.m_frames[frameIndex]);
+	}
+
+	out_speed = gait.m_legSwing > 0.f ? MeasureStrideSpeed(skeleton, rawClip, gait.m_cycleSeconds, gait.m_isSideways) : 0.f;
+	out_clip.Compress(rawClip);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void CreateLocomotionAnimations(LocomotionAnimations& out_animations, float walkSpeed, float sprintSpeed)
+{
+	CreateHumanoidSkeleton(out_animations.m_skeleton);
+	out_animations.m_pelvisHeight = out_animations.m_skeleton.GetBindTranslation(BONE_PELVIS).z;
+	out_animations.m_numCoreBones = NUM_CORE_HUMANOID_BONES;
+
+	GaitParameters idle;
+	idle.m_name = "Idle";
+	idle.m_cycleSeconds = 3.f;
+	idle.m_armSwing = 2.f;
+	idle.m_elbowBend = 8.f;
+	idle.m_bobHeight = 0.005f;
+	idle.m_breathing = 2.f;
+
+	GaitParameters walk;
+	walk.m_name = "WalkForward";
+	walk.m_cycleSeconds = 1.f;
+	walk.m_legSwing = 25.f;
+	walk.m_kneeBend = 45.f;
+	walk.m_armSwing = 20.f;
+	walk.m_elbowBend = 15.f;
+	walk.m_bobHeight = 0.03f;
+	walk.m_lean = 3.f;
+	walk.m_twist = 6.f;
+
+	GaitParameters run = walk;
+	run.m_name = "RunForward";
+	run.m_cycleSeconds = 0.7f;
+	run.m_legSwing = 40.f;
+	run.m_kneeBend = 90.f;
+	run.m_armSwing = 45.f;
+	run.m_elbowBend = 80.f;
+	run.m_bobHeight = 0.06f;
+	run.m_lean = 12.f;
+	run.m_twist = 10.f;
+
+	GaitParameters walkBackward = walk;
+	walkBackward.m_name = "WalkBackward";
+	walkBackward.m_isReversed = true;
+	walkBackward.m_lean = -2.f;
+
+	GaitParameters strafeLeft = walk;
+	strafeLeft.m_name = "StrafeLeft";
+	strafeLeft.m_cycleSeconds = 0.9f;
+	strafeLeft.m_isSideways = true;
+	strafeLeft.m_legSwing = 18.f;
+	strafeLeft.m_kneeBend = 30.f;
+	strafeLeft.m_armSwing = 8.f;
+	strafeLeft.m_twist = 0.f;
+
+	GaitParameters strafeRight = strafeLeft;
+	strafeRight.m_name = "StrafeRight";
+	strafeRight.m_isReversed = true;
+
+	Skeleton const& skeleton = out_animations.m_skeleton;
+	CreateGaitClip(skeleton, idle, out_animations.m_clips[LOCOMOTION_CLIP_IDLE], out_animations.m_clipSpeeds[LOCOMOTION_CLIP_IDLE]);
+	CreateGaitClip(skeleton, walk, out_animations.m_clips[LOCOMOTION_CLIP_WALK_FORWARD], out_animations.m_clipSpeeds[LOCOMOTION_CLIP_WALK_FORWARD]);
+	CreateGaitClip(skeleton, run, out_animations.m_clips[LOCOMOTION_CLIP_RUN_FORWARD], out_animations.m_clipSpeeds[LOCOMOTION_CLIP_RUN_FORWARD]);
+	CreateGaitClip(skeleton, walkBackward, out_animations.m_clips[LOCOMOTION_CLIP_WALK_BACKWARD], out_animations.m_clipSpeeds[LOCOMOTION_CLIP_WALK_BACKWARD]);
+	CreateGaitClip(skeleton, strafeLeft, out_animations.m_clips[LOCOMOTION_CLIP_STRAFE_LEFT], out_animations.m_clipSpeeds[LOCOMOTION_CLIP_STRAFE_LEFT]);
+	CreateGaitClip(skeleton, strafeRight, out_animations.m_clips[LOCOMOTION_CLIP_STRAFE_RIGHT], out_animations.m_clipSpeeds[LOCOMOTION_CLIP_STRAFE_RIGHT]);
+
+	// walk speed on every side, running only straight ahead at sprint speed
+	Vec2* clipVelocities = out_animations.m_clipVelocities;
+	clipVelocities[LOCOMOTION_CLIP_IDLE] = Vec2(0.f, 0.f);
+	clipVelocities[LOCOMOTION_CLIP_WALK_FORWARD] = Vec2(walkSpeed, 0.f);
+	clipVelocities[LOCOMOTION_CLIP_RUN_FORWARD] = Vec2(sprintSpeed, 0.f);
+	clipVelocities[LOCOMOTION_CLIP_WALK_BACKWARD] = Vec2(-walkSpeed, 0.f);
+	clipVelocities[LOCOMOTION_CLIP_STRAFE_LEFT] = Vec2(0.f, walkSpeed);
+	clipVelocities[LOCOMOTION_CLIP_STRAFE_RIGHT] = Vec2(0.f, -walkSpeed);
+
+	BlendSpace2D& blendSpace = out_animations.m_blendSpace;
+	for (int clipIndex = 0; clipIndex < NUM_LOCOMOTION_CLIPS; clipIndex++)
+	{
+		blendSpace.AddSample(clipVelocities[clipIndex], clipIndex);
+	}
+	blendSpace.Build();
+
+	int numPlaybackRates = sizeof(MOTION_DATABASE_PLAYBACK_RATES) / sizeof(MOTION_DATABASE_PLAYBACK_RATES[0]);
+	BuildLocomotionMotionDatabase(out_animations, MOTION_DATABASE_PLAYBACK_RATES, numPlaybackRates, out_animations.m_motionDatabase);
+
+	CreateHumanoidSkinnedMesh(skeleton, out_animations.m_skinnedMesh);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void CreateHumanoidSkinnedMesh(Skeleton const& skeleton, SkinnedMesh& out_mesh)
+{
+	out_mesh.SetBindPose(skeleton);
+
+	SkeletonPose bindPose;
+	bindPose.SetToBindPose(skeleton);
+	std::vector<BoneMatrix> bindTransforms(skeleton.GetNumBones());
+	ComputeModelTransforms(skeleton, bindPose, bindTransforms.data());
+
+	// one cylinder from each parent joint to its child, bending with its neighbors near the joints
+	std::vector<Vertex_PCU> bindVerts;
+	for (int boneIndex = 0; boneIndex < skeleton.GetNumBones(); boneIndex++)
+	{
+		int parentIndex = skeleton.GetParentIndex(boneIndex);
+		if (parentIndex < 0)
+		{
+			continue;
+		}
+
+		Vec3 start = bindTransforms[parentIndex].GetTranslation();
+		Vec3 end = bindTransforms[boneIndex].GetTranslation();
+		bindVerts.clear();
+		AddVertsForCylinder3D(bindVerts, start, end, SKELETON_BONE_RADIUS, Rgba8(80, 120, 200), AABB2::ZERO_TO_ONE, 6);
+		out_mesh.AddLimbVerts(bindVerts, start, end, parentIndex, skeleton.GetParentIndex(parentIndex), boneIndex, SKIN_JOINT_BLEND_FRACTION);
+	}
+
+	// head, with a nose so facing is readable
+	BoneMatrix const& head = bindTransforms[BONE_HEAD];
+	bindVerts.clear();
+	AddVertsForSphere3D(bindVerts, head.TransformPosition(Vec3(0.f, 0.f, 0.1f)), 0.12f, Rgba8(230, 190, 150), AABB2::ZERO_TO_ONE, 8);
+	AddVertsForSphere3D(bindVerts, head.TransformPosition(Vec3(0.12f, 0.f, 0.1f)), 0.03f, Rgba8::RED, AABB2::ZERO_TO_ONE, 4);
+	out_mesh.AddRigidVerts(bindVerts, BONE_HEAD);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void BuildLocomotionMotionDatabase(LocomotionAnimations const& animations, float const* playbackRates, int numPlaybackRates, MotionDatabase& out_database)
+{
+	for (int clipIndex = 0; clipIndex < NUM_LOCOMOTION_CLIPS; clipIndex++)
+	{
+		// idle has no speed to vary
+		int numRates = clipIndex == LOCOMOTION_CLIP_IDLE ? 1 : numPlaybackRates;
+		for (int rateIndex = 0; rateIndex < numRates; rateIndex++)
+		{
+			float playbackRate = clipIndex == LOCOMOTION_CLIP_IDLE ? 1.f : playbackRates[rateIndex];
+			out_database.AddClip(clipIndex, animations.m_clipVelocities[clipIndex], playbackRate);
+		}
+	}
+	out_database.Build(animations.m_skeleton, animations.m_clips, BONE_LEFT_ANKLE, BONE_RIGHT_ANKLE, BONE_PELVIS);
+}
@@ -0,0 +1,62 @@
+//-----------------------------------------------------------------------------------------------
+// LocomotionAnimations.hpp
+//
+// The humanoid skeleton and its locomotion clips. There are no animation assets yet, so the
+// gait cycles are generated procedurally at a 60 fps capture rate and then compressed like authored clips.
+//
+#pragma once
+
+#include "Game/AnimationClip.hpp"
+#include "Game/BlendSpace2D.hpp"
+#include "Game/MotionDatabase.hpp"
+#include "Game/Skeleton.hpp"
+#include "Game/SkinnedMesh.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+enum LocomotionClip
+{
+	LOCOMOTION_CLIP_IDLE,
+	LOCOMOTION_CLIP_WALK_FORWARD,
+	LOCOMOTION_CLIP_RUN_FORWARD,
+	LOCOMOTION_CLIP_WALK_BACKWARD,
+	LOCOMOTION_CLIP_STRAFE_LEFT,
+	LOCOMOTION_CLIP_STRAFE_RIGHT,
+	NUM_LOCOMOTION_CLIPS
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct LocomotionAnimations
+{
+	Skeleton		m_skeleton;
+	AnimationClip	m_clips[NUM_LOCOMOTION_CLIPS];
+
+	// ground speed each clip's stride covers, in its own direction of travel (m/s)
+	float			m_clipSpeeds[NUM_LOCOMOTION_CLIPS] = {};
+
+	// player ground velocity each clip stands for (x forward, y left); both locomotion modes are laid out on these
+	Vec2			m_clipVelocities[NUM_LOCOMOTION_CLIPS];
+
+	// height of the pelvis above the feet in the bind pose
+	float			m_pelvisHeight = 0.f;
+
+	// bones animated at every LOD; the detail bones after them (hands, toes) can be dropped
+	int				m_numCoreBones = 0;
+
+	// laid out on local ground velocity: x forward, y left
+	BlendSpace2D	m_blendSpace;
+
+	// the same clips, searched by motion matching
+	MotionDatabase	m_motionDatabase;
+
+	// bone cylinders and a head, skinned to the skeleton on the CPU
+	SkinnedMesh		m_skinnedMesh;
+};
+
+
+void CreateLocomotionAnimations(LocomotionAnimations& out_animations, float walkSpeed, float sprintSpeed);
+void CreateHumanoidSkinnedMesh(Skeleton const& skeleton, SkinnedMesh& out_mesh);
+
+// every clip at every playback rate; more rates make a bigger database
+void BuildLocomotionMotionDatabase(LocomotionAnimations const& animations, float const* playbackRates, int numPlaybackRates, MotionDatabase& out_database);
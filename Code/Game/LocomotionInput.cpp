@@ -0,0 +1,35 @@
+#include "Game/LocomotionInput.hpp"
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Math/MathUtils.hpp"
+
+
+constexpr float GRAVITY = 9.8f;
+constexpr float JUMP_SPEED = 5.f;
+
+
+//-----------------------------------------------------------------------------------------------
+void ApplyLocomotionInput(LocomotionInput const& input, float yawDegrees, float deltaSeconds, Vec3& inout_velocity, bool& inout_isGrounded)
+{
+	// jump, only from the ground
+	if (inout_isGrounded && input.m_isJumping)
+	{
+		inout_velocity.z = JUMP_SPEED;
+		inout_isGrounded = false;
+	}
+	inout_velocity.z -= GRAVITY * deltaSeconds;
+
+	// ground directions only turn with yaw
+	Vec2 iForward(CosDegrees(yawDegrees), SinDegrees(yawDegrees));
+	Vec2 jLeft(-iForward.y, iForward.x);
+
+	float movementSpeed = MOVEMENT_SPEED;
+	if (input.m_isSprinting)
+	{
+		movementSpeed *= FAST_MOVEMENT_MULTIPLIER;
+	}
+
+	Vec2 horizontalVelocity = (iForward * input.m_moveIntentions.x + jLeft * input.m_moveIntentions.y) * movementSpeed;
+	inout_velocity.x = horizontalVelocity.x;
+	inout_velocity.y = horizontalVelocity.y;
+}
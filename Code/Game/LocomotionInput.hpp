@@ -0,0 +1,24 @@
+//-----------------------------------------------------------------------------------------------
+// LocomotionInput.hpp
+//
+// What a walking character wants to do this frame, independent of where it came from. The
+// Player fills it from the keyboard and crowd agents from their steering, and both then move
+// through the same ApplyLocomotionInput and CharacterController.
+//
+#pragma once
+
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+struct LocomotionInput
+{
+	Vec2	m_moveIntentions;			// x forward, y left, relative to the body's yaw; keys give -1, 0 or 1 per axis
+	bool	m_isSprinting = false;
+	bool	m_isJumping = false;
+};
+
+
+// sets horizontal velocity from the intentions, starts a jump from the ground, and applies gravity
+void ApplyLocomotionInput(LocomotionInput const& input, float yawDegrees, float deltaSeconds, Vec3& inout_velocity, bool& inout_isGrounded);
@@ -8,7 +8,7 @@
 // #include "Game/UnitTests_MP1A5.hpp"	// Uncomment this line after adding the MP1-A5 test code
 // #include "Game/UnitTests_MP1A6.hpp"	// Uncomment this line after adding the MP1-A6 test code
 // #include "Game/UnitTests_MP1A7.hpp"	// Uncomment this line after adding the MP1-A7 test code
-// #include "Game/UnitTests_Custom.hpp"	// Uncomment this line after adding the custom tests file
+#include "Game/UnitTests_Custom.hpp"
 #include "Game/GameCommon.hpp"
 #include <stdio.h>
 #include <stdlib.h>
@@ -24,7 +24,7 @@ void RunTestSets()
 // 	RunTests_MP1A5();	// Uncomment this line after adding the MP1-A5 test code
 // 	RunTests_MP1A6();	// Uncomment this line after adding the MP1-A6 test code
 // 	RunTests_MP1A7();	// Uncomment this line after adding the MP1-A7 test code
-//	RunTests_Custom();	// Uncomment this line after adding the custom tests file
+	RunTests_Custom();
 }
 
 
@@ -0,0 +1,138 @@
+#include "Game/MemoryArena.hpp"
+
+#include <stdlib.h>
+
+
+//-----------------------------------------------------------------------------------------------
+float MemoryArenaStats::GetFragmentation() const
+{
+	if (m_bytesReserved == 0)
+	{
+		return 0.f;
+	}
+
+	return static_cast<float>(m_bytesWasted) / static_cast<float>(m_bytesReserved);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+MemoryArena::MemoryArena(size_t blockSizeBytes) :
+	m_blockSizeBytes(blockSizeBytes)
+{
+}
+
+MemoryArena::~MemoryArena()
+{
+	ReleaseAll();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void* MemoryArena::Allocate(size_t numBytes, size_t alignment)
+{
+	if (numBytes == 0)
+	{
+		return nullptr;
+	}
+
+	// try the current block first, then any rewound block after it
+	while (m_currentBlockIndex >= 0 && m_currentBlockIndex < (int)m_blocks.size())
+	{
+		Block& block = m_blocks[m_currentBlockIndex];
+		size_t address = reinterpret_cast<size_t>(block.m_memory) + block.m_used;
+		size_t padding = (alignment - (address % alignment)) % alignment;
+		if (block.m_used + padding + numBytes <= block.m_size)
+		{
+			void* memory = block.m_memory + block.m_used + padding;
+			block.m_used += padding + numBytes;
+
+			m_numAllocations++;
+			m_bytesUsed += numBytes;
+			m_bytesPadding += padding;
+			return memory;
+		}
+
+		if (m_currentBlockIndex + 1 >= (int)m_blocks.size())
+		{
+			break;
+		}
+		m_currentBlockIndex++;
+	}
+
+	AddBlock(numBytes + alignment);
+	return Allocate(numBytes, alignment);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void MemoryArena::AddBlock(size_t minSizeBytes)
+{
+	Block block;
+	block.m_size = minSizeBytes > m_blockSizeBytes ? minSizeBytes : m_blockSizeBytes;
+	block.m_memory = static_cast<unsigned char*>(malloc(block.m_size));
+	if (block.m_memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	m_blocks.push_back(block);
+	m_currentBlockIndex = (int)m_blocks.size() - 1;
+	m_numHeapAllocations++;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void MemoryArena::Reset()
+{
+	for (int blockIndex = 0; blockIndex < (int)m_blocks.size(); blockIndex++)
+	{
+		m_blocks[blockIndex].m_used = 0;
+	}
+
+	m_currentBlockIndex = m_blocks.empty() ? -1 : 0;
+	m_numAllocations = 0;
+	m_bytesUsed = 0;
+	m_bytesPadding = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void MemoryArena::ReleaseAll()
+{
+	for (int blockIndex = 0; blockIndex < (int)m_blocks.size(); blockIndex++)
+	{
+		free(m_blocks[blockIndex].m_memory);
+	}
+
+	m_blocks.clear();
+	m_currentBlockIndex = -1;
+	m_numAllocations = 0;
+	m_bytesUsed = 0;
+	m_bytesPadding = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+MemoryArenaStats MemoryArena::GetStats() const
+{
+	MemoryArenaStats stats;
+	stats.m_numAllocations = m_numAllocations;
+	stats.m_numBlocks = (int)m_blocks.size();
+	stats.m_numHeapAllocations = m_numHeapAllocations;
+	stats.m_bytesUsed = m_bytesUsed;
+	stats.m_bytesWasted = m_bytesPadding;
+
+	// tails of blocks we already moved past can never be filled again until a reset
+	for (int blockIndex = 0; blockIndex < m_currentBlockIndex; blockIndex++)
+	{
+		Block const& block = m_blocks[blockIndex];
+		stats.m_bytesWasted += block.m_size - block.m_used;
+	}
+
+	for (int blockIndex = 0; blockIndex < (int)m_blocks.size(); blockIndex++)
+	{
+		stats.m_bytesReserved += m_blocks[blockIndex].m_size;
+	}
+
+	return stats;
+}
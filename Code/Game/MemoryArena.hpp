@@ -0,0 +1,206 @@
+//-----------------------------------------------------------------------------------------------
+// MemoryArena.hpp
+//
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+
+constexpr size_t DEFAULT_ARENA_BLOCK_SIZE = 64 * 1024;
+
+
+//-----------------------------------------------------------------------------------------------
+struct MemoryArenaStats
+{
+	int		m_numAllocations = 0;		// Allocate() calls served since the last reset
+	int		m_numBlocks = 0;			// blocks currently held; each one is a single heap allocation
+	int		m_numHeapAllocations = 0;	// blocks ever requested from the heap by this arena
+	size_t	m_bytesUsed = 0;			// bytes handed out to callers
+	size_t	m_bytesWasted = 0;			// alignment padding + unusable tails of filled blocks
+	size_t	m_bytesReserved = 0;		// total size of all blocks
+
+	float GetFragmentation() const;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Bump allocator that carves allocations out of large blocks.
+// Individual allocations are never freed; the whole arena is rewound (Reset) or released at once.
+//
+class MemoryArena
+{
+public:
+	explicit MemoryArena(size_t blockSizeBytes = DEFAULT_ARENA_BLOCK_SIZE);
+	~MemoryArena();
+
+	MemoryArena(MemoryArena const&) = delete;
+	MemoryArena& operator=(MemoryArena const&) = delete;
+
+	void* Allocate(size_t numBytes, size_t alignment = alignof(std::max_align_t));
+
+	template<typename T>
+	T* AllocateArray(int count);
+
+	void Reset();		// rewinds all blocks, keeps the memory for reuse
+	void ReleaseAll();	// returns every block to the heap
+
+	MemoryArenaStats GetStats() const;
+
+private:
+	struct Block
+	{
+		unsigned char*	m_memory = nullptr;
+		size_t			m_size = 0;
+		size_t			m_used = 0;
+	};
+
+	void AddBlock(size_t minSizeBytes);
+
+private:
+	std::vector<Block>	m_blocks;
+	int					m_currentBlockIndex = -1;
+	size_t				m_blockSizeBytes = DEFAULT_ARENA_BLOCK_SIZE;
+
+	int					m_numAllocations = 0;
+	int					m_numHeapAllocations = 0;
+	size_t				m_bytesUsed = 0;
+	size_t				m_bytesPadding = 0;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+template<typename T>
+T* MemoryArena::AllocateArray(int count)
+{
+	if (count <= 0)
+	{
+		return nullptr;
+	}
+
+	return static_cast<T*>(Allocate(sizeof(T) * static_cast<size_t>(count), alignof(T)));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Fixed-size chunks of T carved from a MemoryArena.
+// Objects of one type sit next to each other, and their addresses never move once created.
+//
+template<typename T>
+class EntityPool
+{
+public:
+	EntityPool(MemoryArena& arena, int numPerChunk);
+	~EntityPool();
+
+	EntityPool(EntityPool const&) = delete;
+	EntityPool& operator=(EntityPool const&) = delete;
+
+	template<typename... Args>
+	T* Create(Args&&... args);
+
+	void DestroyAll();
+
+	int GetCount() const { return m_count; }
+
+	template<typename Function>
+	void ForEach(Function&& function);
+
+	template<typename Function>
+	void ForEach(Function&& function) const;
+
+private:
+	MemoryArena&	m_arena;
+	std::vector<T*>	m_chunks;
+	int				m_numPerChunk = 0;
+	int				m_count = 0;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+template<typename T>
+EntityPool<T>::EntityPool(MemoryArena& arena, int numPerChunk) :
+	m_arena(arena),
+	m_numPerChunk(numPerChunk > 0 ? numPerChunk : 1)
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template<typename T>
+EntityPool<T>::~EntityPool()
+{
+	DestroyAll();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template<typename T>
+template<typename... Args>
+T* EntityPool<T>::Create(Args&&... args)
+{
+	int chunkIndex = m_count / m_numPerChunk;
+	int indexInChunk = m_count % m_numPerChunk;
+	if (chunkIndex == (int)m_chunks.size())
+	{
+		m_chunks.push_back(m_arena.AllocateArray<T>(m_numPerChunk));
+	}
+
+	T* object = new (&m_chunks[chunkIndex][indexInChunk]) T(std::forward<Args>(args)...);
+	m_count++;
+
+	return object;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Runs destructors only; the chunk memory goes back with the arena
+//
+template<typename T>
+void EntityPool<T>::DestroyAll()
+{
+	ForEach([](T& object) { object.~T(); });
+
+	m_chunks.clear();
+	m_count = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template<typename T>
+template<typename Function>
+void EntityPool<T>::ForEach(Function&& function)
+{
+	int remaining = m_count;
+	for (int chunkIndex = 0; chunkIndex < (int)m_chunks.size(); chunkIndex++)
+	{
+		T* chunk = m_chunks[chunkIndex];
+		int numInChunk = remaining < m_numPerChunk ? remaining : m_numPerChunk;
+		for (int index = 0; index < numInChunk; index++)
+		{
+			function(chunk[index]);
+		}
+		remaining -= numInChunk;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template<typename T>
+template<typename Function>
+void EntityPool<T>::ForEach(Function&& function) const
+{
+	int remaining = m_count;
+	for (int chunkIndex = 0; chunkIndex < (int)m_chunks.size(); chunkIndex++)
+	{
+		T const* chunk = m_chunks[chunkIndex];
+		int numInChunk = remaining < m_numPerChunk ? remaining : m_numPerChunk;
+		for (int index = 0; index < numInChunk; index++)
+		{
+			function(chunk[index]);
+		}
+		remaining -= numInChunk;
+	}
+}
@@ -0,0 +1,476 @@
+#include "Game/MotionDatabase.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <xmmintrin.h>
+
+
+constexpr float MOTION_ROWS_PER_SECOND = 30.f;
+constexpr float MOTION_TRAJECTORY_SECONDS[MOTION_TRAJECTORY_POINTS] = { 0.33f, 0.67f, 1.f };
+constexpr float MOTION_VELOCITY_SAMPLE_SECONDS = 1.f / 60.f;
+constexpr float MOTION_QUERY_VELOCITY_HALF_LIFE = 0.15f;
+constexpr int MOTION_SMALL_BLOCK_ROWS = 16;
+constexpr int MOTION_LARGE_BLOCK_ROWS = 64;
+constexpr int MAX_MOTION_LARGE_BLOCKS = 1024;
+constexpr int MOTION_SAME_MOTION_ROWS = 2;			// a best match this close ahead of the playing row is the playing row
+
+// feature layout
+constexpr int FEATURE_TRAJECTORY = 0;				// xy at each trajectory time
+constexpr int FEATURE_FOOT_POSITIONS = 6;			// left xyz, right xyz, model space
+constexpr int FEATURE_FOOT_VELOCITIES = 12;
+constexpr int FEATURE_HIP_VELOCITY = 18;
+
+// relative importance of each group once normalized
+struct FeatureGroup
+{
+	int		m_first;
+	int		m_count;
+	float	m_weight;
+};
+constexpr FeatureGroup FEATURE_GROUPS[] =
+{
+	{ FEATURE_TRAJECTORY,		6,	1.f },
+	{ FEATURE_FOOT_POSITIONS,	6,	0.75f },
+	{ FEATURE_FOOT_VELOCITIES,	6,	1.f },
+	{ FEATURE_HIP_VELOCITY,		3,	1.f },
+};
+
+
+//-----------------------------------------------------------------------------------------------
+static inline float GetHorizontalSum(__m128 value)
+{
+	__m128 shuffled = _mm_movehl_ps(value, value);
+	__m128 sums = _mm_add_ps(value, shuffled);
+	shuffled = _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 1, 1, 1));
+	return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Squared distance from the query to the closest point of a feature-space box; a lower bound
+// for every row inside it
+//
+static inline float GetBoxDistanceSquared(float const* query, float const* boxMins, float const* boxMaxs)
+{
+	__m128 const zero = _mm_setzero_ps();
+	__m128 sum = _mm_setzero_ps();
+	for (int featureIndex = 0; featureIndex < MOTION_FEATURE_STRIDE; featureIndex += 4)
+	{
+		__m128 value = _mm_loadu_ps(query + featureIndex);
+		__m128 below = _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(boxMins + featureIndex), value), zero);
+		__m128 above = _mm_max_ps(_mm_sub_ps(value, _mm_loadu_ps(boxMaxs + featureIndex)), zero);
+		__m128 outside = _mm_add_ps(below, above);
+		sum = _mm_add_ps(sum, _mm_mul_ps(outside, outside));
+	}
+	return GetHorizontalSum(sum);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static inline __m128 GetSquaredDifferences(float const* query, float const* features, int featureIndex)
+{
+	__m128 difference = _mm_sub_ps(_mm_loadu_ps(query + featureIndex), _mm_loadu_ps(features + featureIndex));
+	return _mm_mul_ps(difference, difference);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void MotionDatabase::AddClip(int clipIndex, Vec2 const& rootVelocity, float playbackRate)
+{
+	GUARANTEE_OR_DIE(playbackRate > 0.f, "Motion database playback rates must be positive");
+
+	ClipRange range;
+	range.m_clipIndex = clipIndex;
+	range.m_rootVelocity = rootVelocity;
+	range.m_playbackRate = playbackRate;
+	m_ranges.push_back(range);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void MotionDatabase::Build(Skeleton const& skeleton, AnimationClip const* clips, int leftFootBone, int rightFootBone, int hipBone)
+{
+	GUARANTEE_OR_DIE(!m_ranges.empty(), "Motion database has no clips");
+
+	m_sampleSeconds = 1.f / MOTION_ROWS_PER_SECOND;
+	m_rows.clear();
+	for (int rangeIndex = 0; rangeIndex < (int)m_ranges.size(); rangeIndex++)
+	{
+		ClipRange& range = m_ranges[rangeIndex];
+		AnimationClip const& clip = clips[range.m_clipIndex];
+		float clipSecondsPerRow = m_sampleSeconds * range.m_playbackRate;
+
+		// a looping clip's end is its start again, so it gets no row of its own
+		range.m_firstRow = (int)m_rows.size();
+		range.m_numRows = static_cast<int>(clip.GetDuration() / clipSecondsPerRow) + (clip.IsLooping() ? 0 : 1);
+		range.m_numRows = range.m_numRows < 1 ? 1 : range.m_numRows;
+		for (int rowIndex = 0; rowIndex < range.m_numRows; rowIndex++)
+		{
+			Row row;
+			row.m_rangeIndex = rangeIndex;
+			row.m_clipSeconds = static_cast<float>(rowIndex) * clipSecondsPerRow;
+			if (rowIndex + 1 < range.m_numRows)
+			{
+				row.m_nextRow = range.m_firstRow + rowIndex + 1;
+			}
+			else
+			{
+				row.m_nextRow = clip.IsLooping() ? range.m_firstRow : range.m_firstRow + rowIndex;
+			}
+			m_rows.push_back(row);
+		}
+	}
+
+	// raw features
+	int numRows = (int)m_rows.size();
+	m_features.assign(numRows * MOTION_FEATURE_STRIDE, 0.f);
+	SkeletonPose pose(skeleton.GetNumBones());
+	SkeletonPose nextPose(skeleton.GetNumBones());
+	std::vector<BoneMatrix> modelTransforms(skeleton.GetNumBones());
+	std::vector<BoneMatrix> nextModelTransforms(skeleton.GetNumBones());
+	int const featureBones[3] = { leftFootBone, rightFootBone, hipBone };
+	for (int rowIndex = 0; rowIndex < numRows; rowIndex++)
+	{
+		Row const& row = m_rows[rowIndex];
+		ClipRange const& range = m_ranges[row.m_rangeIndex];
+		AnimationClip const& clip = clips[range.m_clipIndex];
+		float* features = &m_features[rowIndex * MOTION_FEATURE_STRIDE];
+
+		Vec2 rootVelocity = range.m_rootVelocity * range.m_playbackRate;
+		for (int pointIndex = 0; pointIndex < MOTION_TRAJECTORY_POINTS; pointIndex++)
+		{
+			features[FEATURE_TRAJECTORY + 2 * pointIndex + 0] = rootVelocity.x * MOTION_TRAJECTORY_SECONDS[pointIndex];
+			features[FEATURE_TRAJECTORY + 2 * pointIndex + 1] = rootVelocity.y * MOTION_TRAJECTORY_SECONDS[pointIndex];
+		}
+
+		// velocities in playback time, so faster variants of a clip really are faster
+		clip.Sample(row.m_clipSeconds, pose);
+		clip.Sample(row.m_clipSeconds + MOTION_VELOCITY_SAMPLE_SECONDS, nextPose);
+		ComputeModelTransforms(skeleton, pose, modelTransforms.data());
+		ComputeModelTransforms(skeleton, nextPose, nextModelTransforms.data());
+		float velocityScale = range.m_playbackRate / MOTION_VELOCITY_SAMPLE_SECONDS;
+		for (int boneSlot = 0; boneSlot < 3; boneSlot++)
+		{
+			Vec3 position = modelTransforms[featureBones[boneSlot]].GetTranslation();
+			Vec3 velocity = (nextModelTransforms[featureBones[boneSlot]].GetTranslation() - position) * velocityScale;
+			if (boneSlot < 2)
+			{
+				float* footPosition = features + FEATURE_FOOT_POSITIONS + 3 * boneSlot;
+				float* footVelocity = features + FEATURE_FOOT_VELOCITIES + 3 * boneSlot;
+				footPosition[0] = position.x;
+				footPosition[1] = position.y;
+				footPosition[2] = position.z;
+				footVelocity[0] = velocity.x;
+				footVelocity[1] = velocity.y;
+				footVelocity[2] = velocity.z;
+			}
+			else
+			{
+				features[FEATURE_HIP_VELOCITY + 0] = velocity.x;
+				features[FEATURE_HIP_VELOCITY + 1] = velocity.y;
+				features[FEATURE_HIP_VELOCITY + 2] = velocity.z;
+			}
+		}
+	}
+
+	GUARANTEE_OR_DIE(numRows <= MAX_MOTION_LARGE_BLOCKS * MOTION_LARGE_BLOCK_ROWS, "Motion database is too big to search");
+	NormalizeFeatures();
+	BuildBlocks(MOTION_SMALL_BLOCK_ROWS, m_smallBlockMins, m_smallBlockMaxs);
+	BuildBlocks(MOTION_LARGE_BLOCK_ROWS, m_largeBlockMins, m_largeBlockMaxs);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Zero mean per feature, one shared deviation per group so a group's axes keep their proportions,
+// then the group weight folded into the scale; the search is plain squared distance afterwards
+//
+void MotionDatabase::NormalizeFeatures()
+{
+	int numRows = (int)m_rows.size();
+	for (int featureIndex = 0; featureIndex < MOTION_FEATURE_STRIDE; featureIndex++)
+	{
+		m_featureOffsets[featureIndex] = 0.f;
+		m_featureScales[featureIndex] = 0.f;
+	}
+
+	for (FeatureGroup const& group : FEATURE_GROUPS)
+	{
+		float variance = 0.f;
+		for (int featureIndex = group.m_first; featureIndex < group.m_first + group.m_count; featureIndex++)
+		{
+			float mean = 0.f;
+			for (int rowIndex = 0; rowIndex < numRows; rowIndex++)
+			{
+				mean += m_features[rowIndex * MOTION_FEATURE_STRIDE + featureIndex];
+			}
+			mean /= static_cast<float>(numRows);
+
+			for (int rowIndex = 0; rowIndex < numRows; rowIndex++)
+			{
+				float deviation = m_features[rowIndex * MOTION_FEATURE_STRIDE + featureIndex] - mean;
+				variance += deviation * deviation;
+			}
+			m_featureOffsets[featureIndex] = mean;
+		}
+
+		float deviation = sqrtf(variance / static_cast<float>(numRows * group.m_count));
+		float scale = deviation > 1.0e-5f ? group.m_weight / deviation : group.m_weight;
+		for (int featureIndex = group.m_first; featureIndex < group.m_first + group.m_count; featureIndex++)
+		{
+			m_featureScales[featureIndex] = scale;
+		}
+	}
+
+	for (int rowIndex = 0; rowIndex < numRows; rowIndex++)
+	{
+		float* features = &m_features[rowIndex * MOTION_FEATURE_STRIDE];
+		for (int featureIndex = 0; featureIndex < MOTION_FEATURE_STRIDE; featureIndex++)
+		{
+			features[featureIndex] = (features[featureIndex] - m_featureOffsets[featureIndex]) * m_featureScales[featureIndex];
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void MotionDatabase::BuildBlocks(int blockSize, std::vector<float>& out_mins, std::vector<float>& out_maxs) const
+{
+	int numRows = (int)m_rows.size();
+	int numBlocks = (numRows + blockSize - 1) / blockSize;
+	out_mins.assign(numBlocks * MOTION_FEATURE_STRIDE, FLT_MAX);
+	out_maxs.assign(numBlocks * MOTION_FEATURE_STRIDE, -FLT_MAX);
+	for (int rowIndex = 0; rowIndex < numRows; rowIndex++)
+	{
+		float const* features = GetRowFeatures(rowIndex);
+		float* mins = &out_mins[(rowIndex / blockSize) * MOTION_FEATURE_STRIDE];
+		float* maxs = &out_maxs[(rowIndex / blockSize) * MOTION_FEATURE_STRIDE];
+		for (int featureIndex = 0; featureIndex < MOTION_FEATURE_STRIDE; featureIndex++)
+		{
+			mins[featureIndex] = features[featureIndex] < mins[featureIndex] ? features[featureIndex] : mins[featureIndex];
+			maxs[featureIndex] = features[featureIndex] > maxs[featureIndex] ? features[featureIndex] : maxs[featureIndex];
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The future trajectory eases from the current velocity toward the desired one, like a damper
+// with MOTION_QUERY_VELOCITY_HALF_LIFE; integrated exactly at each trajectory time
+//
+void MotionDatabase::BuildQuery(Vec2 const& currentVelocity, Vec2 const& desiredVelocity, int currentRow, float* out_query) const
+{
+	float const rate = 0.69314718f / MOTION_QUERY_VELOCITY_HALF_LIFE;
+	Vec2 velocityGap = currentVelocity - desiredVelocity;
+	for (int pointIndex = 0; pointIndex < MOTION_TRAJECTORY_POINTS; pointIndex++)
+	{
+		float seconds = MOTION_TRAJECTORY_SECONDS[pointIndex];
+		Vec2 position = desiredVelocity * seconds + velocityGap * ((1.f - expf(-rate * seconds)) / rate);
+		int featureIndex = FEATURE_TRAJECTORY + 2 * pointIndex;
+		out_query[featureIndex + 0] = (position.x - m_featureOffsets[featureIndex + 0]) * m_featureScales[featureIndex + 0];
+		out_query[featureIndex + 1] = (position.y - m_featureOffsets[featureIndex + 1]) * m_featureScales[featureIndex + 1];
+	}
+
+	// the pose half asks for continuity with what is playing; before anything plays, the average pose
+	for (int featureIndex = FEATURE_FOOT_POSITIONS; featureIndex < MOTION_FEATURE_STRIDE; featureIndex++)
+	{
+		out_query[featureIndex] = currentRow >= 0 ? GetRowFeatures(currentRow)[featureIndex] : 0.f;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+float MotionDatabase::GetDistanceSquared(float const* query, int row) const
+{
+	float const* features = GetRowFeatures(row);
+	__m128 sum = _mm_setzero_ps();
+	for (int featureIndex = 0; featureIndex < MOTION_FEATURE_STRIDE; featureIndex += 4)
+	{
+		sum = _mm_add_ps(sum, GetSquaredDifferences(query, features, featureIndex));
+	}
+	return GetHorizontalSum(sum);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int MotionDatabase::SearchBruteForce(float const* query, float& out_distanceSquared) const
+{
+	int bestRow = -1;
+	out_distanceSquared = FLT_MAX;
+	for (int rowIndex = 0; rowIndex < (int)m_rows.size(); rowIndex++)
+	{
+		float distanceSquared = GetDistanceSquared(query, rowIndex);
+		if (distanceSquared < out_distanceSquared)
+		{
+			out_distanceSquared = distanceSquared;
+			bestRow = rowIndex;
+		}
+	}
+	return bestRow;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Large blocks, then small blocks, then rows; anything whose lower bound (inflated by the
+// tolerance) can't beat the best so far is skipped. Rows bail out after the trajectory and
+// foot positions when those alone are already too far.
+//
+int MotionDatabase::Search(float const* query, float tolerance, float& out_distanceSquared, MotionSearchStats* out_stats) const
+{
+	float const pruneScale = (1.f + tolerance) * (1.f + tolerance);
+	int const numLargeBlocks = (int)m_largeBlockMins.size() / MOTION_FEATURE_STRIDE;
+
+	// visit large blocks nearest first, so a good match is found early and prunes the rest
+	float largeBounds[MAX_MOTION_LARGE_BLOCKS];
+	int largeOrder[MAX_MOTION_LARGE_BLOCKS];
+	for (int largeIndex = 0; largeIndex < numLargeBlocks; largeIndex++)
+	{
+		largeBounds[largeIndex] = GetBoxDistanceSquared(query, &m_largeBlockMins[largeIndex * MOTION_FEATURE_STRIDE], &m_largeBlockMaxs[largeIndex * MOTION_FEATURE_STRIDE]);
+		largeOrder[largeIndex] = largeIndex;
+	}
+	std::sort(largeOrder, largeOrder + numLargeBlocks, [&largeBounds](int a, int b) { return largeBounds[a] < largeBounds[b]; });
+
+	int bestRow = -1;
+	float best = FLT_MAX;
+	MotionSearchStats stats;
+	stats.m_blocksTested = numLargeBlocks;
+	for (int orderIndex = 0; orderIndex < numLargeBlocks; orderIndex++)
+	{
+		int largeIndex = largeOrder[orderIndex];
+		if (largeBounds[largeIndex] * pruneScale >= best)
+		{
+			break;
+		}
+
+		SearchLargeBlock(query, largeIndex, pruneScale, best, bestRow, stats);
+	}
+
+	out_distanceSquared = best;
+	if (out_stats)
+	{
+		*out_stats = stats;
+	}
+	return bestRow;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void MotionDatabase::SearchLargeBlock(float const* query, int largeIndex, float pruneScale, float& inout_best, int& inout_bestRow, MotionSearchStats& stats) const
+{
+	int const numRows = (int)m_rows.size();
+	int const smallBlocksPerLarge = MOTION_LARGE_BLOCK_ROWS / MOTION_SMALL_BLOCK_ROWS;
+	int const numSmallBlocks = (int)m_smallBlockMins.size() / MOTION_FEATURE_STRIDE;
+
+	int smallEnd = (largeIndex + 1) * smallBlocksPerLarge;
+	smallEnd = smallEnd < numSmallBlocks ? smallEnd : numSmallBlocks;
+	for (int smallIndex = largeIndex * smallBlocksPerLarge; smallIndex < smallEnd; smallIndex++)
+	{
+		stats.m_blocksTested++;
+		float smallBound = GetBoxDistanceSquared(query, &m_smallBlockMins[smallIndex * MOTION_FEATURE_STRIDE], &m_smallBlockMaxs[smallIndex * MOTION_FEATURE_STRIDE]);
+		if (smallBound * pruneScale >= inout_best)
+		{
+			continue;
+		}
+
+		int rowEnd = (smallIndex + 1) * MOTION_SMALL_BLOCK_ROWS;
+		rowEnd = rowEnd < numRows ? rowEnd : numRows;
+		for (int rowIndex = smallIndex * MOTION_SMALL_BLOCK_ROWS; rowIndex < rowEnd; rowIndex++)
+		{
+			stats.m_rowsTested++;
+			float const* features = GetRowFeatures(rowIndex);
+			__m128 sum = _mm_add_ps(GetSquaredDifferences(query, features, 0), GetSquaredDifferences(query, features, 4));
+			sum = _mm_add_ps(sum, GetSquaredDifferences(query, features, 8));
+			if (GetHorizontalSum(sum) * pruneScale >= inout_best)
+			{
+				continue;
+			}
+
+			sum = _mm_add_ps(sum, GetSquaredDifferences(query, features, 12));
+			sum = _mm_add_ps(sum, GetSquaredDifferences(query, features, 16));
+			sum = _mm_add_ps(sum, GetSquaredDifferences(query, features, 20));
+			float distanceSquared = GetHorizontalSum(sum);
+			if (distanceSquared < inout_best)
+			{
+				inout_best = distanceSquared;
+				inout_bestRow = rowIndex;
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void MotionDatabase::SampleRow(int row, float rowSeconds, AnimationClip const* clips, SkeletonPose& out_pose) const
+{
+	ClipRange const& range = m_ranges[m_rows[row].m_rangeIndex];
+	clips[range.m_clipIndex].Sample(m_rows[row].m_clipSeconds + rowSeconds * range.m_playbackRate, out_pose);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void MotionDatabase::EvaluatePose(Vec2 const& currentVelocity, Vec2 const& desiredVelocity, float deltaSeconds, AnimationClip const* clips,
+	MotionMatchingSettings const& settings, MotionMatchingState& state, SkeletonPose& scratchPose, SkeletonPose& out_pose) const
+{
+	// keep playing forward through the database
+	if (state.m_row >= 0)
+	{
+		state.m_rowSeconds += deltaSeconds;
+		while (state.m_rowSeconds >= m_sampleSeconds)
+		{
+			state.m_rowSeconds -= m_sampleSeconds;
+			state.m_row = m_rows[state.m_row].m_nextRow;
+		}
+	}
+	if (state.m_transitionSeconds > 0.f)
+	{
+		state.m_transitionSeconds -= deltaSeconds;
+		state.m_previousRowSeconds += deltaSeconds;
+		while (state.m_previousRowSeconds >= m_sampleSeconds)
+		{
+			state.m_previousRowSeconds -= m_sampleSeconds;
+			state.m_previousRow = m_rows[state.m_previousRow].m_nextRow;
+		}
+	}
+
+	state.m_secondsSinceSearch += deltaSeconds;
+	if (state.m_row < 0 || state.m_secondsSinceSearch >= settings.m_searchInterval)
+	{
+		state.m_secondsSinceSearch = 0.f;
+		state.m_numSearches++;
+
+		float query[MOTION_FEATURE_STRIDE];
+		BuildQuery(currentVelocity, desiredVelocity, state.m_row, query);
+		float distanceSquared = 0.f;
+		int bestRow = Search(query, settings.m_searchTolerance, distanceSquared);
+
+		if (state.m_row < 0)
+		{
+			state.m_row = bestRow;
+			state.m_rowSeconds = 0.f;
+		}
+		else
+		{
+			// jumping a frame or two along the same clip isn't worth a crossfade
+			Row const& playing = m_rows[state.m_row];
+			ClipRange const& range = m_ranges[playing.m_rangeIndex];
+			int rowsAhead = (bestRow - state.m_row + range.m_numRows) % range.m_numRows;
+			bool isSameMotion = m_rows[bestRow].m_rangeIndex == playing.m_rangeIndex && rowsAhead <= MOTION_SAME_MOTION_ROWS;
+			if (!isSameMotion)
+			{
+				state.m_previousRow = state.m_row;
+				state.m_previousRowSeconds = state.m_rowSeconds;
+				state.m_transitionSeconds = settings.m_transitionSeconds;
+				state.m_row = bestRow;
+				state.m_rowSeconds = 0.f;
+			}
+		}
+	}
+
+	SampleRow(state.m_row, state.m_rowSeconds, clips, out_pose);
+	if (state.m_transitionSeconds > 0.f && settings.m_transitionSeconds > 0.f)
+	{
+		SampleRow(state.m_previousRow, state.m_previousRowSeconds, clips, scratchPose);
+		BlendPoses(scratchPose, out_pose, 1.f - state.m_transitionSeconds / settings.m_transitionSeconds, out_pose);
+	}
+}
@@ -0,0 +1,111 @@
+//-----------------------------------------------------------------------------------------------
+// MotionDatabase.hpp
+//
+// Motion matching over the locomotion clips. Every clip is sampled into rows of features (future
+// root trajectory, foot positions and velocities, hip velocity), normalized per group and packed
+// at a fixed SSE-friendly stride. Runs of consecutive rows are bounded by a two level AABB
+// hierarchy; a search visits large blocks nearest first, skips whole blocks whose bound can't
+// beat the best match so far and abandons single rows part way through their distance.
+//
+#pragma once
+
+#include "Game/AnimationClip.hpp"
+#include "Game/Skeleton.hpp"
+
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+
+constexpr int MOTION_TRAJECTORY_POINTS = 3;
+constexpr int MOTION_FEATURE_STRIDE = 24;			// 21 features, padded to whole SSE registers
+
+
+//-----------------------------------------------------------------------------------------------
+// Quality vs speed knobs; the defaults are what the player uses
+//
+struct MotionMatchingSettings
+{
+	float	m_searchInterval = 0.1f;		// seconds between searches; playback just continues in between
+	float	m_searchTolerance = 0.f;		// accept a match within (1 + this) of the best distance; 0 is exact
+	float	m_transitionSeconds = 0.2f;		// crossfade into a new match
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct MotionMatchingState
+{
+	int		m_row = -1;						// -1 until the first search
+	float	m_rowSeconds = 0.f;				// time played since entering m_row
+	float	m_secondsSinceSearch = 0.f;
+	int		m_previousRow = -1;				// what is being faded out
+	float	m_previousRowSeconds = 0.f;
+	float	m_transitionSeconds = 0.f;		// remaining fade
+	int		m_numSearches = 0;				// for stats
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct MotionSearchStats
+{
+	int		m_rowsTested = 0;
+	int		m_blocksTested = 0;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class MotionDatabase
+{
+public:
+	// rootVelocity is the ground velocity the clip represents in character space (x forward, y left);
+	// each (clip, playback rate) pair becomes its own run of rows
+	void AddClip(int clipIndex, Vec2 const& rootVelocity, float playbackRate = 1.f);
+	void Build(Skeleton const& skeleton, AnimationClip const* clips, int leftFootBone, int rightFootBone, int hipBone);
+
+	// query for a desired ground velocity, with the pose half copied from the row being played
+	void BuildQuery(Vec2 const& currentVelocity, Vec2 const& desiredVelocity, int currentRow, float* out_query) const;
+	int Search(float const* query, float tolerance, float& out_distanceSquared, MotionSearchStats* out_stats = nullptr) const;
+	int SearchBruteForce(float const* query, float& out_distanceSquared) const;
+	float GetDistanceSquared(float const* query, int row) const;
+
+	void EvaluatePose(Vec2 const& currentVelocity, Vec2 const& desiredVelocity, float deltaSeconds, AnimationClip const* clips,
+		MotionMatchingSettings const& settings, MotionMatchingState& state, SkeletonPose& scratchPose, SkeletonPose& out_pose) const;
+
+	int GetNumRows() const { return (int)m_rows.size(); }
+	int GetNumBlocks() const { return (int)m_smallBlockMins.size() / MOTION_FEATURE_STRIDE; }
+	float const* GetRowFeatures(int row) const { return &m_features[row * MOTION_FEATURE_STRIDE]; }
+
+private:
+	struct ClipRange
+	{
+		int		m_clipIndex = 0;
+		Vec2	m_rootVelocity;
+		float	m_playbackRate = 1.f;
+		int		m_firstRow = 0;
+		int		m_numRows = 0;
+	};
+
+	struct Row
+	{
+		int		m_rangeIndex = 0;
+		float	m_clipSeconds = 0.f;
+		int		m_nextRow = 0;				// following row of the same range, wrapping for loops
+	};
+
+	void NormalizeFeatures();
+	void BuildBlocks(int blockSize, std::vector<float>& out_mins, std::vector<float>& out_maxs) const;
+	void SearchLargeBlock(float const* query, int largeIndex, float pruneScale, float& inout_best, int& inout_bestRow, MotionSearchStats& stats) const;
+	void SampleRow(int row, float rowSeconds, AnimationClip const* clips, SkeletonPose& out_pose) const;
+
+private:
+	std::vector<ClipRange>	m_ranges;
+	std::vector<Row>		m_rows;
+	std::vector<float>		m_features;					// m_rows.size() * MOTION_FEATURE_STRIDE, normalized
+	float					m_featureOffsets[MOTION_FEATURE_STRIDE] = {};
+	float					m_featureScales[MOTION_FEATURE_STRIDE] = {};
+	float					m_sampleSeconds = 0.f;		// spacing of rows in playback time
+
+	std::vector<float>		m_smallBlockMins;			// per block of MOTION_SMALL_BLOCK_ROWS rows
+	std::vector<float>		m_smallBlockMaxs;
+	std::vector<float>		m_largeBlockMins;			// per block of MOTION_LARGE_BLOCK_ROWS rows
+	std::vector<float>		m_largeBlockMaxs;
+};
@@ -0,0 +1,535 @@
+#include "Game/NavigationGrid.hpp"
+#include "Game/WorkerThreadPool.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <math.h>
+
+
+constexpr int NUM_FLOW_DIRECTIONS = 8;
+constexpr int FLOW_DIRECTION_X[NUM_FLOW_DIRECTIONS] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+constexpr int FLOW_DIRECTION_Y[NUM_FLOW_DIRECTIONS] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+constexpr float FLOW_STEP_COSTS[NUM_FLOW_DIRECTIONS] = { 1.f, 1.41421356f, 1.f, 1.41421356f, 1.f, 1.41421356f, 1.f, 1.41421356f };
+
+// past this many changed cells a repair touches most of the field anyway
+constexpr int MAX_CHANGED_CELLS_TO_REPAIR = NUM_NAVIGATION_CELLS / 8;
+
+
+//-----------------------------------------------------------------------------------------------
+static int GetOppositeDirection(int direction)
+{
+	return (direction + NUM_FLOW_DIRECTIONS / 2) % NUM_FLOW_DIRECTIONS;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void NavigationGrid::Startup(float agentRadius)
+{
+	m_agentRadius = agentRadius;
+	m_obstacleCounts.assign(NUM_NAVIGATION_CELLS, 0);
+	m_obstacles.clear();
+	m_freeObstacles.clear();
+	m_changedCells.clear();
+	for (FlowField& field : m_flowFields)
+	{
+		field = FlowField();
+	}
+	m_stats = NavigationStats();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int NavigationGrid::AddObstacle(Vec2 const& center, float radius)
+{
+	int obstacleIndex = (int)m_obstacles.size();
+	if (!m_freeObstacles.empty())
+	{
+		obstacleIndex = m_freeObstacles.back();
+		m_freeObstacles.pop_back();
+	}
+	else
+	{
+		m_obstacles.push_back(Obstacle());
+	}
+
+	Obstacle& obstacle = m_obstacles[obstacleIndex];
+	obstacle.m_center = center;
+	obstacle.m_radius = radius;
+	obstacle.m_isActive = true;
+	RasterizeObstacle(obstacle, 1);
+	m_stats.m_numObstacles++;
+	return obstacleIndex;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void NavigationGrid::MoveObstacle(int obstacleIndex, Vec2 const& center, float radius)
+{
+	Obstacle& obstacle = m_obstacles[obstacleIndex];
+	GUARANTEE_OR_DIE(obstacle.m_isActive, "Moving a removed navigation obstacle");
+	if (obstacle.m_center == center && obstacle.m_radius == radius)
+	{
+		return;
+	}
+
+	RasterizeObstacle(obstacle, -1);
+	obstacle.m_center = center;
+	obstacle.m_radius = radius;
+	RasterizeObstacle(obstacle, 1);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void NavigationGrid::RemoveObstacle(int obstacleIndex)
+{
+	Obstacle& obstacle = m_obstacles[obstacleIndex];
+	GUARANTEE_OR_DIE(obstacle.m_isActive, "Removing a navigation obstacle twice");
+	RasterizeObstacle(obstacle, -1);
+	obstacle.m_isActive = false;
+	m_freeObstacles.push_back(obstacleIndex);
+	m_stats.m_numObstacles--;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// A cell is covered when its center is inside the obstacle grown by the agent radius, so an agent
+// following cell centers clears it
+//
+void NavigationGrid::RasterizeObstacle(Obstacle const& obstacle, int countDelta)
+{
+	float radius = obstacle.m_radius + m_agentRadius;
+	float radiusSquared = radius * radius;
+	int minX = (int)floorf((obstacle.m_center.x - radius + NAVIGATION_GRID_HALF_SIZE) / NAVIGATION_CELL_SIZE);
+	int maxX = (int)floorf((obstacle.m_center.x + radius + NAVIGATION_GRID_HALF_SIZE) / NAVIGATION_CELL_SIZE);
+	int minY = (int)floorf((obstacle.m_center.y - radius + NAVIGATION_GRID_HALF_SIZE) / NAVIGATION_CELL_SIZE);
+	int maxY = (int)floorf((obstacle.m_center.y + radius + NAVIGATION_GRID_HALF_SIZE) / NAVIGATION_CELL_SIZE);
+	minX = std::max(minX, 0);
+	minY = std::max(minY, 0);
+	maxX = std::min(maxX, NAVIGATION_GRID_WIDTH - 1);
+	maxY = std::min(maxY, NAVIGATION_GRID_WIDTH - 1);
+
+	for (int cellY = minY; cellY <= maxY; cellY++)
+	{
+		for (int cellX = minX; cellX <= maxX; cellX++)
+		{
+			int cellIndex = cellY * NAVIGATION_GRID_WIDTH + cellX;
+			Vec2 offset = GetCellCenter(cellIndex) - obstacle.m_center;
+			if (offset.x * offset.x + offset.y * offset.y > radiusSquared)
+			{
+				continue;
+			}
+
+			unsigned short& count = m_obstacleCounts[cellIndex];
+			count = (unsigned short)(count + countDelta);
+			bool didFlip = (countDelta > 0 && count == 1) || (countDelta < 0 && count == 0);
+			if (didFlip)
+			{
+				m_changedCells.push_back(cellIndex);
+				m_stats.m_numBlockedCells += countDelta > 0 ? 1 : -1;
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int NavigationGrid::RequestFlowField(Vec2 const& goal)
+{
+	int goalCell = GetCellIndex(goal);
+	int freeFieldIndex = -1;
+	for (int fieldIndex = 0; fieldIndex < MAX_CACHED_FLOW_FIELDS; fieldIndex++)
+	{
+		FlowField& field = m_flowFields[fieldIndex];
+		if (field.m_goalCell == goalCell)
+		{
+			field.m_lastRequestFrame = m_frameNumber;
+			return fieldIndex;
+		}
+
+		// prefer empty slots, then the one asked for longest ago
+		bool isEvictable = field.m_lastRequestFrame != m_frameNumber;
+		if (isEvictable && (freeFieldIndex < 0 || field.m_lastRequestFrame < m_flowFields[freeFieldIndex].m_lastRequestFrame))
+		{
+			freeFieldIndex = fieldIndex;
+		}
+	}
+
+	if (freeFieldIndex < 0)
+	{
+		return -1;
+	}
+
+	FlowField& field = m_flowFields[freeFieldIndex];
+	field.m_goalCell = goalCell;
+	field.m_goalPosition = goal;
+	field.m_isBuilt = false;
+	field.m_lastRequestFrame = m_frameNumber;
+	return freeFieldIndex;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void NavigationGrid::Update(WorkerThreadPool& workerPool)
+{
+	double startSeconds = GetCurrentTimeSeconds();
+	m_stats.m_numFieldsBuilt = 0;
+	m_stats.m_numFieldsRepaired = 0;
+	m_stats.m_numCellsRepaired = 0;
+	m_stats.m_numFlowFields = 0;
+
+	// a cell that flipped twice is listed twice; dedupe so repairs seed it once
+	std::sort(m_changedCells.begin(), m_changedCells.end());
+	m_changedCells.erase(std::unique(m_changedCells.begin(), m_changedCells.end()), m_changedCells.end());
+
+	m_fieldsToUpdate.clear();
+	for (int fieldIndex = 0; fieldIndex < MAX_CACHED_FLOW_FIELDS; fieldIndex++)
+	{
+		FlowField const& field = m_flowFields[fieldIndex];
+		if (field.m_goalCell < 0)
+		{
+			continue;
+		}
+
+		m_stats.m_numFlowFields++;
+		if (!field.m_isBuilt || !m_changedCells.empty())
+		{
+			m_fieldsToUpdate.push_back(fieldIndex);
+		}
+	}
+
+	workerPool.ParallelFor((int)m_fieldsToUpdate.size(), 1, [this](int beginIndex, int endIndex, int)
+	{
+		for (int updateIndex = beginIndex; updateIndex < endIndex; updateIndex++)
+		{
+			FlowField& field = m_flowFields[m_fieldsToUpdate[updateIndex]];
+			if (field.m_isBuilt)
+			{
+				RepairFlowField(field);
+			}
+			else
+			{
+				BuildFlowField(field);
+			}
+		}
+	});
+
+	for (int fieldIndex : m_fieldsToUpdate)
+	{
+		FlowField const& field = m_flowFields[fieldIndex];
+		if (field.m_numCellsRepaired < 0)
+		{
+			m_stats.m_numFieldsBuilt++;
+		}
+		else
+		{
+			m_stats.m_numFieldsRepaired++;
+			m_stats.m_numCellsRepaired += field.m_numCellsRepaired;
+		}
+	}
+
+	m_changedCells.clear();
+	m_frameNumber++;
+	m_stats.m_updateMs = 1000.0 * (GetCurrentTimeSeconds() - startSeconds);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool NavigationGrid::IsCellBlocked(int cellX, int cellY) const
+{
+	return m_obstacleCounts[cellY * NAVIGATION_GRID_WIDTH + cellX] != 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Diagonal steps may not cut the corner of a blocked cell
+//
+bool NavigationGrid::CanStep(int cellX, int cellY, int direction) const
+{
+	int toX = cellX + FLOW_DIRECTION_X[direction];
+	int toY = cellY + FLOW_DIRECTION_Y[direction];
+	if (toX < 0 || toY < 0 || toX >= NAVIGATION_GRID_WIDTH || toY >= NAVIGATION_GRID_WIDTH || IsCellBlocked(toX, toY))
+	{
+		return false;
+	}
+
+	bool isDiagonal = (direction & 1) != 0;
+	return !isDiagonal || (!IsCellBlocked(toX, cellY) && !IsCellBlocked(cellX, toY));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void NavigationGrid::BuildFlowField(FlowField& field) const
+{
+	field.m_costs.assign(NUM_NAVIGATION_CELLS, FLOW_FIELD_UNREACHABLE);
+	field.m_nextDirections.assign(NUM_NAVIGATION_CELLS, -1);
+	field.m_isRepairCell.assign(NUM_NAVIGATION_CELLS, 0);
+	field.m_openCells.clear();
+	field.m_numCellsRepaired = -1;
+	field.m_isBuilt = true;
+
+	int goalX = field.m_goalCell % NAVIGATION_GRID_WIDTH;
+	int goalY = field.m_goalCell / NAVIGATION_GRID_WIDTH;
+	if (IsCellBlocked(goalX, goalY))
+	{
+		return;
+	}
+
+	field.m_costs[field.m_goalCell] = 0.f;
+	field.m_openCells.push_back({ 0.f, field.m_goalCell });
+	PropagateFlowField(field);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Cells whose path to the goal stepped onto a changed cell, or squeezed diagonally past one, are
+// exactly the subtrees under the changed cells in the field's shortest path tree. Those get reset
+// and searched again from their still-valid neighbors. Changed cells' neighbors are searched too,
+// so newly opened cells and corners can shorten paths that didn't need resetting.
+//
+void NavigationGrid::RepairFlowField(FlowField& field) const
+{
+	bool isGoalChanged = std::binary_search(m_changedCells.begin(), m_changedCells.end(), field.m_goalCell);
+	if (isGoalChanged || (int)m_changedCells.size() > MAX_CHANGED_CELLS_TO_REPAIR)
+	{
+		BuildFlowField(field);
+		return;
+	}
+
+	std::vector<int>& repairCells = field.m_repairCells;
+	std::vector<unsigned char>& isRepairCell = field.m_isRepairCell;
+	repairCells.clear();
+	auto markForRepair = [&repairCells, &isRepairCell](int cellIndex)
+	{
+		if (!isRepairCell[cellIndex])
+		{
+			isRepairCell[cellIndex] = 1;
+			repairCells.push_back(cellIndex);
+		}
+	};
+
+	for (int changedCell : m_changedCells)
+	{
+		markForRepair(changedCell);
+
+		// orthogonal neighbors whose diagonal step had this cell as a corner
+		int changedX = changedCell % NAVIGATION_GRID_WIDTH;
+		int changedY = changedCell / NAVIGATION_GRID_WIDTH;
+		for (int direction = 0; direction < NUM_FLOW_DIRECTIONS; direction += 2)
+		{
+			int neighborX = changedX + FLOW_DIRECTION_X[direction];
+			int neighborY = changedY + FLOW_DIRECTION_Y[direction];
+			if (neighborX < 0 || neighborY < 0 || neighborX >= NAVIGATION_GRID_WIDTH || neighborY >= NAVIGATION_GRID_WIDTH)
+			{
+				continue;
+			}
+
+			int neighborCell = neighborY * NAVIGATION_GRID_WIDTH + neighborX;
+			int next = field.m_nextDirections[neighborCell];
+			bool isDiagonal = next >= 0 && (next & 1) != 0;
+			bool cornersChangedCell = isDiagonal && (neighborX + FLOW_DIRECTION_X[next] == changedX || neighborY + FLOW_DIRECTION_Y[next] == changedY);
+			if (cornersChangedCell)
+			{
+				markForRepair(neighborCell);
+			}
+		}
+	}
+
+	// everything downstream: neighbors whose next step is a cell being repaired
+	for (int repairIndex = 0; repairIndex < (int)repairCells.size(); repairIndex++)
+	{
+		int cellIndex = repairCells[repairIndex];
+		int cellX = cellIndex % NAVIGATION_GRID_WIDTH;
+		int cellY = cellIndex / NAVIGATION_GRID_WIDTH;
+		for (int direction = 0; direction < NUM_FLOW_DIRECTIONS; direction++)
+		{
+			int neighborX = cellX + FLOW_DIRECTION_X[direction];
+			int neighborY = cellY + FLOW_DIRECTION_Y[direction];
+			if (neighborX < 0 || neighborY < 0 || neighborX >= NAVIGATION_GRID_WIDTH || neighborY >= NAVIGATION_GRID_WIDTH)
+			{
+				continue;
+			}
+
+			int neighborCell = neighborY * NAVIGATION_GRID_WIDTH + neighborX;
+			if (field.m_nextDirections[neighborCell] == GetOppositeDirection(direction))
+			{
+				markForRepair(neighborCell);
+			}
+		}
+	}
+
+	for (int cellIndex : repairCells)
+	{
+		field.m_costs[cellIndex] = FLOW_FIELD_UNREACHABLE;
+		field.m_nextDirections[cellIndex] = -1;
+	}
+
+	// seed from the valid cells bordering the repaired region and around every changed cell
+	field.m_openCells.clear();
+	auto seedNeighbors = [this, &field, &isRepairCell](int cellIndex)
+	{
+		int cellX = cellIndex % NAVIGATION_GRID_WIDTH;
+		int cellY = cellIndex / NAVIGATION_GRID_WIDTH;
+		for (int direction = 0; direction < NUM_FLOW_DIRECTIONS; direction++)
+		{
+			int neighborX = cellX + FLOW_DIRECTION_X[direction];
+			int neighborY = cellY + FLOW_DIRECTION_Y[direction];
+			if (neighborX < 0 || neighborY < 0 || neighborX >= NAVIGATION_GRID_WIDTH || neighborY >= NAVIGATION_GRID_WIDTH)
+			{
+				continue;
+			}
+
+			int neighborCell = neighborY * NAVIGATION_GRID_WIDTH + neighborX;
+			float neighborCost = field.m_costs[neighborCell];
+			if (!isRepairCell[neighborCell] && neighborCost < FLOW_FIELD_UNREACHABLE)
+			{
+				field.m_openCells.push_back({ neighborCost, neighborCell });
+			}
+		}
+	};
+	for (int cellIndex : repairCells)
+	{
+		seedNeighbors(cellIndex);
+	}
+	auto isCheaper = [](OpenCell const& a, OpenCell const& b) { return a.m_cost > b.m_cost; };
+	std::make_heap(field.m_openCells.begin(), field.m_openCells.end(), isCheaper);
+	PropagateFlowField(field);
+
+	field.m_numCellsRepaired = (int)repairCells.size();
+	for (int cellIndex : repairCells)
+	{
+		isRepairCell[cellIndex] = 0;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Dijkstra from whatever is queued; a cell is relaxed whenever a cheaper path reaches it, so this
+// also carries cost decreases out into cells that were not reset
+//
+void NavigationGrid::PropagateFlowField(FlowField& field) const
+{
+	auto isCheaper = [](OpenCell const& a, OpenCell const& b) { return a.m_cost > b.m_cost; };
+	std::vector<OpenCell>& openCells = field.m_openCells;
+	while (!openCells.empty())
+	{
+		std::pop_heap(openCells.begin(), openCells.end(), isCheaper);
+		OpenCell openCell = openCells.back();
+		openCells.pop_back();
+		if (openCell.m_cost > field.m_costs[openCell.m_cellIndex])
+		{
+			continue;
+		}
+
+		int cellX = openCell.m_cellIndex % NAVIGATION_GRID_WIDTH;
+		int cellY = openCell.m_cellIndex / NAVIGATION_GRID_WIDTH;
+		for (int direction = 0; direction < NUM_FLOW_DIRECTIONS; direction++)
+		{
+			if (!CanStep(cellX, cellY, direction))
+			{
+				continue;
+			}
+
+			int neighborCell = (cellY + FLOW_DIRECTION_Y[direction]) * NAVIGATION_GRID_WIDTH + cellX + FLOW_DIRECTION_X[direction];
+			float neighborCost = openCell.m_cost + FLOW_STEP_COSTS[direction];
+			if (neighborCost < field.m_costs[neighborCell])
+			{
+				field.m_costs[neighborCell] = neighborCost;
+				field.m_nextDirections[neighborCell] = (signed char)GetOppositeDirection(direction);
+				openCells.push_back({ neighborCost, neighborCell });
+				std::push_heap(openCells.begin(), openCells.end(), isCheaper);
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool NavigationGrid::IsFlowFieldReady(int fieldIndex) const
+{
+	return fieldIndex >= 0 && m_flowFields[fieldIndex].m_isBuilt;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec2 NavigationGrid::GetFlowDirection(int fieldIndex, Vec2 const& position) const
+{
+	if (!IsFlowFieldReady(fieldIndex))
+	{
+		return Vec2();
+	}
+
+	FlowField const& field = m_flowFields[fieldIndex];
+	int cellIndex = GetCellIndex(position);
+	Vec2 target = field.m_goalPosition;
+	if (cellIndex != field.m_goalCell)
+	{
+		int next = field.m_nextDirections[cellIndex];
+		int cellX = cellIndex % NAVIGATION_GRID_WIDTH;
+		int cellY = cellIndex / NAVIGATION_GRID_WIDTH;
+		if (next < 0)
+		{
+			// pushed into an obstacle or cut off: head for the cheapest open neighbor
+			float bestCost = FLOW_FIELD_UNREACHABLE;
+			for (int direction = 0; direction < NUM_FLOW_DIRECTIONS; direction++)
+			{
+				int neighborX = cellX + FLOW_DIRECTION_X[direction];
+				int neighborY = cellY + FLOW_DIRECTION_Y[direction];
+				if (neighborX < 0 || neighborY < 0 || neighborX >= NAVIGATION_GRID_WIDTH || neighborY >= NAVIGATION_GRID_WIDTH)
+				{
+					continue;
+				}
+
+				float neighborCost = field.m_costs[neighborY * NAVIGATION_GRID_WIDTH + neighborX];
+				if (neighborCost < bestCost)
+				{
+					bestCost = neighborCost;
+					next = direction;
+				}
+			}
+			if (next < 0)
+			{
+				return Vec2();
+			}
+		}
+		target = GetCellCenter((cellY + FLOW_DIRECTION_Y[next]) * NAVIGATION_GRID_WIDTH + cellX + FLOW_DIRECTION_X[next]);
+	}
+
+	Vec2 toTarget = target - position;
+	float distance = toTarget.GetLength();
+	return distance > 0.f ? toTarget / distance : Vec2();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+float const* NavigationGrid::GetFlowFieldCosts(int fieldIndex) const
+{
+	return IsFlowFieldReady(fieldIndex) ? m_flowFields[fieldIndex].m_costs.data() : nullptr;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool NavigationGrid::IsBlocked(Vec2 const& position) const
+{
+	return m_obstacleCounts[GetCellIndex(position)] != 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int NavigationGrid::GetCellIndex(Vec2 const& position) const
+{
+	int cellX = (int)floorf((position.x + NAVIGATION_GRID_HALF_SIZE) / NAVIGATION_CELL_SIZE);
+	int cellY = (int)floorf((position.y + NAVIGATION_GRID_HALF_SIZE) / NAVIGATION_CELL_SIZE);
+	cellX = std::min(std::max(cellX, 0), NAVIGATION_GRID_WIDTH - 1);
+	cellY = std::min(std::max(cellY, 0), NAVIGATION_GRID_WIDTH - 1);
+	return cellY * NAVIGATION_GRID_WIDTH + cellX;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec2 NavigationGrid::GetCellCenter(int cellIndex) const
+{
+	int cellX = cellIndex % NAVIGATION_GRID_WIDTH;
+	int cellY = cellIndex / NAVIGATION_GRID_WIDTH;
+	return Vec2(((float)cellX + 0.5f) * NAVIGATION_CELL_SIZE - NAVIGATION_GRID_HALF_SIZE, ((float)cellY + 0.5f) * NAVIGATION_CELL_SIZE - NAVIGATION_GRID_HALF_SIZE);
+}
@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------------------------
+// NavigationGrid.hpp
+//
+// Walkability over the +-50 ground grid, with flow fields toward goals. Obstacles are circles
+// (prop bounds grown by the agent radius) rasterized into per-cell counts. A flow field stores,
+// for every cell, the path length to its goal and the neighbor one step closer. Any number of
+// agents heading to the same goal share one field. Fields live in a small cache keyed by goal
+// cell and are built on the worker pool. When obstacles change, a built field is not rebuilt.
+// Only the cells whose shortest path ran through a changed cell are reset and searched again.
+//
+#pragma once
+
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+class WorkerThreadPool;
+
+
+constexpr float NAVIGATION_GRID_HALF_SIZE = 50.f;
+constexpr float NAVIGATION_CELL_SIZE = 0.5f;
+constexpr int NAVIGATION_GRID_WIDTH = 200;
+constexpr int NUM_NAVIGATION_CELLS = NAVIGATION_GRID_WIDTH * NAVIGATION_GRID_WIDTH;
+constexpr int MAX_CACHED_FLOW_FIELDS = 16;
+constexpr float FLOW_FIELD_UNREACHABLE = 1.0e30f;
+
+
+//-----------------------------------------------------------------------------------------------
+struct NavigationStats
+{
+	int		m_numObstacles = 0;
+	int		m_numBlockedCells = 0;
+	int		m_numFlowFields = 0;
+	int		m_numFieldsBuilt = 0;			// by the last Update
+	int		m_numFieldsRepaired = 0;
+	int		m_numCellsRepaired = 0;
+	double	m_updateMs = 0.0;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class NavigationGrid
+{
+public:
+	void Startup(float agentRadius);
+
+	int AddObstacle(Vec2 const& center, float radius);
+	void MoveObstacle(int obstacleIndex, Vec2 const& center, float radius);
+	void RemoveObstacle(int obstacleIndex);
+
+	// cache slot of the field toward the cell holding goal, or -1 when every slot was already asked
+	// for this frame; slots nobody asks for can be handed to other goals
+	int RequestFlowField(Vec2 const& goal);
+
+	// builds newly requested fields and repairs built ones around changed cells, one field per job
+	void Update(WorkerThreadPool& workerPool);
+
+	bool IsFlowFieldReady(int fieldIndex) const;
+	Vec2 GetFlowDirection(int fieldIndex, Vec2 const& position) const;		// unit length, or zero with nowhere to go
+	float const* GetFlowFieldCosts(int fieldIndex) const;					// path length to the goal per cell, in cells
+
+	bool IsBlocked(Vec2 const& position) const;
+	int GetCellIndex(Vec2 const& position) const;							// clamped onto the grid
+	Vec2 GetCellCenter(int cellIndex) const;
+
+	NavigationStats const& GetStats() const { return m_stats; }
+
+private:
+	struct Obstacle
+	{
+		Vec2	m_center;
+		float	m_radius = 0.f;
+		bool	m_isActive = false;
+	};
+
+	struct OpenCell
+	{
+		float	m_cost;
+		int		m_cellIndex;
+	};
+
+	struct FlowField
+	{
+		int							m_goalCell = -1;
+		Vec2						m_goalPosition;
+		bool						m_isBuilt = false;
+		unsigned int				m_lastRequestFrame = 0;
+		int							m_numCellsRepaired = 0;
+		std::vector<float>			m_costs;
+		std::vector<signed char>	m_nextDirections;		// neighbor one step closer; -1 at the goal, blocked or unreachable
+
+		// search scratch, per field so fields can be worked on in parallel
+		std::vector<OpenCell>		m_openCells;
+		std::vector<int>			m_repairCells;
+		std::vector<unsigned char>	m_isRepairCell;
+	};
+
+	void RasterizeObstacle(Obstacle const& obstacle, int countDelta);
+	bool IsCellBlocked(int cellX, int cellY) const;
+	bool CanStep(int cellX, int cellY, int direction) const;
+	void BuildFlowField(FlowField& field) const;
+	void RepairFlowField(FlowField& field) const;
+	void PropagateFlowField(FlowField& field) const;
+
+private:
+	float						m_agentRadius = 0.f;
+	std::vector<unsigned short>	m_obstacleCounts;			// obstacles covering each cell's center
+	std::vector<Obstacle>		m_obstacles;
+	std::vector<int>			m_freeObstacles;
+	std::vector<int>			m_changedCells;				// blocked state flipped since the last Update
+
+	FlowField					m_flowFields[MAX_CACHED_FLOW_FIELDS];
+	std::vector<int>			m_fieldsToUpdate;
+	unsigned int				m_frameNumber = 1;
+	NavigationStats				m_stats;
+};
@@ -0,0 +1,369 @@
+#include "Game/ParticleSystem.hpp"
+#include "Game/VertexStream.hpp"
+
+#include "Engine/Core/Time.hpp"
+#include <immintrin.h>
+#include <string.h>
+
+
+constexpr int PARTICLE_CORNERS = 4;					// bottom left, bottom right, top right, top left
+constexpr float MIN_PARTICLE_LIFETIME_SECONDS = 0.001f;
+
+
+//-----------------------------------------------------------------------------------------------
+// four lanes of xorshift32; the top 24 bits become a float in [-1, 1)
+//
+static __m128 GetRandomMinusOneToOne(__m128i& state)
+{
+	state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+	state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+	state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+	__m128 zeroToOne = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(state, 8)), _mm_set1_ps(1.f / 16777216.f));
+	return _mm_sub_ps(_mm_add_ps(zeroToOne, zeroToOne), _mm_set1_ps(1.f));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// two counter-clockwise triangles from the corners in order
+//
+static void WriteParticleVertexes(Vertex_PCU* verts, float const* cornerX, float const* cornerY, float const* cornerZ, Rgba8 const& color)
+{
+	Vertex_PCU bottomLeft(Vec3(cornerX[0], cornerY[0], cornerZ[0]), color, Vec2(0.f, 0.f));
+	Vertex_PCU bottomRight(Vec3(cornerX[1], cornerY[1], cornerZ[1]), color, Vec2(1.f, 0.f));
+	Vertex_PCU topRight(Vec3(cornerX[2], cornerY[2], cornerZ[2]), color, Vec2(1.f, 1.f));
+	Vertex_PCU topLeft(Vec3(cornerX[3], cornerY[3], cornerZ[3]), color, Vec2(0.f, 1.f));
+
+	verts[0] = bottomLeft;
+	verts[1] = bottomRight;
+	verts[2] = topRight;
+
+	verts[3] = bottomLeft;
+	verts[4] = topRight;
+	verts[5] = topLeft;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ParticleSystem::ParticleSystem(int capacity, ParticleSystemConfig const& config) :
+	m_config(config),
+	m_capacity(capacity > 0 ? capacity : 0)
+{
+	// whole blocks of four, plus one more for blocks that start unaligned near the end
+	int arraySize = ((m_capacity + 3) & ~3) + 4;
+	m_positionsX.resize(arraySize);
+	m_positionsY.resize(arraySize);
+	m_positionsZ.resize(arraySize);
+	m_velocitiesX.resize(arraySize);
+	m_velocitiesY.resize(arraySize);
+	m_velocitiesZ.resize(arraySize);
+	m_ages.resize(arraySize);
+	m_inverseLifetimes.resize(arraySize);
+	m_startSizes.resize(arraySize);
+	m_sizeChanges.resize(arraySize);
+	m_colors.resize(arraySize);
+	m_expiredParticles.resize(m_capacity);
+	m_stats.m_capacity = m_capacity;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Four at a time from the end of the live particles; the last block may write a few lanes past
+// the burst, which stay dead since they are past m_numLive
+//
+int ParticleSystem::Emit(ParticleBurst const& burst, int numParticles)
+{
+	int numFitting = m_capacity - m_numLive;
+	numFitting = numParticles < numFitting ? numParticles : numFitting;
+	numFitting = numFitting > 0 ? numFitting : 0;
+	m_numEmittedSinceUpdate += numFitting;
+	m_numDroppedSinceUpdate += numParticles > numFitting ? numParticles - numFitting : 0;
+
+	__m128i randomState = _mm_loadu_si128(reinterpret_cast<__m128i const*>(m_randomState));
+	__m128 positionX = _mm_set1_ps(burst.m_position.x);
+	__m128 positionY = _mm_set1_ps(burst.m_position.y);
+	__m128 positionZ = _mm_set1_ps(burst.m_position.z);
+	__m128 positionSpreadX = _mm_set1_ps(burst.m_positionSpread.x);
+	__m128 positionSpreadY = _mm_set1_ps(burst.m_positionSpread.y);
+	__m128 positionSpreadZ = _mm_set1_ps(burst.m_positionSpread.z);
+	__m128 velocityX = _mm_set1_ps(burst.m_velocity.x);
+	__m128 velocityY = _mm_set1_ps(burst.m_velocity.y);
+	__m128 velocityZ = _mm_set1_ps(burst.m_velocity.z);
+	__m128 velocitySpreadX = _mm_set1_ps(burst.m_velocitySpread.x);
+	__m128 velocitySpreadY = _mm_set1_ps(burst.m_velocitySpread.y);
+	__m128 velocitySpreadZ = _mm_set1_ps(burst.m_velocitySpread.z);
+	__m128 halfLifetimeRange = _mm_set1_ps(0.5f * (burst.m_maxLifetimeSeconds - burst.m_minLifetimeSeconds));
+	__m128 middleLifetime = _mm_set1_ps(0.5f * (burst.m_maxLifetimeSeconds + burst.m_minLifetimeSeconds));
+	__m128 minLifetime = _mm_set1_ps(MIN_PARTICLE_LIFETIME_SECONDS);
+	__m128 startSize = _mm_set1_ps(burst.m_startSize);
+	__m128 sizeChange = _mm_set1_ps(burst.m_endSize - burst.m_startSize);
+
+	int packedColor = 0;
+	memcpy(&packedColor, &burst.m_color, sizeof(packedColor));
+	__m128i color = _mm_set1_epi32(packedColor);
+
+	int endParticle = m_numLive + numFitting;
+	for (int particleIndex = m_numLive; particleIndex < endParticle; particleIndex += 4)
+	{
+		_mm_storeu_ps(&m_positionsX[particleIndex], _mm_add_ps(positionX, _mm_mul_ps(positionSpreadX, GetRandomMinusOneToOne(randomState))));
+		_mm_storeu_ps(&m_positionsY[particleIndex], _mm_add_ps(positionY, _mm_mul_ps(positionSpreadY, GetRandomMinusOneToOne(randomState))));
+		_mm_storeu_ps(&m_positionsZ[particleIndex], _mm_add_ps(positionZ, _mm_mul_ps(positionSpreadZ, GetRandomMinusOneToOne(randomState))));
+		_mm_storeu_ps(&m_velocitiesX[particleIndex], _mm_add_ps(velocityX, _mm_mul_ps(velocitySpreadX, GetRandomMinusOneToOne(randomState))));
+		_mm_storeu_ps(&m_velocitiesY[particleIndex], _mm_add_ps(velocityY, _mm_mul_ps(velocitySpreadY, GetRandomMinusOneToOne(randomState))));
+		_mm_storeu_ps(&m_velocitiesZ[particleIndex], _mm_add_ps(velocityZ, _mm_mul_ps(velocitySpreadZ, GetRandomMinusOneToOne(randomState))));
+
+		__m128 lifetime = _mm_add_ps(middleLifetime, _mm_mul_ps(halfLifetimeRange, GetRandomMinusOneToOne(randomState)));
+		_mm_storeu_ps(&m_inverseLifetimes[particleIndex], _mm_div_ps(_mm_set1_ps(1.f), _mm_max_ps(lifetime, minLifetime)));
+		_mm_storeu_ps(&m_ages[particleIndex], _mm_setzero_ps());
+		_mm_storeu_ps(&m_startSizes[particleIndex], startSize);
+		_mm_storeu_ps(&m_sizeChanges[particleIndex], sizeChange);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&m_colors[particleIndex]), color);
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(m_randomState), randomState);
+	m_numLive = endParticle;
+	return numFitting;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// copies every field, for filling the slot of an expired particle
+//
+void ParticleSystem::MoveParticle(int fromIndex, int toIndex)
+{
+	m_positionsX[toIndex] = m_positionsX[fromIndex];
+	m_positionsY[toIndex] = m_positionsY[fromIndex];
+	m_positionsZ[toIndex] = m_positionsZ[fromIndex];
+	m_velocitiesX[toIndex] = m_velocitiesX[fromIndex];
+	m_velocitiesY[toIndex] = m_velocitiesY[fromIndex];
+	m_velocitiesZ[toIndex] = m_velocitiesZ[fromIndex];
+	m_ages[toIndex] = m_ages[fromIndex];
+	m_inverseLifetimes[toIndex] = m_inverseLifetimes[fromIndex];
+	m_startSizes[toIndex] = m_startSizes[fromIndex];
+	m_sizeChanges[toIndex] = m_sizeChanges[fromIndex];
+	m_colors[toIndex] = m_colors[fromIndex];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Blocks of four are moved and aged in place, and the few that expire are listed from the
+// movemask. Their slots are then filled from the end, so only expired particles cost anything
+// beyond the streaming pass
+//
+void ParticleSystem::Update(float deltaSeconds)
+{
+	double updateStartSeconds = GetCurrentTimeSeconds();
+	int numLiveBefore = m_numLive;
+
+	float damping = 1.f - m_config.m_drag * deltaSeconds;
+	damping = damping > 0.f ? damping : 0.f;
+	__m128 deltaTime = _mm_set1_ps(deltaSeconds);
+	__m128 dampingFactor = _mm_set1_ps(damping);
+	__m128 gravityX = _mm_set1_ps(m_config.m_gravity.x * deltaSeconds);
+	__m128 gravityY = _mm_set1_ps(m_config.m_gravity.y * deltaSeconds);
+	__m128 gravityZ = _mm_set1_ps(m_config.m_gravity.z * deltaSeconds);
+	__m128 groundHeight = _mm_set1_ps(m_config.m_groundHeight);
+	__m128 one = _mm_set1_ps(1.f);
+	__m128i laneOffsets = _mm_setr_epi32(0, 1, 2, 3);
+	__m128i numLive = _mm_set1_epi32(m_numLive);
+
+	int numExpired = 0;
+	for (int particleIndex = 0; particleIndex < m_numLive; particleIndex += 4)
+	{
+		__m128 velocityX = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m_velocitiesX[particleIndex]), dampingFactor), gravityX);
+		__m128 velocityY = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m_velocitiesY[particleIndex]), dampingFactor), gravityY);
+		__m128 velocityZ = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m_velocitiesZ[particleIndex]), dampingFactor), gravityZ);
+		__m128 positionX = _mm_add_ps(_mm_loadu_ps(&m_positionsX[particleIndex]), _mm_mul_ps(velocityX, deltaTime));
+		__m128 positionY = _mm_add_ps(_mm_loadu_ps(&m_positionsY[particleIndex]), _mm_mul_ps(velocityY, deltaTime));
+		__m128 positionZ = _mm_add_ps(_mm_loadu_ps(&m_positionsZ[particleIndex]), _mm_mul_ps(velocityZ, deltaTime));
+
+		// settle on the ground, keeping any upward velocity
+		__m128 isBelowGround = _mm_cmplt_ps(positionZ, groundHeight);
+		positionZ = _mm_max_ps(positionZ, groundHeight);
+		velocityZ = _mm_andnot_ps(_mm_and_ps(isBelowGround, _mm_cmplt_ps(velocityZ, _mm_setzero_ps())), velocityZ);
+
+		__m128 age = _mm_add_ps(_mm_loadu_ps(&m_ages[particleIndex]), deltaTime);
+		_mm_storeu_ps(&m_positionsX[particleIndex], positionX);
+		_mm_storeu_ps(&m_positionsY[particleIndex], positionY);
+		_mm_storeu_ps(&m_positionsZ[particleIndex], positionZ);
+		_mm_storeu_ps(&m_velocitiesX[particleIndex], velocityX);
+		_mm_storeu_ps(&m_velocitiesY[particleIndex], velocityY);
+		_mm_storeu_ps(&m_velocitiesZ[particleIndex], velocityZ);
+		_mm_storeu_ps(&m_ages[particleIndex], age);
+
+		__m128 isOld = _mm_cmpge_ps(_mm_mul_ps(age, _mm_loadu_ps(&m_inverseLifetimes[particleIndex])), one);
+		__m128 isLiveLane = _mm_castsi128_ps(_mm_cmplt_epi32(_mm_add_epi32(_mm_set1_epi32(particleIndex), laneOffsets), numLive));
+		int expiredMask = _mm_movemask_ps(_mm_and_ps(isOld, isLiveLane));
+		for (int lane = 0; expiredMask != 0; lane++, expiredMask >>= 1)
+		{
+			if ((expiredMask & 1) != 0)
+			{
+				m_expiredParticles[numExpired++] = particleIndex + lane;
+			}
+		}
+	}
+
+	// the list is ascending, so the last live particle has expired exactly when it is the highest
+	// slot still open; such are dropped, and any other fills the lowest one
+	int firstOpen = 0;
+	int lastOpen = numExpired - 1;
+	while (firstOpen <= lastOpen)
+	{
+		if (m_expiredParticles[lastOpen] == m_numLive - 1)
+		{
+			lastOpen--;
+		}
+		else
+		{
+			MoveParticle(m_numLive - 1, m_expiredParticles[firstOpen]);
+			firstOpen++;
+		}
+		m_numLive--;
+	}
+
+	m_stats.m_numLive = m_numLive;
+	m_stats.m_numEmitted = m_numEmittedSinceUpdate;
+	m_stats.m_numDropped = m_numDroppedSinceUpdate;
+	m_stats.m_numExpired = numLiveBefore - m_numLive;
+	m_stats.m_updateMs = 1000.0 * (GetCurrentTimeSeconds() - updateStartSeconds);
+	m_numEmittedSinceUpdate = 0;
+	m_numDroppedSinceUpdate = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ParticleSystem::Clear()
+{
+	m_numLive = 0;
+	m_numEmittedSinceUpdate = 0;
+	m_numDroppedSinceUpdate = 0;
+	m_stats = ParticleSystemStats();
+	m_stats.m_capacity = m_capacity;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// size and alpha follow the age; with a = left * half size and b = up * half size, the corners
+// are center + a - b, center - a - b, center - a + b and center + a + b
+//
+void ParticleSystem::AddVertsForParticles(VertexSpanWriter& verts, int firstParticle, int numParticles, Vec3 const& cameraLeft, Vec3 const& cameraUp) const
+{
+	Vertex_PCU* particleVerts = verts.Append(numParticles * PARTICLE_NUM_VERTEXES);
+	int endParticle = firstParticle + numParticles;
+
+	__m128 leftX = _mm_set1_ps(cameraLeft.x);
+	__m128 leftY = _mm_set1_ps(cameraLeft.y);
+	__m128 leftZ = _mm_set1_ps(cameraLeft.z);
+	__m128 upX = _mm_set1_ps(cameraUp.x);
+	__m128 upY = _mm_set1_ps(cameraUp.y);
+	__m128 upZ = _mm_set1_ps(cameraUp.z);
+	__m128 half = _mm_set1_ps(0.5f);
+	__m128 one = _mm_set1_ps(1.f);
+
+	int particleIndex = firstParticle;
+	for (; particleIndex + 4 <= endParticle; particleIndex += 4)
+	{
+		__m128 ageFraction = _mm_mul_ps(_mm_loadu_ps(&m_ages[particleIndex]), _mm_loadu_ps(&m_inverseLifetimes[particleIndex]));
+		__m128 halfSize = _mm_mul_ps(half, _mm_add_ps(_mm_loadu_ps(&m_startSizes[particleIndex]), _mm_mul_ps(_mm_loadu_ps(&m_sizeChanges[particleIndex]), ageFraction)));
+		__m128 fade = _mm_max_ps(_mm_sub_ps(one, ageFraction), _mm_setzero_ps());
+
+		__m128 acrossX = _mm_mul_ps(leftX, halfSize);
+		__m128 acrossY = _mm_mul_ps(leftY, halfSize);
+		__m128 acrossZ = _mm_mul_ps(leftZ, halfSize);
+		__m128 upwardX = _mm_mul_ps(upX, halfSize);
+		__m128 upwardY = _mm_mul_ps(upY, halfSize);
+		__m128 upwardZ = _mm_mul_ps(upZ, halfSize);
+
+		__m128 centerX = _mm_loadu_ps(&m_positionsX[particleIndex]);
+		__m128 centerY = _mm_loadu_ps(&m_positionsY[particleIndex]);
+		__m128 centerZ = _mm_loadu_ps(&m_positionsZ[particleIndex]);
+		__m128 leftBottomX = _mm_sub_ps(_mm_add_ps(centerX, acrossX), upwardX);
+		__m128 leftBottomY = _mm_sub_ps(_mm_add_ps(centerY, acrossY), upwardY);
+		__m128 leftBottomZ = _mm_sub_ps(_mm_add_ps(centerZ, acrossZ), upwardZ);
+		__m128 rightBottomX = _mm_sub_ps(_mm_sub_ps(centerX, acrossX), upwardX);
+		__m128 rightBottomY = _mm_sub_ps(_mm_sub_ps(centerY, acrossY), upwardY);
+		__m128 rightBottomZ = _mm_sub_ps(_mm_sub_ps(centerZ, acrossZ), upwardZ);
+
+		// the top corners are the bottom ones across the center
+		alignas(16) float cornerX[PARTICLE_CORNERS][4];
+		alignas(16) float cornerY[PARTICLE_CORNERS][4];
+		alignas(16) float cornerZ[PARTICLE_CORNERS][4];
+		alignas(16) float fades[4];
+		__m128 twoCenterX = _mm_add_ps(centerX, centerX);
+		__m128 twoCenterY = _mm_add_ps(centerY, centerY);
+		__m128 twoCenterZ = _mm_add_ps(centerZ, centerZ);
+		_mm_store_ps(cornerX[0], leftBottomX);
+		_mm_store_ps(cornerY[0], leftBottomY);
+		_mm_store_ps(cornerZ[0], leftBottomZ);
+		_mm_store_ps(cornerX[1], rightBottomX);
+		_mm_store_ps(cornerY[1], rightBottomY);
+		_mm_store_ps(cornerZ[1], rightBottomZ);
+		_mm_store_ps(cornerX[2], _mm_sub_ps(twoCenterX, leftBottomX));
+		_mm_store_ps(cornerY[2], _mm_sub_ps(twoCenterY, leftBottomY));
+		_mm_store_ps(cornerZ[2], _mm_sub_ps(twoCenterZ, leftBottomZ));
+		_mm_store_ps(cornerX[3], _mm_sub_ps(twoCenterX, rightBottomX));
+		_mm_store_ps(cornerY[3], _mm_sub_ps(twoCenterY, rightBottomY));
+		_mm_store_ps(cornerZ[3], _mm_sub_ps(twoCenterZ, rightBottomZ));
+		_mm_store_ps(fades, fade);
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			float laneCornerX[PARTICLE_CORNERS] = { cornerX[0][lane], cornerX[1][lane], cornerX[2][lane], cornerX[3][lane] };
+			float laneCornerY[PARTICLE_CORNERS] = { cornerY[0][lane], cornerY[1][lane], cornerY[2][lane], cornerY[3][lane] };
+			float laneCornerZ[PARTICLE_CORNERS] = { cornerZ[0][lane], cornerZ[1][lane], cornerZ[2][lane], cornerZ[3][lane] };
+			Rgba8 color = m_colors[particleIndex + lane];
+			color.a = (unsigned char)((float)color.a * fades[lane]);
+			Vertex_PCU* quad = particleVerts + ((particleIndex + lane - firstParticle) * PARTICLE_NUM_VERTEXES);
+			WriteParticleVertexes(quad, laneCornerX, laneCornerY, laneCornerZ, color);
+		}
+	}
+
+	for (; particleIndex < endParticle; particleIndex++)
+	{
+		float ageFraction = m_ages[particleIndex] * m_inverseLifetimes[particleIndex];
+		float halfSize = 0.5f * (m_startSizes[particleIndex] + m_sizeChanges[particleIndex] * ageFraction);
+		float fade = ageFraction < 1.f ? 1.f - ageFraction : 0.f;
+
+		float acrossX = cameraLeft.x * halfSize;
+		float acrossY = cameraLeft.y * halfSize;
+		float acrossZ = cameraLeft.z * halfSize;
+		float upwardX = cameraUp.x * halfSize;
+		float upwardY = cameraUp.y * halfSize;
+		float upwardZ = cameraUp.z * halfSize;
+		float centerX = m_positionsX[particleIndex];
+		float centerY = m_positionsY[particleIndex];
+		float centerZ = m_positionsZ[particleIndex];
+		float cornerX[PARTICLE_CORNERS] = { centerX + acrossX - upwardX, centerX - acrossX - upwardX, centerX - acrossX + upwardX, centerX + acrossX + upwardX };
+		float cornerY[PARTICLE_CORNERS] = { centerY + acrossY - upwardY, centerY - acrossY - upwardY, centerY - acrossY + upwardY, centerY + acrossY + upwardY };
+		float cornerZ[PARTICLE_CORNERS] = { centerZ + acrossZ - upwardZ, centerZ - acrossZ - upwardZ, centerZ - acrossZ + upwardZ, centerZ + acrossZ + upwardZ };
+		Rgba8 color = m_colors[particleIndex];
+		color.a = (unsigned char)((float)color.a * fade);
+		Vertex_PCU* quad = particleVerts + ((particleIndex - firstParticle) * PARTICLE_NUM_VERTEXES);
+		WriteParticleVertexes(quad, cornerX, cornerY, cornerZ, color);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// as many particles per stream range as fit, normally all of them
+//
+void ParticleSystem::Render(Vec3 const& cameraLeft, Vec3 const& cameraUp) const
+{
+	m_numDrawsLastFrame = 0;
+
+	for (int firstParticle = 0; firstParticle < m_numLive; )
+	{
+		int numFitting = g_vertexStream->GetNumFreeVertexes() / PARTICLE_NUM_VERTEXES;
+		if (numFitting == 0)
+		{
+			g_vertexStream->Flush();
+			continue;
+		}
+
+		int numInBatch = numFitting < m_numLive - firstParticle ? numFitting : m_numLive - firstParticle;
+		VertexSpanWriter verts = g_vertexStream->Allocate(numInBatch * PARTICLE_NUM_VERTEXES);
+		AddVertsForParticles(verts, firstParticle, numInBatch, cameraLeft, cameraUp);
+		g_vertexStream->Draw(verts);
+		m_numDrawsLastFrame++;
+		firstParticle += numInBatch;
+	}
+}
@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------------------------
+// ParticleSystem.hpp
+//
+// CPU particles for effects like footstep dust and sprint trails. Particles live in a fixed pool
+// allocated up front, one array per field, packed at the front of it. Emission fills four
+// particles per SSE instruction from a four-lane random generator. Update integrates and ages four
+// at a time in place, picking out expired particles by movemask, then fills their slots from the
+// end of the pool, so expiry costs nothing for the particles that live on. Nothing allocates after
+// construction; particles that don't fit are dropped. They are drawn as camera-facing quads built
+// on the CPU straight into the vertex stream, as one range and one draw while they fit in it.
+//
+#pragma once
+
+#include "Game/VertexSpanUtils.hpp"
+
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <vector>
+
+
+constexpr int PARTICLE_NUM_VERTEXES = 6;
+
+
+//-----------------------------------------------------------------------------------------------
+// particles start in a box and with a velocity spread evenly around the given ones
+//
+struct ParticleBurst
+{
+	Vec3	m_position;
+	Vec3	m_positionSpread;				// half extents
+	Vec3	m_velocity;
+	Vec3	m_velocitySpread;				// half extents
+	float	m_minLifetimeSeconds = 0.5f;
+	float	m_maxLifetimeSeconds = 1.f;
+	float	m_startSize = 0.1f;
+	float	m_endSize = 0.3f;
+	Rgba8	m_color = Rgba8::WHITE;			// alpha fades to 0 over the lifetime
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct ParticleSystemConfig
+{
+	Vec3	m_gravity = Vec3(0.f, 0.f, -2.f);		// light, so dust hangs in the air
+	float	m_drag = 2.f;							// fraction of velocity lost per second
+	float	m_groundHeight = 0.f;					// particles settle on it instead of falling through
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct ParticleSystemStats
+{
+	int		m_numLive = 0;
+	int		m_capacity = 0;
+	int		m_numEmitted = 0;				// between the last two updates
+	int		m_numDropped = 0;				// between the last two updates, for want of room
+	int		m_numExpired = 0;				// by the last update
+	double	m_updateMs = 0.0;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class ParticleSystem
+{
+public:
+	explicit ParticleSystem(int capacity, ParticleSystemConfig const& config = ParticleSystemConfig());
+
+	// returns how many were emitted; the rest didn't fit and are dropped
+	int Emit(ParticleBurst const& burst, int numParticles);
+	void Update(float deltaSeconds);
+	void Clear();
+
+	int GetNumLive() const { return m_numLive; }
+	int GetCapacity() const { return m_capacity; }
+
+	// quads for particles [firstParticle, firstParticle + numParticles), facing a camera with the
+	// given left and up axes
+	void AddVertsForParticles(VertexSpanWriter& verts, int firstParticle, int numParticles, Vec3 const& cameraLeft, Vec3 const& cameraUp) const;
+
+	// with the current camera; flushes the vertex stream only when they outgrow it
+	void Render(Vec3 const& cameraLeft, Vec3 const& cameraUp) const;
+	int GetNumDrawsLastFrame() const { return m_numDrawsLastFrame; }
+
+	ParticleSystemConfig const& GetConfig() const { return m_config; }
+	ParticleSystemStats const& GetStats() const { return m_stats; }
+
+private:
+	void MoveParticle(int fromIndex, int toIndex);
+
+private:
+	ParticleSystemConfig	m_config;
+	int						m_capacity = 0;
+	int						m_numLive = 0;
+
+	// sized past the capacity so four lanes can always be read and written
+	std::vector<float>		m_positionsX;
+	std::vector<float>		m_positionsY;
+	std::vector<float>		m_positionsZ;
+	std::vector<float>		m_velocitiesX;
+	std::vector<float>		m_velocitiesY;
+	std::vector<float>		m_velocitiesZ;
+	std::vector<float>		m_ages;
+	std::vector<float>		m_inverseLifetimes;
+	std::vector<float>		m_startSizes;
+	std::vector<float>		m_sizeChanges;		// end size minus start size
+	std::vector<Rgba8>		m_colors;
+	std::vector<int>		m_expiredParticles;		// by the current update, ascending
+
+	unsigned int			m_randomState[4] = { 0x9e3779b9u, 0x7f4a7c15u, 0x85ebca6bu, 0xc2b2ae35u };		// xorshift, one per lane
+
+	int						m_numEmittedSinceUpdate = 0;
+	int						m_numDroppedSinceUpdate = 0;
+	ParticleSystemStats		m_stats;
+	mutable int				m_numDrawsLastFrame = 0;
+};
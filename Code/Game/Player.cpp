@@ -1,6 +1,10 @@
 
 #include "Game/Player.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/Game.hpp"
+#include "Game/InputQueue.hpp"
+#include "Game/LocomotionAnimations.hpp"
+#include "Game/LocomotionInput.hpp"
 
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Window/Window.hpp"
@@ -11,12 +15,16 @@
 #include "Engine/Core/EngineCommon.hpp"
 
 
-constexpr float MOVEMENT_SPEED = 4.f;
-constexpr float FAST_MOVEMENT_MULTIPLIER = 10.f;
 constexpr float MIN_PITCH_DEGREES = -85.f;
 constexpr float MAX_PITCH_DEGREES = 85.f;
 constexpr float MIN_ROLL_DEGREES = -45.f;
 constexpr float MAX_ROLL_DEGREES = 45.f;
+constexpr float LOOK_DEGREES_PER_PIXEL = 0.1f;
+constexpr float FOOTSTEP_STRIDE = 0.8f;						// ground covered between dust puffs
+constexpr float FOOTSTEP_SIDE_OFFSET = 0.15f;				// feet either side of the center
+constexpr int FOOTSTEP_DUST_PARTICLES = 8;
+constexpr int LANDING_DUST_PARTICLES = 40;
+constexpr float SPRINT_TRAIL_PARTICLES_PER_METER = 3.f;
 
 
 Player::Player(Game* game) :
@@ -37,7 +45,7 @@ void Player::Startup()
 	m_worldCamera = new Camera();
 
 	float aspect = g_theRenderer->GetConfig().m_window->GetConfig().m_clientAspect;
-	float fovDegrees = 60.f;
+	float fovDegrees = WORLD_CAMERA_FOV_DEGREES;
 	float zNearPlane = 0.1f;
 	float zFarPlane = 100.f;
 	m_worldCamera->SetPerspectiveView(aspect, fovDegrees, zNearPlane, zFarPlane);
@@ -54,123 +62,218 @@ void Player::Update(float deltaseconds)
 	bool isDevConsoleClosed = !g_theDevConsole->IsOpen();
 	if (isCurrentWindowFocused && isDevConsoleClosed)
 	{
+		UpdateLocomotionMode();
 		UpdatePlayerMovement(deltaseconds);
 	}
+
+	UpdateAnimation(deltaseconds);
 }
 
 
 void Player::UpdatePlayerMovement(float deltaseconds)
 {
-	UpdateVerticalMovement(deltaseconds);
-	UpdateHorizontalMovement(deltaseconds);
+	// look first, so this frame's mouse motion already steers this frame's movement
 	UpdateOrientation();
 
-	// update camera
-	m_worldCamera->SetTransform(m_position, m_orientation);
+	// the same movement every crowd agent runs, fed from the keyboard
+	LocomotionInput input = GetKeyboardLocomotionInput();
+	ApplyLocomotionInput(input, m_orientation.m_yawDegrees, deltaseconds, m_velocity, m_isGrounded);
+
+	// key changes took effect through the keyboard state above
+	g_inputQueue->ConsumeAllEvents();
+
+	// swept move against props and the ground
+	bool wasGrounded = m_isGrounded;
+	CharacterMotion motion;
+	motion.m_position = m_position;
+	motion.m_velocity = m_velocity;
+	motion.m_isGrounded = m_isGrounded;
+	m_game->GetCharacterController().MoveCharacters(&motion, 1, deltaseconds, m_game->GetPropBroadphase());
+	SetPosition(motion.m_position);
+	m_velocity = motion.m_velocity;
+	m_isGrounded = motion.m_isGrounded;
+	EmitLocomotionParticles(input.m_isSprinting, wasGrounded, deltaseconds);
+
+	// update camera; third person, on a spring arm behind the player
+	m_springArm.Update(m_position, m_orientation, deltaseconds, m_game->GetPropBroadphase());
+	m_worldCamera->SetTransform(m_springArm.GetCameraPosition(), m_springArm.GetCameraOrientation());
 }
 
-void Player::UpdateVerticalMovement(float deltaSeconds)
+//----------------------------------------------------------------------------------------------------------
+// Dust where each foot lands, a puff on landing and a trail behind a sprint. Footsteps are spaced
+// by distance rather than time, so they keep pace at any speed
+//
+void Player::EmitLocomotionParticles(bool isSprinting, bool wasGrounded, float deltaseconds)
 {
-	// world up and down using key 'W' & 'R'
-	Vec3 moveIntentions = Vec3(0.f, 0.f, 0.f);
-	Vec3 worldUp = Vec3(0.f, 0.f, 1.f);
-
-	if (g_theInput->IsKeyDown('Q'))
+	if (!m_isGrounded)
 	{
-		moveIntentions -= worldUp;
+		return;
 	}
-	if (g_theInput->IsKeyDown('E'))
+
+	ParticleSystem& particles = m_game->GetParticles();
+	Vec3 feetPosition = m_position - Vec3(0.f, 0.f, m_game->GetCharacterController().GetConfig().m_capsuleHalfHeight);
+
+	ParticleBurst dust;
+	dust.m_positionSpread = Vec3(0.1f, 0.1f, 0.02f);
+	dust.m_velocity = Vec3(0.f, 0.f, 0.4f);
+	dust.m_velocitySpread = Vec3(0.5f, 0.5f, 0.2f);
+	dust.m_minLifetimeSeconds = 0.6f;
+	dust.m_maxLifetimeSeconds = 1.2f;
+	dust.m_startSize = 0.1f;
+	dust.m_endSize = 0.4f;
+	dust.m_color = Rgba8(170, 150, 120, 140);
+
+	if (!wasGrounded)
 	{
-		moveIntentions += worldUp;
+		ParticleBurst landing = dust;
+		landing.m_position = feetPosition;
+		landing.m_positionSpread = Vec3(0.3f, 0.3f, 0.02f);
+		landing.m_velocitySpread = Vec3(1.5f, 1.5f, 0.3f);
+		particles.Emit(landing, LANDING_DUST_PARTICLES);
 	}
 
-	float movementSpeed = MOVEMENT_SPEED;
-	if (g_theInput->IsKeyDown(KEYCODE_SHIFT))
+	float groundSpeed = sqrtf(m_velocity.x * m_velocity.x + m_velocity.y * m_velocity.y);
+	float groundDistance = groundSpeed * deltaseconds;
+	Vec3 jLeft(-SinDegrees(m_orientation.m_yawDegrees), CosDegrees(m_orientation.m_yawDegrees), 0.f);
+	m_distanceSinceFootstep += groundDistance;
+	while (m_distanceSinceFootstep >= FOOTSTEP_STRIDE)
 	{
-		movementSpeed *= FAST_MOVEMENT_MULTIPLIER;
+		m_distanceSinceFootstep -= FOOTSTEP_STRIDE;
+		dust.m_position = feetPosition + jLeft * (m_isLeftFootNext ? FOOTSTEP_SIDE_OFFSET : -FOOTSTEP_SIDE_OFFSET);
+		particles.Emit(dust, FOOTSTEP_DUST_PARTICLES);
+		m_isLeftFootNext = !m_isLeftFootNext;
 	}
 
-	Vec3 verticalDeltaPosition = (moveIntentions * movementSpeed * deltaSeconds);
-	m_position += verticalDeltaPosition;
+	// strewn along this frame's path, kicked back against the run
+	if (isSprinting && groundDistance > 0.f)
+	{
+		m_trailParticlesOwed += SPRINT_TRAIL_PARTICLES_PER_METER * groundDistance;
+		int numTrailParticles = (int)m_trailParticlesOwed;
+		m_trailParticlesOwed -= (float)numTrailParticles;
+
+		ParticleBurst trail;
+		Vec3 halfFrameMove(0.5f * m_velocity.x * deltaseconds, 0.5f * m_velocity.y * deltaseconds, 0.f);
+		trail.m_position = feetPosition - halfFrameMove;
+		trail.m_positionSpread = Vec3(fabsf(halfFrameMove.x) + 0.05f, fabsf(halfFrameMove.y) + 0.05f, 0.05f);
+		trail.m_velocity = Vec3(-0.1f * m_velocity.x, -0.1f * m_velocity.y, 0.3f);
+		trail.m_velocitySpread = Vec3(0.3f, 0.3f, 0.2f);
+		trail.m_minLifetimeSeconds = 0.4f;
+		trail.m_maxLifetimeSeconds = 0.8f;
+		trail.m_startSize = 0.15f;
+		trail.m_endSize = 0.05f;
+		trail.m_color = Rgba8(220, 200, 160, 180);
+		particles.Emit(trail, numTrailParticles);
+	}
 }
 
-void Player::UpdateHorizontalMovement(float deltaseconds)
+LocomotionInput Player::GetKeyboardLocomotionInput() const
 {
-	Vec3 iForward;
-	Vec3 jLeft;
-	Vec3 kUp;
-	m_orientation.GetAsVectors_XFwd_YLeft_ZUp(iForward, jLeft, kUp);
-	iForward.z = 0.f;
-	iForward.Normalize();
-	jLeft.z = 0.f;
-	jLeft.Normalize();
-
-	Vec3 moveIntentions = Vec3(0.f, 0.f, 0.f);
+	LocomotionInput input;
 	if (g_theInput->IsKeyDown('W'))
 	{
-		moveIntentions += iForward;
+		input.m_moveIntentions.x += 1.f;
 	}
 	if (g_theInput->IsKeyDown('S'))
 	{
-		moveIntentions -= iForward;
+		input.m_moveIntentions.x -= 1.f;
 	}
 	if (g_theInput->IsKeyDown('A'))
 	{
-		moveIntentions += jLeft;
+		input.m_moveIntentions.y += 1.f;
 	}
 	if (g_theInput->IsKeyDown('D'))
 	{
-		moveIntentions -= jLeft;
+		input.m_moveIntentions.y -= 1.f;
 	}
 
-	float movementSpeed = MOVEMENT_SPEED;
-	if (g_theInput->IsKeyDown(KEYCODE_SHIFT))
+	input.m_isSprinting = g_theInput->IsKeyDown(KEYCODE_SHIFT);
+	input.m_isJumping = g_theInput->WasKeyJustPressed(KEYCODE_SPACE);
+	return input;
+}
+
+void Player::UpdateOrientation()
+{
+	// only called while focused with the console closed, when the App holds the cursor relative
+	IntVec2 cursorDeltaPosition = g_inputQueue->ConsumeCursorDelta();
+	float deltaYaw = (float)cursorDeltaPosition.x * LOOK_DEGREES_PER_PIXEL;
+	float deltaPitch = (float)cursorDeltaPosition.y * LOOK_DEGREES_PER_PIXEL;
+
+	EulerAngles orientation = m_orientation;
+	orientation.m_yawDegrees -= deltaYaw;
+	orientation.m_pitchDegrees = GetClamped(m_orientation.m_pitchDegrees + deltaPitch, -89.9f, 89.9f);
+	SetOrientation(orientation);
+}
+
+
+void Player::ClampOrientation()
+{
+	EulerAngles orientation = m_orientation;
+	orientation.m_pitchDegrees = GetClamped(orientation.m_pitchDegrees, MIN_PITCH_DEGREES, MAX_PITCH_DEGREES);
+	orientation.m_rollDegrees = GetClamped(orientation.m_rollDegrees, MIN_ROLL_DEGREES, MAX_ROLL_DEGREES);
+	SetOrientation(orientation);
+}
+
+
+void Player::UpdateLocomotionMode()
+{
+	if (g_theInput->WasKeyJustPressed('M'))
 	{
-		movementSpeed *= FAST_MOVEMENT_MULTIPLIER;
-	}
+		m_locomotionMode = (LocomotionMode)((m_locomotionMode + 1) % NUM_LOCOMOTION_MODES);
 
-	Vec3 horizontalDeltaPosition = (moveIntentions * movementSpeed * deltaseconds);
-	m_position += horizontalDeltaPosition;
+		// start the new mode fresh rather than from wherever it was left
+		m_blendState = BlendSpaceState();
+		m_motionMatchingState = MotionMatchingState();
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR_COLOR, m_locomotionMode == LOCOMOTION_MODE_BLEND_SPACE ? "Locomotion: blend space" : "Locomotion: motion matching");
+	}
 }
 
-void Player::UpdateOrientation()
+
+void Player::UpdateAnimation(float deltaseconds)
 {
-	bool isWindowInFocus = g_theWindow->DoesCurrentWindowHaveFocus();
-	if (isWindowInFocus)
+	LocomotionAnimations const& animations = m_game->GetLocomotionAnimations();
+
+	// ground velocity relative to the body's facing, as UpdateHorizontalMovement produced it
+	Vec3 iForward(CosDegrees(m_orientation.m_yawDegrees), SinDegrees(m_orientation.m_yawDegrees), 0.f);
+	Vec3 jLeft(-iForward.y, iForward.x, 0.f);
+	Vec2 localVelocity(DotProduct3D(m_velocity, iForward), DotProduct3D(m_velocity, jLeft));
+
+	if (m_locomotionMode == LOCOMOTION_MODE_MOTION_MATCHING)
 	{
-		// hide mouse and set relative mode
-		bool isCursorHidden = true;
-		bool isCursorRelative = true;
-		g_theInput->SetCursorMode(isCursorHidden, isCursorRelative);
-
-		// update camera
-		IntVec2 cursorDeltaPosition = g_theInput->GetCursorClientDelta();
-		float smoothingFraction = 0.1f;
-		float deltaYaw = (float)cursorDeltaPosition.x * smoothingFraction;
-		float deltaPitch = (float)cursorDeltaPosition.y * smoothingFraction;
-
-		m_orientation.m_yawDegrees -= deltaYaw;
-		float pitch = GetClamped(m_orientation.m_pitchDegrees + deltaPitch, -89.9f, 89.9f);
-		m_orientation.m_pitchDegrees = pitch;
+		animations.m_motionDatabase.EvaluatePose(m_lastLocalVelocity, localVelocity, deltaseconds, animations.m_clips,
+			m_motionMatchingSettings, m_motionMatchingState, m_blendScratchPose, m_pose);
 	}
-	else // isWindowInFocus = false
+	else
 	{
-		// show mouse and disable relative mode
-		bool isCursorHidden = false;
-		bool isCursorRelative = false;
-		g_theInput->SetCursorMode(isCursorHidden, isCursorRelative);
+		animations.m_blendSpace.EvaluatePose(localVelocity, deltaseconds, animations.m_clips, m_blendState, m_blendScratchPose, m_pose);
 	}
+	m_lastLocalVelocity = localVelocity;
+
+	m_boneModelTransforms.resize(animations.m_skeleton.GetNumBones());
+	ComputeModelTransforms(animations.m_skeleton, m_pose, m_boneModelTransforms.data());
+	SkinCharacterMesh();
 }
 
 
-void Player::ClampOrientation()
+void Player::SkinCharacterMesh()
 {
-	m_orientation.m_pitchDegrees = GetClamped(m_orientation.m_pitchDegrees, MIN_PITCH_DEGREES, MAX_PITCH_DEGREES);
-	m_orientation.m_rollDegrees = GetClamped(m_orientation.m_rollDegrees, MIN_ROLL_DEGREES, MAX_ROLL_DEGREES);
+	// the mesh is bound once; each frame only bone matrices change and positions are re-skinned in place
+	SkinnedMesh const& skinnedMesh = m_game->GetLocomotionAnimations().m_skinnedMesh;
+	m_skinningMatrices.resize(skinnedMesh.GetNumBones());
+	skinnedMesh.ComputeSkinningMatrices(m_boneModelTransforms.data(), m_skinningMatrices.data());
+	skinnedMesh.Skin(m_skinningMatrices.data(), GetBestSkinningPath(), m_skeletonVertexes);
 }
 
 
 void Player::Render() const
 {
+	// skeleton root sits at the feet, the bottom of the controller's capsule; body only turns with yaw
+	float capsuleHalfHeight = m_game->GetCharacterController().GetConfig().m_capsuleHalfHeight;
+	EulerAngles bodyOrientation(m_orientation.m_yawDegrees, 0.f, 0.f);
+	Mat44 modelMatrix = bodyOrientation.GetAsMatrix_XFwd_YLeft_ZUp();
+	modelMatrix.SetTranslation3D(m_position - Vec3(0.f, 0.f, capsuleHalfHeight));
+
+	g_theRenderer->SetModelConstants(modelMatrix, m_color);
+	g_theRenderer->BindTexture(nullptr);
+	g_theRenderer->DrawVertexArray((int)m_skeletonVertexes.size(), m_skeletonVertexes.data());
 }
 
@@ -1,9 +1,25 @@
 #pragma once
 
 #include "Game/Entity.hpp"
+#include "Game/BlendSpace2D.hpp"
+#include "Game/LocomotionInput.hpp"
+#include "Game/MotionDatabase.hpp"
+#include "Game/Skeleton.hpp"
+#include "Game/SkinnedMesh.hpp"
+#include "Game/SpringArmCamera.hpp"
+
+#include "Engine/Core/Vertex_PCU.hpp"
+#include <vector>
 
 class Camera;
 
+enum LocomotionMode
+{
+	LOCOMOTION_MODE_BLEND_SPACE,
+	LOCOMOTION_MODE_MOTION_MATCHING,
+	NUM_LOCOMOTION_MODES
+};
+
 class Player : public Entity
 {
 public:
@@ -17,12 +33,35 @@ public:
 	virtual void Render() const override;
 
 	Camera* m_worldCamera = nullptr;
+	SpringArmCamera m_springArm;
+	bool m_isGrounded = false;
 
 protected:
 	void UpdatePlayerMovement(float deltaseconds);
+	void EmitLocomotionParticles(bool isSprinting, bool wasGrounded, float deltaseconds);
 	void ClampOrientation();
 
-	void UpdateVerticalMovement(float deltaseconds);
-	void UpdateHorizontalMovement(float deltaseconds);
+	LocomotionInput GetKeyboardLocomotionInput() const;
 	void UpdateOrientation();
+
+	void UpdateLocomotionMode();
+	void UpdateAnimation(float deltaseconds);
+	void SkinCharacterMesh();
+
+	// locomotion animation
+	LocomotionMode m_locomotionMode = LOCOMOTION_MODE_BLEND_SPACE;
+	BlendSpaceState m_blendState;
+	MotionMatchingSettings m_motionMatchingSettings;
+	MotionMatchingState m_motionMatchingState;
+	Vec2 m_lastLocalVelocity;
+	SkeletonPose m_blendScratchPose;
+	SkeletonPose m_pose;
+	std::vector<BoneMatrix> m_boneModelTransforms;
+	std::vector<SkinningMatrix> m_skinningMatrices;
+	std::vector<Vertex_PCU> m_skeletonVertexes;
+
+	// locomotion effects
+	float m_distanceSinceFootstep = 0.f;
+	bool m_isLeftFootNext = true;
+	float m_trailParticlesOwed = 0.f;
 };
\ No newline at end of file
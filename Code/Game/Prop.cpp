@@ -19,10 +19,24 @@ Prop::~Prop()
 
 void Prop::Update(float deltaseconds)
 {
-	// update current orientation according to the angular velocity
-	m_orientation.m_yawDegrees += m_angularVelocity.m_yawDegrees * deltaseconds;
-	m_orientation.m_pitchDegrees += m_angularVelocity.m_pitchDegrees * deltaseconds;
-	m_orientation.m_rollDegrees += m_angularVelocity.m_rollDegrees * deltaseconds;
+	// update current orientation according to the angular velocity; a prop that doesn't spin never
+	// dirties its transform
+	if (UsesQuaternionOrientation())
+	{
+		// roll, pitch and yaw rates turn the prop about its own forward, left and up axes
+		Vec3 localAngularVelocity(m_angularVelocity.m_rollDegrees, m_angularVelocity.m_pitchDegrees, m_angularVelocity.m_yawDegrees);
+		if (localAngularVelocity.x != 0.f || localAngularVelocity.y != 0.f || localAngularVelocity.z != 0.f)
+		{
+			SetOrientationQuaternion(GetOrientationQuaternion().GetIntegrated(localAngularVelocity, deltaseconds));
+		}
+		return;
+	}
+
+	EulerAngles orientation = m_orientation;
+	orientation.m_yawDegrees += m_angularVelocity.m_yawDegrees * deltaseconds;
+	orientation.m_pitchDegrees += m_angularVelocity.m_pitchDegrees * deltaseconds;
+	orientation.m_rollDegrees += m_angularVelocity.m_rollDegrees * deltaseconds;
+	SetOrientation(orientation);
 }
 
 void Prop::Render() const
@@ -32,5 +46,5 @@ void Prop::Render() const
 
 	//g_theRenderer->SetBlendMode(BlendMode::OPAQUE);
 	g_theRenderer->BindTexture(m_texture);
-	g_theRenderer->DrawVertexArray((int)m_vertexes.size(), m_vertexes.data());
+	g_theRenderer->DrawVertexArray(m_numVertexes, m_vertexes);
 }
@@ -2,7 +2,6 @@
 
 #include "Game/Entity.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
-#include <vector>
 
 class Texture;
 
@@ -17,6 +16,20 @@ public:
 	virtual void Render() const override;
 
 public:
-	std::vector<Vertex_PCU> m_vertexes;
+	// mesh storage is owned by the Game's entity arena and may be shared between props
+	Vertex_PCU const*		m_vertexes = nullptr;
+	int						m_numVertexes = 0;
 	Texture*				m_texture = nullptr;
+
+	// bounding sphere around m_position, used for collision queries
+	float					m_boundingRadius = 0.f;
+
+	// Game's navigation grid obstacle while the bounds reach into the walking band, otherwise -1
+	int						m_navigationObstacle = -1;
+
+	// Game's prop physics body, moved by the physics step instead of Update, otherwise -1
+	int						m_physicsBody = -1;
+
+	// index in Game's prop broadphase once it has been built with this prop, otherwise -1
+	int						m_broadphaseIndex = -1;
 };
\ No newline at end of file
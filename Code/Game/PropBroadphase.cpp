@@ -0,0 +1,382 @@
+#include "Game/PropBroadphase.hpp"
+
+#include <math.h>
+
+
+constexpr int MAX_SPHERE_CASTS_PER_BATCH = 16;
+
+
+//-----------------------------------------------------------------------------------------------
+void PropSphereList::Clear()
+{
+	m_centersX.clear();
+	m_centersY.clear();
+	m_centersZ.clear();
+	m_radii.clear();
+	m_propIndexes.clear();
+	m_count = 0;
+}
+
+void PropSphereList::Add(float x, float y, float z, float radius, int propIndex)
+{
+	m_centersX.push_back(x);
+	m_centersY.push_back(y);
+	m_centersZ.push_back(z);
+	m_radii.push_back(radius);
+	m_propIndexes.push_back(propIndex);
+	m_count++;
+}
+
+void PropSphereList::PadToMultipleOfFour()
+{
+	// padding lanes are far away with no radius, so they never report a hit
+	while ((m_centersX.size() & 3) != 0)
+	{
+		m_centersX.push_back(1.0e6f);
+		m_centersY.push_back(1.0e6f);
+		m_centersZ.push_back(1.0e6f);
+		m_radii.push_back(0.f);
+		m_propIndexes.push_back(-1);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void PropBroadphase::Clear()
+{
+	m_centersX.clear();
+	m_centersY.clear();
+	m_centersZ.clear();
+	m_radii.clear();
+	m_cellStarts.clear();
+	m_cellEntries.clear();
+	m_numCellsX = 0;
+	m_numCellsY = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void PropBroadphase::Build(Vec3 const* centers, float const* radii, int numProps, float cellSize)
+{
+	Clear();
+	m_requestedCellSize = cellSize;
+	if (numProps <= 0)
+	{
+		return;
+	}
+
+	m_centersX.resize(numProps);
+	m_centersY.resize(numProps);
+	m_centersZ.resize(numProps);
+	m_radii.resize(numProps);
+	for (int propIndex = 0; propIndex < numProps; propIndex++)
+	{
+		m_centersX[propIndex] = centers[propIndex].x;
+		m_centersY[propIndex] = centers[propIndex].y;
+		m_centersZ[propIndex] = centers[propIndex].z;
+		m_radii[propIndex] = radii[propIndex];
+	}
+
+	SortIntoCells();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// A prop that stays in the same cells only has its bounds overwritten. One that reaches other
+// cells, or leaves the grid, sorts every prop again, into the storage the grid already has
+//
+bool PropBroadphase::UpdateProps(int const* propIndexes, Vec3 const* centers, float const* radii, int numProps)
+{
+	bool needsSort = false;
+	for (int updateIndex = 0; updateIndex < numProps; updateIndex++)
+	{
+		int propIndex = propIndexes[updateIndex];
+		float oldRadius = m_radii[propIndex];
+		int oldCellMinX = GetCellX(m_centersX[propIndex] - oldRadius);
+		int oldCellMaxX = GetCellX(m_centersX[propIndex] + oldRadius);
+		int oldCellMinY = GetCellY(m_centersY[propIndex] - oldRadius);
+		int oldCellMaxY = GetCellY(m_centersY[propIndex] + oldRadius);
+
+		Vec3 const& center = centers[updateIndex];
+		float radius = radii[updateIndex];
+		m_centersX[propIndex] = center.x;
+		m_centersY[propIndex] = center.y;
+		m_centersZ[propIndex] = center.z;
+		m_radii[propIndex] = radius;
+
+		if (needsSort)
+		{
+			continue;
+		}
+
+		needsSort = !IsInsideGrid(center.x - radius, center.y - radius, center.x + radius, center.y + radius) ||
+			GetCellX(center.x - radius) != oldCellMinX || GetCellX(center.x + radius) != oldCellMaxX ||
+			GetCellY(center.y - radius) != oldCellMinY || GetCellY(center.y + radius) != oldCellMaxY;
+	}
+
+	if (needsSort)
+	{
+		SortIntoCells();
+	}
+
+	return needsSort;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Fits the grid to the current bounds and counting-sorts the props into it
+//
+void PropBroadphase::SortIntoCells()
+{
+	int numProps = GetNumProps();
+	float minX = m_centersX[0] - m_radii[0];
+	float minY = m_centersY[0] - m_radii[0];
+	float maxX = m_centersX[0] + m_radii[0];
+	float maxY = m_centersY[0] + m_radii[0];
+	for (int propIndex = 1; propIndex < numProps; propIndex++)
+	{
+		minX = fminf(minX, m_centersX[propIndex] - m_radii[propIndex]);
+		minY = fminf(minY, m_centersY[propIndex] - m_radii[propIndex]);
+		maxX = fmaxf(maxX, m_centersX[propIndex] + m_radii[propIndex]);
+		maxY = fmaxf(maxY, m_centersY[propIndex] + m_radii[propIndex]);
+	}
+
+	// grow the cells if the area would need too many of them
+	float largestExtent = fmaxf(maxX - minX, maxY - minY);
+	m_cellSize = fmaxf(m_requestedCellSize, largestExtent / static_cast<float>(MAX_BROADPHASE_CELLS_PER_AXIS));
+	m_gridMinX = minX;
+	m_gridMinY = minY;
+	m_numCellsX = static_cast<int>((maxX - minX) / m_cellSize) + 1;
+	m_numCellsY = static_cast<int>((maxY - minY) / m_cellSize) + 1;
+
+	// counting sort: a prop goes into every cell its bounds overlap. Storage grows with headroom,
+	// since props moving about change the cell count a little at a time
+	int numCells = m_numCellsX * m_numCellsY;
+	if (m_cellStarts.capacity() < (size_t)numCells + 1)
+	{
+		m_cellStarts.reserve(2 * ((size_t)numCells + 1));
+		m_cellCursors.reserve(2 * (size_t)numCells);
+	}
+	m_cellStarts.assign(numCells + 1, 0);
+	for (int propIndex = 0; propIndex < numProps; propIndex++)
+	{
+		int cellMinX = GetCellX(m_centersX[propIndex] - m_radii[propIndex]);
+		int cellMaxX = GetCellX(m_centersX[propIndex] + m_radii[propIndex]);
+		int cellMinY = GetCellY(m_centersY[propIndex] - m_radii[propIndex]);
+		int cellMaxY = GetCellY(m_centersY[propIndex] + m_radii[propIndex]);
+		for (int cellY = cellMinY; cellY <= cellMaxY; cellY++)
+		{
+			for (int cellX = cellMinX; cellX <= cellMaxX; cellX++)
+			{
+				m_cellStarts[cellY * m_numCellsX + cellX + 1]++;
+			}
+		}
+	}
+
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		m_cellStarts[cellIndex + 1] += m_cellStarts[cellIndex];
+	}
+
+	m_cellCursors.assign(m_cellStarts.begin(), m_cellStarts.end() - 1);
+	if (m_cellEntries.capacity() < (size_t)m_cellStarts[numCells])
+	{
+		m_cellEntries.reserve(2 * (size_t)m_cellStarts[numCells]);
+	}
+	m_cellEntries.resize(m_cellStarts[numCells]);
+	for (int propIndex = 0; propIndex < numProps; propIndex++)
+	{
+		int cellMinX = GetCellX(m_centersX[propIndex] - m_radii[propIndex]);
+		int cellMaxX = GetCellX(m_centersX[propIndex] + m_radii[propIndex]);
+		int cellMinY = GetCellY(m_centersY[propIndex] - m_radii[propIndex]);
+		int cellMaxY = GetCellY(m_centersY[propIndex] + m_radii[propIndex]);
+		for (int cellY = cellMinY; cellY <= cellMaxY; cellY++)
+		{
+			for (int cellX = cellMinX; cellX <= cellMaxX; cellX++)
+			{
+				m_cellEntries[m_cellCursors[cellY * m_numCellsX + cellX]++] = propIndex;
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool PropBroadphase::IsInsideGrid(float minX, float minY, float maxX, float maxY) const
+{
+	return minX >= m_gridMinX && minY >= m_gridMinY &&
+		maxX <= m_gridMinX + m_cellSize * (float)m_numCellsX && maxY <= m_gridMinY + m_cellSize * (float)m_numCellsY;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int PropBroadphase::GetCellX(float x) const
+{
+	int cellX = static_cast<int>(floorf((x - m_gridMinX) / m_cellSize));
+	return cellX < 0 ? 0 : (cellX >= m_numCellsX ? m_numCellsX - 1 : cellX);
+}
+
+int PropBroadphase::GetCellY(float y) const
+{
+	int cellY = static_cast<int>(floorf((y - m_gridMinY) / m_cellSize));
+	return cellY < 0 ? 0 : (cellY >= m_numCellsY ? m_numCellsY - 1 : cellY);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec3 PropBroadphase::GetPropCenter(int propIndex) const
+{
+	return Vec3(m_centersX[propIndex], m_centersY[propIndex], m_centersZ[propIndex]);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// A prop spanning several cells may be tested more than once; the minimum hit fraction doesn't care
+//
+void PropBroadphase::SphereCastBatch(Vec3 const* starts, Vec3 const* ends, int numCasts, float castRadius, SphereCastResult* results) const
+{
+	if (numCasts > MAX_SPHERE_CASTS_PER_BATCH)
+	{
+		SphereCastBatch(starts, ends, MAX_SPHERE_CASTS_PER_BATCH, castRadius, results);
+		SphereCastBatch(starts + MAX_SPHERE_CASTS_PER_BATCH, ends + MAX_SPHERE_CASTS_PER_BATCH, numCasts - MAX_SPHERE_CASTS_PER_BATCH, castRadius, results + MAX_SPHERE_CASTS_PER_BATCH);
+		return;
+	}
+
+	Vec3 displacements[MAX_SPHERE_CASTS_PER_BATCH];
+	float lengthsSquared[MAX_SPHERE_CASTS_PER_BATCH];
+	for (int castIndex = 0; castIndex < numCasts; castIndex++)
+	{
+		results[castIndex] = SphereCastResult();
+		displacements[castIndex] = ends[castIndex] - starts[castIndex];
+		lengthsSquared[castIndex] = displacements[castIndex].GetLengthSquared();
+	}
+
+	if (m_numCellsX == 0 || numCasts <= 0)
+	{
+		return;
+	}
+
+	// one XY region covering every cast in the batch
+	float minX = fminf(starts[0].x, ends[0].x);
+	float maxX = fmaxf(starts[0].x, ends[0].x);
+	float minY = fminf(starts[0].y, ends[0].y);
+	float maxY = fmaxf(starts[0].y, ends[0].y);
+	for (int castIndex = 1; castIndex < numCasts; castIndex++)
+	{
+		minX = fminf(minX, fminf(starts[castIndex].x, ends[castIndex].x));
+		maxX = fmaxf(maxX, fmaxf(starts[castIndex].x, ends[castIndex].x));
+		minY = fminf(minY, fminf(starts[castIndex].y, ends[castIndex].y));
+		maxY = fmaxf(maxY, fmaxf(starts[castIndex].y, ends[castIndex].y));
+	}
+
+	if (maxX + castRadius < m_gridMinX || maxY + castRadius < m_gridMinY ||
+		minX - castRadius > m_gridMinX + m_cellSize * (float)m_numCellsX ||
+		minY - castRadius > m_gridMinY + m_cellSize * (float)m_numCellsY)
+	{
+		return;
+	}
+
+	int cellMinX = GetCellX(minX - castRadius);
+	int cellMaxX = GetCellX(maxX + castRadius);
+	int cellMinY = GetCellY(minY - castRadius);
+	int cellMaxY = GetCellY(maxY + castRadius);
+	for (int cellY = cellMinY; cellY <= cellMaxY; cellY++)
+	{
+		for (int cellX = cellMinX; cellX <= cellMaxX; cellX++)
+		{
+			int cellIndex = cellY * m_numCellsX + cellX;
+			for (int entryIndex = m_cellStarts[cellIndex]; entryIndex < m_cellStarts[cellIndex + 1]; entryIndex++)
+			{
+				int propIndex = m_cellEntries[entryIndex];
+				float combinedRadius = m_radii[propIndex] + castRadius;
+				float combinedRadiusSquared = combinedRadius * combinedRadius;
+
+				for (int castIndex = 0; castIndex < numCasts; castIndex++)
+				{
+					// |start + t * displacement - center|^2 = combinedRadius^2
+					float toStartX = starts[castIndex].x - m_centersX[propIndex];
+					float toStartY = starts[castIndex].y - m_centersY[propIndex];
+					float toStartZ = starts[castIndex].z - m_centersZ[propIndex];
+					Vec3 const& displacement = displacements[castIndex];
+
+					float c = toStartX * toStartX + toStartY * toStartY + toStartZ * toStartZ - combinedRadiusSquared;
+					float hitFraction = 0.f;
+					if (c > 0.f)
+					{
+						float a = lengthsSquared[castIndex];
+						float b = toStartX * displacement.x + toStartY * displacement.y + toStartZ * displacement.z;
+						if (b >= 0.f || a <= 0.f)
+						{
+							continue;	// moving away, or not moving at all
+						}
+
+						float discriminant = b * b - a * c;
+						if (discriminant < 0.f)
+						{
+							continue;
+						}
+
+						hitFraction = (-b - sqrtf(discriminant)) / a;
+						if (hitFraction > 1.f)
+						{
+							continue;
+						}
+					}
+
+					SphereCastResult& result = results[castIndex];
+					if (hitFraction < result.m_hitFraction)
+					{
+						result.m_didHit = true;
+						result.m_hitFraction = hitFraction;
+						result.m_propIndex = propIndex;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void PropBroadphase::GatherPropsInRegion(float minX, float minY, float maxX, float maxY, PropSphereList& out_props) const
+{
+	out_props.Clear();
+	if (m_numCellsX == 0 ||
+		maxX < m_gridMinX || maxY < m_gridMinY ||
+		minX > m_gridMinX + m_cellSize * (float)m_numCellsX ||
+		minY > m_gridMinY + m_cellSize * (float)m_numCellsY)
+	{
+		out_props.PadToMultipleOfFour();
+		return;
+	}
+
+	int cellMinX = GetCellX(minX);
+	int cellMaxX = GetCellX(maxX);
+	int cellMinY = GetCellY(minY);
+	int cellMaxY = GetCellY(maxY);
+	for (int cellY = cellMinY; cellY <= cellMaxY; cellY++)
+	{
+		for (int cellX = cellMinX; cellX <= cellMaxX; cellX++)
+		{
+			int cellIndex = cellY * m_numCellsX + cellX;
+			for (int entryIndex = m_cellStarts[cellIndex]; entryIndex < m_cellStarts[cellIndex + 1]; entryIndex++)
+			{
+				int propIndex = m_cellEntries[entryIndex];
+
+				// a prop spanning several cells is only taken from the first one inside the region
+				int firstCellX = GetCellX(m_centersX[propIndex] - m_radii[propIndex]);
+				int firstCellY = GetCellY(m_centersY[propIndex] - m_radii[propIndex]);
+				firstCellX = firstCellX > cellMinX ? firstCellX : cellMinX;
+				firstCellY = firstCellY > cellMinY ? firstCellY : cellMinY;
+				if (firstCellX != cellX || firstCellY != cellY)
+				{
+					continue;
+				}
+
+				out_props.Add(m_centersX[propIndex], m_centersY[propIndex], m_centersZ[propIndex], m_radii[propIndex], propIndex);
+			}
+		}
+	}
+
+	out_props.PadToMultipleOfFour();
+}
@@ -0,0 +1,90 @@
+//-----------------------------------------------------------------------------------------------
+// PropBroadphase.hpp
+//
+// Uniform XY grid over prop bounding spheres, built with a counting sort so each cell's props are
+// contiguous. Queries only touch the cells a probe can reach, never the whole prop list. Props
+// that move are updated in place; the cells are only sorted again when one of them reaches
+// different cells, and that reuses the grid's own storage.
+//
+#pragma once
+
+#include "Engine/Math/Vec3.hpp"
+#include <vector>
+
+
+constexpr float DEFAULT_BROADPHASE_CELL_SIZE = 4.f;
+constexpr int MAX_BROADPHASE_CELLS_PER_AXIS = 1024;
+
+
+//-----------------------------------------------------------------------------------------------
+struct SphereCastResult
+{
+	bool	m_didHit = false;
+	float	m_hitFraction = 1.f;	// 0 = start of the cast, 1 = end
+	int		m_propIndex = -1;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Gathered prop bounding spheres, SoA and padded to a multiple of 4 so callers can run SSE over them
+//
+struct PropSphereList
+{
+	std::vector<float>	m_centersX;
+	std::vector<float>	m_centersY;
+	std::vector<float>	m_centersZ;
+	std::vector<float>	m_radii;
+	std::vector<int>	m_propIndexes;
+	int					m_count = 0;
+
+	void Clear();
+	void Add(float x, float y, float z, float radius, int propIndex);
+	void PadToMultipleOfFour();
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class PropBroadphase
+{
+public:
+	void Build(Vec3 const* centers, float const* radii, int numProps, float cellSize = DEFAULT_BROADPHASE_CELL_SIZE);
+	void Clear();
+
+	// new bounds for props already in the grid; returns true if the cells had to be sorted again
+	bool UpdateProps(int const* propIndexes, Vec3 const* centers, float const* radii, int numProps);
+
+	// all casts share one candidate gather; results[i] is filled for casts[i]
+	void SphereCastBatch(Vec3 const* starts, Vec3 const* ends, int numCasts, float castRadius, SphereCastResult* results) const;
+
+	// every prop whose bounds touch the XY region, each listed once; replaces the list's contents
+	void GatherPropsInRegion(float minX, float minY, float maxX, float maxY, PropSphereList& out_props) const;
+
+	int GetNumProps() const { return (int)m_radii.size(); }
+	Vec3 GetPropCenter(int propIndex) const;
+	float GetPropRadius(int propIndex) const { return m_radii[propIndex]; }
+
+private:
+	void SortIntoCells();
+	bool IsInsideGrid(float minX, float minY, float maxX, float maxY) const;
+	int GetCellX(float x) const;
+	int GetCellY(float y) const;
+
+private:
+	// prop bounding spheres, SoA
+	std::vector<float>	m_centersX;
+	std::vector<float>	m_centersY;
+	std::vector<float>	m_centersZ;
+	std::vector<float>	m_radii;
+
+	// cell c owns m_cellEntries[m_cellStarts[c] .. m_cellStarts[c + 1])
+	std::vector<int>	m_cellStarts;
+	std::vector<int>	m_cellEntries;
+	std::vector<int>	m_cellCursors;		// sorting scratch, kept for its capacity
+
+	float	m_requestedCellSize = DEFAULT_BROADPHASE_CELL_SIZE;
+	float	m_cellSize = DEFAULT_BROADPHASE_CELL_SIZE;
+	float	m_gridMinX = 0.f;
+	float	m_gridMinY = 0.f;
+	int		m_numCellsX = 0;
+	int		m_numCellsY = 0;
+};
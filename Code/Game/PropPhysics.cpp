@@ -0,0 +1,920 @@
+#include "Game/PropPhysics.hpp"
+
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <algorithm>
+#include <float.h>
+#include <immintrin.h>
+#include <math.h>
+
+
+constexpr float SPHERE_INERTIA_FACTOR = 2.5f;		// inverse inertia of a solid sphere is 2.5 * inverseMass / r^2
+constexpr int MAX_INSERTION_SORTED_NEW_BODIES = 16;
+
+
+//-----------------------------------------------------------------------------------------------
+char const* GetPropPhysicsPhaseName(PropPhysicsPhase phase)
+{
+	switch (phase)
+	{
+	case PROP_PHYSICS_PHASE_FORCES:			return "forces";
+	case PROP_PHYSICS_PHASE_BROADPHASE:		return "broadphase";
+	case PROP_PHYSICS_PHASE_NARROWPHASE:	return "narrowphase";
+	case PROP_PHYSICS_PHASE_SOLVER:			return "solver";
+	case PROP_PHYSICS_PHASE_INTEGRATION:	return "integration";
+	case PROP_PHYSICS_PHASE_SLEEPING:		return "sleeping";
+	default:								return "unknown";
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+double PropPhysicsStats::GetStepMs() const
+{
+	double stepMs = 0.0;
+	for (int phaseIndex = 0; phaseIndex < NUM_PROP_PHYSICS_PHASES; phaseIndex++)
+	{
+		stepMs += m_phaseMs[phaseIndex];
+	}
+	return stepMs;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// lanes that aren't awake keep their old value
+//
+static inline __m128 SelectAwake(__m128 awakeMask, __m128 updated, __m128 original)
+{
+	return _mm_or_ps(_mm_and_ps(awakeMask, updated), _mm_andnot_ps(awakeMask, original));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+PropPhysics::PropPhysics(PropPhysicsConfig const& config) :
+	m_config(config)
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int PropPhysics::AddBody(Vec3 const& position, float radius, float mass)
+{
+	int bodyIndex = m_numBodies++;
+	int paddedCount = (m_numBodies + 3) & ~3;
+	if ((int)m_radii.size() < paddedCount)
+	{
+		m_positionsX.resize(paddedCount);
+		m_positionsY.resize(paddedCount);
+		m_positionsZ.resize(paddedCount);
+		m_velocitiesX.resize(paddedCount);
+		m_velocitiesY.resize(paddedCount);
+		m_velocitiesZ.resize(paddedCount);
+		m_angularVelocitiesX.resize(paddedCount);
+		m_angularVelocitiesY.resize(paddedCount);
+		m_angularVelocitiesZ.resize(paddedCount);
+		m_orientationsX.resize(paddedCount);
+		m_orientationsY.resize(paddedCount);
+		m_orientationsZ.resize(paddedCount);
+		m_orientationsW.resize(paddedCount, 1.f);
+		m_radii.resize(paddedCount);
+		m_inverseMasses.resize(paddedCount);
+		m_awakeMasks.resize(paddedCount);
+		m_slowSeconds.resize(paddedCount);
+		m_sleepingIslandOfBody.resize(paddedCount, -1);
+		m_boundsMinX.resize(paddedCount);
+		m_solverBodyOfBody.resize(paddedCount);
+		m_islandParents.resize(paddedCount);
+		m_islandSlowSeconds.resize(paddedCount);
+	}
+
+	m_positionsX[bodyIndex] = position.x;
+	m_positionsY[bodyIndex] = position.y;
+	m_positionsZ[bodyIndex] = position.z;
+	m_radii[bodyIndex] = radius;
+	m_inverseMasses[bodyIndex] = mass > 0.f ? 1.f / mass : 0.f;
+	m_awakeMasks[bodyIndex] = mass > 0.f ? -1 : 0;
+	if (mass > 0.f)
+	{
+		m_awakeBodies.push_back(bodyIndex);
+		m_numUnsortedAwake++;
+	}
+	else
+	{
+		m_isRestingListDirty = true;
+	}
+
+	m_stats.m_numBodies = m_numBodies;
+	m_stats.m_numAwake = (int)m_awakeBodies.size();
+	return bodyIndex;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void PropPhysics::Clear()
+{
+	*this = PropPhysics(m_config);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec3 PropPhysics::GetPosition(int bodyIndex) const
+{
+	return Vec3(m_positionsX[bodyIndex], m_positionsY[bodyIndex], m_positionsZ[bodyIndex]);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Quaternion PropPhysics::GetOrientation(int bodyIndex) const
+{
+	return Quaternion(m_orientationsX[bodyIndex], m_orientationsY[bodyIndex], m_orientationsZ[bodyIndex], m_orientationsW[bodyIndex]);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec3 PropPhysics::GetVelocity(int bodyIndex) const
+{
+	return Vec3(m_velocitiesX[bodyIndex], m_velocitiesY[bodyIndex], m_velocitiesZ[bodyIndex]);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec3 PropPhysics::GetAngularVelocityDegrees(int bodyIndex) const
+{
+	Vec3 radiansPerSecond(m_angularVelocitiesX[bodyIndex], m_angularVelocitiesY[bodyIndex], m_angularVelocitiesZ[bodyIndex]);
+	return radiansPerSecond * ConvertRadiansToDegrees(1.f);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void PropPhysics::SetVelocity(int bodyIndex, Vec3 const& velocity)
+{
+	if (m_inverseMasses[bodyIndex] == 0.f)
+	{
+		return;
+	}
+
+	WakeBody(bodyIndex);
+	m_velocitiesX[bodyIndex] = velocity.x;
+	m_velocitiesY[bodyIndex] = velocity.y;
+	m_velocitiesZ[bodyIndex] = velocity.z;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void PropPhysics::SetAngularVelocityDegrees(int bodyIndex, Vec3 const& angularVelocityDegrees)
+{
+	if (m_inverseMasses[bodyIndex] == 0.f)
+	{
+		return;
+	}
+
+	WakeBody(bodyIndex);
+	Vec3 radiansPerSecond = angularVelocityDegrees * ConvertDegreesToRadians(1.f);
+	m_angularVelocitiesX[bodyIndex] = radiansPerSecond.x;
+	m_angularVelocitiesY[bodyIndex] = radiansPerSecond.y;
+	m_angularVelocitiesZ[bodyIndex] = radiansPerSecond.z;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void PropPhysics::WakeBody(int bodyIndex)
+{
+	if (m_sleepingIslandOfBody[bodyIndex] >= 0)
+	{
+		WakeIsland(m_sleepingIslandOfBody[bodyIndex]);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void PropPhysics::WakeIsland(int islandIndex)
+{
+	for (int bodyIndex : m_sleepingIslands[islandIndex])
+	{
+		m_awakeMasks[bodyIndex] = -1;
+		m_slowSeconds[bodyIndex] = 0.f;
+		m_sleepingIslandOfBody[bodyIndex] = -1;
+		m_awakeBodies.push_back(bodyIndex);
+	}
+
+	m_numUnsortedAwake += (int)m_sleepingIslands[islandIndex].size();
+	m_sleepingIslands[islandIndex].clear();
+	m_freeSleepingIslands.push_back(islandIndex);
+	m_isRestingListDirty = true;
+	m_stats.m_numIslandsWoken++;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Gravity and damping first, so contacts solved this step already hold resting bodies up
+//
+void PropPhysics::Step(float deltaSeconds)
+{
+	m_bodiesMovedLastStep.clear();
+	if (deltaSeconds <= 0.f || m_numBodies == 0)
+	{
+		return;
+	}
+	deltaSeconds = deltaSeconds < m_config.m_maxStepSeconds ? deltaSeconds : m_config.m_maxStepSeconds;
+
+	m_stats.m_numIslandsWoken = 0;
+	double phaseStartSeconds = GetCurrentTimeSeconds();
+	auto endPhase = [this, &phaseStartSeconds](PropPhysicsPhase phase)
+	{
+		double nowSeconds = GetCurrentTimeSeconds();
+		m_stats.m_phaseMs[phase] = 1000.0 * (nowSeconds - phaseStartSeconds);
+		phaseStartSeconds = nowSeconds;
+	};
+
+	ApplyForces(deltaSeconds);
+	endPhase(PROP_PHYSICS_PHASE_FORCES);
+	UpdateBroadphase();
+	endPhase(PROP_PHYSICS_PHASE_BROADPHASE);
+	FindContacts(deltaSeconds);
+	endPhase(PROP_PHYSICS_PHASE_NARROWPHASE);
+	SolveContacts();
+	endPhase(PROP_PHYSICS_PHASE_SOLVER);
+	IntegrateBodies(deltaSeconds);
+	endPhase(PROP_PHYSICS_PHASE_INTEGRATION);
+	UpdateSleeping(deltaSeconds);
+	endPhase(PROP_PHYSICS_PHASE_SLEEPING);
+
+	m_stats.m_numBodies = m_numBodies;
+	m_stats.m_numAwake = (int)m_awakeBodies.size();
+	m_stats.m_numSleepingIslands = (int)(m_sleepingIslands.size() - m_freeSleepingIslands.size());
+	m_stats.m_numPairs = (int)m_pairs.size();
+	m_stats.m_numContacts = (int)m_contacts.size();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// four bodies at a time; groups of four with nobody awake are skipped
+//
+void PropPhysics::ApplyForces(float deltaSeconds)
+{
+	float linearScale = 1.f - m_config.m_linearDamping * deltaSeconds;
+	float angularScale = 1.f - m_config.m_angularDamping * deltaSeconds;
+	__m128 linearScales = _mm_set1_ps(linearScale > 0.f ? linearScale : 0.f);
+	__m128 angularScales = _mm_set1_ps(angularScale > 0.f ? angularScale : 0.f);
+	__m128 gravityStepX = _mm_set1_ps(m_config.m_gravity.x * deltaSeconds);
+	__m128 gravityStepY = _mm_set1_ps(m_config.m_gravity.y * deltaSeconds);
+	__m128 gravityStepZ = _mm_set1_ps(m_config.m_gravity.z * deltaSeconds);
+
+	int paddedCount = (m_numBodies + 3) & ~3;
+	for (int bodyIndex = 0; bodyIndex < paddedCount; bodyIndex += 4)
+	{
+		__m128 awakeMask = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(&m_awakeMasks[bodyIndex])));
+		if (_mm_movemask_ps(awakeMask) == 0)
+		{
+			continue;
+		}
+
+		__m128 velocityX = _mm_loadu_ps(&m_velocitiesX[bodyIndex]);
+		__m128 velocityY = _mm_loadu_ps(&m_velocitiesY[bodyIndex]);
+		__m128 velocityZ = _mm_loadu_ps(&m_velocitiesZ[bodyIndex]);
+		_mm_storeu_ps(&m_velocitiesX[bodyIndex], SelectAwake(awakeMask, _mm_mul_ps(_mm_add_ps(velocityX, gravityStepX), linearScales), velocityX));
+		_mm_storeu_ps(&m_velocitiesY[bodyIndex], SelectAwake(awakeMask, _mm_mul_ps(_mm_add_ps(velocityY, gravityStepY), linearScales), velocityY));
+		_mm_storeu_ps(&m_velocitiesZ[bodyIndex], SelectAwake(awakeMask, _mm_mul_ps(_mm_add_ps(velocityZ, gravityStepZ), linearScales), velocityZ));
+
+		// resting bodies have no spin, so scaling theirs changes nothing
+		_mm_storeu_ps(&m_angularVelocitiesX[bodyIndex], _mm_mul_ps(_mm_loadu_ps(&m_angularVelocitiesX[bodyIndex]), angularScales));
+		_mm_storeu_ps(&m_angularVelocitiesY[bodyIndex], _mm_mul_ps(_mm_loadu_ps(&m_angularVelocitiesY[bodyIndex]), angularScales));
+		_mm_storeu_ps(&m_angularVelocitiesZ[bodyIndex], _mm_mul_ps(_mm_loadu_ps(&m_angularVelocitiesZ[bodyIndex]), angularScales));
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void PropSweepList::Clear()
+{
+	m_minX.clear();
+	m_centersX.clear();
+	m_centersY.clear();
+	m_centersZ.clear();
+	m_radii.clear();
+	m_bodies.clear();
+	m_count = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void PropSweepList::Add(float minX, float x, float y, float z, float radius, int bodyIndex)
+{
+	m_minX.push_back(minX);
+	m_centersX.push_back(x);
+	m_centersY.push_back(y);
+	m_centersZ.push_back(z);
+	m_radii.push_back(radius);
+	m_bodies.push_back(bodyIndex);
+	m_count++;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// four entries that start past any body, so a sweep reading them always stops
+//
+void PropSweepList::Pad()
+{
+	for (int padIndex = 0; padIndex < 4; padIndex++)
+	{
+		m_minX.push_back(FLT_MAX);
+		m_centersX.push_back(FLT_MAX);
+		m_centersY.push_back(0.f);
+		m_centersZ.push_back(0.f);
+		m_radii.push_back(0.f);
+		m_bodies.push_back(-1);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Bounds grow by half the contact margin on each side, so pairs within the margin are found
+//
+void PropPhysics::UpdateBroadphase()
+{
+	float halfMargin = 0.5f * m_config.m_contactMargin;
+	for (int bodyIndex : m_awakeBodies)
+	{
+		m_boundsMinX[bodyIndex] = m_positionsX[bodyIndex] - m_radii[bodyIndex] - halfMargin;
+	}
+
+	// insertion sort, since the order barely changes between steps; bodies added or woken since
+	// the last step may have far to go, so many of them get a full sort instead
+	int numAwake = (int)m_awakeBodies.size();
+	if (m_numUnsortedAwake > MAX_INSERTION_SORTED_NEW_BODIES)
+	{
+		std::sort(m_awakeBodies.begin(), m_awakeBodies.end(), [this](int bodyA, int bodyB) { return m_boundsMinX[bodyA] < m_boundsMinX[bodyB]; });
+	}
+	m_numUnsortedAwake = 0;
+	for (int sortedIndex = 1; sortedIndex < numAwake; sortedIndex++)
+	{
+		int bodyIndex = m_awakeBodies[sortedIndex];
+		float minX = m_boundsMinX[bodyIndex];
+		int insertIndex = sortedIndex;
+		while (insertIndex > 0 && m_boundsMinX[m_awakeBodies[insertIndex - 1]] > minX)
+		{
+			m_awakeBodies[insertIndex] = m_awakeBodies[insertIndex - 1];
+			insertIndex--;
+		}
+		m_awakeBodies[insertIndex] = bodyIndex;
+	}
+
+	m_awakeSweep.Clear();
+	for (int bodyIndex : m_awakeBodies)
+	{
+		m_awakeSweep.Add(m_boundsMinX[bodyIndex], m_positionsX[bodyIndex], m_positionsY[bodyIndex], m_positionsZ[bodyIndex], m_radii[bodyIndex], bodyIndex);
+	}
+	m_awakeSweep.Pad();
+
+	if (m_isRestingListDirty)
+	{
+		RebuildRestingList();
+	}
+
+	// awake against later awake bodies until one starts past the end, then binary search the resting
+	// bodies for the first that could reach back this far
+	m_pairs.clear();
+	float maxRestingReach = 2.f * m_maxRestingRadius + m_config.m_contactMargin;
+	for (int sortedIndex = 0; sortedIndex < numAwake; sortedIndex++)
+	{
+		int bodyA = m_awakeBodies[sortedIndex];
+		float maxX = m_positionsX[bodyA] + m_radii[bodyA] + halfMargin;
+		AddPairsFromSweep(m_awakeSweep, sortedIndex + 1, bodyA, maxX);
+
+		auto restingMinXEnd = m_restingSweep.m_minX.begin() + m_restingSweep.m_count;
+		auto firstResting = std::lower_bound(m_restingSweep.m_minX.begin(), restingMinXEnd, m_boundsMinX[bodyA] - maxRestingReach);
+		AddPairsFromSweep(m_restingSweep, (int)(firstResting - m_restingSweep.m_minX.begin()), bodyA, maxX);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// only when bodies fell asleep, woke or were added; resting bodies never move
+//
+void PropPhysics::RebuildRestingList()
+{
+	float halfMargin = 0.5f * m_config.m_contactMargin;
+	m_restingBodies.clear();
+	m_maxRestingRadius = 0.f;
+	for (int bodyIndex = 0; bodyIndex < m_numBodies; bodyIndex++)
+	{
+		if (m_awakeMasks[bodyIndex] == 0)
+		{
+			m_boundsMinX[bodyIndex] = m_positionsX[bodyIndex] - m_radii[bodyIndex] - halfMargin;
+			m_maxRestingRadius = m_radii[bodyIndex] > m_maxRestingRadius ? m_radii[bodyIndex] : m_maxRestingRadius;
+			m_restingBodies.push_back(bodyIndex);
+		}
+	}
+	std::sort(m_restingBodies.begin(), m_restingBodies.end(), [this](int bodyA, int bodyB) { return m_boundsMinX[bodyA] < m_boundsMinX[bodyB]; });
+
+	m_restingSweep.Clear();
+	for (int bodyIndex : m_restingBodies)
+	{
+		m_restingSweep.Add(m_boundsMinX[bodyIndex], m_positionsX[bodyIndex], m_positionsY[bodyIndex], m_positionsZ[bodyIndex], m_radii[bodyIndex], bodyIndex);
+	}
+	m_restingSweep.Pad();
+	m_isRestingListDirty = false;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// From firstIndex until a body starts past maxX, four at a time: every one whose bounds overlap
+// bodyA's on all three axes is paired with it
+//
+void PropPhysics::AddPairsFromSweep(PropSweepList const& list, int firstIndex, int bodyA, float maxX)
+{
+	__m128 signBits = _mm_set1_ps(-0.f);
+	__m128 maxXs = _mm_set1_ps(maxX);
+	__m128 centerX = _mm_set1_ps(m_positionsX[bodyA]);
+	__m128 centerY = _mm_set1_ps(m_positionsY[bodyA]);
+	__m128 centerZ = _mm_set1_ps(m_positionsZ[bodyA]);
+	__m128 reachA = _mm_set1_ps(m_radii[bodyA] + m_config.m_contactMargin);
+	for (int listIndex = firstIndex; listIndex < list.m_count; listIndex += 4)
+	{
+		__m128 isPastEnd = _mm_cmpgt_ps(_mm_loadu_ps(&list.m_minX[listIndex]), maxXs);
+		__m128 reach = _mm_add_ps(reachA, _mm_loadu_ps(&list.m_radii[listIndex]));
+		__m128 distanceX = _mm_andnot_ps(signBits, _mm_sub_ps(_mm_loadu_ps(&list.m_centersX[listIndex]), centerX));
+		__m128 distanceY = _mm_andnot_ps(signBits, _mm_sub_ps(_mm_loadu_ps(&list.m_centersY[listIndex]), centerY));
+		__m128 distanceZ = _mm_andnot_ps(signBits, _mm_sub_ps(_mm_loadu_ps(&list.m_centersZ[listIndex]), centerZ));
+		__m128 overlaps = _mm_and_ps(_mm_and_ps(_mm_cmple_ps(distanceX, reach), _mm_cmple_ps(distanceY, reach)), _mm_cmple_ps(distanceZ, reach));
+		int overlapBits = _mm_movemask_ps(_mm_andnot_ps(isPastEnd, overlaps));
+		while (overlapBits != 0)
+		{
+			int lane = 0;
+			while ((overlapBits & (1 << lane)) == 0)
+			{
+				lane++;
+			}
+			overlapBits &= ~(1 << lane);
+
+			PropPhysicsPair pair;
+			pair.m_bodyA = bodyA;
+			pair.m_bodyB = list.m_bodies[listIndex + lane];
+			m_pairs.push_back(pair);
+		}
+
+		if (_mm_movemask_ps(isPastEnd) != 0)
+		{
+			break;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Pairs always have an awake A; a sleeping B wakes its whole island. Its bodies join the solve
+// from the next step, except for the ground they rest on
+//
+void PropPhysics::FindContacts(float deltaSeconds)
+{
+	m_contacts.clear();
+	for (PropPhysicsPair const& pair : m_pairs)
+	{
+		int bodyA = pair.m_bodyA;
+		int bodyB = pair.m_bodyB;
+		float displacementX = m_positionsX[bodyB] - m_positionsX[bodyA];
+		float displacementY = m_positionsY[bodyB] - m_positionsY[bodyA];
+		float displacementZ = m_positionsZ[bodyB] - m_positionsZ[bodyA];
+		float radiusSum = m_radii[bodyA] + m_radii[bodyB];
+		float reach = radiusSum + m_config.m_contactMargin;
+		float distanceSquared = displacementX * displacementX + displacementY * displacementY + displacementZ * displacementZ;
+		if (distanceSquared > reach * reach)
+		{
+			continue;
+		}
+
+		float distance = sqrtf(distanceSquared);
+		Vec3 normal(0.f, 0.f, 1.f);
+		if (distance > 0.f)
+		{
+			float inverseDistance = 1.f / distance;
+			normal = Vec3(displacementX * inverseDistance, displacementY * inverseDistance, displacementZ * inverseDistance);
+		}
+		WakeBody(bodyB);
+		AddContact(bodyA, bodyB, normal, radiusSum - distance, deltaSeconds);
+	}
+
+	Vec3 downNormal(0.f, 0.f, -1.f);
+	for (int awakeIndex = 0; awakeIndex < (int)m_awakeBodies.size(); awakeIndex++)
+	{
+		int bodyIndex = m_awakeBodies[awakeIndex];
+		float gap = m_positionsZ[bodyIndex] - m_radii[bodyIndex] - m_config.m_groundHeight;
+		if (gap < m_config.m_contactMargin)
+		{
+			AddContact(bodyIndex, -1, downNormal, -gap, deltaSeconds);
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The lower index goes in the high half; the ground, -1, is always the higher
+//
+static unsigned long long GetContactKey(int bodyA, int bodyB, bool& out_isSwapped)
+{
+	unsigned int lowerBody = (unsigned int)bodyA;
+	unsigned int higherBody = (unsigned int)bodyB;
+	out_isSwapped = lowerBody > higherBody;
+	if (out_isSwapped)
+	{
+		lowerBody = (unsigned int)bodyB;
+		higherBody = (unsigned int)bodyA;
+	}
+	return ((unsigned long long)lowerBody << 32) | higherBody;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static int GetCachedImpulseSlot(unsigned long long key, int slotMask)
+{
+	return (int)((key * 0x9E3779B97F4A7C15ull) >> 32) & slotMask;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// A contact still apart only stops the bodies from closing more than the gap this step; one
+// already touching pushes out part of its penetration, or bounces if it hit hard enough. Impulses
+// the same pair had last step are the starting guess
+//
+void PropPhysics::AddContact(int bodyA, int bodyB, Vec3 const& normal, float penetration, float deltaSeconds)
+{
+	float inverseMassSum = m_inverseMasses[bodyA];
+	float normalSpeed = -(m_velocitiesX[bodyA] * normal.x + m_velocitiesY[bodyA] * normal.y + m_velocitiesZ[bodyA] * normal.z);
+	if (bodyB >= 0)
+	{
+		inverseMassSum += m_inverseMasses[bodyB];
+		normalSpeed += m_velocitiesX[bodyB] * normal.x + m_velocitiesY[bodyB] * normal.y + m_velocitiesZ[bodyB] * normal.z;
+	}
+
+	PropPhysicsContact contact;
+	contact.m_bodyA = bodyA;
+	contact.m_bodyB = bodyB;
+	contact.m_normal = normal;
+	contact.m_radiusA = m_radii[bodyA];
+	contact.m_radiusB = bodyB >= 0 ? m_radii[bodyB] : 0.f;
+	contact.m_normalMass = 1.f / inverseMassSum;
+	contact.m_tangentMass = 1.f / ((1.f + SPHERE_INERTIA_FACTOR) * inverseMassSum);
+	if (penetration < 0.f)
+	{
+		contact.m_velocityBias = penetration / deltaSeconds;
+	}
+	else
+	{
+		float excessPenetration = penetration - m_config.m_penetrationSlop;
+		contact.m_velocityBias = excessPenetration > 0.f ? m_config.m_penetrationCorrection * excessPenetration / deltaSeconds : 0.f;
+		if (-normalSpeed > m_config.m_restitutionMinSpeed)
+		{
+			float bounceSpeed = -m_config.m_restitution * normalSpeed;
+			contact.m_velocityBias = bounceSpeed > contact.m_velocityBias ? bounceSpeed : contact.m_velocityBias;
+		}
+	}
+
+	if (!m_cachedImpulses.empty())
+	{
+		bool isSwapped = false;
+		unsigned long long key = GetContactKey(bodyA, bodyB, isSwapped);
+		int slotMask = (int)m_cachedImpulses.size() - 1;
+		for (int slot = GetCachedImpulseSlot(key, slotMask); m_cachedImpulses[slot].m_key != ~0ull; slot = (slot + 1) & slotMask)
+		{
+			PropPhysicsCachedImpulse const& cached = m_cachedImpulses[slot];
+			if (cached.m_key == key)
+			{
+				contact.m_normalImpulse = cached.m_normalImpulse;
+				contact.m_frictionImpulse = isSwapped ? cached.m_frictionImpulse * -1.f : cached.m_frictionImpulse;
+				break;
+			}
+		}
+	}
+	m_contacts.push_back(contact);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// impulse is applied to B and its opposite to A. Both contact points lie along the normal, at
+// radiusA from A's center and radiusB from B's on the other side
+//
+static inline void ApplyContactImpulse(PropPhysicsSolverBody& bodyA, PropPhysicsSolverBody& bodyB, Vec3 const& normal, float radiusA, float radiusB, float impulseX, float impulseY, float impulseZ)
+{
+	// normal x impulse, the torque per unit arm
+	float torqueX = normal.y * impulseZ - normal.z * impulseY;
+	float torqueY = normal.z * impulseX - normal.x * impulseZ;
+	float torqueZ = normal.x * impulseY - normal.y * impulseX;
+
+	float scaleA = radiusA * bodyA.m_inverseInertia;
+	bodyA.m_velocity[0] -= impulseX * bodyA.m_inverseMass;
+	bodyA.m_velocity[1] -= impulseY * bodyA.m_inverseMass;
+	bodyA.m_velocity[2] -= impulseZ * bodyA.m_inverseMass;
+	bodyA.m_angularVelocity[0] -= torqueX * scaleA;
+	bodyA.m_angularVelocity[1] -= torqueY * scaleA;
+	bodyA.m_angularVelocity[2] -= torqueZ * scaleA;
+
+	float scaleB = radiusB * bodyB.m_inverseInertia;
+	bodyB.m_velocity[0] += impulseX * bodyB.m_inverseMass;
+	bodyB.m_velocity[1] += impulseY * bodyB.m_inverseMass;
+	bodyB.m_velocity[2] += impulseZ * bodyB.m_inverseMass;
+	bodyB.m_angularVelocity[0] -= torqueX * scaleB;
+	bodyB.m_angularVelocity[1] -= torqueY * scaleB;
+	bodyB.m_angularVelocity[2] -= torqueZ * scaleB;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Sequential impulses on copies of the awake bodies' velocities; the ground and static bodies
+// share solver body 0, which has no mass to move. Normal impulses go through both centers, so
+// only friction turns the spheres, and for a sphere the contact arm is perpendicular to any
+// tangent, giving the 1 + 2.5 tangent mass
+//
+void PropPhysics::SolveContacts()
+{
+	m_solverBodies.resize(m_awakeBodies.size() + 1);
+	m_solverBodies[0] = PropPhysicsSolverBody();
+	for (int awakeIndex = 0; awakeIndex < (int)m_awakeBodies.size(); awakeIndex++)
+	{
+		int bodyIndex = m_awakeBodies[awakeIndex];
+		PropPhysicsSolverBody& solverBody = m_solverBodies[awakeIndex + 1];
+		solverBody.m_velocity[0] = m_velocitiesX[bodyIndex];
+		solverBody.m_velocity[1] = m_velocitiesY[bodyIndex];
+		solverBody.m_velocity[2] = m_velocitiesZ[bodyIndex];
+		solverBody.m_angularVelocity[0] = m_angularVelocitiesX[bodyIndex];
+		solverBody.m_angularVelocity[1] = m_angularVelocitiesY[bodyIndex];
+		solverBody.m_angularVelocity[2] = m_angularVelocitiesZ[bodyIndex];
+		solverBody.m_inverseMass = m_inverseMasses[bodyIndex];
+		solverBody.m_inverseInertia = SPHERE_INERTIA_FACTOR * m_inverseMasses[bodyIndex] / (m_radii[bodyIndex] * m_radii[bodyIndex]);
+		m_solverBodyOfBody[bodyIndex] = awakeIndex + 1;
+	}
+
+	// warm start
+	for (PropPhysicsContact& contact : m_contacts)
+	{
+		bool isBodyBMoving = contact.m_bodyB >= 0 && m_inverseMasses[contact.m_bodyB] > 0.f;
+		contact.m_solverBodyA = m_solverBodyOfBody[contact.m_bodyA];
+		contact.m_solverBodyB = isBodyBMoving ? m_solverBodyOfBody[contact.m_bodyB] : 0;
+
+		Vec3 const& normal = contact.m_normal;
+		ApplyContactImpulse(m_solverBodies[contact.m_solverBodyA], m_solverBodies[contact.m_solverBodyB], normal, contact.m_radiusA, contact.m_radiusB,
+			normal.x * contact.m_normalImpulse + contact.m_frictionImpulse.x,
+			normal.y * contact.m_normalImpulse + contact.m_frictionImpulse.y,
+			normal.z * contact.m_normalImpulse + contact.m_frictionImpulse.z);
+	}
+	m_solverBodies[0] = PropPhysicsSolverBody();
+
+	for (int iteration = 0; iteration < m_config.m_numSolverIterations; iteration++)
+	{
+		for (PropPhysicsContact& contact : m_contacts)
+		{
+			PropPhysicsSolverBody& bodyA = m_solverBodies[contact.m_solverBodyA];
+			PropPhysicsSolverBody& bodyB = m_solverBodies[contact.m_solverBodyB];
+			Vec3 const& normal = contact.m_normal;
+
+			// velocity of B's contact point relative to A's; the arms are -radiusB and radiusA along
+			// the normal, so both spins add as (spin x normal) scaled by -radius
+			float spinX = -contact.m_radiusB * bodyB.m_angularVelocity[0] - contact.m_radiusA * bodyA.m_angularVelocity[0];
+			float spinY = -contact.m_radiusB * bodyB.m_angularVelocity[1] - contact.m_radiusA * bodyA.m_angularVelocity[1];
+			float spinZ = -contact.m_radiusB * bodyB.m_angularVelocity[2] - contact.m_radiusA * bodyA.m_angularVelocity[2];
+			float relativeX = bodyB.m_velocity[0] - bodyA.m_velocity[0] + (spinY * normal.z - spinZ * normal.y);
+			float relativeY = bodyB.m_velocity[1] - bodyA.m_velocity[1] + (spinZ * normal.x - spinX * normal.z);
+			float relativeZ = bodyB.m_velocity[2] - bodyA.m_velocity[2] + (spinX * normal.y - spinY * normal.x);
+
+			// normal
+			float normalSpeed = relativeX * normal.x + relativeY * normal.y + relativeZ * normal.z;
+			float normalImpulse = contact.m_normalImpulse + contact.m_normalMass * (contact.m_velocityBias - normalSpeed);
+			normalImpulse = normalImpulse > 0.f ? normalImpulse : 0.f;
+			float normalChange = normalImpulse - contact.m_normalImpulse;
+			contact.m_normalImpulse = normalImpulse;
+
+			// friction, from the velocity the normal change leaves and inside its cone
+			float inverseMassSum = bodyA.m_inverseMass + bodyB.m_inverseMass;
+			normalSpeed += normalChange * inverseMassSum;
+			float tangentX = relativeX + normal.x * (normalChange * inverseMassSum - normalSpeed);
+			float tangentY = relativeY + normal.y * (normalChange * inverseMassSum - normalSpeed);
+			float tangentZ = relativeZ + normal.z * (normalChange * inverseMassSum - normalSpeed);
+			Vec3 frictionImpulse = contact.m_frictionImpulse;
+			frictionImpulse.x -= tangentX * contact.m_tangentMass;
+			frictionImpulse.y -= tangentY * contact.m_tangentMass;
+			frictionImpulse.z -= tangentZ * contact.m_tangentMass;
+			float maxFriction = m_config.m_friction * normalImpulse;
+			float frictionSquared = frictionImpulse.x * frictionImpulse.x + frictionImpulse.y * frictionImpulse.y + frictionImpulse.z * frictionImpulse.z;
+			if (frictionSquared > maxFriction * maxFriction)
+			{
+				float frictionScale = maxFriction / sqrtf(frictionSquared);
+				frictionImpulse.x *= frictionScale;
+				frictionImpulse.y *= frictionScale;
+				frictionImpulse.z *= frictionScale;
+			}
+
+			ApplyContactImpulse(bodyA, bodyB, normal, contact.m_radiusA, contact.m_radiusB,
+				normal.x * normalChange + frictionImpulse.x - contact.m_frictionImpulse.x,
+				normal.y * normalChange + frictionImpulse.y - contact.m_frictionImpulse.y,
+				normal.z * normalChange + frictionImpulse.z - contact.m_frictionImpulse.z);
+			contact.m_frictionImpulse = frictionImpulse;
+		}
+		m_solverBodies[0] = PropPhysicsSolverBody();
+	}
+
+	for (int awakeIndex = 0; awakeIndex < (int)m_awakeBodies.size(); awakeIndex++)
+	{
+		int bodyIndex = m_awakeBodies[awakeIndex];
+		PropPhysicsSolverBody const& solverBody = m_solverBodies[awakeIndex + 1];
+		m_velocitiesX[bodyIndex] = solverBody.m_velocity[0];
+		m_velocitiesY[bodyIndex] = solverBody.m_velocity[1];
+		m_velocitiesZ[bodyIndex] = solverBody.m_velocity[2];
+		m_angularVelocitiesX[bodyIndex] = solverBody.m_angularVelocity[0];
+		m_angularVelocitiesY[bodyIndex] = solverBody.m_angularVelocity[1];
+		m_angularVelocitiesZ[bodyIndex] = solverBody.m_angularVelocity[2];
+	}
+
+	CacheImpulses();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// at most half full, so probes stay short
+//
+void PropPhysics::CacheImpulses()
+{
+	int numSlots = 16;
+	while (numSlots < 2 * (int)m_contacts.size())
+	{
+		numSlots <<= 1;
+	}
+	m_cachedImpulses.assign(numSlots, PropPhysicsCachedImpulse());
+
+	int slotMask = numSlots - 1;
+	for (PropPhysicsContact const& contact : m_contacts)
+	{
+		bool isSwapped = false;
+		unsigned long long key = GetContactKey(contact.m_bodyA, contact.m_bodyB, isSwapped);
+		int slot = GetCachedImpulseSlot(key, slotMask);
+		while (m_cachedImpulses[slot].m_key != ~0ull)
+		{
+			slot = (slot + 1) & slotMask;
+		}
+
+		PropPhysicsCachedImpulse& cached = m_cachedImpulses[slot];
+		cached.m_key = key;
+		cached.m_normalImpulse = contact.m_normalImpulse;
+		cached.m_frictionImpulse = isSwapped ? contact.m_frictionImpulse * -1.f : contact.m_frictionImpulse;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Positions and orientations, four bodies at a time. Each orientation is turned by its world
+// angular velocity with the small-angle step and renormalization of Quaternion::GetIntegrated
+//
+void PropPhysics::IntegrateBodies(float deltaSeconds)
+{
+	m_bodiesMovedLastStep = m_awakeBodies;
+
+	__m128 stepSeconds = _mm_set1_ps(deltaSeconds);
+	__m128 halfStepSeconds = _mm_set1_ps(0.5f * deltaSeconds);
+	__m128 one = _mm_set1_ps(1.f);
+	__m128 half = _mm_set1_ps(0.5f);
+	__m128 three = _mm_set1_ps(3.f);
+	__m128 sixth = _mm_set1_ps(1.f / 6.f);
+
+	int paddedCount = (m_numBodies + 3) & ~3;
+	for (int bodyIndex = 0; bodyIndex < paddedCount; bodyIndex += 4)
+	{
+		__m128 awakeMask = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(&m_awakeMasks[bodyIndex])));
+		if (_mm_movemask_ps(awakeMask) == 0)
+		{
+			continue;
+		}
+
+		__m128 positionX = _mm_loadu_ps(&m_positionsX[bodyIndex]);
+		__m128 positionY = _mm_loadu_ps(&m_positionsY[bodyIndex]);
+		__m128 positionZ = _mm_loadu_ps(&m_positionsZ[bodyIndex]);
+		positionX = SelectAwake(awakeMask, _mm_add_ps(positionX, _mm_mul_ps(_mm_loadu_ps(&m_velocitiesX[bodyIndex]), stepSeconds)), positionX);
+		positionY = SelectAwake(awakeMask, _mm_add_ps(positionY, _mm_mul_ps(_mm_loadu_ps(&m_velocitiesY[bodyIndex]), stepSeconds)), positionY);
+		positionZ = SelectAwake(awakeMask, _mm_add_ps(positionZ, _mm_mul_ps(_mm_loadu_ps(&m_velocitiesZ[bodyIndex]), stepSeconds)), positionZ);
+		_mm_storeu_ps(&m_positionsX[bodyIndex], positionX);
+		_mm_storeu_ps(&m_positionsY[bodyIndex], positionY);
+		_mm_storeu_ps(&m_positionsZ[bodyIndex], positionZ);
+
+		__m128 halfX = _mm_mul_ps(_mm_loadu_ps(&m_angularVelocitiesX[bodyIndex]), halfStepSeconds);
+		__m128 halfY = _mm_mul_ps(_mm_loadu_ps(&m_angularVelocitiesY[bodyIndex]), halfStepSeconds);
+		__m128 halfZ = _mm_mul_ps(_mm_loadu_ps(&m_angularVelocitiesZ[bodyIndex]), halfStepSeconds);
+		__m128 halfAngleSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(halfX, halfX), _mm_mul_ps(halfY, halfY)), _mm_mul_ps(halfZ, halfZ));
+		__m128 axisScale = _mm_sub_ps(one, _mm_mul_ps(halfAngleSquared, sixth));
+		__m128 stepX = _mm_mul_ps(halfX, axisScale);
+		__m128 stepY = _mm_mul_ps(halfY, axisScale);
+		__m128 stepZ = _mm_mul_ps(halfZ, axisScale);
+		__m128 stepW = _mm_sub_ps(one, _mm_mul_ps(half, halfAngleSquared));
+
+		// step * orientation: the turn is about world axes
+		__m128 x = _mm_loadu_ps(&m_orientationsX[bodyIndex]);
+		__m128 y = _mm_loadu_ps(&m_orientationsY[bodyIndex]);
+		__m128 z = _mm_loadu_ps(&m_orientationsZ[bodyIndex]);
+		__m128 w = _mm_loadu_ps(&m_orientationsW[bodyIndex]);
+		__m128 turnedX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(stepW, x), _mm_mul_ps(stepX, w)), _mm_sub_ps(_mm_mul_ps(stepY, z), _mm_mul_ps(stepZ, y)));
+		__m128 turnedY = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(stepW, y), _mm_mul_ps(stepX, z)), _mm_add_ps(_mm_mul_ps(stepY, w), _mm_mul_ps(stepZ, x)));
+		__m128 turnedZ = _mm_add_ps(_mm_add_ps(_mm_mul_ps(stepW, z), _mm_mul_ps(stepX, y)), _mm_sub_ps(_mm_mul_ps(stepZ, w), _mm_mul_ps(stepY, x)));
+		__m128 turnedW = _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(stepW, w), _mm_mul_ps(stepX, x)), _mm_add_ps(_mm_mul_ps(stepY, y), _mm_mul_ps(stepZ, z)));
+		__m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(turnedX, turnedX), _mm_mul_ps(turnedY, turnedY)), _mm_add_ps(_mm_mul_ps(turnedZ, turnedZ), _mm_mul_ps(turnedW, turnedW)));
+		__m128 scale = _mm_mul_ps(half, _mm_sub_ps(three, lengthSquared));
+		_mm_storeu_ps(&m_orientationsX[bodyIndex], SelectAwake(awakeMask, _mm_mul_ps(turnedX, scale), x));
+		_mm_storeu_ps(&m_orientationsY[bodyIndex], SelectAwake(awakeMask, _mm_mul_ps(turnedY, scale), y));
+		_mm_storeu_ps(&m_orientationsZ[bodyIndex], SelectAwake(awakeMask, _mm_mul_ps(turnedZ, scale), z));
+		_mm_storeu_ps(&m_orientationsW[bodyIndex], SelectAwake(awakeMask, _mm_mul_ps(turnedW, scale), w));
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int PropPhysics::FindIslandRoot(int bodyIndex)
+{
+	while (m_islandParents[bodyIndex] != bodyIndex)
+	{
+		m_islandParents[bodyIndex] = m_islandParents[m_islandParents[bodyIndex]];
+		bodyIndex = m_islandParents[bodyIndex];
+	}
+	return bodyIndex;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Awake bodies touching each other (not the ground or static bodies) are joined into islands. An
+// island sleeps once its least settled body has been slow for m_sleepSeconds; its bodies stop
+// dead and move to the resting list
+//
+void PropPhysics::UpdateSleeping(float deltaSeconds)
+{
+	float sleepSpeedSquared = m_config.m_sleepSpeed * m_config.m_sleepSpeed;
+	float sleepAngularSpeed = ConvertDegreesToRadians(m_config.m_sleepAngularSpeedDegrees);
+	float sleepAngularSpeedSquared = sleepAngularSpeed * sleepAngularSpeed;
+	for (int bodyIndex : m_awakeBodies)
+	{
+		float speedSquared = GetVelocity(bodyIndex).GetLengthSquared();
+		float angularSpeedSquared = m_angularVelocitiesX[bodyIndex] * m_angularVelocitiesX[bodyIndex] +
+			m_angularVelocitiesY[bodyIndex] * m_angularVelocitiesY[bodyIndex] + m_angularVelocitiesZ[bodyIndex] * m_angularVelocitiesZ[bodyIndex];
+		bool isSlow = speedSquared < sleepSpeedSquared && angularSpeedSquared < sleepAngularSpeedSquared;
+		m_slowSeconds[bodyIndex] = isSlow ? m_slowSeconds[bodyIndex] + deltaSeconds : 0.f;
+		m_islandParents[bodyIndex] = bodyIndex;
+		m_islandSlowSeconds[bodyIndex] = m_slowSeconds[bodyIndex];
+	}
+
+	for (PropPhysicsContact const& contact : m_contacts)
+	{
+		// any sleeping B was woken when the contact was found
+		int bodyB = contact.m_bodyB;
+		if (bodyB < 0 || m_inverseMasses[bodyB] == 0.f)
+		{
+			continue;
+		}
+		int rootA = FindIslandRoot(contact.m_bodyA);
+		int rootB = FindIslandRoot(bodyB);
+		m_islandParents[rootB] = rootA;
+	}
+
+	for (int bodyIndex : m_awakeBodies)
+	{
+		int root = FindIslandRoot(bodyIndex);
+		float slowSeconds = m_slowSeconds[bodyIndex];
+		m_islandSlowSeconds[root] = slowSeconds < m_islandSlowSeconds[root] ? slowSeconds : m_islandSlowSeconds[root];
+	}
+
+	bool didAnyFallAsleep = false;
+	for (int bodyIndex : m_awakeBodies)
+	{
+		int root = FindIslandRoot(bodyIndex);
+		if (m_islandSlowSeconds[root] < m_config.m_sleepSeconds)
+		{
+			continue;
+		}
+
+		// the root is the first of its island to get here, or already points at the island
+		if (m_sleepingIslandOfBody[root] < 0)
+		{
+			int islandIndex = (int)m_sleepingIslands.size();
+			if (!m_freeSleepingIslands.empty())
+			{
+				islandIndex = m_freeSleepingIslands.back();
+				m_freeSleepingIslands.pop_back();
+			}
+			else
+			{
+				m_sleepingIslands.emplace_back();
+			}
+			m_sleepingIslandOfBody[root] = islandIndex;
+		}
+
+		int islandIndex = m_sleepingIslandOfBody[root];
+		m_sleepingIslandOfBody[bodyIndex] = islandIndex;
+		m_sleepingIslands[islandIndex].push_back(bodyIndex);
+		m_awakeMasks[bodyIndex] = 0;
+		m_velocitiesX[bodyIndex] = 0.f;
+		m_velocitiesY[bodyIndex] = 0.f;
+		m_velocitiesZ[bodyIndex] = 0.f;
+		m_angularVelocitiesX[bodyIndex] = 0.f;
+		m_angularVelocitiesY[bodyIndex] = 0.f;
+		m_angularVelocitiesZ[bodyIndex] = 0.f;
+		didAnyFallAsleep = true;
+	}
+
+	if (didAnyFallAsleep)
+	{
+		m_awakeBodies.erase(std::remove_if(m_awakeBodies.begin(), m_awakeBodies.end(), [this](int bodyIndex) { return m_awakeMasks[bodyIndex] == 0; }), m_awakeBodies.end());
+		m_isRestingListDirty = true;
+	}
+}
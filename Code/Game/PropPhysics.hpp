@@ -0,0 +1,234 @@
+//-----------------------------------------------------------------------------------------------
+// PropPhysics.hpp
+//
+// Rigid-body step for props. A body is a prop's bounding sphere, moved by gravity and by contacts
+// with other bodies and the ground plane. Body state is kept one array per field, padded to a
+// multiple of 4, so forces and integration run four bodies per SSE instruction. Pairs come from
+// sweep-and-prune along X: awake bodies stay sorted by insertion sort, which is nearly free while
+// they move a little each step, and are swept against each other and against the sorted resting
+// bodies. Contacts are solved with sequential impulses; friction spins the spheres. Bodies joined
+// by contacts form islands, and an island that stays slow long enough falls asleep as a whole.
+// Sleeping bodies are skipped by every phase until something awake touches them.
+//
+#pragma once
+
+#include "Game/Quaternion.hpp"
+
+#include "Engine/Math/Vec3.hpp"
+#include <vector>
+
+
+//-----------------------------------------------------------------------------------------------
+enum PropPhysicsPhase
+{
+	PROP_PHYSICS_PHASE_FORCES,
+	PROP_PHYSICS_PHASE_BROADPHASE,
+	PROP_PHYSICS_PHASE_NARROWPHASE,
+	PROP_PHYSICS_PHASE_SOLVER,
+	PROP_PHYSICS_PHASE_INTEGRATION,
+	PROP_PHYSICS_PHASE_SLEEPING,
+	NUM_PROP_PHYSICS_PHASES
+};
+
+char const* GetPropPhysicsPhaseName(PropPhysicsPhase phase);
+
+
+//-----------------------------------------------------------------------------------------------
+struct PropPhysicsConfig
+{
+	Vec3	m_gravity = Vec3(0.f, 0.f, -9.8f);
+	float	m_groundHeight = 0.f;
+	float	m_restitution = 0.2f;
+	float	m_restitutionMinSpeed = 1.f;		// slower impacts don't bounce, so stacks settle
+	float	m_friction = 1.f;				// grippy enough for spheres to stack three high
+	float	m_linearDamping = 0.05f;			// fraction of velocity lost per second
+	float	m_angularDamping = 0.5f;			// stands in for rolling resistance
+	float	m_contactMargin = 0.05f;			// contacts start this far before touching
+	float	m_penetrationSlop = 0.005f;
+	float	m_penetrationCorrection = 0.2f;		// of the remaining penetration per step
+	int		m_numSolverIterations = 8;
+	float	m_maxStepSeconds = 1.f / 30.f;		// longer frames are simulated as this
+	float	m_sleepSpeed = 0.08f;
+	float	m_sleepAngularSpeedDegrees = 10.f;
+	float	m_sleepSeconds = 0.5f;				// every body of an island slow this long
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct PropPhysicsStats
+{
+	int		m_numBodies = 0;
+	int		m_numAwake = 0;
+	int		m_numSleepingIslands = 0;
+	int		m_numPairs = 0;
+	int		m_numContacts = 0;					// including ground contacts
+	int		m_numIslandsWoken = 0;				// last step
+	double	m_phaseMs[NUM_PROP_PHYSICS_PHASES] = {};
+
+	double GetStepMs() const;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Bodies in sweep order with the fields the overlap test reads, padded past the end so the sweep
+// can load four at a time and stop on the padding
+//
+struct PropSweepList
+{
+	std::vector<float>	m_minX;
+	std::vector<float>	m_centersX;
+	std::vector<float>	m_centersY;
+	std::vector<float>	m_centersZ;
+	std::vector<float>	m_radii;
+	std::vector<int>	m_bodies;
+	int					m_count = 0;
+
+	void Clear();
+	void Add(float minX, float x, float y, float z, float radius, int bodyIndex);
+	void Pad();
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct PropPhysicsPair
+{
+	int		m_bodyA = -1;					// always awake
+	int		m_bodyB = -1;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct PropPhysicsContact
+{
+	int		m_bodyA = -1;
+	int		m_bodyB = -1;					// -1 for the ground
+	int		m_solverBodyA = 0;
+	int		m_solverBodyB = 0;				// 0 is the shared body for the ground and static bodies
+	Vec3	m_normal;						// from A toward B
+	float	m_radiusA = 0.f;
+	float	m_radiusB = 0.f;
+	float	m_normalMass = 0.f;
+	float	m_tangentMass = 0.f;
+	float	m_velocityBias = 0.f;
+	float	m_normalImpulse = 0.f;
+	Vec3	m_frictionImpulse;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// velocities of the bodies being solved, copied together so contacts read one cache line per body
+//
+struct PropPhysicsSolverBody
+{
+	float	m_velocity[3] = {};
+	float	m_angularVelocity[3] = {};
+	float	m_inverseMass = 0.f;
+	float	m_inverseInertia = 0.f;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// a contact's impulses kept for the next step, which starts its solve from them
+//
+struct PropPhysicsCachedImpulse
+{
+	unsigned long long	m_key = ~0ull;		// lower body index in the high half
+	float				m_normalImpulse = 0.f;
+	Vec3				m_frictionImpulse;	// from the lower body toward the higher
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class PropPhysics
+{
+public:
+	explicit PropPhysics(PropPhysicsConfig const& config = PropPhysicsConfig());
+
+	// mass 0 makes a static body, which collides but never moves. Returns the body index
+	int AddBody(Vec3 const& position, float radius, float mass);
+	void Clear();
+	int GetNumBodies() const { return m_numBodies; }
+
+	void Step(float deltaSeconds);
+
+	Vec3 GetPosition(int bodyIndex) const;
+	Quaternion GetOrientation(int bodyIndex) const;
+	Vec3 GetVelocity(int bodyIndex) const;
+	Vec3 GetAngularVelocityDegrees(int bodyIndex) const;		// world axes
+	bool IsAwake(int bodyIndex) const { return m_awakeMasks[bodyIndex] != 0; }
+
+	// both wake the body's island
+	void SetVelocity(int bodyIndex, Vec3 const& velocity);
+	void SetAngularVelocityDegrees(int bodyIndex, Vec3 const& angularVelocityDegrees);
+	void WakeBody(int bodyIndex);
+
+	// bodies integrated by the last step, including any that fell asleep at its end
+	std::vector<int> const& GetBodiesMovedLastStep() const { return m_bodiesMovedLastStep; }
+
+	PropPhysicsConfig const& GetConfig() const { return m_config; }
+	PropPhysicsStats const& GetStats() const { return m_stats; }
+
+private:
+	void ApplyForces(float deltaSeconds);
+	void UpdateBroadphase();
+	void RebuildRestingList();
+	void AddPairsFromSweep(PropSweepList const& list, int firstIndex, int bodyA, float maxX);
+	void FindContacts(float deltaSeconds);
+	void AddContact(int bodyA, int bodyB, Vec3 const& normal, float penetration, float deltaSeconds);
+	void SolveContacts();
+	void CacheImpulses();
+	void IntegrateBodies(float deltaSeconds);
+	void UpdateSleeping(float deltaSeconds);
+	void WakeIsland(int islandIndex);
+	int FindIslandRoot(int bodyIndex);
+
+private:
+	PropPhysicsConfig					m_config;
+	int									m_numBodies = 0;
+
+	// body state, one array per field, padded to a multiple of 4
+	std::vector<float>					m_positionsX;
+	std::vector<float>					m_positionsY;
+	std::vector<float>					m_positionsZ;
+	std::vector<float>					m_velocitiesX;
+	std::vector<float>					m_velocitiesY;
+	std::vector<float>					m_velocitiesZ;
+	std::vector<float>					m_angularVelocitiesX;		// radians per second
+	std::vector<float>					m_angularVelocitiesY;
+	std::vector<float>					m_angularVelocitiesZ;
+	std::vector<float>					m_orientationsX;
+	std::vector<float>					m_orientationsY;
+	std::vector<float>					m_orientationsZ;
+	std::vector<float>					m_orientationsW;
+	std::vector<float>					m_radii;
+	std::vector<float>					m_inverseMasses;			// 0 for static bodies and padding
+	std::vector<int>					m_awakeMasks;				// all bits set while awake
+	std::vector<float>					m_slowSeconds;
+	std::vector<int>					m_sleepingIslandOfBody;		// -1 unless asleep
+
+	// sweep-and-prune: awake bodies re-sorted every step, sleeping and static ones only when the
+	// set changes since they don't move
+	std::vector<float>					m_boundsMinX;
+	std::vector<int>					m_awakeBodies;
+	int									m_numUnsortedAwake = 0;		// added or woken since the last sort
+	std::vector<int>					m_restingBodies;
+	PropSweepList						m_awakeSweep;
+	PropSweepList						m_restingSweep;
+	float								m_maxRestingRadius = 0.f;
+	bool								m_isRestingListDirty = false;
+	std::vector<PropPhysicsPair>		m_pairs;
+
+	std::vector<PropPhysicsContact>		m_contacts;
+	std::vector<PropPhysicsSolverBody>	m_solverBodies;
+	std::vector<int>					m_solverBodyOfBody;
+	std::vector<PropPhysicsCachedImpulse>	m_cachedImpulses;		// open addressing, a power of two
+
+	// islands of awake bodies are found again every step; sleeping ones keep their member lists
+	std::vector<int>					m_islandParents;
+	std::vector<float>					m_islandSlowSeconds;
+	std::vector<std::vector<int>>		m_sleepingIslands;
+	std::vector<int>					m_freeSleepingIslands;
+	std::vector<int>					m_bodiesMovedLastStep;
+
+	PropPhysicsStats					m_stats;
+};
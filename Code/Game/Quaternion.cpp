@@ -0,0 +1,177 @@
+#include "Game/Quaternion.hpp"
+
+#include "Engine/Math/MathUtils.hpp"
+
+
+const Quaternion Quaternion::IDENTITY = Quaternion(0.f, 0.f, 0.f, 1.f);
+
+
+//-----------------------------------------------------------------------------------------------
+Quaternion::Quaternion(float initialX, float initialY, float initialZ, float initialW) :
+	x(initialX),
+	y(initialY),
+	z(initialZ),
+	w(initialW)
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Quaternion Quaternion::MakeFromAxisAngleDegrees(Vec3 const& axis, float degrees)
+{
+	Vec3 unitAxis = axis.GetNormalized();
+	float halfDegrees = 0.5f * degrees;
+	float s = SinDegrees(halfDegrees);
+	return Quaternion(unitAxis.x * s, unitAxis.y * s, unitAxis.z * s, CosDegrees(halfDegrees));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Quaternion Quaternion::MakeFromEulerAnglesDegrees(EulerAngles const& orientation)
+{
+	Quaternion yaw = MakeFromAxisAngleDegrees(Vec3(0.f, 0.f, 1.f), orientation.m_yawDegrees);
+	Quaternion pitch = MakeFromAxisAngleDegrees(Vec3(0.f, 1.f, 0.f), orientation.m_pitchDegrees);
+	Quaternion roll = MakeFromAxisAngleDegrees(Vec3(1.f, 0.f, 0.f), orientation.m_rollDegrees);
+	return yaw * pitch * roll;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Quaternion Quaternion::operator*(Quaternion const& rotationToApplyFirst) const
+{
+	Quaternion const& b = rotationToApplyFirst;
+	return Quaternion(
+		w * b.x + x * b.w + y * b.z - z * b.y,
+		w * b.y - x * b.z + y * b.w + z * b.x,
+		w * b.z + x * b.y - y * b.x + z * b.w,
+		w * b.w - x * b.x - y * b.y - z * b.z);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec3 Quaternion::Rotate(Vec3 const& vector) const
+{
+	// v + 2w(q x v) + 2q x (q x v)
+	Vec3 axis(x, y, z);
+	Vec3 twiceCross = CrossProduct3D(axis, vector) * 2.f;
+	return vector + (twiceCross * w) + CrossProduct3D(axis, twiceCross);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+float Quaternion::GetLength() const
+{
+	return sqrtf(x * x + y * y + z * z + w * w);
+}
+
+Quaternion Quaternion::GetNormalized() const
+{
+	float length = GetLength();
+	if (length <= 0.f)
+	{
+		return IDENTITY;
+	}
+
+	float scale = 1.f / length;
+	return Quaternion(x * scale, y * scale, z * scale, w * scale);
+}
+
+Quaternion Quaternion::GetConjugate() const
+{
+	return Quaternion(-x, -y, -z, w);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Quaternion::GetAsVectors_XFwd_YLeft_ZUp(Vec3& out_forwardIBasis, Vec3& out_leftJBasis, Vec3& out_upKBasis) const
+{
+	float xx = x * x;
+	float yy = y * y;
+	float zz = z * z;
+	float xy = x * y;
+	float xz = x * z;
+	float yz = y * z;
+	float wx = w * x;
+	float wy = w * y;
+	float wz = w * z;
+	out_forwardIBasis = Vec3(1.f - 2.f * (yy + zz), 2.f * (xy + wz), 2.f * (xz - wy));
+	out_leftJBasis = Vec3(2.f * (xy - wz), 1.f - 2.f * (xx + zz), 2.f * (yz + wx));
+	out_upKBasis = Vec3(2.f * (xz + wy), 2.f * (yz - wx), 1.f - 2.f * (xx + yy));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// read back off the basis; at +-90 pitch the roll is folded into the yaw
+//
+EulerAngles Quaternion::GetAsEulerAnglesDegrees() const
+{
+	Vec3 forward;
+	Vec3 left;
+	Vec3 up;
+	GetAsVectors_XFwd_YLeft_ZUp(forward, left, up);
+	float horizontalLength = sqrtf(forward.x * forward.x + forward.y * forward.y);
+	if (horizontalLength < 0.0001f)
+	{
+		return EulerAngles(Atan2Degrees(-left.x, left.y), Atan2Degrees(-forward.z, horizontalLength), 0.f);
+	}
+	return EulerAngles(Atan2Degrees(forward.y, forward.x), Atan2Degrees(-forward.z, horizontalLength), Atan2Degrees(left.z, up.z));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Quaternion Quaternion::GetRenormalizedFast() const
+{
+	// 1 / sqrt(l) is close to (3 - l) / 2 when l is close to one
+	float scale = 0.5f * (3.f - (x * x + y * y + z * z + w * w));
+	return Quaternion(x * scale, y * scale, z * scale, w * scale);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The step rotation comes from the series for sin and cos of the half angle, which is accurate to
+// far below float precision at frame-sized steps. Written out in floats since this runs for every
+// spinning entity every frame
+//
+Quaternion Quaternion::GetIntegrated(Vec3 const& localAngularVelocityDegrees, float deltaSeconds) const
+{
+	float halfRadiansPerDegree = ConvertDegreesToRadians(0.5f * deltaSeconds);
+	float halfX = localAngularVelocityDegrees.x * halfRadiansPerDegree;
+	float halfY = localAngularVelocityDegrees.y * halfRadiansPerDegree;
+	float halfZ = localAngularVelocityDegrees.z * halfRadiansPerDegree;
+	float halfAngleSquared = halfX * halfX + halfY * halfY + halfZ * halfZ;
+	float axisScale = 1.f - halfAngleSquared * (1.f / 6.f);
+	float stepX = halfX * axisScale;
+	float stepY = halfY * axisScale;
+	float stepZ = halfZ * axisScale;
+	float stepW = 1.f - 0.5f * halfAngleSquared;
+
+	// (*this) * step, then GetRenormalizedFast
+	float turnedX = w * stepX + x * stepW + y * stepZ - z * stepY;
+	float turnedY = w * stepY - x * stepZ + y * stepW + z * stepX;
+	float turnedZ = w * stepZ + x * stepY - y * stepX + z * stepW;
+	float turnedW = w * stepW - x * stepX - y * stepY - z * stepZ;
+	float scale = 0.5f * (3.f - (turnedX * turnedX + turnedY * turnedY + turnedZ * turnedZ + turnedW * turnedW));
+	return Quaternion(turnedX * scale, turnedY * scale, turnedZ * scale, turnedW * scale);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+float DotProduct4D(Quaternion const& a, Quaternion const& b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Quaternion Nlerp(Quaternion const& start, Quaternion const& end, float fraction)
+{
+	float sign = DotProduct4D(start, end) < 0.f ? -1.f : 1.f;
+	float startWeight = 1.f - fraction;
+	float endWeight = fraction * sign;
+	Quaternion blended(
+		start.x * startWeight + end.x * endWeight,
+		start.y * startWeight + end.y * endWeight,
+		start.z * startWeight + end.z * endWeight,
+		start.w * startWeight + end.w * endWeight);
+	return blended.GetNormalized();
+}
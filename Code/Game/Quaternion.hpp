@@ -0,0 +1,57 @@
+//-----------------------------------------------------------------------------------------------
+// Quaternion.hpp
+//
+// Unit quaternion rotations for the animation code, where Euler angles can't be blended, and for
+// entities that integrate their spin. Same axis conventions as the rest of the game: X forward,
+// Y left, Z up.
+//
+#pragma once
+
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+struct Quaternion
+{
+public:
+	float x = 0.f;
+	float y = 0.f;
+	float z = 0.f;
+	float w = 1.f;
+
+public:
+	Quaternion() = default;
+	Quaternion(float initialX, float initialY, float initialZ, float initialW);
+
+	static Quaternion MakeFromAxisAngleDegrees(Vec3 const& axis, float degrees);
+
+	// the rotation EulerAngles::GetAsMatrix_XFwd_YLeft_ZUp builds: yaw about Z, then pitch about Y,
+	// then roll about X
+	static Quaternion MakeFromEulerAnglesDegrees(EulerAngles const& orientation);
+
+	Quaternion operator*(Quaternion const& rotationToApplyFirst) const;
+
+	Vec3 Rotate(Vec3 const& vector) const;
+	float GetLength() const;
+	Quaternion GetNormalized() const;
+	Quaternion GetConjugate() const;
+
+	// rotated X, Y and Z axes of a unit quaternion, without trig
+	void GetAsVectors_XFwd_YLeft_ZUp(Vec3& out_forwardIBasis, Vec3& out_leftJBasis, Vec3& out_upKBasis) const;
+	EulerAngles GetAsEulerAnglesDegrees() const;
+
+	// one Newton step toward unit length; only for quaternions already close to it
+	Quaternion GetRenormalizedFast() const;
+
+	// turned by an angular velocity about its own X, Y and Z axes over one step
+	Quaternion GetIntegrated(Vec3 const& localAngularVelocityDegrees, float deltaSeconds) const;
+
+	static const Quaternion IDENTITY;
+};
+
+
+float DotProduct4D(Quaternion const& a, Quaternion const& b);
+
+// normalized lerp along the shorter arc
+Quaternion Nlerp(Quaternion const& start, Quaternion const& end, float fraction);
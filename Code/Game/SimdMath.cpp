@@ -0,0 +1,933 @@
+#include "Game/SimdMath.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+// flatten pulls the lane templates below into the AVX2 functions so they are built for AVX2 too
+#if defined(_MSC_VER)
+#define SIMD_MATH_AVX2_BATCH_FUNCTION
+#else
+#define SIMD_MATH_AVX2_BATCH_FUNCTION __attribute__((target("avx2,fma"), flatten))
+#endif
+
+
+static_assert(sizeof(Vec3) == 3 * sizeof(float), "NormalizeVectors reads Vec3 arrays as packed floats");
+static_assert(sizeof(SimdMat44) == sizeof(Mat44), "SimdMat44 must keep Mat44's layout");
+
+constexpr float DEGREES_PER_QUADRANT = 90.f;
+constexpr float RADIANS_PER_DEGREE = 0.01745329251994329577f;
+
+// minimax polynomials for sine and cosine on [-pi/4, pi/4]
+constexpr float SIN_COEFFICIENT_3 = -1.6666654611e-1f;
+constexpr float SIN_COEFFICIENT_5 = 8.3321608736e-3f;
+constexpr float SIN_COEFFICIENT_7 = -1.9515295891e-4f;
+constexpr float COS_COEFFICIENT_4 = 4.166664568298827e-2f;
+constexpr float COS_COEFFICIENT_6 = -1.388731625493765e-3f;
+constexpr float COS_COEFFICIENT_8 = 2.443315711809948e-5f;
+
+
+//-----------------------------------------------------------------------------------------------
+static CpuSimdSupport DetectCpuSimdSupport()
+{
+	CpuSimdSupport support;
+#if defined(_MSC_VER)
+	int cpuInfo[4];
+	__cpuid(cpuInfo, 0);
+	int highestFunction = cpuInfo[0];
+
+	__cpuid(cpuInfo, 1);
+	bool hasFma = (cpuInfo[2] & (1 << 12)) != 0;
+	bool hasAvx = (cpuInfo[2] & (1 << 28)) != 0;
+	bool hasOsSaveRestore = (cpuInfo[2] & (1 << 27)) != 0;
+	if (!hasAvx || !hasOsSaveRestore)
+	{
+		return support;
+	}
+
+	// the OS must also save the upper halves of the registers on a context switch
+	unsigned long long enabledStates = _xgetbv(0);
+	if ((enabledStates & 0x6) != 0x6)
+	{
+		return support;
+	}
+	support.m_hasAvx = true;
+
+	if (highestFunction >= 7 && hasFma)
+	{
+		__cpuidex(cpuInfo, 7, 0);
+		support.m_hasAvx2Fma = (cpuInfo[1] & (1 << 5)) != 0;
+	}
+#else
+	support.m_hasAvx = __builtin_cpu_supports("avx");
+	support.m_hasAvx2Fma = support.m_hasAvx && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+	return support;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+CpuSimdSupport const& GetCpuSimdSupport()
+{
+	static CpuSimdSupport const s_support = DetectCpuSimdSupport();
+	return s_support;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SimdMathPath GetBestSimdMathPath()
+{
+	static SimdMathPath const s_bestPath = GetCpuSimdSupport().m_hasAvx2Fma ? SIMD_MATH_PATH_AVX2 : SIMD_MATH_PATH_SSE;
+	return s_bestPath;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+char const* GetSimdMathPathName(SimdMathPath path)
+{
+	switch (path)
+	{
+	case SIMD_MATH_PATH_SCALAR:	return "scalar";
+	case SIMD_MATH_PATH_SSE:	return "SSE";
+	case SIMD_MATH_PATH_AVX2:	return "AVX2";
+	default:					return "unknown";
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static Vec3 GetAsVec3(__m128 values)
+{
+	alignas(16) float floats[4];
+	_mm_store_ps(floats, values);
+	return Vec3(floats[0], floats[1], floats[2]);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template<int LANE>
+static __m128 Splat(__m128 values)
+{
+	return _mm_shuffle_ps(values, values, _MM_SHUFFLE(LANE, LANE, LANE, LANE));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// matrix * column, one column of a product
+//
+static __m128 TransformColumn(__m128 const* matrixColumns, __m128 column)
+{
+	__m128 result = _mm_mul_ps(matrixColumns[0], Splat<0>(column));
+	result = _mm_add_ps(result, _mm_mul_ps(matrixColumns[1], Splat<1>(column)));
+	result = _mm_add_ps(result, _mm_mul_ps(matrixColumns[2], Splat<2>(column)));
+	return _mm_add_ps(result, _mm_mul_ps(matrixColumns[3], Splat<3>(column)));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SimdMat44::SimdMat44(Mat44 const& matrix)
+{
+	for (int columnIndex = 0; columnIndex < 4; columnIndex++)
+	{
+		m_columns[columnIndex] = _mm_loadu_ps(&matrix.m_values[4 * columnIndex]);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SimdMat44 SimdMat44::CreateIdentity()
+{
+	SimdMat44 identity;
+	identity.m_columns[0] = _mm_setr_ps(1.f, 0.f, 0.f, 0.f);
+	identity.m_columns[1] = _mm_setr_ps(0.f, 1.f, 0.f, 0.f);
+	identity.m_columns[2] = _mm_setr_ps(0.f, 0.f, 1.f, 0.f);
+	identity.m_columns[3] = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+	return identity;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Mat44 SimdMat44::GetAsMat44() const
+{
+	Mat44 matrix;
+	for (int columnIndex = 0; columnIndex < 4; columnIndex++)
+	{
+		_mm_storeu_ps(&matrix.m_values[4 * columnIndex], m_columns[columnIndex]);
+	}
+	return matrix;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec3 SimdMat44::GetIBasis3D() const
+{
+	return GetAsVec3(m_columns[0]);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec3 SimdMat44::GetJBasis3D() const
+{
+	return GetAsVec3(m_columns[1]);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec3 SimdMat44::GetKBasis3D() const
+{
+	return GetAsVec3(m_columns[2]);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec3 SimdMat44::GetTranslation3D() const
+{
+	return GetAsVec3(m_columns[3]);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SimdMat44::SetTranslation3D(Vec3 const& translation)
+{
+	m_columns[3] = _mm_setr_ps(translation.x, translation.y, translation.z, 1.f);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SimdMat44::AppendTranslation3D(Vec3 const& translation)
+{
+	m_columns[3] = TransformColumn(m_columns, _mm_setr_ps(translation.x, translation.y, translation.z, 1.f));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SimdMat44::Append(SimdMat44 const& appendThis)
+{
+	// every column is read before any is written, so appending a matrix to itself works
+	__m128 columns[4];
+	for (int columnIndex = 0; columnIndex < 4; columnIndex++)
+	{
+		columns[columnIndex] = TransformColumn(m_columns, appendThis.m_columns[columnIndex]);
+	}
+	for (int columnIndex = 0; columnIndex < 4; columnIndex++)
+	{
+		m_columns[columnIndex] = columns[columnIndex];
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec3 SimdMat44::TransformPosition3D(Vec3 const& position) const
+{
+	return GetAsVec3(TransformColumn(m_columns, _mm_setr_ps(position.x, position.y, position.z, 1.f)));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SimdMat44 SimdMat44::GetOrthonormalInverse() const
+{
+	// transposing I, J, K with (0, 0, 0, 1) gives the inverse rotation and keeps its w row zero
+	__m128 iBasis = m_columns[0];
+	__m128 jBasis = m_columns[1];
+	__m128 kBasis = m_columns[2];
+	__m128 wColumn = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+	_MM_TRANSPOSE4_PS(iBasis, jBasis, kBasis, wColumn);
+
+	__m128 translation = m_columns[3];
+	__m128 rotatedTranslation = _mm_mul_ps(iBasis, Splat<0>(translation));
+	rotatedTranslation = _mm_add_ps(rotatedTranslation, _mm_mul_ps(jBasis, Splat<1>(translation)));
+	rotatedTranslation = _mm_add_ps(rotatedTranslation, _mm_mul_ps(kBasis, Splat<2>(translation)));
+
+	SimdMat44 inverse;
+	inverse.m_columns[0] = iBasis;
+	inverse.m_columns[1] = jBasis;
+	inverse.m_columns[2] = kBasis;
+	inverse.m_columns[3] = _mm_sub_ps(wColumn, rotatedTranslation);
+	return inverse;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// One float per matrix: lane n of every value belongs to the nth matrix of the batch. The lane
+// templates below are written once and run on plain floats, FloatX4 and FloatX8.
+//
+struct FloatX4
+{
+	FloatX4() = default;
+	explicit FloatX4(__m128 values) : m_values(values) {}
+	explicit FloatX4(float value) : m_values(_mm_set1_ps(value)) {}
+
+	__m128	m_values;
+};
+
+inline FloatX4 operator+(FloatX4 a, FloatX4 b)	{ return FloatX4(_mm_add_ps(a.m_values, b.m_values)); }
+inline FloatX4 operator-(FloatX4 a, FloatX4 b)	{ return FloatX4(_mm_sub_ps(a.m_values, b.m_values)); }
+inline FloatX4 operator*(FloatX4 a, FloatX4 b)	{ return FloatX4(_mm_mul_ps(a.m_values, b.m_values)); }
+inline FloatX4 operator/(FloatX4 a, FloatX4 b)	{ return FloatX4(_mm_div_ps(a.m_values, b.m_values)); }
+inline FloatX4 operator-(FloatX4 a)				{ return FloatX4(_mm_xor_ps(a.m_values, _mm_set1_ps(-0.f))); }
+
+
+//-----------------------------------------------------------------------------------------------
+struct FloatX8
+{
+	FloatX8() = default;
+	SIMD_AVX2_FUNCTION explicit FloatX8(__m256 values) : m_values(values) {}
+	SIMD_AVX2_FUNCTION explicit FloatX8(float value) : m_values(_mm256_set1_ps(value)) {}
+
+	__m256	m_values;
+};
+
+SIMD_AVX2_FUNCTION inline FloatX8 operator+(FloatX8 a, FloatX8 b)	{ return FloatX8(_mm256_add_ps(a.m_values, b.m_values)); }
+SIMD_AVX2_FUNCTION inline FloatX8 operator-(FloatX8 a, FloatX8 b)	{ return FloatX8(_mm256_sub_ps(a.m_values, b.m_values)); }
+SIMD_AVX2_FUNCTION inline FloatX8 operator*(FloatX8 a, FloatX8 b)	{ return FloatX8(_mm256_mul_ps(a.m_values, b.m_values)); }
+SIMD_AVX2_FUNCTION inline FloatX8 operator/(FloatX8 a, FloatX8 b)	{ return FloatX8(_mm256_div_ps(a.m_values, b.m_values)); }
+SIMD_AVX2_FUNCTION inline FloatX8 operator-(FloatX8 a)				{ return FloatX8(_mm256_xor_ps(a.m_values, _mm256_set1_ps(-0.f))); }
+
+
+//-----------------------------------------------------------------------------------------------
+// Reduced to the nearest multiple of 90 degrees, which is exact in degrees, then the quadrant picks
+// which polynomial and sign each result takes
+//
+static void SinCosDegrees(FloatX4 const& degrees, FloatX4& out_sin, FloatX4& out_cos)
+{
+	__m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(degrees.m_values, _mm_set1_ps(1.f / DEGREES_PER_QUADRANT)));
+	__m128 reducedDegrees = _mm_sub_ps(degrees.m_values, _mm_mul_ps(_mm_cvtepi32_ps(quadrant), _mm_set1_ps(DEGREES_PER_QUADRANT)));
+	__m128 x = _mm_mul_ps(reducedDegrees, _mm_set1_ps(RADIANS_PER_DEGREE));
+	__m128 x2 = _mm_mul_ps(x, x);
+
+	__m128 sinPoly = _mm_add_ps(_mm_set1_ps(SIN_COEFFICIENT_5), _mm_mul_ps(x2, _mm_set1_ps(SIN_COEFFICIENT_7)));
+	sinPoly = _mm_add_ps(_mm_set1_ps(SIN_COEFFICIENT_3), _mm_mul_ps(x2, sinPoly));
+	sinPoly = _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(x, x2), sinPoly));
+
+	__m128 cosPoly = _mm_add_ps(_mm_set1_ps(COS_COEFFICIENT_6), _mm_mul_ps(x2, _mm_set1_ps(COS_COEFFICIENT_8)));
+	cosPoly = _mm_add_ps(_mm_set1_ps(COS_COEFFICIENT_4), _mm_mul_ps(x2, cosPoly));
+	cosPoly = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.f), _mm_mul_ps(_mm_set1_ps(0.5f), x2)), _mm_mul_ps(_mm_mul_ps(x2, x2), cosPoly));
+
+	__m128i one = _mm_set1_epi32(1);
+	__m128i two = _mm_set1_epi32(2);
+	__m128 isSwapped = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+	__m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+	__m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+
+	__m128 sinValues = _mm_or_ps(_mm_and_ps(isSwapped, cosPoly), _mm_andnot_ps(isSwapped, sinPoly));
+	__m128 cosValues = _mm_or_ps(_mm_and_ps(isSwapped, sinPoly), _mm_andnot_ps(isSwapped, cosPoly));
+	out_sin = FloatX4(_mm_xor_ps(sinValues, sinSign));
+	out_cos = FloatX4(_mm_xor_ps(cosValues, cosSign));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SIMD_AVX2_FUNCTION static void SinCosDegrees(FloatX8 const& degrees, FloatX8& out_sin, FloatX8& out_cos)
+{
+	__m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(degrees.m_values, _mm256_set1_ps(1.f / DEGREES_PER_QUADRANT)));
+	__m256 reducedDegrees = _mm256_fnmadd_ps(_mm256_cvtepi32_ps(quadrant), _mm256_set1_ps(DEGREES_PER_QUADRANT), degrees.m_values);
+	__m256 x = _mm256_mul_ps(reducedDegrees, _mm256_set1_ps(RADIANS_PER_DEGREE));
+	__m256 x2 = _mm256_mul_ps(x, x);
+
+	__m256 sinPoly = _mm256_fmadd_ps(x2, _mm256_set1_ps(SIN_COEFFICIENT_7), _mm256_set1_ps(SIN_COEFFICIENT_5));
+	sinPoly = _mm256_fmadd_ps(x2, sinPoly, _mm256_set1_ps(SIN_COEFFICIENT_3));
+	sinPoly = _mm256_fmadd_ps(_mm256_mul_ps(x, x2), sinPoly, x);
+
+	__m256 cosPoly = _mm256_fmadd_ps(x2, _mm256_set1_ps(COS_COEFFICIENT_8), _mm256_set1_ps(COS_COEFFICIENT_6));
+	cosPoly = _mm256_fmadd_ps(x2, cosPoly, _mm256_set1_ps(COS_COEFFICIENT_4));
+	cosPoly = _mm256_fmadd_ps(_mm256_mul_ps(x2, x2), cosPoly, _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), x2, _mm256_set1_ps(1.f)));
+
+	__m256i one = _mm256_set1_epi32(1);
+	__m256i two = _mm256_set1_epi32(2);
+	__m256 isSwapped = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+	__m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30));
+	__m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30));
+
+	__m256 sinValues = _mm256_blendv_ps(sinPoly, cosPoly, isSwapped);
+	__m256 cosValues = _mm256_blendv_ps(cosPoly, sinPoly, isSwapped);
+	out_sin = FloatX8(_mm256_xor_ps(sinValues, sinSign));
+	out_cos = FloatX8(_mm256_xor_ps(cosValues, cosSign));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Cofactor expansion through the 2x2 determinants of the top and bottom row pairs. a<row><column>
+// name the elements; Mat44 stores column <c> row <r> at 4 * c + r. Returns the determinant.
+//
+template<typename Lane>
+static Lane InvertMatrixLanes(Lane const* elements, Lane* out_inverse)
+{
+	Lane const& a00 = elements[0];	Lane const& a01 = elements[4];	Lane const& a02 = elements[8];	Lane const& a03 = elements[12];
+	Lane const& a10 = elements[1];	Lane const& a11 = elements[5];	Lane const& a12 = elements[9];	Lane const& a13 = elements[13];
+	Lane const& a20 = elements[2];	Lane const& a21 = elements[6];	Lane const& a22 = elements[10];	Lane const& a23 = elements[14];
+	Lane const& a30 = elements[3];	Lane const& a31 = elements[7];	Lane const& a32 = elements[11];	Lane const& a33 = elements[15];
+
+	Lane top0 = a00 * a11 - a10 * a01;
+	Lane top1 = a00 * a12 - a10 * a02;
+	Lane top2 = a00 * a13 - a10 * a03;
+	Lane top3 = a01 * a12 - a11 * a02;
+	Lane top4 = a01 * a13 - a11 * a03;
+	Lane top5 = a02 * a13 - a12 * a03;
+
+	Lane bottom0 = a20 * a31 - a30 * a21;
+	Lane bottom1 = a20 * a32 - a30 * a22;
+	Lane bottom2 = a20 * a33 - a30 * a23;
+	Lane bottom3 = a21 * a32 - a31 * a22;
+	Lane bottom4 = a21 * a33 - a31 * a23;
+	Lane bottom5 = a22 * a33 - a32 * a23;
+
+	Lane determinant = top0 * bottom5 - top1 * bottom4 + top2 * bottom3 + top3 * bottom2 - top4 * bottom1 + top5 * bottom0;
+	Lane scale = Lane(1.f) / determinant;
+
+	out_inverse[0] = (a11 * bottom5 - a12 * bottom4 + a13 * bottom3) * scale;
+	out_inverse[4] = (-a01 * bottom5 + a02 * bottom4 - a03 * bottom3) * scale;
+	out_inverse[8] = (a31 * top5 - a32 * top4 + a33 * top3) * scale;
+	out_inverse[12] = (-a21 * top5 + a22 * top4 - a23 * top3) * scale;
+
+	out_inverse[1] = (-a10 * bottom5 + a12 * bottom2 - a13 * bottom1) * scale;
+	out_inverse[5] = (a00 * bottom5 - a02 * bottom2 + a03 * bottom1) * scale;
+	out_inverse[9] = (-a30 * top5 + a32 * top2 - a33 * top1) * scale;
+	out_inverse[13] = (a20 * top5 - a22 * top2 + a23 * top1) * scale;
+
+	out_inverse[2] = (a10 * bottom4 - a11 * bottom2 + a13 * bottom0) * scale;
+	out_inverse[6] = (-a00 * bottom4 + a01 * bottom2 - a03 * bottom0) * scale;
+	out_inverse[10] = (a30 * top4 - a31 * top2 + a33 * top0) * scale;
+	out_inverse[14] = (-a20 * top4 + a21 * top2 - a23 * top0) * scale;
+
+	out_inverse[3] = (-a10 * bottom3 + a11 * bottom1 - a12 * bottom0) * scale;
+	out_inverse[7] = (a00 * bottom3 - a01 * bottom1 + a02 * bottom0) * scale;
+	out_inverse[11] = (-a30 * top3 + a31 * top1 - a32 * top0) * scale;
+	out_inverse[15] = (a20 * top3 - a21 * top1 + a22 * top0) * scale;
+	return determinant;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The same basis as EulerAngles::GetAsVectors_XFwd_YLeft_ZUp: yaw about Z, then pitch about Y,
+// then roll about X
+//
+template<typename Lane>
+static void GetEulerMatrixLanes(Lane const& yawDegrees, Lane const& pitchDegrees, Lane const& rollDegrees, Lane const* translation, Lane* out_elements)
+{
+	Lane sinYaw, cosYaw, sinPitch, cosPitch, sinRoll, cosRoll;
+	SinCosDegrees(yawDegrees, sinYaw, cosYaw);
+	SinCosDegrees(pitchDegrees, sinPitch, cosPitch);
+	SinCosDegrees(rollDegrees, sinRoll, cosRoll);
+
+	Lane zero = Lane(0.f);
+	out_elements[0] = cosYaw * cosPitch;
+	out_elements[1] = sinYaw * cosPitch;
+	out_elements[2] = -sinPitch;
+	out_elements[3] = zero;
+
+	out_elements[4] = cosYaw * sinPitch * sinRoll - sinYaw * cosRoll;
+	out_elements[5] = cosYaw * cosRoll + sinYaw * sinPitch * sinRoll;
+	out_elements[6] = cosPitch * sinRoll;
+	out_elements[7] = zero;
+
+	out_elements[8] = sinYaw * sinRoll + cosYaw * sinPitch * cosRoll;
+	out_elements[9] = sinYaw * sinPitch * cosRoll - cosYaw * sinRoll;
+	out_elements[10] = cosPitch * cosRoll;
+	out_elements[11] = zero;
+
+	out_elements[12] = translation[0];
+	out_elements[13] = translation[1];
+	out_elements[14] = translation[2];
+	out_elements[15] = Lane(1.f);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Four matrices to and from lanes: transposing the same column of each gives its four elements
+//
+static void LoadMatrixLanes(SimdMat44 const* matrices, FloatX4* out_elements)
+{
+	for (int columnIndex = 0; columnIndex < 4; columnIndex++)
+	{
+		__m128 row0 = matrices[0].m_columns[columnIndex];
+		__m128 row1 = matrices[1].m_columns[columnIndex];
+		__m128 row2 = matrices[2].m_columns[columnIndex];
+		__m128 row3 = matrices[3].m_columns[columnIndex];
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+		out_elements[4 * columnIndex + 0] = FloatX4(row0);
+		out_elements[4 * columnIndex + 1] = FloatX4(row1);
+		out_elements[4 * columnIndex + 2] = FloatX4(row2);
+		out_elements[4 * columnIndex + 3] = FloatX4(row3);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void StoreMatrixLanes(FloatX4 const* elements, SimdMat44* out_matrices)
+{
+	for (int columnIndex = 0; columnIndex < 4; columnIndex++)
+	{
+		__m128 row0 = elements[4 * columnIndex + 0].m_values;
+		__m128 row1 = elements[4 * columnIndex + 1].m_values;
+		__m128 row2 = elements[4 * columnIndex + 2].m_values;
+		__m128 row3 = elements[4 * columnIndex + 3].m_values;
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+		out_matrices[0].m_columns[columnIndex] = row0;
+		out_matrices[1].m_columns[columnIndex] = row1;
+		out_matrices[2].m_columns[columnIndex] = row2;
+		out_matrices[3].m_columns[columnIndex] = row3;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// eight matrices as two groups of four, one per half of each register
+//
+SIMD_AVX2_FUNCTION static void LoadMatrixLanes(SimdMat44 const* matrices, FloatX8* out_elements)
+{
+	FloatX4 lowElements[16];
+	FloatX4 highElements[16];
+	LoadMatrixLanes(&matrices[0], lowElements);
+	LoadMatrixLanes(&matrices[4], highElements);
+	for (int elementIndex = 0; elementIndex < 16; elementIndex++)
+	{
+		__m256 low = _mm256_castps128_ps256(lowElements[elementIndex].m_values);
+		out_elements[elementIndex] = FloatX8(_mm256_insertf128_ps(low, highElements[elementIndex].m_values, 1));
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SIMD_AVX2_FUNCTION static void StoreMatrixLanes(FloatX8 const* elements, SimdMat44* out_matrices)
+{
+	FloatX4 lowElements[16];
+	FloatX4 highElements[16];
+	for (int elementIndex = 0; elementIndex < 16; elementIndex++)
+	{
+		lowElements[elementIndex] = FloatX4(_mm256_castps256_ps128(elements[elementIndex].m_values));
+		highElements[elementIndex] = FloatX4(_mm256_extractf128_ps(elements[elementIndex].m_values, 1));
+	}
+	StoreMatrixLanes(lowElements, &out_matrices[0]);
+	StoreMatrixLanes(highElements, &out_matrices[4]);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static int ReplaceSingularInverses(float const* determinants, SimdMat44* inout_inverses, int count)
+{
+	int numSingular = 0;
+	for (int matrixIndex = 0; matrixIndex < count; matrixIndex++)
+	{
+		if (determinants[matrixIndex] == 0.f)
+		{
+			inout_inverses[matrixIndex] = SimdMat44::CreateIdentity();
+			numSingular++;
+		}
+	}
+	return numSingular;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void AppendMatricesScalar(SimdMat44 const* matrices, SimdMat44 const* appendThese, SimdMat44* out_matrices, int count)
+{
+	for (int matrixIndex = 0; matrixIndex < count; matrixIndex++)
+	{
+		Mat44 matrix = matrices[matrixIndex].GetAsMat44();
+		matrix.Append(appendThese[matrixIndex].GetAsMat44());
+		out_matrices[matrixIndex] = SimdMat44(matrix);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void AppendMatricesSse(SimdMat44 const* matrices, SimdMat44 const* appendThese, SimdMat44* out_matrices, int count)
+{
+	for (int matrixIndex = 0; matrixIndex < count; matrixIndex++)
+	{
+		SimdMat44 matrix = matrices[matrixIndex];
+		matrix.Append(appendThese[matrixIndex]);
+		out_matrices[matrixIndex] = matrix;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Two product columns per register: each half broadcasts its own column's weights
+//
+SIMD_AVX2_FUNCTION static void AppendMatricesAvx2(SimdMat44 const* matrices, SimdMat44 const* appendThese, SimdMat44* out_matrices, int count)
+{
+	for (int matrixIndex = 0; matrixIndex < count; matrixIndex++)
+	{
+		SimdMat44 const& matrix = matrices[matrixIndex];
+		__m256 iBasis = _mm256_broadcast_ps(&matrix.m_columns[0]);
+		__m256 jBasis = _mm256_broadcast_ps(&matrix.m_columns[1]);
+		__m256 kBasis = _mm256_broadcast_ps(&matrix.m_columns[2]);
+		__m256 translation = _mm256_broadcast_ps(&matrix.m_columns[3]);
+
+		float const* appendValues = reinterpret_cast<float const*>(appendThese[matrixIndex].m_columns);
+		__m256 columns01 = _mm256_loadu_ps(&appendValues[0]);
+		__m256 columns23 = _mm256_loadu_ps(&appendValues[8]);
+
+		__m256 result01 = _mm256_mul_ps(iBasis, _mm256_shuffle_ps(columns01, columns01, _MM_SHUFFLE(0, 0, 0, 0)));
+		result01 = _mm256_fmadd_ps(jBasis, _mm256_shuffle_ps(columns01, columns01, _MM_SHUFFLE(1, 1, 1, 1)), result01);
+		result01 = _mm256_fmadd_ps(kBasis, _mm256_shuffle_ps(columns01, columns01, _MM_SHUFFLE(2, 2, 2, 2)), result01);
+		result01 = _mm256_fmadd_ps(translation, _mm256_shuffle_ps(columns01, columns01, _MM_SHUFFLE(3, 3, 3, 3)), result01);
+
+		__m256 result23 = _mm256_mul_ps(iBasis, _mm256_shuffle_ps(columns23, columns23, _MM_SHUFFLE(0, 0, 0, 0)));
+		result23 = _mm256_fmadd_ps(jBasis, _mm256_shuffle_ps(columns23, columns23, _MM_SHUFFLE(1, 1, 1, 1)), result23);
+		result23 = _mm256_fmadd_ps(kBasis, _mm256_shuffle_ps(columns23, columns23, _MM_SHUFFLE(2, 2, 2, 2)), result23);
+		result23 = _mm256_fmadd_ps(translation, _mm256_shuffle_ps(columns23, columns23, _MM_SHUFFLE(3, 3, 3, 3)), result23);
+
+		float* outValues = reinterpret_cast<float*>(out_matrices[matrixIndex].m_columns);
+		_mm256_storeu_ps(&outValues[0], result01);
+		_mm256_storeu_ps(&outValues[8], result23);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AppendMatrices(SimdMathPath path, SimdMat44 const* matrices, SimdMat44 const* appendThese, SimdMat44* out_matrices, int count)
+{
+	switch (path)
+	{
+	case SIMD_MATH_PATH_AVX2:
+		GUARANTEE_OR_DIE(GetBestSimdMathPath() == SIMD_MATH_PATH_AVX2, "AVX2 math on a CPU without AVX2");
+		AppendMatricesAvx2(matrices, appendThese, out_matrices, count);
+		break;
+	case SIMD_MATH_PATH_SSE:
+		AppendMatricesSse(matrices, appendThese, out_matrices, count);
+		break;
+	default:
+		AppendMatricesScalar(matrices, appendThese, out_matrices, count);
+		break;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Mat44 only has GetOrthonormalInverse, so the scalar path runs the same expansion one matrix at
+// a time
+//
+static int InvertMatricesScalar(SimdMat44 const* matrices, SimdMat44* out_inverses, int count)
+{
+	int numSingular = 0;
+	for (int matrixIndex = 0; matrixIndex < count; matrixIndex++)
+	{
+		Mat44 matrix = matrices[matrixIndex].GetAsMat44();
+		Mat44 inverse;
+		float determinant = InvertMatrixLanes(matrix.m_values, inverse.m_values);
+		out_inverses[matrixIndex] = SimdMat44(inverse);
+		numSingular += ReplaceSingularInverses(&determinant, &out_inverses[matrixIndex], 1);
+	}
+	return numSingular;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static int InvertMatricesSse(SimdMat44 const* matrices, SimdMat44* out_inverses, int count)
+{
+	int numSingular = 0;
+	int matrixIndex = 0;
+	for (; matrixIndex + 4 <= count; matrixIndex += 4)
+	{
+		FloatX4 elements[16];
+		FloatX4 inverse[16];
+		LoadMatrixLanes(&matrices[matrixIndex], elements);
+		FloatX4 determinants = InvertMatrixLanes(elements, inverse);
+		StoreMatrixLanes(inverse, &out_inverses[matrixIndex]);
+
+		alignas(16) float laneDeterminants[4];
+		_mm_store_ps(laneDeterminants, determinants.m_values);
+		numSingular += ReplaceSingularInverses(laneDeterminants, &out_inverses[matrixIndex], 4);
+	}
+	return numSingular + InvertMatricesScalar(&matrices[matrixIndex], &out_inverses[matrixIndex], count - matrixIndex);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SIMD_MATH_AVX2_BATCH_FUNCTION static int InvertMatricesAvx2(SimdMat44 const* matrices, SimdMat44* out_inverses, int count)
+{
+	int numSingular = 0;
+	int matrixIndex = 0;
+	for (; matrixIndex + 8 <= count; matrixIndex += 8)
+	{
+		FloatX8 elements[16];
+		FloatX8 inverse[16];
+		LoadMatrixLanes(&matrices[matrixIndex], elements);
+		FloatX8 determinants = InvertMatrixLanes(elements, inverse);
+		StoreMatrixLanes(inverse, &out_inverses[matrixIndex]);
+
+		alignas(32) float laneDeterminants[8];
+		_mm256_store_ps(laneDeterminants, determinants.m_values);
+		numSingular += ReplaceSingularInverses(laneDeterminants, &out_inverses[matrixIndex], 8);
+	}
+	return numSingular + InvertMatricesSse(&matrices[matrixIndex], &out_inverses[matrixIndex], count - matrixIndex);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int InvertMatrices(SimdMathPath path, SimdMat44 const* matrices, SimdMat44* out_inverses, int count)
+{
+	switch (path)
+	{
+	case SIMD_MATH_PATH_AVX2:
+		GUARANTEE_OR_DIE(GetBestSimdMathPath() == SIMD_MATH_PATH_AVX2, "AVX2 math on a CPU without AVX2");
+		return InvertMatricesAvx2(matrices, out_inverses, count);
+	case SIMD_MATH_PATH_SSE:
+		return InvertMatricesSse(matrices, out_inverses, count);
+	default:
+		return InvertMatricesScalar(matrices, out_inverses, count);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void GetMatricesFromEulerAnglesScalar(EulerAngles const* orientations, Vec3 const* translations, SimdMat44* out_matrices, int count)
+{
+	for (int matrixIndex = 0; matrixIndex < count; matrixIndex++)
+	{
+		Mat44 matrix = orientations[matrixIndex].GetAsMatrix_XFwd_YLeft_ZUp();
+		matrix.SetTranslation3D(translations[matrixIndex]);
+		out_matrices[matrixIndex] = SimdMat44(matrix);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void GetMatricesFromEulerAnglesSse(EulerAngles const* orientations, Vec3 const* translations, SimdMat44* out_matrices, int count)
+{
+	int matrixIndex = 0;
+	for (; matrixIndex + 4 <= count; matrixIndex += 4)
+	{
+		EulerAngles const* angles = &orientations[matrixIndex];
+		Vec3 const* positions = &translations[matrixIndex];
+		FloatX4 yawDegrees(_mm_setr_ps(angles[0].m_yawDegrees, angles[1].m_yawDegrees, angles[2].m_yawDegrees, angles[3].m_yawDegrees));
+		FloatX4 pitchDegrees(_mm_setr_ps(angles[0].m_pitchDegrees, angles[1].m_pitchDegrees, angles[2].m_pitchDegrees, angles[3].m_pitchDegrees));
+		FloatX4 rollDegrees(_mm_setr_ps(angles[0].m_rollDegrees, angles[1].m_rollDegrees, angles[2].m_rollDegrees, angles[3].m_rollDegrees));
+		FloatX4 translation[3] =
+		{
+			FloatX4(_mm_setr_ps(positions[0].x, positions[1].x, positions[2].x, positions[3].x)),
+			FloatX4(_mm_setr_ps(positions[0].y, positions[1].y, positions[2].y, positions[3].y)),
+			FloatX4(_mm_setr_ps(positions[0].z, positions[1].z, positions[2].z, positions[3].z)),
+		};
+
+		FloatX4 elements[16];
+		GetEulerMatrixLanes(yawDegrees, pitchDegrees, rollDegrees, translation, elements);
+		StoreMatrixLanes(elements, &out_matrices[matrixIndex]);
+	}
+	GetMatricesFromEulerAnglesScalar(&orientations[matrixIndex], &translations[matrixIndex], &out_matrices[matrixIndex], count - matrixIndex);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SIMD_MATH_AVX2_BATCH_FUNCTION static void GetMatricesFromEulerAnglesAvx2(EulerAngles const* orientations, Vec3 const* translations, SimdMat44* out_matrices, int count)
+{
+	int matrixIndex = 0;
+	for (; matrixIndex + 8 <= count; matrixIndex += 8)
+	{
+		EulerAngles const* angles = &orientations[matrixIndex];
+		Vec3 const* positions = &translations[matrixIndex];
+		alignas(32) float lanes[6][8];
+		for (int lane = 0; lane < 8; lane++)
+		{
+			lanes[0][lane] = angles[lane].m_yawDegrees;
+			lanes[1][lane] = angles[lane].m_pitchDegrees;
+			lanes[2][lane] = angles[lane].m_rollDegrees;
+			lanes[3][lane] = positions[lane].x;
+			lanes[4][lane] = positions[lane].y;
+			lanes[5][lane] = positions[lane].z;
+		}
+
+		FloatX8 translation[3] = { FloatX8(_mm256_load_ps(lanes[3])), FloatX8(_mm256_load_ps(lanes[4])), FloatX8(_mm256_load_ps(lanes[5])) };
+		FloatX8 elements[16];
+		GetEulerMatrixLanes(FloatX8(_mm256_load_ps(lanes[0])), FloatX8(_mm256_load_ps(lanes[1])), FloatX8(_mm256_load_ps(lanes[2])), translation, elements);
+		StoreMatrixLanes(elements, &out_matrices[matrixIndex]);
+	}
+	GetMatricesFromEulerAnglesSse(&orientations[matrixIndex], &translations[matrixIndex], &out_matrices[matrixIndex], count - matrixIndex);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void GetMatricesFromEulerAngles(SimdMathPath path, EulerAngles const* orientations, Vec3 const* translations, SimdMat44* out_matrices, int count)
+{
+	switch (path)
+	{
+	case SIMD_MATH_PATH_AVX2:
+		GUARANTEE_OR_DIE(GetBestSimdMathPath() == SIMD_MATH_PATH_AVX2, "AVX2 math on a CPU without AVX2");
+		GetMatricesFromEulerAnglesAvx2(orientations, translations, out_matrices, count);
+		break;
+	case SIMD_MATH_PATH_SSE:
+		GetMatricesFromEulerAnglesSse(orientations, translations, out_matrices, count);
+		break;
+	default:
+		GetMatricesFromEulerAnglesScalar(orientations, translations, out_matrices, count);
+		break;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void NormalizeVectorsScalar(Vec3* inout_vectors, int count)
+{
+	for (int vectorIndex = 0; vectorIndex < count; vectorIndex++)
+	{
+		Vec3& vector = inout_vectors[vectorIndex];
+		if (vector.GetLengthSquared() > 0.f)
+		{
+			vector = vector.GetNormalized();
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Four packed Vec3s are three registers: x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3. They are split
+// into x, y and z registers, scaled, and packed back
+//
+static void NormalizeVectorsSse(Vec3* inout_vectors, int count)
+{
+	int vectorIndex = 0;
+	for (; vectorIndex + 4 <= count; vectorIndex += 4)
+	{
+		float* values = &inout_vectors[vectorIndex].x;
+		__m128 packed0 = _mm_loadu_ps(&values[0]);
+		__m128 packed1 = _mm_loadu_ps(&values[4]);
+		__m128 packed2 = _mm_loadu_ps(&values[8]);
+
+		__m128 xPair = _mm_shuffle_ps(packed1, packed2, _MM_SHUFFLE(1, 1, 2, 2));
+		__m128 x = _mm_shuffle_ps(packed0, xPair, _MM_SHUFFLE(2, 0, 3, 0));
+		__m128 y = _mm_shuffle_ps(_mm_shuffle_ps(packed0, packed1, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(packed1, packed2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 z = _mm_shuffle_ps(_mm_shuffle_ps(packed0, packed1, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(packed2, packed2, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+		__m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		__m128 isNonZero = _mm_cmpgt_ps(lengthSquared, _mm_setzero_ps());
+		__m128 scale = _mm_and_ps(isNonZero, _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(lengthSquared)));
+		x = _mm_mul_ps(x, scale);
+		y = _mm_mul_ps(y, scale);
+		z = _mm_mul_ps(z, scale);
+
+		packed0 = _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+		packed1 = _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+		packed2 = _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		_mm_storeu_ps(&values[0], packed0);
+		_mm_storeu_ps(&values[4], packed1);
+		_mm_storeu_ps(&values[8], packed2);
+	}
+	NormalizeVectorsScalar(&inout_vectors[vectorIndex], count - vectorIndex);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Normalizing is bound by loads and stores, which wider registers do not help, so the AVX2 path
+// uses SSE here
+//
+void NormalizeVectors(SimdMathPath path, Vec3* inout_vectors, int count)
+{
+	switch (path)
+	{
+	case SIMD_MATH_PATH_AVX2:
+	case SIMD_MATH_PATH_SSE:
+		NormalizeVectorsSse(inout_vectors, count);
+		break;
+	default:
+		NormalizeVectorsScalar(inout_vectors, count);
+		break;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void GetSinCosDegreesScalar(float const* degrees, float* out_sines, float* out_cosines, int count)
+{
+	for (int angleIndex = 0; angleIndex < count; angleIndex++)
+	{
+		out_sines[angleIndex] = SinDegrees(degrees[angleIndex]);
+		out_cosines[angleIndex] = CosDegrees(degrees[angleIndex]);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The last partial group is padded and run through the same polynomial, so every angle of one
+// call agrees with every other to the bit when their angles do
+//
+static void GetSinCosDegreesSse(float const* degrees, float* out_sines, float* out_cosines, int count)
+{
+	int angleIndex = 0;
+	for (; angleIndex + 4 <= count; angleIndex += 4)
+	{
+		FloatX4 sines;
+		FloatX4 cosines;
+		SinCosDegrees(FloatX4(_mm_loadu_ps(&degrees[angleIndex])), sines, cosines);
+		_mm_storeu_ps(&out_sines[angleIndex], sines.m_values);
+		_mm_storeu_ps(&out_cosines[angleIndex], cosines.m_values);
+	}
+
+	int numLeft = count - angleIndex;
+	if (numLeft > 0)
+	{
+		alignas(16) float lanes[3][4] = {};
+		for (int lane = 0; lane < numLeft; lane++)
+		{
+			lanes[0][lane] = degrees[angleIndex + lane];
+		}
+		FloatX4 sines;
+		FloatX4 cosines;
+		SinCosDegrees(FloatX4(_mm_load_ps(lanes[0])), sines, cosines);
+		_mm_store_ps(lanes[1], sines.m_values);
+		_mm_store_ps(lanes[2], cosines.m_values);
+		for (int lane = 0; lane < numLeft; lane++)
+		{
+			out_sines[angleIndex + lane] = lanes[1][lane];
+			out_cosines[angleIndex + lane] = lanes[2][lane];
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SIMD_AVX2_FUNCTION static void GetSinCosDegreesAvx2(float const* degrees, float* out_sines, float* out_cosines, int count)
+{
+	int angleIndex = 0;
+	for (; angleIndex + 8 <= count; angleIndex += 8)
+	{
+		FloatX8 sines;
+		FloatX8 cosines;
+		SinCosDegrees(FloatX8(_mm256_loadu_ps(&degrees[angleIndex])), sines, cosines);
+		_mm256_storeu_ps(&out_sines[angleIndex], sines.m_values);
+		_mm256_storeu_ps(&out_cosines[angleIndex], cosines.m_values);
+	}
+
+	int numLeft = count - angleIndex;
+	if (numLeft > 0)
+	{
+		alignas(32) float lanes[3][8] = {};
+		for (int lane = 0; lane < numLeft; lane++)
+		{
+			lanes[0][lane] = degrees[angleIndex + lane];
+		}
+		FloatX8 sines;
+		FloatX8 cosines;
+		SinCosDegrees(FloatX8(_mm256_load_ps(lanes[0])), sines, cosines);
+		_mm256_store_ps(lanes[1], sines.m_values);
+		_mm256_store_ps(lanes[2], cosines.m_values);
+		for (int lane = 0; lane < numLeft; lane++)
+		{
+			out_sines[angleIndex + lane] = lanes[1][lane];
+			out_cosines[angleIndex + lane] = lanes[2][lane];
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void GetSinCosDegrees(SimdMathPath path, float const* degrees, float* out_sines, float* out_cosines, int count)
+{
+	switch (path)
+	{
+	case SIMD_MATH_PATH_AVX2:
+		GUARANTEE_OR_DIE(GetBestSimdMathPath() == SIMD_MATH_PATH_AVX2, "AVX2 math on a CPU without AVX2");
+		GetSinCosDegreesAvx2(degrees, out_sines, out_cosines, count);
+		break;
+	case SIMD_MATH_PATH_SSE:
+		GetSinCosDegreesSse(degrees, out_sines, out_cosines, count);
+		break;
+	default:
+		GetSinCosDegreesScalar(degrees, out_sines, out_cosines, count);
+		break;
+	}
+}
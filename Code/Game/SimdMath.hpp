@@ -0,0 +1,95 @@
+//-----------------------------------------------------------------------------------------------
+// SimdMath.hpp
+//
+// SSE and AVX2 versions of the per-frame matrix work the engine's Mat44 and EulerAngles do one
+// call at a time. SimdMat44 keeps Mat44's layout (I, J, K, T columns, x y z w each) aligned to 16
+// bytes, so each column is one register and converting is a copy. The batch functions take a
+// path so the scalar reference, SSE and AVX2 can be compared. The scalar path calls the engine
+// wherever it has the operation (Append, GetAsMatrix_XFwd_YLeft_ZUp, GetNormalized). Every path
+// agrees with it to float rounding; sine and cosine come from a polynomial accurate to ~1e-7.
+// Batches work across matrices, one matrix per lane: 4 at a time for SSE and 8 for AVX2.
+//
+#pragma once
+
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <immintrin.h>
+
+
+// AVX and AVX2 code is only ever reached after the runtime check, so it is compiled for those
+// instructions on its own, function by function
+#if defined(_MSC_VER)
+#define SIMD_AVX_FUNCTION
+#define SIMD_AVX2_FUNCTION
+#else
+#define SIMD_AVX_FUNCTION __attribute__((target("avx")))
+#define SIMD_AVX2_FUNCTION __attribute__((target("avx2,fma")))
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// what the CPU and OS support past SSE2, checked once; every runtime path choice comes from here
+//
+struct CpuSimdSupport
+{
+	bool	m_hasAvx = false;
+	bool	m_hasAvx2Fma = false;			// AVX2 and FMA together
+};
+
+CpuSimdSupport const& GetCpuSimdSupport();
+
+
+//-----------------------------------------------------------------------------------------------
+enum SimdMathPath
+{
+	SIMD_MATH_PATH_SCALAR,
+	SIMD_MATH_PATH_SSE,
+	SIMD_MATH_PATH_AVX2,		// with FMA
+	NUM_SIMD_MATH_PATHS
+};
+
+SimdMathPath GetBestSimdMathPath();
+char const* GetSimdMathPathName(SimdMathPath path);
+
+
+//-----------------------------------------------------------------------------------------------
+struct alignas(16) SimdMat44
+{
+public:
+	SimdMat44() = default;
+	explicit SimdMat44(Mat44 const& matrix);
+	static SimdMat44 CreateIdentity();
+
+	Mat44 GetAsMat44() const;
+	Vec3 GetIBasis3D() const;
+	Vec3 GetJBasis3D() const;
+	Vec3 GetKBasis3D() const;
+	Vec3 GetTranslation3D() const;
+
+	void SetTranslation3D(Vec3 const& translation);
+	void AppendTranslation3D(Vec3 const& translation);
+	void Append(SimdMat44 const& appendThis);				// this = this * appendThis, as Mat44::Append
+	Vec3 TransformPosition3D(Vec3 const& position) const;
+	SimdMat44 GetOrthonormalInverse() const;				// rotation and translation only
+
+public:
+	__m128	m_columns[4];
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// out_matrices[i] = matrices[i] * appendThese[i]; out may alias either input
+void AppendMatrices(SimdMathPath path, SimdMat44 const* matrices, SimdMat44 const* appendThese, SimdMat44* out_matrices, int count);
+
+// general inverses; a singular matrix gets identity. Returns how many were singular
+int InvertMatrices(SimdMathPath path, SimdMat44 const* matrices, SimdMat44* out_inverses, int count);
+
+// the XFwd_YLeft_ZUp model matrix of each orientation, translated to its position
+void GetMatricesFromEulerAngles(SimdMathPath path, EulerAngles const* orientations, Vec3 const* translations, SimdMat44* out_matrices, int count);
+
+// zero vectors stay zero
+void NormalizeVectors(SimdMathPath path, Vec3* inout_vectors, int count);
+
+// out_sines[i] and out_cosines[i] of degrees[i], any range
+void GetSinCosDegrees(SimdMathPath path, float const* degrees, float* out_sines, float* out_cosines, int count);
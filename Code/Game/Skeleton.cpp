@@ -0,0 +1,369 @@
+#include "Game/Skeleton.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <emmintrin.h>
+
+
+//-----------------------------------------------------------------------------------------------
+int Skeleton::AddBone(std::string const& name, int parentIndex, Vec3 const& bindTranslation, Quaternion const& bindRotation)
+{
+	GUARANTEE_OR_DIE(GetNumBones() < MAX_SKELETON_BONES, "Skeleton has too many bones");
+	GUARANTEE_OR_DIE(parentIndex < GetNumBones(), "Bone parents must be added before their children");
+
+	m_boneNames.push_back(name);
+	m_parentIndexes.push_back(parentIndex);
+	m_bindTranslations.push_back(bindTranslation);
+	m_bindRotations.push_back(bindRotation);
+	return GetNumBones() - 1;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int Skeleton::GetBoneIndex(std::string const& name) const
+{
+	for (int boneIndex = 0; boneIndex < GetNumBones(); boneIndex++)
+	{
+		if (m_boneNames[boneIndex] == name)
+		{
+			return boneIndex;
+		}
+	}
+
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SkeletonPose::SkeletonPose(int numBones)
+{
+	Resize(numBones);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SkeletonPose::Resize(int numBones)
+{
+	m_numBones = numBones;
+	m_numBonesPadded = ::GetNumBonesPadded(numBones);
+	m_values.assign(NUM_POSE_CHANNELS * m_numBonesPadded, 0.f);
+
+	// padding bones hold identity so normalizing them is harmless
+	for (int boneIndex = 0; boneIndex < m_numBonesPadded; boneIndex++)
+	{
+		GetChannel(POSE_CHANNEL_ROTATION_W)[boneIndex] = 1.f;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SkeletonPose::SetToBindPose(Skeleton const& skeleton)
+{
+	Resize(skeleton.GetNumBones());
+	for (int boneIndex = 0; boneIndex < m_numBones; boneIndex++)
+	{
+		SetBone(boneIndex, skeleton.GetBindRotation(boneIndex), skeleton.GetBindTranslation(boneIndex));
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SkeletonPose::SetToZero()
+{
+	for (int valueIndex = 0; valueIndex < (int)m_values.size(); valueIndex++)
+	{
+		m_values[valueIndex] = 0.f;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Quaternion SkeletonPose::GetBoneRotation(int boneIndex) const
+{
+	return Quaternion(
+		GetChannel(POSE_CHANNEL_ROTATION_X)[boneIndex],
+		GetChannel(POSE_CHANNEL_ROTATION_Y)[boneIndex],
+		GetChannel(POSE_CHANNEL_ROTATION_Z)[boneIndex],
+		GetChannel(POSE_CHANNEL_ROTATION_W)[boneIndex]);
+}
+
+Vec3 SkeletonPose::GetBoneTranslation(int boneIndex) const
+{
+	return Vec3(
+		GetChannel(POSE_CHANNEL_TRANSLATION_X)[boneIndex],
+		GetChannel(POSE_CHANNEL_TRANSLATION_Y)[boneIndex],
+		GetChannel(POSE_CHANNEL_TRANSLATION_Z)[boneIndex]);
+}
+
+void SkeletonPose::SetBone(int boneIndex, Quaternion const& rotation, Vec3 const& translation)
+{
+	GetChannel(POSE_CHANNEL_ROTATION_X)[boneIndex] = rotation.x;
+	GetChannel(POSE_CHANNEL_ROTATION_Y)[boneIndex] = rotation.y;
+	GetChannel(POSE_CHANNEL_ROTATION_Z)[boneIndex] = rotation.z;
+	GetChannel(POSE_CHANNEL_ROTATION_W)[boneIndex] = rotation.w;
+	GetChannel(POSE_CHANNEL_TRANSLATION_X)[boneIndex] = translation.x;
+	GetChannel(POSE_CHANNEL_TRANSLATION_Y)[boneIndex] = translation.y;
+	GetChannel(POSE_CHANNEL_TRANSLATION_Z)[boneIndex] = translation.z;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vec3 BoneMatrix::TransformPosition(Vec3 const& position) const
+{
+	return Vec3(
+		m_rows[0][0] * position.x + m_rows[0][1] * position.y + m_rows[0][2] * position.z + m_rows[0][3],
+		m_rows[1][0] * position.x + m_rows[1][1] * position.y + m_rows[1][2] * position.z + m_rows[1][3],
+		m_rows[2][0] * position.x + m_rows[2][1] * position.y + m_rows[2][2] * position.z + m_rows[2][3]);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Scales four quaternions to unit length; zero-length ones (empty accumulators) become identity
+//
+static void NormalizeQuaternions4(__m128& x, __m128& y, __m128& z, __m128& w)
+{
+	__m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+	__m128 isValid = _mm_cmpgt_ps(lengthSquared, _mm_set1_ps(1.0e-12f));
+	__m128 inverseLength = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(_mm_max_ps(lengthSquared, _mm_set1_ps(1.0e-12f))));
+	x = _mm_and_ps(isValid, _mm_mul_ps(x, inverseLength));
+	y = _mm_and_ps(isValid, _mm_mul_ps(y, inverseLength));
+	z = _mm_and_ps(isValid, _mm_mul_ps(z, inverseLength));
+	w = _mm_or_ps(_mm_and_ps(isValid, _mm_mul_ps(w, inverseLength)), _mm_andnot_ps(isValid, _mm_set1_ps(1.f)));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void BlendPoses(SkeletonPose const& a, SkeletonPose const& b, float weight, SkeletonPose& out_pose)
+{
+	ASSERT_OR_DIE(a.GetNumBones() == b.GetNumBones(), "Blending poses from different skeletons");
+	if (out_pose.GetNumBones() != a.GetNumBones())
+	{
+		out_pose.Resize(a.GetNumBones());
+	}
+
+	__m128 const weightB = _mm_set1_ps(weight);
+	__m128 const weightA = _mm_set1_ps(1.f - weight);
+	__m128 const signBit = _mm_set1_ps(-0.f);
+	int numBonesPadded = a.GetNumBonesPadded();
+	for (int boneIndex = 0; boneIndex < numBonesPadded; boneIndex += 4)
+	{
+		__m128 ax = _mm_loadu_ps(a.GetChannel(POSE_CHANNEL_ROTATION_X) + boneIndex);
+		__m128 ay = _mm_loadu_ps(a.GetChannel(POSE_CHANNEL_ROTATION_Y) + boneIndex);
+		__m128 az = _mm_loadu_ps(a.GetChannel(POSE_CHANNEL_ROTATION_Z) + boneIndex);
+		__m128 aw = _mm_loadu_ps(a.GetChannel(POSE_CHANNEL_ROTATION_W) + boneIndex);
+		__m128 bx = _mm_loadu_ps(b.GetChannel(POSE_CHANNEL_ROTATION_X) + boneIndex);
+		__m128 by = _mm_loadu_ps(b.GetChannel(POSE_CHANNEL_ROTATION_Y) + boneIndex);
+		__m128 bz = _mm_loadu_ps(b.GetChannel(POSE_CHANNEL_ROTATION_Z) + boneIndex);
+		__m128 bw = _mm_loadu_ps(b.GetChannel(POSE_CHANNEL_ROTATION_W) + boneIndex);
+
+		// flip b's weight wherever it sits in the other hemisphere
+		__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+		__m128 signedWeightB = _mm_xor_ps(weightB, _mm_and_ps(dot, signBit));
+
+		__m128 x = _mm_add_ps(_mm_mul_ps(ax, weightA), _mm_mul_ps(bx, signedWeightB));
+		__m128 y = _mm_add_ps(_mm_mul_ps(ay, weightA), _mm_mul_ps(by, signedWeightB));
+		__m128 z = _mm_add_ps(_mm_mul_ps(az, weightA), _mm_mul_ps(bz, signedWeightB));
+		__m128 w = _mm_add_ps(_mm_mul_ps(aw, weightA), _mm_mul_ps(bw, signedWeightB));
+		NormalizeQuaternions4(x, y, z, w);
+		_mm_storeu_ps(out_pose.GetChannel(POSE_CHANNEL_ROTATION_X) + boneIndex, x);
+		_mm_storeu_ps(out_pose.GetChannel(POSE_CHANNEL_ROTATION_Y) + boneIndex, y);
+		_mm_storeu_ps(out_pose.GetChannel(POSE_CHANNEL_ROTATION_Z) + boneIndex, z);
+		_mm_storeu_ps(out_pose.GetChannel(POSE_CHANNEL_ROTATION_W) + boneIndex, w);
+
+		for (int channel = POSE_CHANNEL_TRANSLATION_X; channel <= POSE_CHANNEL_TRANSLATION_Z; channel++)
+		{
+			__m128 ta = _mm_loadu_ps(a.GetChannel((PoseChannel)channel) + boneIndex);
+			__m128 tb = _mm_loadu_ps(b.GetChannel((PoseChannel)channel) + boneIndex);
+			_mm_storeu_ps(out_pose.GetChannel((PoseChannel)channel) + boneIndex, _mm_add_ps(_mm_mul_ps(ta, weightA), _mm_mul_ps(tb, weightB)));
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AccumulatePose(SkeletonPose& accumulator, SkeletonPose const& pose, float weight)
+{
+	ASSERT_OR_DIE(accumulator.GetNumBones() == pose.GetNumBones(), "Accumulating poses from different skeletons");
+
+	__m128 const poseWeight = _mm_set1_ps(weight);
+	__m128 const signBit = _mm_set1_ps(-0.f);
+	int numBonesPadded = pose.GetNumBonesPadded();
+	for (int boneIndex = 0; boneIndex < numBonesPadded; boneIndex += 4)
+	{
+		__m128 ax = _mm_loadu_ps(accumulator.GetChannel(POSE_CHANNEL_ROTATION_X) + boneIndex);
+		__m128 ay = _mm_loadu_ps(accumulator.GetChannel(POSE_CHANNEL_ROTATION_Y) + boneIndex);
+		__m128 az = _mm_loadu_ps(accumulator.GetChannel(POSE_CHANNEL_ROTATION_Z) + boneIndex);
+		__m128 aw = _mm_loadu_ps(accumulator.GetChannel(POSE_CHANNEL_ROTATION_W) + boneIndex);
+		__m128 px = _mm_loadu_ps(pose.GetChannel(POSE_CHANNEL_ROTATION_X) + boneIndex);
+		__m128 py = _mm_loadu_ps(pose.GetChannel(POSE_CHANNEL_ROTATION_Y) + boneIndex);
+		__m128 pz = _mm_loadu_ps(pose.GetChannel(POSE_CHANNEL_ROTATION_Z) + boneIndex);
+		__m128 pw = _mm_loadu_ps(pose.GetChannel(POSE_CHANNEL_ROTATION_W) + boneIndex);
+
+		__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, px), _mm_mul_ps(ay, py)), _mm_add_ps(_mm_mul_ps(az, pz), _mm_mul_ps(aw, pw)));
+		__m128 signedWeight = _mm_xor_ps(poseWeight, _mm_and_ps(dot, signBit));
+		_mm_storeu_ps(accumulator.GetChannel(POSE_CHANNEL_ROTATION_X) + boneIndex, _mm_add_ps(ax, _mm_mul_ps(px, signedWeight)));
+		_mm_storeu_ps(accumulator.GetChannel(POSE_CHANNEL_ROTATION_Y) + boneIndex, _mm_add_ps(ay, _mm_mul_ps(py, signedWeight)));
+		_mm_storeu_ps(accumulator.GetChannel(POSE_CHANNEL_ROTATION_Z) + boneIndex, _mm_add_ps(az, _mm_mul_ps(pz, signedWeight)));
+		_mm_storeu_ps(accumulator.GetChannel(POSE_CHANNEL_ROTATION_W) + boneIndex, _mm_add_ps(aw, _mm_mul_ps(pw, signedWeight)));
+
+		for (int channel = POSE_CHANNEL_TRANSLATION_X; channel <= POSE_CHANNEL_TRANSLATION_Z; channel++)
+		{
+			float* accumulated = accumulator.GetChannel((PoseChannel)channel) + boneIndex;
+			__m128 translation = _mm_loadu_ps(pose.GetChannel((PoseChannel)channel) + boneIndex);
+			_mm_storeu_ps(accumulated, _mm_add_ps(_mm_loadu_ps(accumulated), _mm_mul_ps(translation, poseWeight)));
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void NormalizePoseRotations(SkeletonPose& pose)
+{
+	int numBonesPadded = pose.GetNumBonesPadded();
+	for (int boneIndex = 0; boneIndex < numBonesPadded; boneIndex += 4)
+	{
+		float* rotationX = pose.GetChannel(POSE_CHANNEL_ROTATION_X) + boneIndex;
+		float* rotationY = pose.GetChannel(POSE_CHANNEL_ROTATION_Y) + boneIndex;
+		float* rotationZ = pose.GetChannel(POSE_CHANNEL_ROTATION_Z) + boneIndex;
+		float* rotationW = pose.GetChannel(POSE_CHANNEL_ROTATION_W) + boneIndex;
+		__m128 x = _mm_loadu_ps(rotationX);
+		__m128 y = _mm_loadu_ps(rotationY);
+		__m128 z = _mm_loadu_ps(rotationZ);
+		__m128 w = _mm_loadu_ps(rotationW);
+		NormalizeQuaternions4(x, y, z, w);
+		_mm_storeu_ps(rotationX, x);
+		_mm_storeu_ps(rotationY, y);
+		_mm_storeu_ps(rotationZ, z);
+		_mm_storeu_ps(rotationW, w);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Local matrices for four bones at once, then transposed so each bone gets its own rows
+//
+static void ComputeLocalMatrices4(SkeletonPose const& pose, int firstBone, BoneMatrix* out_matrices)
+{
+	__m128 const one = _mm_set1_ps(1.f);
+	__m128 const two = _mm_set1_ps(2.f);
+	__m128 x = _mm_loadu_ps(pose.GetChannel(POSE_CHANNEL_ROTATION_X) + firstBone);
+	__m128 y = _mm_loadu_ps(pose.GetChannel(POSE_CHANNEL_ROTATION_Y) + firstBone);
+	__m128 z = _mm_loadu_ps(pose.GetChannel(POSE_CHANNEL_ROTATION_Z) + firstBone);
+	__m128 w = _mm_loadu_ps(pose.GetChannel(POSE_CHANNEL_ROTATION_W) + firstBone);
+
+	__m128 xx = _mm_mul_ps(x, x);
+	__m128 yy = _mm_mul_ps(y, y);
+	__m128 zz = _mm_mul_ps(z, z);
+	__m128 xy = _mm_mul_ps(x, y);
+	__m128 xz = _mm_mul_ps(x, z);
+	__m128 yz = _mm_mul_ps(y, z);
+	__m128 wx = _mm_mul_ps(w, x);
+	__m128 wy = _mm_mul_ps(w, y);
+	__m128 wz = _mm_mul_ps(w, z);
+
+	__m128 row0[4] =
+	{
+		_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))),
+		_mm_mul_ps(two, _mm_sub_ps(xy, wz)),
+		_mm_mul_ps(two, _mm_add_ps(xz, wy)),
+		_mm_loadu_ps(pose.GetChannel(POSE_CHANNEL_TRANSLATION_X) + firstBone),
+	};
+	__m128 row1[4] =
+	{
+		_mm_mul_ps(two, _mm_add_ps(xy, wz)),
+		_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))),
+		_mm_mul_ps(two, _mm_sub_ps(yz, wx)),
+		_mm_loadu_ps(pose.GetChannel(POSE_CHANNEL_TRANSLATION_Y) + firstBone),
+	};
+	__m128 row2[4] =
+	{
+		_mm_mul_ps(two, _mm_sub_ps(xz, wy)),
+		_mm_mul_ps(two, _mm_add_ps(yz, wx)),
+		_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))),
+		_mm_loadu_ps(pose.GetChannel(POSE_CHANNEL_TRANSLATION_Z) + firstBone),
+	};
+
+	_MM_TRANSPOSE4_PS(row0[0], row0[1], row0[2], row0[3]);
+	_MM_TRANSPOSE4_PS(row1[0], row1[1], row1[2], row1[3]);
+	_MM_TRANSPOSE4_PS(row2[0], row2[1], row2[2], row2[3]);
+	for (int lane = 0; lane < 4; lane++)
+	{
+		_mm_store_ps(out_matrices[lane].m_rows[0], row0[lane]);
+		_mm_store_ps(out_matrices[lane].m_rows[1], row1[lane]);
+		_mm_store_ps(out_matrices[lane].m_rows[2], row2[lane]);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// out = parent * local, in place over local
+//
+static void ConcatenateBoneMatrix(BoneMatrix const& parent, BoneMatrix& inout_local)
+{
+	__m128 localRow0 = _mm_load_ps(inout_local.m_rows[0]);
+	__m128 localRow1 = _mm_load_ps(inout_local.m_rows[1]);
+	__m128 localRow2 = _mm_load_ps(inout_local.m_rows[2]);
+	for (int row = 0; row < 3; row++)
+	{
+		__m128 parentRow = _mm_load_ps(parent.m_rows[row]);
+		__m128 result = _mm_mul_ps(_mm_shuffle_ps(parentRow, parentRow, _MM_SHUFFLE(0, 0, 0, 0)), localRow0);
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(parentRow, parentRow, _MM_SHUFFLE(1, 1, 1, 1)), localRow1));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(parentRow, parentRow, _MM_SHUFFLE(2, 2, 2, 2)), localRow2));
+
+		// the parent's translation only lands in the last column
+		__m128 parentTranslation = _mm_and_ps(parentRow, _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1)));
+		_mm_store_ps(inout_local.m_rows[row], _mm_add_ps(result, parentTranslation));
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void ComputeModelTransformsForBones(Skeleton const& skeleton, SkeletonPose const& pose, int numBones, BoneMatrix* transforms)
+{
+	// local matrices straight into the output; the last partial group goes through a scratch copy
+	int boneIndex = 0;
+	for (; boneIndex + 4 <= numBones; boneIndex += 4)
+	{
+		ComputeLocalMatrices4(pose, boneIndex, transforms + boneIndex);
+	}
+	if (boneIndex < numBones)
+	{
+		BoneMatrix tail[4];
+		ComputeLocalMatrices4(pose, boneIndex, tail);
+		for (int lane = 0; boneIndex + lane < numBones; lane++)
+		{
+			transforms[boneIndex + lane] = tail[lane];
+		}
+	}
+
+	// parents come first, so their model transforms are always ready
+	for (boneIndex = 0; boneIndex < numBones; boneIndex++)
+	{
+		int parentIndex = skeleton.GetParentIndex(boneIndex);
+		if (parentIndex >= 0)
+		{
+			ConcatenateBoneMatrix(transforms[parentIndex], transforms[boneIndex]);
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ComputeModelTransforms(Skeleton const& skeleton, SkeletonPose const& pose, BoneMatrix* out_modelTransforms, int numBones)
+{
+	ASSERT_OR_DIE(pose.GetNumBones() == skeleton.GetNumBones(), "Pose doesn't match skeleton");
+	numBones = numBones < 0 || numBones > skeleton.GetNumBones() ? skeleton.GetNumBones() : numBones;
+	ComputeModelTransformsForBones(skeleton, pose, numBones, out_modelTransforms);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ComputeModelTransformsBatch(Skeleton const& skeleton, SkeletonPose const* const* poses, int numPoses, BoneMatrix* out_modelTransforms)
+{
+	int numBones = skeleton.GetNumBones();
+	for (int poseIndex = 0; poseIndex < numPoses; poseIndex++)
+	{
+		SkeletonPose const& pose = *poses[poseIndex];
+		ASSERT_OR_DIE(pose.GetNumBones() == numBones, "Pose doesn't match skeleton");
+		ComputeModelTransformsForBones(skeleton, pose, numBones, out_modelTransforms + poseIndex * numBones);
+	}
+}
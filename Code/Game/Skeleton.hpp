@@ -0,0 +1,120 @@
+//-----------------------------------------------------------------------------------------------
+// Skeleton.hpp
+//
+// Bone hierarchy plus SoA pose buffers. A pose keeps every channel (rotation xyzw, translation xyz)
+// in its own contiguous run of floats, padded to a multiple of 4 bones, so sampling, blending and
+// quaternion-to-matrix conversion all run four bones per SSE instruction.
+//
+#pragma once
+
+#include "Game/Quaternion.hpp"
+
+#include "Engine/Math/Vec3.hpp"
+#include <string>
+#include <vector>
+
+
+constexpr int MAX_SKELETON_BONES = 64;
+
+
+//-----------------------------------------------------------------------------------------------
+enum PoseChannel
+{
+	POSE_CHANNEL_ROTATION_X,
+	POSE_CHANNEL_ROTATION_Y,
+	POSE_CHANNEL_ROTATION_Z,
+	POSE_CHANNEL_ROTATION_W,
+	POSE_CHANNEL_TRANSLATION_X,
+	POSE_CHANNEL_TRANSLATION_Y,
+	POSE_CHANNEL_TRANSLATION_Z,
+	NUM_POSE_CHANNELS
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline int GetNumBonesPadded(int numBones)
+{
+	return (numBones + 3) & ~3;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Parents always come before their children, so one forward pass resolves the hierarchy. Detail
+// bones (hands, toes) go last, so coarse LODs can animate just the leading bones.
+//
+class Skeleton
+{
+public:
+	int AddBone(std::string const& name, int parentIndex, Vec3 const& bindTranslation, Quaternion const& bindRotation = Quaternion::IDENTITY);
+
+	int GetNumBones() const { return (int)m_parentIndexes.size(); }
+	int GetNumBonesPadded() const { return ::GetNumBonesPadded(GetNumBones()); }
+	int GetParentIndex(int boneIndex) const { return m_parentIndexes[boneIndex]; }
+	std::string const& GetBoneName(int boneIndex) const { return m_boneNames[boneIndex]; }
+	int GetBoneIndex(std::string const& name) const;
+	Vec3 const& GetBindTranslation(int boneIndex) const { return m_bindTranslations[boneIndex]; }
+	Quaternion const& GetBindRotation(int boneIndex) const { return m_bindRotations[boneIndex]; }
+
+private:
+	std::vector<std::string>	m_boneNames;
+	std::vector<int>			m_parentIndexes;
+	std::vector<Vec3>			m_bindTranslations;
+	std::vector<Quaternion>		m_bindRotations;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Local (parent-relative) bone transforms, one float run per channel
+//
+class SkeletonPose
+{
+public:
+	SkeletonPose() = default;
+	explicit SkeletonPose(int numBones);
+
+	void Resize(int numBones);
+	void SetToBindPose(Skeleton const& skeleton);
+	void SetToZero();
+
+	int GetNumBones() const { return m_numBones; }
+	int GetNumBonesPadded() const { return m_numBonesPadded; }
+
+	float* GetChannel(PoseChannel channel) { return &m_values[channel * m_numBonesPadded]; }
+	float const* GetChannel(PoseChannel channel) const { return &m_values[channel * m_numBonesPadded]; }
+	float* GetValues() { return m_values.data(); }
+	float const* GetValues() const { return m_values.data(); }
+
+	Quaternion GetBoneRotation(int boneIndex) const;
+	Vec3 GetBoneTranslation(int boneIndex) const;
+	void SetBone(int boneIndex, Quaternion const& rotation, Vec3 const& translation);
+
+private:
+	int					m_numBones = 0;
+	int					m_numBonesPadded = 0;
+	std::vector<float>	m_values;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Affine bone transform, row-major 3x4 (rotation columns | translation) so each row is one SSE register
+//
+struct alignas(16) BoneMatrix
+{
+	float m_rows[3][4];
+
+	Vec3 GetTranslation() const { return Vec3(m_rows[0][3], m_rows[1][3], m_rows[2][3]); }
+	Vec3 TransformPosition(Vec3 const& position) const;
+};
+
+
+// out = a * (1 - weight) + b * weight, rotations along the shorter arc and renormalized
+void BlendPoses(SkeletonPose const& a, SkeletonPose const& b, float weight, SkeletonPose& out_pose);
+
+// weighted sum for multi-way blends: clear with SetToZero, accumulate, then normalize once
+void AccumulatePose(SkeletonPose& accumulator, SkeletonPose const& pose, float weight);
+void NormalizePoseRotations(SkeletonPose& pose);
+
+// local poses -> model space bone transforms, numBones per pose written back to back;
+// the single pose version can stop after the leading numBones (-1 for all)
+void ComputeModelTransforms(Skeleton const& skeleton, SkeletonPose const& pose, BoneMatrix* out_modelTransforms, int numBones = -1);
+void ComputeModelTransformsBatch(Skeleton const& skeleton, SkeletonPose const* const* poses, int numPoses, BoneMatrix* out_modelTransforms);
@@ -0,0 +1,339 @@
+#include "Game/SkinnedMesh.hpp"
+#include "Game/SimdMath.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <immintrin.h>
+
+
+//-----------------------------------------------------------------------------------------------
+SkinningPath GetBestSkinningPath()
+{
+	static SkinningPath const s_bestPath = GetCpuSimdSupport().m_hasAvx ? SKINNING_PATH_AVX : SKINNING_PATH_SSE;
+	return s_bestPath;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+char const* GetSkinningPathName(SkinningPath path)
+{
+	switch (path)
+	{
+	case SKINNING_PATH_SCALAR:	return "scalar";
+	case SKINNING_PATH_SSE:		return "SSE";
+	case SKINNING_PATH_AVX:		return "AVX";
+	default:					return "unknown";
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void SkinVertexesScalar(SkinningMatrix const* matrices, SkinVertex const* vertexes, int numVertexes, Vertex_PCU* out_vertexes)
+{
+	for (int vertexIndex = 0; vertexIndex < numVertexes; vertexIndex++)
+	{
+		SkinVertex const& vertex = vertexes[vertexIndex];
+		float blended[4][3] = {};
+		for (int influence = 0; influence < MAX_SKIN_INFLUENCES; influence++)
+		{
+			float weight = vertex.m_weights[influence];
+			SkinningMatrix const& matrix = matrices[vertex.m_boneIndexes[influence]];
+			for (int column = 0; column < 4; column++)
+			{
+				blended[column][0] += weight * matrix.m_columns[column][0];
+				blended[column][1] += weight * matrix.m_columns[column][1];
+				blended[column][2] += weight * matrix.m_columns[column][2];
+			}
+		}
+
+		float const* position = vertex.m_position;
+		Vec3& out_position = out_vertexes[vertexIndex].m_position;
+		out_position.x = blended[0][0] * position[0] + blended[1][0] * position[1] + blended[2][0] * position[2] + blended[3][0];
+		out_position.y = blended[0][1] * position[0] + blended[1][1] * position[1] + blended[2][1] * position[2] + blended[3][1];
+		out_position.z = blended[0][2] * position[0] + blended[1][2] * position[1] + blended[2][2] * position[2] + blended[3][2];
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Vertex_PCU positions are only 12 bytes, so the fourth lane must not be stored over the color
+//
+static inline void StorePosition(__m128 position, Vec3& out_position)
+{
+	_mm_storel_pi(reinterpret_cast<__m64*>(&out_position.x), position);
+	_mm_store_ss(&out_position.z, _mm_movehl_ps(position, position));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void SkinVertexesSse(SkinningMatrix const* matrices, SkinVertex const* vertexes, int numVertexes, Vertex_PCU* out_vertexes)
+{
+	for (int vertexIndex = 0; vertexIndex < numVertexes; vertexIndex++)
+	{
+		SkinVertex const& vertex = vertexes[vertexIndex];
+		__m128 weights = _mm_load_ps(vertex.m_weights);
+		__m128 column0 = _mm_setzero_ps();
+		__m128 column1 = _mm_setzero_ps();
+		__m128 column2 = _mm_setzero_ps();
+		__m128 column3 = _mm_setzero_ps();
+
+		// unrolled by hand; the weight broadcast needs a compile time lane
+		#define ACCUMULATE_INFLUENCE(lane)																	\
+		{																									\
+			SkinningMatrix const& matrix = matrices[vertex.m_boneIndexes[lane]];							\
+			__m128 weight = _mm_shuffle_ps(weights, weights, _MM_SHUFFLE(lane, lane, lane, lane));			\
+			column0 = _mm_add_ps(column0, _mm_mul_ps(_mm_load_ps(matrix.m_columns[0]), weight));			\
+			column1 = _mm_add_ps(column1, _mm_mul_ps(_mm_load_ps(matrix.m_columns[1]), weight));			\
+			column2 = _mm_add_ps(column2, _mm_mul_ps(_mm_load_ps(matrix.m_columns[2]), weight));			\
+			column3 = _mm_add_ps(column3, _mm_mul_ps(_mm_load_ps(matrix.m_columns[3]), weight));			\
+		}
+		ACCUMULATE_INFLUENCE(0)
+		ACCUMULATE_INFLUENCE(1)
+		ACCUMULATE_INFLUENCE(2)
+		ACCUMULATE_INFLUENCE(3)
+		#undef ACCUMULATE_INFLUENCE
+
+		__m128 position = _mm_load_ps(vertex.m_position);
+		__m128 result = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(column0, _mm_shuffle_ps(position, position, _MM_SHUFFLE(0, 0, 0, 0))), _mm_mul_ps(column1, _mm_shuffle_ps(position, position, _MM_SHUFFLE(1, 1, 1, 1)))),
+			_mm_add_ps(_mm_mul_ps(column2, _mm_shuffle_ps(position, position, _MM_SHUFFLE(2, 2, 2, 2))), column3));
+		StorePosition(result, out_vertexes[vertexIndex].m_position);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Two columns per register: (i | j) scaled by (x | y), (k | t) by (z | 1), then the halves summed
+//
+SIMD_AVX_FUNCTION static void SkinVertexesAvx(SkinningMatrix const* matrices, SkinVertex const* vertexes, int numVertexes, Vertex_PCU* out_vertexes)
+{
+	for (int vertexIndex = 0; vertexIndex < numVertexes; vertexIndex++)
+	{
+		SkinVertex const& vertex = vertexes[vertexIndex];
+		__m256 columns01 = _mm256_setzero_ps();
+		__m256 columns23 = _mm256_setzero_ps();
+		for (int influence = 0; influence < MAX_SKIN_INFLUENCES; influence++)
+		{
+			SkinningMatrix const& matrix = matrices[vertex.m_boneIndexes[influence]];
+			__m256 weight = _mm256_broadcast_ss(&vertex.m_weights[influence]);
+			columns01 = _mm256_add_ps(columns01, _mm256_mul_ps(_mm256_load_ps(matrix.m_columns[0]), weight));
+			columns23 = _mm256_add_ps(columns23, _mm256_mul_ps(_mm256_load_ps(matrix.m_columns[2]), weight));
+		}
+
+		__m128 position = _mm_load_ps(vertex.m_position);
+		__m128 x = _mm_shuffle_ps(position, position, _MM_SHUFFLE(0, 0, 0, 0));
+		__m128 y = _mm_shuffle_ps(position, position, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 z = _mm_shuffle_ps(position, position, _MM_SHUFFLE(2, 2, 2, 2));
+		__m256 xy = _mm256_insertf128_ps(_mm256_castps128_ps256(x), y, 1);
+		__m256 z1 = _mm256_insertf128_ps(_mm256_castps128_ps256(z), _mm_set1_ps(1.f), 1);
+		__m256 sum = _mm256_add_ps(_mm256_mul_ps(columns01, xy), _mm256_mul_ps(columns23, z1));
+		__m128 result = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+		StorePosition(result, out_vertexes[vertexIndex].m_position);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SkinVertexes(SkinningPath path, SkinningMatrix const* matrices, SkinVertex const* vertexes, int numVertexes, Vertex_PCU* out_vertexes)
+{
+	switch (path)
+	{
+	case SKINNING_PATH_AVX:
+		GUARANTEE_OR_DIE(GetBestSkinningPath() == SKINNING_PATH_AVX, "AVX skinning on a CPU without AVX");
+		SkinVertexesAvx(matrices, vertexes, numVertexes, out_vertexes);
+		break;
+	case SKINNING_PATH_SSE:
+		SkinVertexesSse(matrices, vertexes, numVertexes, out_vertexes);
+		break;
+	default:
+		SkinVertexesScalar(matrices, vertexes, numVertexes, out_vertexes);
+		break;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Textbook linear blend skinning in doubles, straight from the row-major transforms; the other
+// paths are measured against this
+//
+void SkinVertexesReference(BoneMatrix const* skinningTransforms, SkinVertex const* vertexes, int numVertexes, Vec3* out_positions)
+{
+	for (int vertexIndex = 0; vertexIndex < numVertexes; vertexIndex++)
+	{
+		SkinVertex const& vertex = vertexes[vertexIndex];
+		double skinned[3] = {};
+		for (int influence = 0; influence < MAX_SKIN_INFLUENCES; influence++)
+		{
+			double weight = vertex.m_weights[influence];
+			if (weight == 0.0)
+			{
+				continue;
+			}
+
+			BoneMatrix const& transform = skinningTransforms[vertex.m_boneIndexes[influence]];
+			for (int row = 0; row < 3; row++)
+			{
+				double transformed = static_cast<double>(transform.m_rows[row][0]) * vertex.m_position[0] +
+					static_cast<double>(transform.m_rows[row][1]) * vertex.m_position[1] +
+					static_cast<double>(transform.m_rows[row][2]) * vertex.m_position[2] +
+					static_cast<double>(transform.m_rows[row][3]);
+				skinned[row] += weight * transformed;
+			}
+		}
+		out_positions[vertexIndex] = Vec3(static_cast<float>(skinned[0]), static_cast<float>(skinned[1]), static_cast<float>(skinned[2]));
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+BoneMatrix GetInverseRigidTransform(BoneMatrix const& transform)
+{
+	// rotation transposed, translation rotated back and negated
+	BoneMatrix inverse;
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 3; column++)
+		{
+			inverse.m_rows[row][column] = transform.m_rows[column][row];
+		}
+		inverse.m_rows[row][3] = -(transform.m_rows[0][row] * transform.m_rows[0][3] + transform.m_rows[1][row] * transform.m_rows[1][3] + transform.m_rows[2][row] * transform.m_rows[2][3]);
+	}
+	return inverse;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+BoneMatrix GetConcatenatedTransform(BoneMatrix const& first, BoneMatrix const& second)
+{
+	BoneMatrix result;
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			result.m_rows[row][column] = first.m_rows[row][0] * second.m_rows[0][column] + first.m_rows[row][1] * second.m_rows[1][column] + first.m_rows[row][2] * second.m_rows[2][column];
+		}
+		result.m_rows[row][3] += first.m_rows[row][3];
+	}
+	return result;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ComputeSkinningMatrices(BoneMatrix const* modelTransforms, BoneMatrix const* inverseBindTransforms, int numBones, SkinningMatrix* out_matrices)
+{
+	for (int boneIndex = 0; boneIndex < numBones; boneIndex++)
+	{
+		BoneMatrix skinning = GetConcatenatedTransform(modelTransforms[boneIndex], inverseBindTransforms[boneIndex]);
+		SkinningMatrix& matrix = out_matrices[boneIndex];
+		for (int column = 0; column < 4; column++)
+		{
+			matrix.m_columns[column][0] = skinning.m_rows[0][column];
+			matrix.m_columns[column][1] = skinning.m_rows[1][column];
+			matrix.m_columns[column][2] = skinning.m_rows[2][column];
+			matrix.m_columns[column][3] = 0.f;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SkinnedMesh::SetBindPose(Skeleton const& skeleton)
+{
+	SkeletonPose bindPose;
+	bindPose.SetToBindPose(skeleton);
+	std::vector<BoneMatrix> bindTransforms(skeleton.GetNumBones());
+	ComputeModelTransforms(skeleton, bindPose, bindTransforms.data());
+
+	m_inverseBindTransforms.resize(skeleton.GetNumBones());
+	for (int boneIndex = 0; boneIndex < skeleton.GetNumBones(); boneIndex++)
+	{
+		m_inverseBindTransforms[boneIndex] = GetInverseRigidTransform(bindTransforms[boneIndex]);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SkinnedMesh::AddVertex(Vertex_PCU const& bindVert, int const* boneIndexes, float const* weights, int numInfluences)
+{
+	SkinVertex vertex;
+	vertex.m_position[0] = bindVert.m_position.x;
+	vertex.m_position[1] = bindVert.m_position.y;
+	vertex.m_position[2] = bindVert.m_position.z;
+
+	float totalWeight = 0.f;
+	for (int influence = 0; influence < numInfluences; influence++)
+	{
+		totalWeight += weights[influence];
+	}
+	for (int influence = 0; influence < numInfluences; influence++)
+	{
+		GUARANTEE_OR_DIE(boneIndexes[influence] >= 0 && boneIndexes[influence] < 256, "Skin influences must use bones 0 to 255");
+		vertex.m_boneIndexes[influence] = static_cast<unsigned char>(boneIndexes[influence]);
+		vertex.m_weights[influence] = weights[influence] / totalWeight;
+	}
+
+	m_skinVertexes.push_back(vertex);
+	m_bindVertexes.push_back(bindVert);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SkinnedMesh::AddRigidVerts(std::vector<Vertex_PCU> const& bindVerts, int boneIndex)
+{
+	float const weight = 1.f;
+	for (Vertex_PCU const& bindVert : bindVerts)
+	{
+		AddVertex(bindVert, &boneIndex, &weight, 1);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SkinnedMesh::AddLimbVerts(std::vector<Vertex_PCU> const& bindVerts, Vec3 const& start, Vec3 const& end, int boneIndex,
+	int startNeighborBone, int endNeighborBone, float blendFraction)
+{
+	Vec3 axis = end - start;
+	float axisLengthSquared = axis.x * axis.x + axis.y * axis.y + axis.z * axis.z;
+	for (Vertex_PCU const& bindVert : bindVerts)
+	{
+		Vec3 offset = bindVert.m_position - start;
+		float fraction = axisLengthSquared > 0.f ? (offset.x * axis.x + offset.y * axis.y + offset.z * axis.z) / axisLengthSquared : 0.f;
+		fraction = fraction < 0.f ? 0.f : (fraction > 1.f ? 1.f : fraction);
+
+		int boneIndexes[3] = { boneIndex, 0, 0 };
+		float weights[3] = { 1.f, 0.f, 0.f };
+		int numInfluences = 1;
+		if (startNeighborBone >= 0 && fraction < blendFraction)
+		{
+			boneIndexes[numInfluences] = startNeighborBone;
+			weights[numInfluences] = 0.5f * (1.f - fraction / blendFraction);
+			weights[0] -= weights[numInfluences];
+			numInfluences++;
+		}
+		if (endNeighborBone >= 0 && fraction > 1.f - blendFraction)
+		{
+			boneIndexes[numInfluences] = endNeighborBone;
+			weights[numInfluences] = 0.5f * (fraction - (1.f - blendFraction)) / blendFraction;
+			weights[0] -= weights[numInfluences];
+			numInfluences++;
+		}
+		AddVertex(bindVert, boneIndexes, weights, numInfluences);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SkinnedMesh::ComputeSkinningMatrices(BoneMatrix const* modelTransforms, SkinningMatrix* out_matrices) const
+{
+	::ComputeSkinningMatrices(modelTransforms, m_inverseBindTransforms.data(), GetNumBones(), out_matrices);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SkinnedMesh::Skin(SkinningMatrix const* matrices, SkinningPath path, std::vector<Vertex_PCU>& inout_vertexes) const
+{
+	if (inout_vertexes.size() != m_bindVertexes.size())
+	{
+		inout_vertexes = m_bindVertexes;
+	}
+	SkinVertexes(path, matrices, m_skinVertexes.data(), GetNumVertexes(), inout_vertexes.data());
+}
@@ -0,0 +1,98 @@
+//-----------------------------------------------------------------------------------------------
+// SkinnedMesh.hpp
+//
+// CPU skinning. Default.hlsl only applies a rigid model matrix, so skinned characters are deformed
+// here and drawn as ordinary Vertex_PCU arrays. Each vertex has up to four bone influences. The
+// skinning loop blends the bones' column-major matrices and transforms the bind position once.
+// It comes in scalar, SSE and AVX versions, picked at runtime from what the CPU supports, and all
+// three are checked against a double precision reference in BenchmarkSkinning.
+//
+#pragma once
+
+#include "Game/Skeleton.hpp"
+
+#include "Engine/Core/Vertex_PCU.hpp"
+#include <vector>
+
+
+constexpr int MAX_SKIN_INFLUENCES = 4;
+
+
+//-----------------------------------------------------------------------------------------------
+enum SkinningPath
+{
+	SKINNING_PATH_SCALAR,
+	SKINNING_PATH_SSE,
+	SKINNING_PATH_AVX,
+	NUM_SKINNING_PATHS
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Bind position padded to a full register; unused influences have zero weight
+//
+struct alignas(16) SkinVertex
+{
+	float			m_position[4] = { 0.f, 0.f, 0.f, 1.f };
+	float			m_weights[MAX_SKIN_INFLUENCES] = {};
+	unsigned char	m_boneIndexes[MAX_SKIN_INFLUENCES] = {};
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Model transform times inverse bind transform, stored by column (i, j, k, translation) so two
+// columns fill one AVX register; the fourth lane of each column is zero
+//
+struct alignas(32) SkinningMatrix
+{
+	float m_columns[4][4];
+};
+
+
+SkinningPath GetBestSkinningPath();
+char const* GetSkinningPathName(SkinningPath path);
+
+// writes only m_position of each output vertex; path must be supported by this CPU
+void SkinVertexes(SkinningPath path, SkinningMatrix const* matrices, SkinVertex const* vertexes, int numVertexes, Vertex_PCU* out_vertexes);
+void SkinVertexesReference(BoneMatrix const* skinningTransforms, SkinVertex const* vertexes, int numVertexes, Vec3* out_positions);
+
+BoneMatrix GetInverseRigidTransform(BoneMatrix const& transform);
+BoneMatrix GetConcatenatedTransform(BoneMatrix const& first, BoneMatrix const& second);		// first * second
+void ComputeSkinningMatrices(BoneMatrix const* modelTransforms, BoneMatrix const* inverseBindTransforms, int numBones, SkinningMatrix* out_matrices);
+
+
+//-----------------------------------------------------------------------------------------------
+// Bind pose triangles with their influences, plus the inverse bind transforms they need
+//
+class SkinnedMesh
+{
+public:
+	void SetBindPose(Skeleton const& skeleton);
+
+	// triangles that follow one bone rigidly
+	void AddRigidVerts(std::vector<Vertex_PCU> const& bindVerts, int boneIndex);
+
+	// triangles along a limb from start to end that follows boneIndex, blending halfway into the
+	// neighboring bones over blendFraction of the length at each end (-1 for no neighbor)
+	void AddLimbVerts(std::vector<Vertex_PCU> const& bindVerts, Vec3 const& start, Vec3 const& end, int boneIndex,
+		int startNeighborBone, int endNeighborBone, float blendFraction);
+
+	void ComputeSkinningMatrices(BoneMatrix const* modelTransforms, SkinningMatrix* out_matrices) const;
+
+	// the first call on a fresh buffer copies colors and UVs; after that only positions are written
+	void Skin(SkinningMatrix const* matrices, SkinningPath path, std::vector<Vertex_PCU>& inout_vertexes) const;
+
+	int GetNumVertexes() const { return (int)m_skinVertexes.size(); }
+	int GetNumBones() const { return (int)m_inverseBindTransforms.size(); }
+	std::vector<Vertex_PCU> const& GetBindVertexes() const { return m_bindVertexes; }
+	SkinVertex const* GetSkinVertexes() const { return m_skinVertexes.data(); }
+	BoneMatrix const* GetInverseBindTransforms() const { return m_inverseBindTransforms.data(); }
+
+private:
+	void AddVertex(Vertex_PCU const& bindVert, int const* boneIndexes, float const* weights, int numInfluences);
+
+private:
+	std::vector<SkinVertex>		m_skinVertexes;
+	std::vector<Vertex_PCU>		m_bindVertexes;
+	std::vector<BoneMatrix>		m_inverseBindTransforms;
+};
@@ -0,0 +1,98 @@
+#include "Game/SpringArmCamera.hpp"
+#include "Game/PropBroadphase.hpp"
+
+#include "Engine/Math/MathUtils.hpp"
+
+
+constexpr float SPRING_ARM_MIN_LENGTH = 0.2f;
+
+
+//-----------------------------------------------------------------------------------------------
+SpringArmCamera::SpringArmCamera(SpringArmConfig const& config) :
+	m_config(config)
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SpringArmCamera::SnapTo(Vec3 const& targetPosition, EulerAngles const& viewOrientation)
+{
+	m_smoothedPivot = targetPosition + m_config.m_pivotOffset;
+	m_smoothedOrientation = viewOrientation;
+	m_currentArmLength = m_config.m_armLength;
+	m_hasSnapped = true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SpringArmCamera::Update(Vec3 const& targetPosition, EulerAngles const& viewOrientation, float deltaSeconds, PropBroadphase const& broadphase)
+{
+	if (!m_hasSnapped)
+	{
+		SnapTo(targetPosition, viewOrientation);
+	}
+
+	// lag: frame-rate independent exponential smoothing toward the target
+	float positionBlend = 1.f - expf(-m_config.m_positionLagSpeed * deltaSeconds);
+	float rotationBlend = 1.f - expf(-m_config.m_rotationLagSpeed * deltaSeconds);
+
+	Vec3 desiredPivot = targetPosition + m_config.m_pivotOffset;
+	m_smoothedPivot += (desiredPivot - m_smoothedPivot) * positionBlend;
+
+	float yawDisplacement = GetShortestAngularDispDegrees(m_smoothedOrientation.m_yawDegrees, viewOrientation.m_yawDegrees);
+	m_smoothedOrientation.m_yawDegrees += yawDisplacement * rotationBlend;
+	m_smoothedOrientation.m_pitchDegrees += (viewOrientation.m_pitchDegrees - m_smoothedOrientation.m_pitchDegrees) * rotationBlend;
+	m_smoothedOrientation.m_rollDegrees = 0.f;
+
+	Vec3 forward;
+	Vec3 left;
+	Vec3 up;
+	m_smoothedOrientation.GetAsVectors_XFwd_YLeft_ZUp(forward, left, up);
+
+	// probes: arm center plus four corners around it, all gathered in one broadphase pass
+	Vec3 armStart = m_smoothedPivot + (left * m_config.m_shoulderOffset);
+	Vec3 armEnd = armStart - (forward * m_config.m_armLength);
+	float spread = m_config.m_probeSpread;
+	Vec3 probeOffsets[NUM_SPRING_ARM_PROBES] =
+	{
+		Vec3(0.f, 0.f, 0.f),
+		(left + up) * spread,
+		(left - up) * spread,
+		(up - left) * spread,
+		(-left - up) * spread,
+	};
+
+	Vec3 probeStarts[NUM_SPRING_ARM_PROBES];
+	Vec3 probeEnds[NUM_SPRING_ARM_PROBES];
+	for (int probeIndex = 0; probeIndex < NUM_SPRING_ARM_PROBES; probeIndex++)
+	{
+		probeStarts[probeIndex] = armStart;
+		probeEnds[probeIndex] = armEnd + probeOffsets[probeIndex];
+	}
+
+	SphereCastResult probeResults[NUM_SPRING_ARM_PROBES];
+	broadphase.SphereCastBatch(probeStarts, probeEnds, NUM_SPRING_ARM_PROBES, m_config.m_probeRadius, probeResults);
+
+	float blockedFraction = 1.f;
+	for (int probeIndex = 0; probeIndex < NUM_SPRING_ARM_PROBES; probeIndex++)
+	{
+		if (probeResults[probeIndex].m_hitFraction < blockedFraction)
+		{
+			blockedFraction = probeResults[probeIndex].m_hitFraction;
+		}
+	}
+
+	// pull in immediately so the camera never ends up inside a prop, ease back out afterwards
+	float allowedArmLength = GetClamped(blockedFraction * m_config.m_armLength, SPRING_ARM_MIN_LENGTH, m_config.m_armLength);
+	if (allowedArmLength < m_currentArmLength)
+	{
+		m_currentArmLength = allowedArmLength;
+	}
+	else
+	{
+		float recoverBlend = 1.f - expf(-m_config.m_armRecoverSpeed * deltaSeconds);
+		m_currentArmLength += (allowedArmLength - m_currentArmLength) * recoverBlend;
+	}
+
+	m_cameraPosition = armStart - (forward * m_currentArmLength);
+}
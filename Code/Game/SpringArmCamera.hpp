@@ -0,0 +1,54 @@
+//-----------------------------------------------------------------------------------------------
+// SpringArmCamera.hpp
+//
+// Third-person camera boom: trails a pivot above the target with positional and rotational lag,
+// and sphere-casts from the pivot to pull the camera in when props block the arm.
+//
+#pragma once
+
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+
+class PropBroadphase;
+
+constexpr int NUM_SPRING_ARM_PROBES = 5;
+
+
+//-----------------------------------------------------------------------------------------------
+struct SpringArmConfig
+{
+	float	m_armLength = 4.f;
+	Vec3	m_pivotOffset = Vec3(0.f, 0.f, 0.6f);		// above the target, in world space
+	float	m_shoulderOffset = -0.5f;					// along the view's left axis; negative = right shoulder
+	float	m_probeRadius = 0.2f;
+	float	m_probeSpread = 0.15f;						// corner probes, roughly the near-plane footprint
+	float	m_positionLagSpeed = 12.f;
+	float	m_rotationLagSpeed = 25.f;
+	float	m_armRecoverSpeed = 3.f;					// arm lengthens slowly once the blocker is gone
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class SpringArmCamera
+{
+public:
+	SpringArmCamera() = default;
+	explicit SpringArmCamera(SpringArmConfig const& config);
+
+	void Update(Vec3 const& targetPosition, EulerAngles const& viewOrientation, float deltaSeconds, PropBroadphase const& broadphase);
+	void SnapTo(Vec3 const& targetPosition, EulerAngles const& viewOrientation);
+
+	Vec3 const& GetCameraPosition() const { return m_cameraPosition; }
+	EulerAngles const& GetCameraOrientation() const { return m_smoothedOrientation; }
+	float GetCurrentArmLength() const { return m_currentArmLength; }
+
+private:
+	SpringArmConfig	m_config;
+
+	bool			m_hasSnapped = false;
+	Vec3			m_smoothedPivot;
+	EulerAngles		m_smoothedOrientation;
+	float			m_currentArmLength = 0.f;
+	Vec3			m_cameraPosition;
+};
@@ -0,0 +1,746 @@
+//-----------------------------------------------------------------------------------------------
+// UnitTests_Custom.hpp
+//
+// Tests for SimdMath, the quaternion orientation entities can use, and the span vertex builders. The single-matrix functions
+// are checked against Mat44. Every batch path is checked against the scalar path, which calls the
+// engine, on batch sizes that leave remainders for the narrower paths. The AVX2 batches run only
+// where the CPU supports them; the tests then count the same either way. Rings are checked against
+// the per-side trig version they replaced, and the table-driven cube against quads. Prop physics
+// is checked by simple scenes whose outcome is known: resting, colliding, stacking and waking,
+// and a prop broadphase updated in place against one built from scratch.
+// Particles are checked for pool limits, expiry, motion, and SIMD billboards against scalar ones.
+//
+#pragma once
+
+#include "Game/DebugLineBatch.hpp"
+#include "Game/ParticleSystem.hpp"
+#include "Game/PropBroadphase.hpp"
+#include "Game/PropPhysics.hpp"
+#include "Game/Quaternion.hpp"
+#include "Game/SimdMath.hpp"
+#include "Game/VertexSpanUtils.hpp"
+
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+
+typedef int (TestSetFunctionType)();
+void VerifyTestResult(bool isCorrect, const char* testName);
+void RunTestSet(bool isGraded, TestSetFunctionType testSetFunction, const char* testSetName);
+
+
+constexpr float CUSTOM_TEST_TOLERANCE = 0.0001f;
+constexpr int CUSTOM_TEST_BATCH_SIZE = 37;		// not a multiple of 4 or 8
+
+
+//-----------------------------------------------------------------------------------------------
+// relative to b once it is larger than 1, since inverses can have large elements
+//
+static bool IsMostlyEqualCustom(float a, float b, float tolerance = CUSTOM_TEST_TOLERANCE)
+{
+	return fabsf(a - b) <= tolerance * fmaxf(1.f, fabsf(b));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static bool IsMostlyEqualCustom(Vec3 const& a, Vec3 const& b, float tolerance = CUSTOM_TEST_TOLERANCE)
+{
+	return IsMostlyEqualCustom(a.x, b.x, tolerance) && IsMostlyEqualCustom(a.y, b.y, tolerance) && IsMostlyEqualCustom(a.z, b.z, tolerance);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static bool IsMostlyEqualCustom(Mat44 const& a, Mat44 const& b, float tolerance = CUSTOM_TEST_TOLERANCE)
+{
+	for (int valueIndex = 0; valueIndex < 16; valueIndex++)
+	{
+		if (!IsMostlyEqualCustom(a.m_values[valueIndex], b.m_values[valueIndex], tolerance))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static bool AreBatchesMostlyEqualCustom(SimdMat44 const* a, SimdMat44 const* b, int count, float tolerance = CUSTOM_TEST_TOLERANCE)
+{
+	for (int matrixIndex = 0; matrixIndex < count; matrixIndex++)
+	{
+		if (!IsMostlyEqualCustom(a[matrixIndex].GetAsMat44(), b[matrixIndex].GetAsMat44(), tolerance))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// repeatable values in [-1, 1] without touching the engine's random number generator
+//
+static float GetCustomTestValue(int index)
+{
+	float value = sinf(12.9898f * (float)index) * 43758.5453f;
+	return 2.f * (value - floorf(value)) - 1.f;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static Mat44 GetCustomTestMatrix(int index)
+{
+	EulerAngles orientation(360.f * GetCustomTestValue(6 * index), 90.f * GetCustomTestValue(6 * index + 1), 180.f * GetCustomTestValue(6 * index + 2));
+	Mat44 matrix = orientation.GetAsMatrix_XFwd_YLeft_ZUp();
+	matrix.SetTranslation3D(Vec3(GetCustomTestValue(6 * index + 3), GetCustomTestValue(6 * index + 4), GetCustomTestValue(6 * index + 5)) * 50.f);
+	return matrix;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// a general matrix: rotation and translation with shear and scale mixed into the basis
+//
+static Mat44 GetCustomTestGeneralMatrix(int index)
+{
+	Mat44 matrix = GetCustomTestMatrix(index);
+	for (int valueIndex = 0; valueIndex < 12; valueIndex++)
+	{
+		if (valueIndex % 4 != 3)
+		{
+			matrix.m_values[valueIndex] += 0.5f * GetCustomTestValue(100 * index + valueIndex);
+		}
+	}
+	return matrix;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int TestSet_Custom_SimdMat44()
+{
+	Mat44 matrix = GetCustomTestMatrix(1);
+	Mat44 otherMatrix = GetCustomTestGeneralMatrix(2);
+	Vec3 position(3.f, -4.f, 5.5f);
+	SimdMat44 simdMatrix(matrix);
+
+	Mat44 roundTrip = simdMatrix.GetAsMat44();
+	bool isRoundTripExact = true;
+	for (int valueIndex = 0; valueIndex < 16; valueIndex++)
+	{
+		isRoundTripExact = isRoundTripExact && roundTrip.m_values[valueIndex] == matrix.m_values[valueIndex];
+	}
+	VerifyTestResult(isRoundTripExact, "SimdMat44 converts to and from Mat44 exactly");
+	VerifyTestResult(IsMostlyEqualCustom(SimdMat44::CreateIdentity().GetAsMat44(), Mat44(), 0.f), "SimdMat44::CreateIdentity matches Mat44()");
+	VerifyTestResult(IsMostlyEqualCustom(simdMatrix.GetIBasis3D(), matrix.GetIBasis3D(), 0.f), "SimdMat44::GetIBasis3D");
+	VerifyTestResult(IsMostlyEqualCustom(simdMatrix.GetJBasis3D(), matrix.GetJBasis3D(), 0.f), "SimdMat44::GetJBasis3D");
+	VerifyTestResult(IsMostlyEqualCustom(simdMatrix.GetKBasis3D(), matrix.GetKBasis3D(), 0.f), "SimdMat44::GetKBasis3D");
+	VerifyTestResult(IsMostlyEqualCustom(simdMatrix.GetTranslation3D(), matrix.GetTranslation3D(), 0.f), "SimdMat44::GetTranslation3D");
+
+	Mat44 translated = matrix;
+	translated.SetTranslation3D(position);
+	SimdMat44 simdTranslated = simdMatrix;
+	simdTranslated.SetTranslation3D(position);
+	VerifyTestResult(IsMostlyEqualCustom(simdTranslated.GetAsMat44(), translated), "SimdMat44::SetTranslation3D matches Mat44");
+
+	Mat44 appendedTranslation = matrix;
+	appendedTranslation.AppendTranslation3D(position);
+	SimdMat44 simdAppendedTranslation = simdMatrix;
+	simdAppendedTranslation.AppendTranslation3D(position);
+	VerifyTestResult(IsMostlyEqualCustom(simdAppendedTranslation.GetAsMat44(), appendedTranslation), "SimdMat44::AppendTranslation3D matches Mat44");
+
+	Mat44 appended = matrix;
+	appended.Append(otherMatrix);
+	SimdMat44 simdAppended = simdMatrix;
+	simdAppended.Append(SimdMat44(otherMatrix));
+	VerifyTestResult(IsMostlyEqualCustom(simdAppended.GetAsMat44(), appended), "SimdMat44::Append matches Mat44");
+
+	Mat44 selfAppended = matrix;
+	selfAppended.Append(matrix);
+	SimdMat44 simdSelfAppended = simdMatrix;
+	simdSelfAppended.Append(simdSelfAppended);
+	VerifyTestResult(IsMostlyEqualCustom(simdSelfAppended.GetAsMat44(), selfAppended), "SimdMat44::Append of itself matches Mat44");
+
+	VerifyTestResult(IsMostlyEqualCustom(simdMatrix.TransformPosition3D(position), matrix.TransformPosition3D(position)), "SimdMat44::TransformPosition3D matches Mat44");
+	VerifyTestResult(IsMostlyEqualCustom(simdMatrix.GetOrthonormalInverse().GetAsMat44(), matrix.GetOrthonormalInverse()), "SimdMat44::GetOrthonormalInverse matches Mat44");
+
+	SimdMat44 roundTripPosition = simdMatrix;
+	roundTripPosition.Append(simdMatrix.GetOrthonormalInverse());
+	VerifyTestResult(IsMostlyEqualCustom(roundTripPosition.GetAsMat44(), Mat44()), "SimdMat44 times its orthonormal inverse is identity");
+
+	return 13; // Number of tests expected
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// the best path and SSE, each against scalar
+//
+int TestSet_Custom_SimdBatches()
+{
+	std::vector<SimdMat44> matrices;
+	std::vector<SimdMat44> appendThese;
+	std::vector<EulerAngles> orientations;
+	std::vector<Vec3> translations;
+	std::vector<Vec3> vectors;
+	for (int index = 0; index < CUSTOM_TEST_BATCH_SIZE; index++)
+	{
+		matrices.push_back(SimdMat44(GetCustomTestGeneralMatrix(index)));
+		appendThese.push_back(SimdMat44(GetCustomTestMatrix(index + CUSTOM_TEST_BATCH_SIZE)));
+
+		// far outside one turn too, where reducing the angle matters
+		float turns = (index % 3 == 0) ? 40.f : 1.f;
+		orientations.push_back(EulerAngles(360.f * turns * GetCustomTestValue(3 * index), 90.f * GetCustomTestValue(3 * index + 1), 360.f * turns * GetCustomTestValue(3 * index + 2)));
+		translations.push_back(Vec3(GetCustomTestValue(index), GetCustomTestValue(index + 1), GetCustomTestValue(index + 2)) * 100.f);
+		vectors.push_back(index % 5 == 0 ? Vec3() : Vec3(GetCustomTestValue(index + 7), GetCustomTestValue(index + 8), GetCustomTestValue(index + 9)) * 20.f);
+	}
+	matrices[CUSTOM_TEST_BATCH_SIZE - 2] = SimdMat44(Mat44(Vec3(1.f, 0.f, 0.f), Vec3(2.f, 0.f, 0.f), Vec3(0.f, 0.f, 1.f), Vec3())); // singular
+
+	std::vector<SimdMat44> scalarAppended(CUSTOM_TEST_BATCH_SIZE);
+	std::vector<SimdMat44> scalarInverses(CUSTOM_TEST_BATCH_SIZE);
+	std::vector<SimdMat44> scalarEulerMatrices(CUSTOM_TEST_BATCH_SIZE);
+	std::vector<Vec3> scalarNormalized = vectors;
+	AppendMatrices(SIMD_MATH_PATH_SCALAR, matrices.data(), appendThese.data(), scalarAppended.data(), CUSTOM_TEST_BATCH_SIZE);
+	int numScalarSingular = InvertMatrices(SIMD_MATH_PATH_SCALAR, matrices.data(), scalarInverses.data(), CUSTOM_TEST_BATCH_SIZE);
+	GetMatricesFromEulerAngles(SIMD_MATH_PATH_SCALAR, orientations.data(), translations.data(), scalarEulerMatrices.data(), CUSTOM_TEST_BATCH_SIZE);
+	NormalizeVectors(SIMD_MATH_PATH_SCALAR, scalarNormalized.data(), CUSTOM_TEST_BATCH_SIZE);
+
+	std::vector<SimdMat44> products = matrices;
+	AppendMatrices(SIMD_MATH_PATH_SCALAR, products.data(), scalarInverses.data(), products.data(), CUSTOM_TEST_BATCH_SIZE);
+	bool areProductsIdentity = true;
+	for (int matrixIndex = 0; matrixIndex < CUSTOM_TEST_BATCH_SIZE; matrixIndex++)
+	{
+		areProductsIdentity = areProductsIdentity && (matrixIndex == CUSTOM_TEST_BATCH_SIZE - 2 || IsMostlyEqualCustom(products[matrixIndex].GetAsMat44(), Mat44(), 0.001f));
+	}
+	VerifyTestResult(areProductsIdentity, "InvertMatrices gives matrices whose products with the originals are identity");
+	VerifyTestResult(numScalarSingular == 1, "InvertMatrices reports the singular matrix");
+	VerifyTestResult(IsMostlyEqualCustom(scalarInverses[CUSTOM_TEST_BATCH_SIZE - 2].GetAsMat44(), Mat44(), 0.f), "InvertMatrices gives a singular matrix identity");
+
+	SimdMathPath paths[2] = { GetBestSimdMathPath(), SIMD_MATH_PATH_SSE };
+	for (SimdMathPath path : paths)
+	{
+		std::vector<SimdMat44> appended(CUSTOM_TEST_BATCH_SIZE);
+		std::vector<SimdMat44> inverses(CUSTOM_TEST_BATCH_SIZE);
+		std::vector<SimdMat44> eulerMatrices(CUSTOM_TEST_BATCH_SIZE);
+		std::vector<Vec3> normalized = vectors;
+		AppendMatrices(path, matrices.data(), appendThese.data(), appended.data(), CUSTOM_TEST_BATCH_SIZE);
+		int numSingular = InvertMatrices(path, matrices.data(), inverses.data(), CUSTOM_TEST_BATCH_SIZE);
+		GetMatricesFromEulerAngles(path, orientations.data(), translations.data(), eulerMatrices.data(), CUSTOM_TEST_BATCH_SIZE);
+		NormalizeVectors(path, normalized.data(), CUSTOM_TEST_BATCH_SIZE);
+
+		bool areNormalizedEqual = true;
+		for (int vectorIndex = 0; vectorIndex < CUSTOM_TEST_BATCH_SIZE; vectorIndex++)
+		{
+			areNormalizedEqual = areNormalizedEqual && IsMostlyEqualCustom(normalized[vectorIndex], scalarNormalized[vectorIndex]);
+		}
+
+		SimdMat44 aliased = matrices[0];
+		AppendMatrices(path, &aliased, &aliased, &aliased, 1);
+		SimdMat44 scalarAliased = matrices[0];
+		AppendMatrices(SIMD_MATH_PATH_SCALAR, &scalarAliased, &scalarAliased, &scalarAliased, 1);
+
+		VerifyTestResult(AreBatchesMostlyEqualCustom(appended.data(), scalarAppended.data(), CUSTOM_TEST_BATCH_SIZE), "AppendMatrices matches scalar");
+		VerifyTestResult(AreBatchesMostlyEqualCustom(&aliased, &scalarAliased, 1), "AppendMatrices in place matches scalar");
+		VerifyTestResult(AreBatchesMostlyEqualCustom(inverses.data(), scalarInverses.data(), CUSTOM_TEST_BATCH_SIZE), "InvertMatrices matches scalar");
+		VerifyTestResult(numSingular == numScalarSingular, "InvertMatrices counts singular matrices as scalar does");
+		VerifyTestResult(AreBatchesMostlyEqualCustom(eulerMatrices.data(), scalarEulerMatrices.data(), CUSTOM_TEST_BATCH_SIZE), "GetMatricesFromEulerAngles matches scalar");
+		VerifyTestResult(areNormalizedEqual, "NormalizeVectors matches scalar and keeps zero vectors zero");
+	}
+
+	return 15; // Number of tests expected
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int TestSet_Custom_QuaternionOrientation()
+{
+	EulerAngles orientation(123.f, -35.f, 70.f);
+	Vec3 eulerForward, eulerLeft, eulerUp;
+	orientation.GetAsVectors_XFwd_YLeft_ZUp(eulerForward, eulerLeft, eulerUp);
+	Quaternion quaternion = Quaternion::MakeFromEulerAnglesDegrees(orientation);
+	Vec3 forward, left, up;
+	quaternion.GetAsVectors_XFwd_YLeft_ZUp(forward, left, up);
+	VerifyTestResult(IsMostlyEqualCustom(forward, eulerForward) && IsMostlyEqualCustom(left, eulerLeft) && IsMostlyEqualCustom(up, eulerUp),
+		"Quaternion::MakeFromEulerAnglesDegrees matches EulerAngles::GetAsVectors_XFwd_YLeft_ZUp");
+
+	EulerAngles roundTrip = quaternion.GetAsEulerAnglesDegrees();
+	VerifyTestResult(IsMostlyEqualCustom(roundTrip.m_yawDegrees, orientation.m_yawDegrees, 0.001f) && IsMostlyEqualCustom(roundTrip.m_pitchDegrees, orientation.m_pitchDegrees, 0.001f)
+		&& IsMostlyEqualCustom(roundTrip.m_rollDegrees, orientation.m_rollDegrees, 0.001f), "Quaternion::GetAsEulerAnglesDegrees undoes MakeFromEulerAnglesDegrees");
+
+	Quaternion nearlyUnit(quaternion.x * 1.01f, quaternion.y * 1.01f, quaternion.z * 1.01f, quaternion.w * 1.01f);
+	VerifyTestResult(IsMostlyEqualCustom(nearlyUnit.GetRenormalizedFast().GetLength(), 1.f, 0.001f), "Quaternion::GetRenormalizedFast brings a nearly unit quaternion back to length 1");
+
+	// ten seconds of spin about a fixed axis of the body, one frame at a time
+	Vec3 angularVelocity(40.f, -25.f, 70.f);
+	Quaternion integrated = quaternion;
+	for (int frameIndex = 0; frameIndex < 600; frameIndex++)
+	{
+		integrated = integrated.GetIntegrated(angularVelocity, 1.f / 60.f);
+	}
+	Quaternion exact = quaternion * Quaternion::MakeFromAxisAngleDegrees(angularVelocity, angularVelocity.GetLength() * 10.f);
+	Vec3 exactForward, exactLeft, exactUp;
+	exact.GetAsVectors_XFwd_YLeft_ZUp(exactForward, exactLeft, exactUp);
+	integrated.GetAsVectors_XFwd_YLeft_ZUp(forward, left, up);
+	VerifyTestResult(IsMostlyEqualCustom(forward, exactForward, 0.001f) && IsMostlyEqualCustom(left, exactLeft, 0.001f) && IsMostlyEqualCustom(up, exactUp, 0.001f),
+		"Quaternion::GetIntegrated follows a constant spin");
+	VerifyTestResult(IsMostlyEqualCustom(integrated.GetLength(), 1.f, 0.0001f), "Quaternion::GetIntegrated stays unit length");
+
+	return 5; // Number of tests expected
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static bool AreVertexesMostlyEqualCustom(Vertex_PCU const* a, Vertex_PCU const* b, int count, float tolerance = CUSTOM_TEST_TOLERANCE)
+{
+	for (int vertexIndex = 0; vertexIndex < count; vertexIndex++)
+	{
+		Vertex_PCU const& vertexA = a[vertexIndex];
+		Vertex_PCU const& vertexB = b[vertexIndex];
+		if (!IsMostlyEqualCustom(vertexA.m_position, vertexB.m_position, tolerance) || !(vertexA.m_color == vertexB.m_color)
+			|| vertexA.m_uvTexCoords.x != vertexB.m_uvTexCoords.x || vertexA.m_uvTexCoords.y != vertexB.m_uvTexCoords.y)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int TestSet_Custom_RingTessellation()
+{
+	std::vector<float> degrees;
+	for (int index = 0; index < CUSTOM_TEST_BATCH_SIZE; index++)
+	{
+		degrees.push_back((index % 3 == 0 ? 14400.f : 360.f) * GetCustomTestValue(index));
+	}
+	std::vector<float> scalarSines(CUSTOM_TEST_BATCH_SIZE);
+	std::vector<float> scalarCosines(CUSTOM_TEST_BATCH_SIZE);
+	GetSinCosDegrees(SIMD_MATH_PATH_SCALAR, degrees.data(), scalarSines.data(), scalarCosines.data(), CUSTOM_TEST_BATCH_SIZE);
+
+	SimdMathPath paths[2] = { GetBestSimdMathPath(), SIMD_MATH_PATH_SSE };
+	for (SimdMathPath path : paths)
+	{
+		std::vector<float> sines(CUSTOM_TEST_BATCH_SIZE);
+		std::vector<float> cosines(CUSTOM_TEST_BATCH_SIZE);
+		GetSinCosDegrees(path, degrees.data(), sines.data(), cosines.data(), CUSTOM_TEST_BATCH_SIZE);
+		bool areEqual = true;
+		for (int index = 0; index < CUSTOM_TEST_BATCH_SIZE; index++)
+		{
+			areEqual = areEqual && IsMostlyEqualCustom(sines[index], scalarSines[index]) && IsMostlyEqualCustom(cosines[index], scalarCosines[index]);
+		}
+		VerifyTestResult(areEqual, "GetSinCosDegrees matches scalar");
+	}
+
+	// fewer sides than a SIMD register, the default, and more than one chunk
+	Vec2 center(800.f, 400.f);
+	Rgba8 color(10, 20, 30, 40);
+	int sideCounts[3] = { 7, RING2D_DEFAULT_NUM_SIDES, 300 };
+	for (int numSides : sideCounts)
+	{
+		std::vector<Vertex_PCU> ring(GetNumVertexesForRing2D(numSides));
+		std::vector<Vertex_PCU> reference(GetNumVertexesForRing2D(numSides));
+		VertexSpanWriter ringVerts(ring.data(), (int)ring.size());
+		VertexSpanWriter referenceVerts(reference.data(), (int)reference.size());
+		AddVertsForRing2D(ringVerts, center, 350.f, 20.f, color, numSides);
+		AddVertsForRing2DReference(referenceVerts, center, 350.f, 20.f, color, numSides);
+		VerifyTestResult(ringVerts.m_count == referenceVerts.m_count && AreVertexesMostlyEqualCustom(ring.data(), reference.data(), (int)ring.size()), "AddVertsForRing2D matches the trig reference");
+	}
+
+	std::vector<Vertex_PCU> ring(GetNumVertexesForRing2D());
+	VertexSpanWriter ringVerts(ring.data(), (int)ring.size());
+	AddVertsForRing2D(ringVerts, center, 350.f, 20.f, color);
+	Vec3 const& firstInner = ring[0].m_position;
+	Vec3 const& lastInner = ring[ring.size() - 1].m_position;
+	VerifyTestResult(firstInner.x == lastInner.x && firstInner.y == lastInner.y, "AddVertsForRing2D closes its seam exactly");
+
+	std::vector<Vertex_PCU> arc(GetNumVertexesForArc2D());
+	VertexSpanWriter arcVerts(arc.data(), (int)arc.size());
+	AddVertsForArc2D(arcVerts, center, 350.f, 20.f, 0.f, 360.f, color);
+	VerifyTestResult(AreVertexesMostlyEqualCustom(arc.data(), ring.data(), (int)ring.size(), 0.f), "AddVertsForArc2D over a full turn is AddVertsForRing2D");
+
+	arcVerts.m_count = 0;
+	AddVertsForArc2D(arcVerts, Vec2(), 100.f, 0.f, 30.f, 90.f, color);
+	Vec3 arcStart(100.f * CosDegrees(30.f), 100.f * SinDegrees(30.f), 0.f);
+	Vec3 arcEnd(100.f * CosDegrees(120.f), 100.f * SinDegrees(120.f), 0.f);
+	VerifyTestResult(IsMostlyEqualCustom(arc[0].m_position, arcStart) && IsMostlyEqualCustom(arc[arc.size() - 2].m_position, arcEnd), "AddVertsForArc2D starts and ends at its angles");
+
+	std::vector<Vertex_PCU> disc(GetNumVertexesForDisc2D());
+	VertexSpanWriter discVerts(disc.data(), (int)disc.size());
+	AddVertsForDisc2D(discVerts, center, 50.f, color);
+	bool isDiscRound = discVerts.m_count == GetNumVertexesForDisc2D();
+	for (int sideIndex = 0; sideIndex < RING2D_DEFAULT_NUM_SIDES; sideIndex++)
+	{
+		Vec3 const& hub = disc[3 * sideIndex].m_position;
+		Vec3 const& edge = disc[3 * sideIndex + 1].m_position;
+		isDiscRound = isDiscRound && hub.x == center.x && hub.y == center.y && IsMostlyEqualCustom(GetDistance2D(Vec2(edge.x, edge.y), center), 50.f);
+	}
+	VerifyTestResult(isDiscRound, "AddVertsForDisc2D fans from the center to the edge");
+
+	Ring2D rings[3];
+	for (int ringIndex = 0; ringIndex < 3; ringIndex++)
+	{
+		rings[ringIndex].m_center = Vec2(100.f * GetCustomTestValue(ringIndex), 100.f * GetCustomTestValue(ringIndex + 3));
+		rings[ringIndex].m_radius = 10.f + 5.f * (float)ringIndex;
+		rings[ringIndex].m_thickness = 1.f + (float)ringIndex;
+		rings[ringIndex].m_color = Rgba8((unsigned char)(50 * ringIndex), 0, 0);
+	}
+	std::vector<Vertex_PCU> batched(3 * GetNumVertexesForRing2D(100));
+	std::vector<Vertex_PCU> separate(3 * GetNumVertexesForRing2D(100));
+	VertexSpanWriter batchedVerts(batched.data(), (int)batched.size());
+	VertexSpanWriter separateVerts(separate.data(), (int)separate.size());
+	AddVertsForRings2D(batchedVerts, rings, 3, 100);
+	for (Ring2D const& ringDesc : rings)
+	{
+		AddVertsForRing2D(separateVerts, ringDesc.m_center, ringDesc.m_radius, ringDesc.m_thickness, ringDesc.m_color, 100);
+	}
+	VerifyTestResult(batchedVerts.m_count == separateVerts.m_count && AreVertexesMostlyEqualCustom(batched.data(), separate.data(), (int)batched.size(), 0.f), "AddVertsForRings2D matches separate AddVertsForRing2D calls");
+
+	return 10; // Number of tests expected
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// lines 0-3 are built by SSE and the rest one at a time
+//
+int TestSet_Custom_DebugLines()
+{
+	DebugLineBatch lines;
+	lines.AddLine(Vec2(0.f, 0.f), Vec2(10.f, 0.f), 2.f, Rgba8::RED);
+	lines.AddLine(Vec2(5.f, 5.f), Vec2(5.f, 5.f), 2.f, Rgba8::GREEN);
+	for (int lineIndex = 2; lineIndex < 9; lineIndex++)
+	{
+		Vec2 start(100.f * GetCustomTestValue(lineIndex), 100.f * GetCustomTestValue(lineIndex + 20));
+		Vec2 end(100.f * GetCustomTestValue(lineIndex + 40), 100.f * GetCustomTestValue(lineIndex + 60));
+		lines.AddLine(start, end, 1.f + (float)lineIndex, Rgba8::WHITE);
+	}
+	lines.AddLine(Vec2(0.f, 0.f), Vec2(10.f, 0.f), 2.f, Rgba8::RED);
+	lines.AddLine(Vec2(5.f, 5.f), Vec2(5.f, 5.f), 2.f, Rgba8::GREEN);
+
+	int numLines = lines.GetNumLines();
+	std::vector<Vertex_PCU> vertexes(numLines * LINE_SEGMENT2D_NUM_VERTEXES);
+	VertexSpanWriter verts(vertexes.data(), (int)vertexes.size());
+	lines.AddVertsForLines(verts, 0, numLines);
+
+	Vec3 expectedCorners[LINE_SEGMENT2D_NUM_VERTEXES] = { Vec3(-1.f, -1.f, 0.f), Vec3(11.f, -1.f, 0.f), Vec3(11.f, 1.f, 0.f), Vec3(-1.f, -1.f, 0.f), Vec3(11.f, 1.f, 0.f), Vec3(-1.f, 1.f, 0.f) };
+	bool isQuadExact = true;
+	for (int vertexIndex = 0; vertexIndex < LINE_SEGMENT2D_NUM_VERTEXES; vertexIndex++)
+	{
+		isQuadExact = isQuadExact && IsMostlyEqualCustom(vertexes[vertexIndex].m_position, expectedCorners[vertexIndex]) && vertexes[vertexIndex].m_color == Rgba8::RED;
+	}
+	VerifyTestResult(isQuadExact, "DebugLineBatch pushes corners out by half the thickness along and across the line");
+
+	Vertex_PCU const* square = &vertexes[LINE_SEGMENT2D_NUM_VERTEXES];
+	VerifyTestResult(IsMostlyEqualCustom(square[0].m_position, Vec3(4.f, 4.f, 0.f)) && IsMostlyEqualCustom(square[2].m_position, Vec3(6.f, 6.f, 0.f)), "DebugLineBatch draws a zero-length line as a square");
+
+	int tailFirstVertex = (numLines - 2) * LINE_SEGMENT2D_NUM_VERTEXES;
+	VerifyTestResult(AreVertexesMostlyEqualCustom(&vertexes[tailFirstVertex], &vertexes[0], 2 * LINE_SEGMENT2D_NUM_VERTEXES, 0.f), "DebugLineBatch builds the same quads with and without SSE");
+
+	bool areCounterClockwise = verts.m_count == (int)vertexes.size();
+	for (int triangleIndex = 0; triangleIndex < (int)vertexes.size() / 3; triangleIndex++)
+	{
+		Vec3 const& a = vertexes[3 * triangleIndex].m_position;
+		Vec3 const& b = vertexes[3 * triangleIndex + 1].m_position;
+		Vec3 const& c = vertexes[3 * triangleIndex + 2].m_position;
+		areCounterClockwise = areCounterClockwise && ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)) > 0.f;
+	}
+	VerifyTestResult(areCounterClockwise, "DebugLineBatch triangles are counter-clockwise");
+
+	return 4; // Number of tests expected
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int TestSet_Custom_VertexSpans()
+{
+	AABB3 bounds(Vec3(-1.5f, 2.25f, -0.75f), Vec3(3.f, 4.5f, 1.f));
+	AABB2 UVs(Vec2(0.25f, 0.5f), Vec2(0.75f, 1.f));
+	Vec3 const& mins = bounds.m_mins;
+	Vec3 const& maxs = bounds.m_maxs;
+
+	std::vector<Vertex_PCU> quads(AABB3_NUM_VERTEXES);
+	VertexSpanWriter quadVerts(quads.data(), AABB3_NUM_VERTEXES);
+	AddVertsForQuad3D(quadVerts, Vec3(maxs.x, mins.y, mins.z), Vec3(maxs.x, maxs.y, mins.z), Vec3(maxs.x, maxs.y, maxs.z), Vec3(maxs.x, mins.y, maxs.z), Rgba8::RED, UVs);
+	AddVertsForQuad3D(quadVerts, Vec3(mins.x, maxs.y, mins.z), Vec3(mins.x, mins.y, mins.z), Vec3(mins.x, mins.y, maxs.z), Vec3(mins.x, maxs.y, maxs.z), Rgba8::RED, UVs);
+	AddVertsForQuad3D(quadVerts, Vec3(maxs.x, maxs.y, mins.z), Vec3(mins.x, maxs.y, mins.z), Vec3(mins.x, maxs.y, maxs.z), Vec3(maxs.x, maxs.y, maxs.z), Rgba8::RED, UVs);
+	AddVertsForQuad3D(quadVerts, Vec3(mins.x, mins.y, mins.z), Vec3(maxs.x, mins.y, mins.z), Vec3(maxs.x, mins.y, maxs.z), Vec3(mins.x, mins.y, maxs.z), Rgba8::RED, UVs);
+	AddVertsForQuad3D(quadVerts, Vec3(maxs.x, mins.y, maxs.z), Vec3(maxs.x, maxs.y, maxs.z), Vec3(mins.x, maxs.y, maxs.z), Vec3(mins.x, mins.y, maxs.z), Rgba8::RED, UVs);
+	AddVertsForQuad3D(quadVerts, Vec3(maxs.x, maxs.y, mins.z), Vec3(maxs.x, mins.y, mins.z), Vec3(mins.x, mins.y, mins.z), Vec3(mins.x, maxs.y, mins.z), Rgba8::RED, UVs);
+
+	std::vector<Vertex_PCU> cube(AABB3_NUM_VERTEXES);
+	VertexSpanWriter cubeVerts(cube.data(), AABB3_NUM_VERTEXES);
+	AddVertsForAABB3D(cubeVerts, bounds, Rgba8::RED, UVs);
+	VerifyTestResult(AreVertexesMostlyEqualCustom(cube.data(), quads.data(), AABB3_NUM_VERTEXES, 0.f), "AddVertsForAABB3D from CUBE_MESH matches six AddVertsForQuad3D faces");
+
+	Rgba8 faceColors[AABB3_NUM_FACES] = { Rgba8(1, 0, 0), Rgba8(2, 0, 0), Rgba8(3, 0, 0), Rgba8(4, 0, 0), Rgba8(5, 0, 0), Rgba8(6, 0, 0) };
+	cubeVerts.m_count = 0;
+	AddVertsForAABB3DWithFaceColors(cubeVerts, bounds, faceColors, UVs);
+	bool areFacesColored = true;
+	for (int vertexIndex = 0; vertexIndex < AABB3_NUM_VERTEXES; vertexIndex++)
+	{
+		areFacesColored = areFacesColored && cube[vertexIndex].m_color == faceColors[vertexIndex / QUAD3D_NUM_VERTEXES]
+			&& IsMostlyEqualCustom(cube[vertexIndex].m_position, quads[vertexIndex].m_position, 0.f);
+	}
+	VerifyTestResult(areFacesColored, "AddVertsForAABB3DWithFaceColors colors each face");
+
+	// fewer longitudes than a chunk, and more
+	Vec3 center(1.f, -2.f, 3.f);
+	bool areSpheresRound = true;
+	bool areSpheresOutward = true;
+	bool areSphereUVsInRange = true;
+	int latitudeSliceCounts[2] = { SPHERE3D_DEFAULT_NUM_LATITUDE_SLICES, 40 };
+	for (int numLatitudeSlices : latitudeSliceCounts)
+	{
+		std::vector<Vertex_PCU> sphere(GetNumVertexesForSphere3D(numLatitudeSlices));
+		VertexSpanWriter sphereVerts(sphere.data(), (int)sphere.size());
+		AddVertsForSphere3D(sphereVerts, center, 2.f, Rgba8::WHITE, UVs, numLatitudeSlices);
+		areSpheresRound = areSpheresRound && sphereVerts.m_count == sphereVerts.m_capacity;
+
+		for (int triangleIndex = 0; triangleIndex < (int)sphere.size() / 3; triangleIndex++)
+		{
+			Vec3 const& a = sphere[3 * triangleIndex].m_position;
+			Vec3 const& b = sphere[3 * triangleIndex + 1].m_position;
+			Vec3 const& c = sphere[3 * triangleIndex + 2].m_position;
+			for (int cornerIndex = 0; cornerIndex < 3; cornerIndex++)
+			{
+				Vertex_PCU const& vertex = sphere[3 * triangleIndex + cornerIndex];
+				areSpheresRound = areSpheresRound && IsMostlyEqualCustom(GetDistance3D(vertex.m_position, center), 2.f);
+				areSphereUVsInRange = areSphereUVsInRange && vertex.m_uvTexCoords.x >= UVs.m_mins.x && vertex.m_uvTexCoords.x <= UVs.m_maxs.x
+					&& vertex.m_uvTexCoords.y >= UVs.m_mins.y && vertex.m_uvTexCoords.y <= UVs.m_maxs.y;
+			}
+
+			// triangles touching a pole have two corners there and no area
+			Vec3 normal = CrossProduct3D(b - a, c - a);
+			if (normal.GetLengthSquared() > 0.000001f)
+			{
+				areSpheresOutward = areSpheresOutward && DotProduct3D(normal, (a + b + c) / 3.f - center) > 0.f;
+			}
+		}
+	}
+	VerifyTestResult(areSpheresRound, "AddVertsForSphere3D fills exactly GetNumVertexesForSphere3D vertexes, all on the sphere");
+	VerifyTestResult(areSpheresOutward, "AddVertsForSphere3D triangles face outward");
+	VerifyTestResult(areSphereUVsInRange, "AddVertsForSphere3D UVs stay in range");
+
+	return 5; // Number of tests expected
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int TestSet_Custom_PropPhysics()
+{
+	float const deltaSeconds = 1.f / 60.f;
+	float const radius = 0.5f;
+
+	PropPhysics dropPhysics;
+	int droppedBody = dropPhysics.AddBody(Vec3(1.f, 2.f, 3.f), radius, 1.f);
+	for (int frameIndex = 0; frameIndex < 180; frameIndex++)
+	{
+		dropPhysics.Step(deltaSeconds);
+	}
+	Vec3 restingPosition = dropPhysics.GetPosition(droppedBody);
+	VerifyTestResult(IsMostlyEqualCustom(restingPosition, Vec3(1.f, 2.f, radius), 0.02f) && !dropPhysics.IsAwake(droppedBody), "PropPhysics drops a sphere onto the ground, where it falls asleep");
+
+	// landing on the sleeping sphere wakes it
+	int secondBody = dropPhysics.AddBody(Vec3(1.f, 2.f, 3.f), radius, 1.f);
+	bool wasWoken = false;
+	for (int frameIndex = 0; frameIndex < 60; frameIndex++)
+	{
+		dropPhysics.Step(deltaSeconds);
+		wasWoken = wasWoken || dropPhysics.IsAwake(droppedBody);
+	}
+	VerifyTestResult(wasWoken && dropPhysics.GetPosition(secondBody).z > restingPosition.z + radius, "PropPhysics wakes a sleeping sphere that is landed on");
+
+	// head-on, without gravity or the ground; momentum along X is kept and neither passes through
+	PropPhysicsConfig spaceConfig;
+	spaceConfig.m_gravity = Vec3();
+	spaceConfig.m_groundHeight = -100.f;
+	spaceConfig.m_linearDamping = 0.f;
+	PropPhysics collidePhysics(spaceConfig);
+	int leftBody = collidePhysics.AddBody(Vec3(0.f, 0.f, 0.f), radius, 1.f);
+	int rightBody = collidePhysics.AddBody(Vec3(3.f, 0.f, 0.f), radius, 3.f);
+	collidePhysics.SetVelocity(leftBody, Vec3(4.f, 0.f, 0.f));
+	collidePhysics.SetVelocity(rightBody, Vec3(-1.f, 0.f, 0.f));
+	for (int frameIndex = 0; frameIndex < 60; frameIndex++)
+	{
+		collidePhysics.Step(deltaSeconds);
+	}
+	float momentumX = collidePhysics.GetVelocity(leftBody).x + 3.f * collidePhysics.GetVelocity(rightBody).x;
+	bool areApart = collidePhysics.GetPosition(rightBody).x - collidePhysics.GetPosition(leftBody).x > 2.f * radius - 0.01f;
+	VerifyTestResult(IsMostlyEqualCustom(momentumX, 1.f, 0.01f) && areApart, "PropPhysics keeps momentum in a head-on collision");
+
+	// a sphere in the pocket of four static ones stays there
+	PropPhysics stackPhysics;
+	for (int baseIndex = 0; baseIndex < 4; baseIndex++)
+	{
+		stackPhysics.AddBody(Vec3(2.f * radius * (float)(baseIndex % 2), 2.f * radius * (float)(baseIndex / 2), radius), radius, 0.f);
+	}
+	int topBody = stackPhysics.AddBody(Vec3(radius, radius, radius + radius * sqrtf(2.f) + 0.1f), radius, 1.f);
+	for (int frameIndex = 0; frameIndex < 180; frameIndex++)
+	{
+		stackPhysics.Step(deltaSeconds);
+	}
+	Vec3 pocketPosition(radius, radius, radius + radius * sqrtf(2.f));
+	VerifyTestResult(IsMostlyEqualCustom(stackPhysics.GetPosition(topBody), pocketPosition, 0.02f) && !stackPhysics.IsAwake(topBody), "PropPhysics rests a sphere on static spheres and puts it to sleep");
+
+	// props nudged within their cells, moved across cells, and moved off the grid
+	std::vector<Vec3> centers;
+	std::vector<float> radii;
+	for (int propIndex = 0; propIndex < 64; propIndex++)
+	{
+		centers.push_back(Vec3(1.5f * (float)(propIndex % 8), 1.5f * (float)(propIndex / 8), radius));
+		radii.push_back(radius);
+	}
+	PropBroadphase updatedBroadphase;
+	updatedBroadphase.Build(centers.data(), radii.data(), (int)centers.size());
+
+	int movedIndexes[] = { 3, 9, 41, 63 };
+	Vec3 movedCenters[] = { centers[3] + Vec3(0.01f, 0.f, 0.f), centers[9] + Vec3(0.f, -0.02f, 0.1f), centers[41] + Vec3(5.f, 0.f, 0.f), Vec3(30.f, -8.f, radius) };
+	float movedRadii[] = { radius, radius, radius, radius };
+	bool wasNudgeSorted = updatedBroadphase.UpdateProps(movedIndexes, movedCenters, movedRadii, 2);
+	updatedBroadphase.UpdateProps(movedIndexes + 2, movedCenters + 2, movedRadii + 2, 2);
+	for (int movedIndex = 0; movedIndex < 4; movedIndex++)
+	{
+		centers[movedIndexes[movedIndex]] = movedCenters[movedIndex];
+	}
+	PropBroadphase builtBroadphase;
+	builtBroadphase.Build(centers.data(), radii.data(), (int)centers.size());
+
+	bool doGathersMatch = true;
+	PropSphereList updatedList;
+	PropSphereList builtList;
+	for (int regionIndex = 0; regionIndex < 16; regionIndex++)
+	{
+		float minX = -10.f + 3.f * (float)regionIndex;
+		float minY = -10.f + 1.5f * (float)regionIndex;
+		updatedBroadphase.GatherPropsInRegion(minX, minY, minX + 6.f, minY + 6.f, updatedList);
+		builtBroadphase.GatherPropsInRegion(minX, minY, minX + 6.f, minY + 6.f, builtList);
+		std::vector<int> updatedIndexes(updatedList.m_propIndexes.begin(), updatedList.m_propIndexes.begin() + updatedList.m_count);
+		std::vector<int> builtIndexes(builtList.m_propIndexes.begin(), builtList.m_propIndexes.begin() + builtList.m_count);
+		std::sort(updatedIndexes.begin(), updatedIndexes.end());
+		std::sort(builtIndexes.begin(), builtIndexes.end());
+		doGathersMatch = doGathersMatch && updatedIndexes == builtIndexes;
+	}
+	VerifyTestResult(!wasNudgeSorted && doGathersMatch, "PropBroadphase updated in place finds the same props as one built from scratch");
+
+	return 5; // Number of tests expected
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// particle centers are read back as the middle of their billboards
+//
+static Vec3 GetParticleCenterCustom(Vertex_PCU const* quad)
+{
+	return (quad[0].m_position + quad[2].m_position) * 0.5f;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int TestSet_Custom_Particles()
+{
+	ParticleSystem pool(10);
+	ParticleBurst burst;
+	int numFirst = pool.Emit(burst, 7);
+	int numSecond = pool.Emit(burst, 7);
+	VerifyTestResult(numFirst == 7 && numSecond == 3 && pool.GetNumLive() == 10, "ParticleSystem emits only what fits in its pool");
+
+	// short-lived red ones between long-lived blue ones; every red one goes and no blue one does
+	ParticleSystem expiring(CUSTOM_TEST_BATCH_SIZE);
+	ParticleBurst shortBurst;
+	shortBurst.m_minLifetimeSeconds = 0.1f;
+	shortBurst.m_maxLifetimeSeconds = 0.1f;
+	shortBurst.m_color = Rgba8::RED;
+	ParticleBurst longBurst;
+	longBurst.m_minLifetimeSeconds = 10.f;
+	longBurst.m_maxLifetimeSeconds = 10.f;
+	longBurst.m_color = Rgba8::BLUE;
+	int numLong = 0;
+	for (int burstIndex = 0; burstIndex < 6; burstIndex++)
+	{
+		expiring.Emit(shortBurst, 3 + burstIndex % 2);
+		numLong += expiring.Emit(longBurst, 2 + burstIndex % 3);
+	}
+	expiring.Update(0.2f);
+	std::vector<Vertex_PCU> expiringVerts(CUSTOM_TEST_BATCH_SIZE * PARTICLE_NUM_VERTEXES);
+	VertexSpanWriter expiringSpan(expiringVerts.data(), (int)expiringVerts.size());
+	expiring.AddVertsForParticles(expiringSpan, 0, expiring.GetNumLive(), Vec3(0.f, 1.f, 0.f), Vec3(0.f, 0.f, 1.f));
+	bool areAllLong = expiring.GetNumLive() == numLong;
+	for (int vertexIndex = 0; vertexIndex < expiringSpan.m_count; vertexIndex++)
+	{
+		areAllLong = areAllLong && expiringVerts[vertexIndex].m_color.b == 255 && expiringVerts[vertexIndex].m_color.r == 0;
+	}
+	VerifyTestResult(areAllLong && expiring.GetStats().m_numExpired == CUSTOM_TEST_BATCH_SIZE - numLong, "ParticleSystem expires exactly the particles past their lifetime");
+
+	// one particle moving along X without gravity or drag, then one falling onto the ground
+	ParticleSystemConfig stillAirConfig;
+	stillAirConfig.m_gravity = Vec3();
+	stillAirConfig.m_drag = 0.f;
+	ParticleSystem moving(4, stillAirConfig);
+	ParticleBurst movingBurst;
+	movingBurst.m_position = Vec3(1.f, 2.f, 3.f);
+	movingBurst.m_velocity = Vec3(2.f, 0.f, 0.f);
+	movingBurst.m_minLifetimeSeconds = 10.f;
+	movingBurst.m_maxLifetimeSeconds = 10.f;
+	moving.Emit(movingBurst, 1);
+	ParticleSystem falling(4);
+	ParticleBurst fallingBurst;
+	fallingBurst.m_position = Vec3(0.f, 0.f, 0.5f);
+	fallingBurst.m_velocity = Vec3(0.f, 0.f, -5.f);
+	fallingBurst.m_minLifetimeSeconds = 10.f;
+	fallingBurst.m_maxLifetimeSeconds = 10.f;
+	falling.Emit(fallingBurst, 1);
+	for (int stepIndex = 0; stepIndex < 10; stepIndex++)
+	{
+		moving.Update(0.1f);
+		falling.Update(0.1f);
+	}
+	Vertex_PCU movingQuad[PARTICLE_NUM_VERTEXES];
+	Vertex_PCU fallingQuad[PARTICLE_NUM_VERTEXES];
+	VertexSpanWriter movingSpan(movingQuad, PARTICLE_NUM_VERTEXES);
+	VertexSpanWriter fallingSpan(fallingQuad, PARTICLE_NUM_VERTEXES);
+	moving.AddVertsForParticles(movingSpan, 0, 1, Vec3(0.f, 1.f, 0.f), Vec3(0.f, 0.f, 1.f));
+	falling.AddVertsForParticles(fallingSpan, 0, 1, Vec3(0.f, 1.f, 0.f), Vec3(0.f, 0.f, 1.f));
+	VerifyTestResult(IsMostlyEqualCustom(GetParticleCenterCustom(movingQuad), Vec3(3.f, 2.f, 3.f), 0.001f), "ParticleSystem moves particles by their velocity");
+	VerifyTestResult(IsMostlyEqualCustom(GetParticleCenterCustom(fallingQuad).z, falling.GetConfig().m_groundHeight, 0.f), "ParticleSystem settles particles on the ground");
+
+	// four at a time against one at a time, which takes the scalar path
+	ParticleSystem spread(CUSTOM_TEST_BATCH_SIZE);
+	ParticleBurst spreadBurst;
+	spreadBurst.m_positionSpread = Vec3(1.f, 2.f, 3.f);
+	spreadBurst.m_velocitySpread = Vec3(1.f, 1.f, 1.f);
+	spreadBurst.m_minLifetimeSeconds = 1.f;
+	spreadBurst.m_maxLifetimeSeconds = 2.f;
+	spreadBurst.m_color = Rgba8(10, 20, 30, 200);
+	spread.Emit(spreadBurst, CUSTOM_TEST_BATCH_SIZE);
+	spread.Update(0.5f);
+	Vec3 cameraLeft(0.6f, 0.8f, 0.f);
+	Vec3 cameraUp(0.f, 0.f, 1.f);
+	std::vector<Vertex_PCU> batched(CUSTOM_TEST_BATCH_SIZE * PARTICLE_NUM_VERTEXES);
+	std::vector<Vertex_PCU> single(CUSTOM_TEST_BATCH_SIZE * PARTICLE_NUM_VERTEXES);
+	VertexSpanWriter batchedSpan(batched.data(), (int)batched.size());
+	VertexSpanWriter singleSpan(single.data(), (int)single.size());
+	spread.AddVertsForParticles(batchedSpan, 0, CUSTOM_TEST_BATCH_SIZE, cameraLeft, cameraUp);
+	for (int particleIndex = 0; particleIndex < CUSTOM_TEST_BATCH_SIZE; particleIndex++)
+	{
+		spread.AddVertsForParticles(singleSpan, particleIndex, 1, cameraLeft, cameraUp);
+	}
+	VerifyTestResult(AreVertexesMostlyEqualCustom(batched.data(), single.data(), (int)batched.size(), CUSTOM_TEST_TOLERANCE), "ParticleSystem builds the same billboards with and without SSE");
+
+	return 5; // Number of tests expected
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void RunTests_Custom()
+{
+	RunTestSet(false, TestSet_Custom_SimdMat44, "Custom SimdMat44 vs. Mat44");
+	RunTestSet(false, TestSet_Custom_SimdBatches, "Custom SimdMath batch paths");
+	RunTestSet(false, TestSet_Custom_QuaternionOrientation, "Custom quaternion orientation");
+	RunTestSet(false, TestSet_Custom_RingTessellation, "Custom ring tessellation");
+	RunTestSet(false, TestSet_Custom_DebugLines, "Custom debug line batch");
+	RunTestSet(false, TestSet_Custom_VertexSpans, "Custom span vertex builders");
+	RunTestSet(false, TestSet_Custom_PropPhysics, "Custom prop physics");
+	RunTestSet(false, TestSet_Custom_Particles, "Custom particle system");
+}
@@ -0,0 +1,313 @@
+#include "Game/VertexSpanUtils.hpp"
+#include "Game/FrameMemory.hpp"
+#include "Game/SimdMath.hpp"
+
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+
+constexpr int ARC_SIDES_PER_CHUNK = 64;
+
+
+//-----------------------------------------------------------------------------------------------
+VertexSpanWriter::VertexSpanWriter(Vertex_PCU* vertexes, int capacity) :
+	m_vertexes(vertexes),
+	m_capacity(capacity)
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Vertex_PCU* VertexSpanWriter::Append(int numVertexes)
+{
+	ASSERT_OR_DIE(m_count + numVertexes <= m_capacity, "VertexSpanWriter overflow; reserve more vertexes");
+
+	Vertex_PCU* first = m_vertexes + m_count;
+	m_count += numVertexes;
+	return first;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+VertexSpanWriter AllocateFrameVertexes(int capacity)
+{
+	return VertexSpanWriter(AllocateFrameArray<Vertex_PCU>(capacity), capacity);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AddVertsForQuad3D(VertexSpanWriter& verts, Vec3 const& bottomLeft, Vec3 const& bottomRight, Vec3 const& topRight, Vec3 const& topLeft, Rgba8 const& color, AABB2 const& UVs)
+{
+	Vec2 uvBottomLeft = UVs.m_mins;
+	Vec2 uvBottomRight = Vec2(UVs.m_maxs.x, UVs.m_mins.y);
+	Vec2 uvTopRight = UVs.m_maxs;
+	Vec2 uvTopLeft = Vec2(UVs.m_mins.x, UVs.m_maxs.y);
+
+	Vertex_PCU* quad = verts.Append(QUAD3D_NUM_VERTEXES);
+	quad[0] = Vertex_PCU(bottomLeft, color, uvBottomLeft);
+	quad[1] = Vertex_PCU(bottomRight, color, uvBottomRight);
+	quad[2] = Vertex_PCU(topRight, color, uvTopRight);
+
+	quad[3] = Vertex_PCU(bottomLeft, color, uvBottomLeft);
+	quad[4] = Vertex_PCU(topRight, color, uvTopRight);
+	quad[5] = Vertex_PCU(topLeft, color, uvTopLeft);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void WriteCubeMeshVertexes(Vertex_PCU* cube, AABB3 const& bounds, Rgba8 const* faceColors, int faceColorStride, AABB2 const& UVs)
+{
+	Vec3 const& mins = bounds.m_mins;
+	Vec3 const& maxs = bounds.m_maxs;
+	for (int vertexIndex = 0; vertexIndex < AABB3_NUM_VERTEXES; vertexIndex++)
+	{
+		CubeMeshVertex const& meshVertex = CUBE_MESH[vertexIndex];
+		Vec3 position(meshVertex.m_isMaxX ? maxs.x : mins.x, meshVertex.m_isMaxY ? maxs.y : mins.y, meshVertex.m_isMaxZ ? maxs.z : mins.z);
+		Vec2 uv(meshVertex.m_isMaxU ? UVs.m_maxs.x : UVs.m_mins.x, meshVertex.m_isMaxV ? UVs.m_maxs.y : UVs.m_mins.y);
+		Rgba8 const& color = faceColors[(vertexIndex / QUAD3D_NUM_VERTEXES) * faceColorStride];
+		cube[vertexIndex] = Vertex_PCU(position, color, uv);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AddVertsForAABB3D(VertexSpanWriter& verts, AABB3 const& bounds, Rgba8 const& color, AABB2 const& UVs)
+{
+	WriteCubeMeshVertexes(verts.Append(AABB3_NUM_VERTEXES), bounds, &color, 0, UVs);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AddVertsForAABB3DWithFaceColors(VertexSpanWriter& verts, AABB3 const& bounds, Rgba8 const* faceColors, AABB2 const& UVs)
+{
+	WriteCubeMeshVertexes(verts.Append(AABB3_NUM_VERTEXES), bounds, faceColors, 1, UVs);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AddVertsForAABB2(VertexSpanWriter& verts, AABB2 const& bounds, Rgba8 const& color, AABB2 const& UVs)
+{
+	Vec3 bottomLeft(bounds.m_mins.x, bounds.m_mins.y, 0.f);
+	Vec3 bottomRight(bounds.m_maxs.x, bounds.m_mins.y, 0.f);
+	Vec3 topRight(bounds.m_maxs.x, bounds.m_maxs.y, 0.f);
+	Vec3 topLeft(bounds.m_mins.x, bounds.m_maxs.y, 0.f);
+
+	AddVertsForQuad3D(verts, bottomLeft, bottomRight, topRight, topLeft, color, UVs);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Unit directions for the points of one chunk of an arc's sides. Every direction comes from its own
+// angle through one batched sincos, so long arcs do not drift the way a rotation recurrence does,
+// and the two sides meeting at a point share it. Both ends of a full circle come out exactly
+// (1, 0), so the seam closes
+//
+struct ArcChunk
+{
+	int		m_firstSide = 0;
+	int		m_numSides = 0;
+	float	m_cosines[ARC_SIDES_PER_CHUNK + 1];
+	float	m_sines[ARC_SIDES_PER_CHUNK + 1];
+
+	Vec2 GetDirection(int chunkPointIndex) const { return Vec2(m_cosines[chunkPointIndex], m_sines[chunkPointIndex]); }
+};
+
+
+//-----------------------------------------------------------------------------------------------
+template<typename EmitChunk>
+static void ForEachArcChunk(float startDegrees, float spanDegrees, int numSides, EmitChunk const& emitChunk)
+{
+	float deltaDegrees = spanDegrees / static_cast<float>(numSides);
+	SimdMathPath path = GetBestSimdMathPath();
+
+	ArcChunk chunk;
+	float pointDegrees[ARC_SIDES_PER_CHUNK + 1];
+	for (int firstSide = 0; firstSide < numSides; firstSide += ARC_SIDES_PER_CHUNK)
+	{
+		chunk.m_firstSide = firstSide;
+		chunk.m_numSides = numSides - firstSide < ARC_SIDES_PER_CHUNK ? numSides - firstSide : ARC_SIDES_PER_CHUNK;
+		for (int pointIndex = 0; pointIndex <= chunk.m_numSides; pointIndex++)
+		{
+			pointDegrees[pointIndex] = startDegrees + deltaDegrees * static_cast<float>(firstSide + pointIndex);
+		}
+		GetSinCosDegrees(path, pointDegrees, chunk.m_sines, chunk.m_cosines, chunk.m_numSides + 1);
+		emitChunk(chunk);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void WriteThickArcSide(Vertex_PCU* side, Vec2 const& center, float innerRadius, float outerRadius, Vec2 const& startDirection, Vec2 const& endDirection, Rgba8 const& color)
+{
+	Vec3 innerStart(center.x + innerRadius * startDirection.x, center.y + innerRadius * startDirection.y, 0.f);
+	Vec3 outerStart(center.x + outerRadius * startDirection.x, center.y + outerRadius * startDirection.y, 0.f);
+	Vec3 innerEnd(center.x + innerRadius * endDirection.x, center.y + innerRadius * endDirection.y, 0.f);
+	Vec3 outerEnd(center.x + outerRadius * endDirection.x, center.y + outerRadius * endDirection.y, 0.f);
+
+	side[0] = Vertex_PCU(innerStart, color, Vec2::ZERO);
+	side[1] = Vertex_PCU(outerStart, color, Vec2::ZERO);
+	side[2] = Vertex_PCU(outerEnd, color, Vec2::ZERO);
+
+	side[3] = Vertex_PCU(innerStart, color, Vec2::ZERO);
+	side[4] = Vertex_PCU(outerEnd, color, Vec2::ZERO);
+	side[5] = Vertex_PCU(innerEnd, color, Vec2::ZERO);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void WriteThickArcChunk(Vertex_PCU* arc, ArcChunk const& chunk, Vec2 const& center, float radius, float thickness, Rgba8 const& color)
+{
+	float innerRadius = radius - (thickness * 0.5f);
+	float outerRadius = radius + (thickness * 0.5f);
+	for (int sideIndex = 0; sideIndex < chunk.m_numSides; sideIndex++)
+	{
+		Vertex_PCU* side = arc + ((chunk.m_firstSide + sideIndex) * 6);
+		WriteThickArcSide(side, center, innerRadius, outerRadius, chunk.GetDirection(sideIndex), chunk.GetDirection(sideIndex + 1), color);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AddVertsForRing2D(VertexSpanWriter& verts, Vec2 const& center, float radius, float thickness, Rgba8 const& color, int numSides)
+{
+	AddVertsForArc2D(verts, center, radius, thickness, 0.f, 360.f, color, numSides);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AddVertsForArc2D(VertexSpanWriter& verts, Vec2 const& center, float radius, float thickness, float startDegrees, float spanDegrees, Rgba8 const& color, int numSides)
+{
+	Vertex_PCU* arc = verts.Append(GetNumVertexesForArc2D(numSides));
+	ForEachArcChunk(startDegrees, spanDegrees, numSides, [&](ArcChunk const& chunk)
+	{
+		WriteThickArcChunk(arc, chunk, center, radius, thickness, color);
+	});
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AddVertsForDisc2D(VertexSpanWriter& verts, Vec2 const& center, float radius, Rgba8 const& color, int numSides)
+{
+	Vec3 center3D(center.x, center.y, 0.f);
+
+	Vertex_PCU* disc = verts.Append(GetNumVertexesForDisc2D(numSides));
+	ForEachArcChunk(0.f, 360.f, numSides, [&](ArcChunk const& chunk)
+	{
+		for (int sideIndex = 0; sideIndex < chunk.m_numSides; sideIndex++)
+		{
+			Vec2 startDirection = chunk.GetDirection(sideIndex);
+			Vec2 endDirection = chunk.GetDirection(sideIndex + 1);
+			Vertex_PCU* side = disc + ((chunk.m_firstSide + sideIndex) * 3);
+			side[0] = Vertex_PCU(center3D, color, Vec2::ZERO);
+			side[1] = Vertex_PCU(Vec3(center.x + radius * startDirection.x, center.y + radius * startDirection.y, 0.f), color, Vec2::ZERO);
+			side[2] = Vertex_PCU(Vec3(center.x + radius * endDirection.x, center.y + radius * endDirection.y, 0.f), color, Vec2::ZERO);
+		}
+	});
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// ring by ring within each chunk, so writes stay sequential
+//
+void AddVertsForRings2D(VertexSpanWriter& verts, Ring2D const* rings, int numRings, int numSides)
+{
+	int numVertexesPerRing = GetNumVertexesForRing2D(numSides);
+	Vertex_PCU* firstRing = verts.Append(numRings * numVertexesPerRing);
+	ForEachArcChunk(0.f, 360.f, numSides, [&](ArcChunk const& chunk)
+	{
+		for (int ringIndex = 0; ringIndex < numRings; ringIndex++)
+		{
+			Ring2D const& ring = rings[ringIndex];
+			WriteThickArcChunk(firstRing + (ringIndex * numVertexesPerRing), chunk, ring.m_center, ring.m_radius, ring.m_thickness, ring.m_color);
+		}
+	});
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Latitude stacks from the south pole up, each cut into twice as many longitude slices, with quads
+// counter-clockwise seen from outside. Longitudes come from the batched sincos a chunk at a time
+// and every stack reuses them; the poles are exact, so the quads there close to a point
+//
+void AddVertsForSphere3D(VertexSpanWriter& verts, Vec3 const& center, float radius, Rgba8 const& color, AABB2 const& UVs, int numLatitudeSlices)
+{
+	int numLongitudeSlices = 2 * numLatitudeSlices;
+	float deltaLatitudeDegrees = 180.f / static_cast<float>(numLatitudeSlices);
+	Vec2 uvSize = UVs.m_maxs - UVs.m_mins;
+
+	Vertex_PCU* sphere = verts.Append(GetNumVertexesForSphere3D(numLatitudeSlices));
+	ForEachArcChunk(0.f, 360.f, numLongitudeSlices, [&](ArcChunk const& chunk)
+	{
+		float bottomCos = 0.f;
+		float bottomSin = -1.f;
+		for (int latitudeIndex = 0; latitudeIndex < numLatitudeSlices; latitudeIndex++)
+		{
+			bool isTopStack = latitudeIndex == numLatitudeSlices - 1;
+			float topDegrees = -90.f + deltaLatitudeDegrees * static_cast<float>(latitudeIndex + 1);
+			float topCos = isTopStack ? 0.f : CosDegrees(topDegrees);
+			float topSin = isTopStack ? 1.f : SinDegrees(topDegrees);
+			float bottomV = UVs.m_mins.y + uvSize.y * (static_cast<float>(latitudeIndex) / static_cast<float>(numLatitudeSlices));
+			float topV = UVs.m_mins.y + uvSize.y * (static_cast<float>(latitudeIndex + 1) / static_cast<float>(numLatitudeSlices));
+
+			for (int sideIndex = 0; sideIndex < chunk.m_numSides; sideIndex++)
+			{
+				int longitudeIndex = chunk.m_firstSide + sideIndex;
+				Vec2 leftDirection = chunk.GetDirection(sideIndex);
+				Vec2 rightDirection = chunk.GetDirection(sideIndex + 1);
+				float leftU = UVs.m_mins.x + uvSize.x * (static_cast<float>(longitudeIndex) / static_cast<float>(numLongitudeSlices));
+				float rightU = UVs.m_mins.x + uvSize.x * (static_cast<float>(longitudeIndex + 1) / static_cast<float>(numLongitudeSlices));
+
+				Vertex_PCU bottomLeft(center + Vec3(bottomCos * leftDirection.x, bottomCos * leftDirection.y, bottomSin) * radius, color, Vec2(leftU, bottomV));
+				Vertex_PCU bottomRight(center + Vec3(bottomCos * rightDirection.x, bottomCos * rightDirection.y, bottomSin) * radius, color, Vec2(rightU, bottomV));
+				Vertex_PCU topRight(center + Vec3(topCos * rightDirection.x, topCos * rightDirection.y, topSin) * radius, color, Vec2(rightU, topV));
+				Vertex_PCU topLeft(center + Vec3(topCos * leftDirection.x, topCos * leftDirection.y, topSin) * radius, color, Vec2(leftU, topV));
+
+				Vertex_PCU* quad = sphere + ((latitudeIndex * numLongitudeSlices + longitudeIndex) * QUAD3D_NUM_VERTEXES);
+				quad[0] = bottomLeft;
+				quad[1] = bottomRight;
+				quad[2] = topRight;
+
+				quad[3] = bottomLeft;
+				quad[4] = topRight;
+				quad[5] = topLeft;
+			}
+
+			bottomCos = topCos;
+			bottomSin = topSin;
+		}
+	});
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AddVertsForRing2DReference(VertexSpanWriter& verts, Vec2 const& center, float radius, float thickness, Rgba8 const& color, int numSides)
+{
+	float innerRadius = radius - (thickness * 0.5f);
+	float outerRadius = radius + (thickness * 0.5f);
+	float deltaThetaDegrees = 360.f / static_cast<float>(numSides);
+
+	Vertex_PCU* ring = verts.Append(GetNumVertexesForRing2D(numSides));
+	for (int sideIndex = 0; sideIndex < numSides; sideIndex++)
+	{
+		float startDegrees = deltaThetaDegrees * static_cast<float>(sideIndex);
+		float endDegrees = deltaThetaDegrees * static_cast<float>(sideIndex + 1);
+		float startCos = CosDegrees(startDegrees);
+		float startSin = SinDegrees(startDegrees);
+		float endCos = CosDegrees(endDegrees);
+		float endSin = SinDegrees(endDegrees);
+
+		Vec3 innerStart(center.x + innerRadius * startCos, center.y + innerRadius * startSin, 0.f);
+		Vec3 outerStart(center.x + outerRadius * startCos, center.y + outerRadius * startSin, 0.f);
+		Vec3 innerEnd(center.x + innerRadius * endCos, center.y + innerRadius * endSin, 0.f);
+		Vec3 outerEnd(center.x + outerRadius * endCos, center.y + outerRadius * endSin, 0.f);
+
+		Vertex_PCU* side = ring + (sideIndex * 6);
+		side[0] = Vertex_PCU(innerStart, color, Vec2::ZERO);
+		side[1] = Vertex_PCU(outerStart, color, Vec2::ZERO);
+		side[2] = Vertex_PCU(outerEnd, color, Vec2::ZERO);
+
+		side[3] = Vertex_PCU(innerStart, color, Vec2::ZERO);
+		side[4] = Vertex_PCU(outerEnd, color, Vec2::ZERO);
+		side[5] = Vertex_PCU(innerEnd, color, Vec2::ZERO);
+	}
+}
@@ -0,0 +1,121 @@
+//-----------------------------------------------------------------------------------------------
+// VertexSpanUtils.hpp
+//
+// Vertex builders that write into caller-provided storage (frame scratch, arena, stack arrays)
+// instead of growing a std::vector. Every shape has an exact, constexpr vertex count, so callers
+// allocate once: from frame memory, an arena, a stack array, or the vertex stream's staging array.
+// The cube's corners and UVs are a table built at compile time. Rings, arcs and discs take their
+// points from one batched sincos per chunk of sides, so each point costs one polynomial instead
+// of four trig calls.
+//
+#pragma once
+
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include <array>
+
+
+constexpr int QUAD3D_NUM_VERTEXES = 6;
+constexpr int AABB2_NUM_VERTEXES = 6;
+constexpr int AABB3_NUM_VERTEXES = 6 * QUAD3D_NUM_VERTEXES;
+constexpr int AABB3_NUM_FACES = 6;
+constexpr int RING2D_DEFAULT_NUM_SIDES = 64;
+constexpr int SPHERE3D_DEFAULT_NUM_LATITUDE_SLICES = 8;
+
+constexpr int GetNumVertexesForSphere3D(int numLatitudeSlices = SPHERE3D_DEFAULT_NUM_LATITUDE_SLICES) { return numLatitudeSlices * (2 * numLatitudeSlices) * 6; }
+constexpr int GetNumVertexesForRing2D(int numSides = RING2D_DEFAULT_NUM_SIDES) { return numSides * 6; }
+constexpr int GetNumVertexesForArc2D(int numSides = RING2D_DEFAULT_NUM_SIDES) { return numSides * 6; }
+constexpr int GetNumVertexesForDisc2D(int numSides = RING2D_DEFAULT_NUM_SIDES) { return numSides * 3; }
+
+
+//-----------------------------------------------------------------------------------------------
+// One vertex of the cube mesh: whether each axis takes the box's mins or maxs, and likewise U and
+// V. Faces go +x, -x, +y, -y, +z, -z, each as two triangles from bottom left, bottom right, top
+// right and top left, seen from outside
+//
+struct CubeMeshVertex
+{
+	bool	m_isMaxX = false;
+	bool	m_isMaxY = false;
+	bool	m_isMaxZ = false;
+	bool	m_isMaxU = false;
+	bool	m_isMaxV = false;
+};
+
+constexpr std::array<CubeMeshVertex, AABB3_NUM_VERTEXES> MakeCubeMesh()
+{
+	// corners as bits: 1 is max x, 2 is max y, 4 is max z
+	constexpr int FACE_CORNERS[AABB3_NUM_FACES][4] = { { 1, 3, 7, 5 }, { 2, 0, 4, 6 }, { 3, 2, 6, 7 }, { 0, 1, 5, 4 }, { 5, 7, 6, 4 }, { 3, 1, 0, 2 } };
+	constexpr int QUAD_CORNERS[QUAD3D_NUM_VERTEXES] = { 0, 1, 2, 0, 2, 3 };
+	constexpr bool IS_CORNER_MAX_U[4] = { false, true, true, false };
+	constexpr bool IS_CORNER_MAX_V[4] = { false, false, true, true };
+
+	std::array<CubeMeshVertex, AABB3_NUM_VERTEXES> mesh = {};
+	for (int faceIndex = 0; faceIndex < AABB3_NUM_FACES; faceIndex++)
+	{
+		for (int quadIndex = 0; quadIndex < QUAD3D_NUM_VERTEXES; quadIndex++)
+		{
+			int quadCorner = QUAD_CORNERS[quadIndex];
+			int cubeCorner = FACE_CORNERS[faceIndex][quadCorner];
+			CubeMeshVertex& vertex = mesh[faceIndex * QUAD3D_NUM_VERTEXES + quadIndex];
+			vertex.m_isMaxX = (cubeCorner & 1) != 0;
+			vertex.m_isMaxY = (cubeCorner & 2) != 0;
+			vertex.m_isMaxZ = (cubeCorner & 4) != 0;
+			vertex.m_isMaxU = IS_CORNER_MAX_U[quadCorner];
+			vertex.m_isMaxV = IS_CORNER_MAX_V[quadCorner];
+		}
+	}
+	return mesh;
+}
+
+constexpr std::array<CubeMeshVertex, AABB3_NUM_VERTEXES> CUBE_MESH = MakeCubeMesh();
+
+
+//-----------------------------------------------------------------------------------------------
+struct Ring2D
+{
+	Vec2	m_center;
+	float	m_radius = 0.f;
+	float	m_thickness = 0.f;
+	Rgba8	m_color;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Fixed-capacity view over contiguous vertex storage
+//
+struct VertexSpanWriter
+{
+public:
+	VertexSpanWriter() = default;
+	VertexSpanWriter(Vertex_PCU* vertexes, int capacity);
+
+	Vertex_PCU* Append(int numVertexes);
+	int GetNumRemaining() const { return m_capacity - m_count; }
+
+public:
+	Vertex_PCU*	m_vertexes = nullptr;
+	int			m_capacity = 0;
+	int			m_count = 0;
+};
+
+VertexSpanWriter AllocateFrameVertexes(int capacity);
+
+
+//-----------------------------------------------------------------------------------------------
+void AddVertsForQuad3D(VertexSpanWriter& verts, Vec3 const& bottomLeft, Vec3 const& bottomRight, Vec3 const& topRight, Vec3 const& topLeft, Rgba8 const& color = Rgba8::WHITE, AABB2 const& UVs = AABB2::ZERO_TO_ONE);
+void AddVertsForAABB3D(VertexSpanWriter& verts, AABB3 const& bounds, Rgba8 const& color = Rgba8::WHITE, AABB2 const& UVs = AABB2::ZERO_TO_ONE);
+void AddVertsForAABB3DWithFaceColors(VertexSpanWriter& verts, AABB3 const& bounds, Rgba8 const* faceColors, AABB2 const& UVs = AABB2::ZERO_TO_ONE);	// one color per face, in CUBE_MESH order
+void AddVertsForSphere3D(VertexSpanWriter& verts, Vec3 const& center, float radius, Rgba8 const& color = Rgba8::WHITE, AABB2 const& UVs = AABB2::ZERO_TO_ONE, int numLatitudeSlices = SPHERE3D_DEFAULT_NUM_LATITUDE_SLICES);
+void AddVertsForAABB2(VertexSpanWriter& verts, AABB2 const& bounds, Rgba8 const& color, AABB2 const& UVs = AABB2::ZERO_TO_ONE);
+void AddVertsForRing2D(VertexSpanWriter& verts, Vec2 const& center, float radius, float thickness, Rgba8 const& color, int numSides = RING2D_DEFAULT_NUM_SIDES);
+void AddVertsForArc2D(VertexSpanWriter& verts, Vec2 const& center, float radius, float thickness, float startDegrees, float spanDegrees, Rgba8 const& color, int numSides = RING2D_DEFAULT_NUM_SIDES);
+void AddVertsForDisc2D(VertexSpanWriter& verts, Vec2 const& center, float radius, Rgba8 const& color, int numSides = RING2D_DEFAULT_NUM_SIDES);
+
+// rings one after another, as separate AddVertsForRing2D calls would write them; the points
+// around the circle are computed once for all of them
+void AddVertsForRings2D(VertexSpanWriter& verts, Ring2D const* rings, int numRings, int numSides = RING2D_DEFAULT_NUM_SIDES);
+
+// four trig calls per side, as rings were first built; kept to check the others against
+void AddVertsForRing2DReference(VertexSpanWriter& verts, Vec2 const& center, float radius, float thickness, Rgba8 const& color, int numSides = RING2D_DEFAULT_NUM_SIDES);
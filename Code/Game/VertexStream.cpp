@@ -0,0 +1,110 @@
+#include "Game/VertexStream.hpp"
+
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+
+VertexStream* g_vertexStream = nullptr;	// Created and owned by the App
+
+constexpr int MAX_QUEUED_STREAM_DRAWS = 256;
+
+
+//-----------------------------------------------------------------------------------------------
+VertexStream::VertexStream(Renderer* renderer, int capacity) :
+	m_renderer(renderer),
+	m_capacity(capacity)
+{
+	m_stagingVertexes = new Vertex_PCU[m_capacity];
+	m_gpuBuffer = m_renderer->CreateVertexBuffer(sizeof(Vertex_PCU) * static_cast<size_t>(m_capacity));
+	m_queuedDraws.reserve(MAX_QUEUED_STREAM_DRAWS);
+}
+
+VertexStream::~VertexStream()
+{
+	delete m_gpuBuffer;
+	m_gpuBuffer = nullptr;
+
+	delete[] m_stagingVertexes;
+	m_stagingVertexes = nullptr;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void VertexStream::BeginFrame()
+{
+	m_statsLastFrame = m_stats;
+	m_stats = VertexStreamStats();
+
+	m_numStagedVertexes = 0;
+	m_queuedDraws.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The returned writer stays valid until the next Flush()
+//
+VertexSpanWriter VertexStream::Allocate(int maxNumVertexes)
+{
+	GUARANTEE_OR_DIE(m_numStagedVertexes + maxNumVertexes <= m_capacity, "VertexStream out of space; flush more often or raise its capacity");
+
+	VertexSpanWriter writer(m_stagingVertexes + m_numStagedVertexes, maxNumVertexes);
+	m_numStagedVertexes += maxNumVertexes;
+	return writer;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void VertexStream::Draw(VertexSpanWriter const& verts, Texture const* texture, Mat44 const& modelMatrix, Rgba8 const& modelColor)
+{
+	if (verts.m_count == 0)
+	{
+		return;
+	}
+
+	QueuedDraw draw;
+	draw.m_firstVertex = static_cast<int>(verts.m_vertexes - m_stagingVertexes);
+	draw.m_numVertexes = verts.m_count;
+	draw.m_texture = texture;
+	draw.m_modelMatrix = modelMatrix;
+	draw.m_modelColor = modelColor;
+	m_queuedDraws.push_back(draw);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void VertexStream::Flush()
+{
+	if (m_queuedDraws.empty())
+	{
+		m_numStagedVertexes = 0;
+		return;
+	}
+
+	// one copy for everything staged since the last flush, up to the end of the last range drawn
+	int numUsedVertexes = 0;
+	for (int drawIndex = 0; drawIndex < (int)m_queuedDraws.size(); drawIndex++)
+	{
+		int drawEnd = m_queuedDraws[drawIndex].m_firstVertex + m_queuedDraws[drawIndex].m_numVertexes;
+		numUsedVertexes = drawEnd > numUsedVertexes ? drawEnd : numUsedVertexes;
+	}
+
+	size_t numBytes = sizeof(Vertex_PCU) * static_cast<size_t>(numUsedVertexes);
+	m_renderer->CopyCPUToGPU(m_stagingVertexes, numBytes, m_gpuBuffer);
+	m_stats.m_numBytesStreamed += static_cast<int>(numBytes);
+	m_stats.m_numUploads++;
+
+	for (int drawIndex = 0; drawIndex < (int)m_queuedDraws.size(); drawIndex++)
+	{
+		QueuedDraw const& draw = m_queuedDraws[drawIndex];
+		m_renderer->SetModelConstants(draw.m_modelMatrix, draw.m_modelColor);
+		m_renderer->BindTexture(draw.m_texture);
+		m_renderer->DrawVertexBuffer(m_gpuBuffer, draw.m_numVertexes, draw.m_firstVertex);
+
+		m_stats.m_numDraws++;
+		m_stats.m_numVertexes += draw.m_numVertexes;
+	}
+
+	m_numStagedVertexes = 0;
+	m_queuedDraws.clear();
+}
@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------------------------
+// VertexStream.hpp
+//
+// One large CPU staging array for transient geometry. Callers write straight into sub-ranges
+// handed out by Allocate() and queue them with Draw(). Flush() copies the staged vertexes to one
+// persistent GPU vertex buffer with a single CopyCPUToGPU, then issues the draws at their offsets
+// in it. This turns one upload per draw into one per flush; the vertexes are still written to CPU
+// memory first and copied from there. The engine's Renderer has no call for mapping a buffer with
+// no-overwrite, so there is no ring of GPU ranges and no fence here, and the stream relies on
+// CopyCPUToGPU discarding the buffer's previous contents on every upload.
+//
+#pragma once
+
+#include "Game/VertexSpanUtils.hpp"
+
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include <vector>
+
+
+class Renderer;
+class Texture;
+class VertexBuffer;
+
+constexpr int VERTEX_STREAM_DEFAULT_CAPACITY = 256 * 1024;
+
+
+//-----------------------------------------------------------------------------------------------
+struct VertexStreamStats
+{
+	int		m_numBytesStreamed = 0;
+	int		m_numUploads = 0;
+	int		m_numDraws = 0;
+	int		m_numVertexes = 0;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class VertexStream
+{
+public:
+	VertexStream(Renderer* renderer, int capacity = VERTEX_STREAM_DEFAULT_CAPACITY);
+	~VertexStream();
+
+	void BeginFrame();
+
+	VertexSpanWriter Allocate(int maxNumVertexes);
+	void Draw(VertexSpanWriter const& verts, Texture const* texture = nullptr, Mat44 const& modelMatrix = Mat44(), Rgba8 const& modelColor = Rgba8::WHITE);
+	void Flush();
+
+	int GetNumFreeVertexes() const { return m_capacity - m_numStagedVertexes; }
+
+	VertexStreamStats const& GetStatsLastFrame() const { return m_statsLastFrame; }
+
+private:
+	struct QueuedDraw
+	{
+		int				m_firstVertex = 0;
+		int				m_numVertexes = 0;
+		Texture const*	m_texture = nullptr;
+		Mat44			m_modelMatrix;
+		Rgba8			m_modelColor;
+	};
+
+private:
+	Renderer*				m_renderer = nullptr;
+	VertexBuffer*			m_gpuBuffer = nullptr;
+	Vertex_PCU*				m_stagingVertexes = nullptr;
+	int						m_capacity = 0;
+	int						m_numStagedVertexes = 0;
+	std::vector<QueuedDraw>	m_queuedDraws;
+
+	VertexStreamStats		m_stats;
+	VertexStreamStats		m_statsLastFrame;
+};
+
+extern VertexStream* g_vertexStream;
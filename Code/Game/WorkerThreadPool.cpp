@@ -0,0 +1,113 @@
+#include "Game/WorkerThreadPool.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+WorkerThreadPool::~WorkerThreadPool()
+{
+	Shutdown();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void WorkerThreadPool::Startup(int numWorkerThreads)
+{
+	GUARANTEE_OR_DIE(m_workerThreads.empty(), "WorkerThreadPool started twice");
+	if (numWorkerThreads < 0)
+	{
+		int numHardwareThreads = (int)std::thread::hardware_concurrency();
+		numWorkerThreads = numHardwareThreads > 1 ? numHardwareThreads - 1 : 0;
+	}
+
+	m_isShuttingDown = false;
+	for (int workerIndex = 0; workerIndex < numWorkerThreads; workerIndex++)
+	{
+		m_workerThreads.emplace_back(&WorkerThreadPool::WorkerThreadMain, this, workerIndex + 1);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void WorkerThreadPool::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isShuttingDown = true;
+	}
+	m_jobStartedCondition.notify_all();
+
+	for (std::thread& workerThread : m_workerThreads)
+	{
+		workerThread.join();
+	}
+	m_workerThreads.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void WorkerThreadPool::RunParallelFor(int count, int batchSize, BatchFunction function, void const* context)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_batchFunction = function;
+		m_batchContext = context;
+		m_count = count;
+		m_batchSize = batchSize > 0 ? batchSize : 1;
+		m_nextIndex.store(0, std::memory_order_relaxed);
+		m_numWorkersBusy = (int)m_workerThreads.size();
+		m_jobGeneration++;
+	}
+	m_jobStartedCondition.notify_all();
+
+	// the caller works too, then waits for stragglers
+	RunBatches(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_jobFinishedCondition.wait(lock, [this] { return m_numWorkersBusy == 0; });
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void WorkerThreadPool::RunBatches(int threadIndex)
+{
+	for (;;)
+	{
+		int beginIndex = m_nextIndex.fetch_add(m_batchSize, std::memory_order_relaxed);
+		if (beginIndex >= m_count)
+		{
+			return;
+		}
+
+		int endIndex = beginIndex + m_batchSize < m_count ? beginIndex + m_batchSize : m_count;
+		m_batchFunction(m_batchContext, beginIndex, endIndex, threadIndex);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void WorkerThreadPool::WorkerThreadMain(int threadIndex)
+{
+	unsigned int lastJobGeneration = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobStartedCondition.wait(lock, [this, lastJobGeneration] { return m_isShuttingDown || m_jobGeneration != lastJobGeneration; });
+			if (m_isShuttingDown)
+			{
+				return;
+			}
+			lastJobGeneration = m_jobGeneration;
+		}
+
+		RunBatches(threadIndex);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_numWorkersBusy--;
+		if (m_numWorkersBusy == 0)
+		{
+			m_jobFinishedCondition.notify_one();
+		}
+	}
+}
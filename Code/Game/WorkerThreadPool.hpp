@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------------------------
+// WorkerThreadPool.hpp
+//
+// A fixed set of worker threads for data-parallel game updates. ParallelFor splits an index range
+// into batches. The calling thread and the workers then take batches from a shared counter until
+// none are left. The call returns only once every batch has finished. Each batch gets a thread
+// index (0 is the caller), so jobs can keep per-thread scratch data without locking.
+//
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+//-----------------------------------------------------------------------------------------------
+class WorkerThreadPool
+{
+public:
+	WorkerThreadPool() = default;
+	~WorkerThreadPool();
+
+	// -1 uses one worker per hardware thread beyond the caller's
+	void Startup(int numWorkerThreads = -1);
+	void Shutdown();
+
+	// worker threads plus the calling thread; size per-thread scratch with this
+	int GetNumThreads() const { return (int)m_workerThreads.size() + 1; }
+
+	// function(int beginIndex, int endIndex, int threadIndex), called on batches of up to batchSize
+	template<typename Function>
+	void ParallelFor(int count, int batchSize, Function const& function);
+
+private:
+	typedef void (*BatchFunction)(void const* context, int beginIndex, int endIndex, int threadIndex);
+
+	template<typename Function>
+	static void CallBatchFunction(void const* context, int beginIndex, int endIndex, int threadIndex)
+	{
+		(*static_cast<Function const*>(context))(beginIndex, endIndex, threadIndex);
+	}
+
+	void RunParallelFor(int count, int batchSize, BatchFunction function, void const* context);
+	void RunBatches(int threadIndex);
+	void WorkerThreadMain(int threadIndex);
+
+private:
+	std::vector<std::thread>	m_workerThreads;
+	std::mutex					m_mutex;
+	std::condition_variable		m_jobStartedCondition;
+	std::condition_variable		m_jobFinishedCondition;
+	bool						m_isShuttingDown = false;
+	unsigned int				m_jobGeneration = 0;
+	int							m_numWorkersBusy = 0;
+
+	// the job in flight; written under the mutex before workers are woken
+	BatchFunction				m_batchFunction = nullptr;
+	void const*					m_batchContext = nullptr;
+	int							m_count = 0;
+	int							m_batchSize = 1;
+	std::atomic<int>			m_nextIndex{ 0 };
+};
+
+
+//-----------------------------------------------------------------------------------------------
+template<typename Function>
+void WorkerThreadPool::ParallelFor(int count, int batchSize, Function const& function)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	// not worth waking anyone for one batch
+	if (count <= batchSize || m_workerThreads.empty())
+	{
+		function(0, count, 0);
+		return;
+	}
+
+	RunParallelFor(count, batchSize, &CallBatchFunction<Function>, &function);
+}